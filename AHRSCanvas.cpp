@@ -15,7 +15,9 @@ Stratofier Stratux AHRS Display
 #include <QTransform>
 #include <QVariant>
 #include <QScreen>
+#include <QGuiApplication>
 #include <QBitmap>
+#include <QStringList>
 
 #include <math.h>
 
@@ -31,6 +33,8 @@ Stratofier Stratux AHRS Display
 #include "DetailsDialog.h"
 #include "Overlays.h"
 #include "AHRSDraw.h"
+#include "TrafficTable.h"
+#include "AirportCache.h"
 
 
 extern QFont itsy;
@@ -40,22 +44,17 @@ extern QFont small;
 extern QFont med;
 extern QFont large;
 
-extern QList<Airport>  g_airportCache;
-extern QList<Airspace> g_airspaceCache;
+extern AirportDatabase g_airportDB;
 
 extern QSettings *g_pSet;
 
-StratuxSituation      g_situation;
-QList<StratuxTraffic> g_trafficList;
+StratuxSituation g_situation;
+TrafficTable     g_trafficTable;
 
 extern Canvas::Units g_eUnitsAirspeed;
 
-bool g_bNoAirportsUpdate = false;
-
 QString g_qsStratofierVersion( "1.9.0.0" );
 
-QFuture<void> g_apt;
-
 
 /*
 IMPORTANT NOTE:
@@ -90,8 +89,23 @@ AHRSCanvas::AHRSCanvas( QWidget *parent )
       m_tanks( { 0.0, 0.0, 0.0, 0.0, 9.0, 10.0, 8.0, 5.0, 30, true, true, QDateTime::currentDateTime() } ),
       m_dBaroPress( 29.92 ),
       m_lastTrafficUpdate( QDateTime::currentDateTime() ),
-      m_bDark( false )
+      m_bDark( false ),
+      m_frameTimer( this ),
+      m_bFrameDirty( false ),
+      m_bPaintPending( false ),
+      m_bLogFrames( false ),
+      m_uiFrameUpdatesBase( 0 ),
+      m_iFramesPainted( 0 ),
+      m_iFramesWithData( 0 ),
+      m_iFramesDropped( 0 ),
+      m_bRenderThread( false ),
+      m_bRendering( false ),
+      m_bRenderShown( false ),
+      m_bLogLayersPending( false ),
+      m_bLogTraffic( false )
 {
+    m_trafficClock.start();
+
     m_directAP.qsID = "NULL";
     m_directAP.qsName = "NULL";
     m_fromAP.qsID = "NULL";
@@ -120,6 +134,9 @@ AHRSCanvas::AHRSCanvas( QWidget *parent )
 
     loadSettings();
 
+    m_frameTimer.setTimerType( Qt::PreciseTimer );
+    connect( &m_frameTimer, SIGNAL( timeout() ), this, SLOT( frame() ) );
+
     // Quick and dirty way to ensure we're shown full screen before any calculations happen
     QTimer::singleShot( 2000, this, SLOT( init() ) );
 }
@@ -128,6 +145,7 @@ AHRSCanvas::AHRSCanvas( QWidget *parent )
 // Delete everything that needs deleting
 AHRSCanvas::~AHRSCanvas()
 {
+    waitForRender();
     if( g_pSet != Q_NULLPTR )
     {
         g_pSet->sync();
@@ -146,6 +164,7 @@ AHRSCanvas::~AHRSCanvas()
 // and start the update timer.
 void AHRSCanvas::init()
 {
+    waitForRender();
     if( m_pCanvas != Q_NULLPTR )
         delete m_pCanvas;
 
@@ -154,6 +173,10 @@ void AHRSCanvas::init()
     CanvasConstants c = m_pCanvas->constants();
     int             iBugSize = static_cast<int>( c.dWa * (m_bPortrait ? 0.1333 : 0.08) ) / 2.0;
 
+    m_numbers.build( &c );
+    m_runwayLabels.clear();
+    m_layers.invalidateAll();
+
     m_headIcon = m_headIcon.scaled( iBugSize, iBugSize, Qt::IgnoreAspectRatio, Qt::SmoothTransformation );
     m_windIcon = m_windIcon.scaled( iBugSize, iBugSize, Qt::IgnoreAspectRatio, Qt::SmoothTransformation );
 
@@ -176,6 +199,23 @@ void AHRSCanvas::init()
 
     m_iDispTimer = startTimer( 5000 );     // Update the in-memory airspace objects every 15 seconds
 
+    // Stream data is painted at most once per frame however fast it arrives, and never faster than the screen refreshes
+    double   dFrameHz = g_pSet->value( "FrameRateHz", 30.0 ).toDouble();
+    QScreen *pScreen = QGuiApplication::primaryScreen();
+
+    if( (pScreen != Q_NULLPTR) && (pScreen->refreshRate() > 1.0) && (dFrameHz > pScreen->refreshRate()) )
+        dFrameHz = pScreen->refreshRate();
+    if( dFrameHz < 1.0 )
+        dFrameHz = 1.0;
+    m_bLogFrames = g_pSet->value( "LogFrames", false ).toBool();
+    // Pixmaps get drawn on the render thread, which needs a platform with threaded pixmaps (xcb, eglfs and linuxfb are)
+    m_bRenderThread = g_pSet->value( "RenderThread", false ).toBool();
+    m_frameStatsTimer.start();
+    m_bLogTraffic = g_pSet->value( "LogTraffic", false ).toBool();
+    g_trafficTable.setTimeout( g_pSet->value( "TrafficTimeout", 30 ).toInt() );
+    m_frameTimer.start( qRound( 1000.0 / dFrameHz ) );
+    m_bFrameDirty = true;
+
     QtConcurrent::run( TrafficMath::cacheAirports );
     QtConcurrent::run( TrafficMath::cacheAirspaces );
 
@@ -219,9 +259,7 @@ void AHRSCanvas::timerEvent( QTimerEvent *pEvent )
     QDateTime qdtNow = QDateTime::currentDateTime();
 
     m_settings.eShowAirports = static_cast<Canvas::ShowAirports>( g_pSet->value( "ShowAirports", 2 ).toInt() );
-    update();
-
-    cullTrafficMap();
+    redraw();
 
     if( m_lastTrafficUpdate.secsTo( qdtNow ) > 30 )
     {
@@ -232,10 +270,9 @@ void AHRSCanvas::timerEvent( QTimerEvent *pEvent )
     // If we have a valid GPS position, run the list of airports within range by threading it so it doesn't interfere with the display update
     if( (g_situation.dGPSlat != 0.0) && (g_situation.dGPSlong != 0.0) )
     {
-        // This threaded function will crash the app if we're accessing the airports cache in the middle of an update
-        if( !g_bNoAirportsUpdate )
-            g_apt = QtConcurrent::run( TrafficMath::updateNearbyAirports, &m_airports, &m_directAP, &m_fromAP, &m_toAP, m_dZoomNM );
-        QtConcurrent::run( TrafficMath::updateNearbyAirspaces, &m_airspaces, m_dZoomNM );
+        // The workers only ever publish whole new lists so painting never sees one half built
+        updateNearbyAirports();
+        updateNearbyAirspaces();
     }
 
     if( m_bFuelFlowStarted )
@@ -283,27 +320,267 @@ void AHRSCanvas::timerEvent( QTimerEvent *pEvent )
 }
 
 
+// One display frame: collect whatever the stream thread has handed off and repaint once if anything changed
+void AHRSCanvas::frame()
+{
+    StreamReader *pStream = static_cast<AHRSMainWin *>( parentWidget()->parentWidget() )->streamReader();
+
+    // A render in flight paints from its own copy of everything, so new data can go in underneath it
+    streamData();
+    cullTrafficMap();
+    if( m_bFrameDirty )
+    {
+        if( m_bRenderThread && m_bInitialized )
+        {
+            // One render at a time; anything newer stays dirty and goes out with the next tick after it's done
+            if( !m_bRendering )
+            {
+                m_iFramesWithData++;
+                startRender();
+                m_bFrameDirty = false;
+            }
+        }
+        // The last frame hasn't been painted yet; this data goes out with it
+        else if( m_bPaintPending )
+        {
+            m_iFramesDropped++;
+            m_bFrameDirty = false;
+        }
+        else
+        {
+            m_bPaintPending = true;
+            m_iFramesWithData++;
+            update();
+            m_bFrameDirty = false;
+        }
+    }
+
+    if( m_frameStatsTimer.elapsed() >= 1000 )
+    {
+        quint32 uiUpdatesTotal = pStream->updatesTotal();
+        int     iUpdates = static_cast<int>( uiUpdatesTotal - m_uiFrameUpdatesBase );
+
+        // Merged updates are the ones that shared a frame with another
+        if( m_bLogFrames )
+            qInfo() << QString( "Frames: %1 painted, %2 updates, %3 merged, %4 dropped frames" )
+                           .arg( m_iFramesPainted ).arg( iUpdates )
+                           .arg( qMax( 0, iUpdates - m_iFramesWithData ) ).arg( m_iFramesDropped ).toLatin1().constData();
+        m_uiFrameUpdatesBase = uiUpdatesTotal;
+        m_iFramesPainted = 0;
+        m_iFramesWithData = 0;
+        m_iFramesDropped = 0;
+        m_frameStatsTimer.restart();
+
+        // The render in flight is counting into the layer stats; they're logged once it's finished
+        if( m_bLogFrames )
+        {
+            if( m_bRendering )
+                m_bLogLayersPending = true;
+            else
+                logLayers();
+        }
+
+        if( m_bLogTraffic )
+        {
+            TrafficTableStats traffic = g_trafficTable.stats();
+
+            qInfo() << QString( "Traffic: %1 tracked, %2 added, %3 refreshed, %4 expired" )
+                           .arg( traffic.iCount ).arg( traffic.uiAdded ).arg( traffic.uiRefreshed ).arg( traffic.uiExpired ).toLatin1().constData();
+        }
+    }
+}
+
+
 // Where all the magic happens
 void AHRSCanvas::paintEvent( QPaintEvent *pEvent )
 {
+    m_bPaintPending = false;
+
     if( (!m_bInitialized) || (pEvent == 0) )
         return;
 
+    m_iFramesPainted++;
+
+    // With the render thread every frame is painted there, so whatever asked for this paint it only copies out the last
+    // finished one; changes get to the screen through redraw()
+    if( m_bRenderThread )
+    {
+        QPainter screen( this );
+
+        if( !m_frontImage.isNull() )
+            screen.drawImage( 0, 0, m_frontImage );
+        m_bRenderShown = false;
+        return;
+    }
+
+    snapshotFrame();
+    renderFrame( this );
+}
+
+
+// Everything a frame paints that the GUI thread can change, copied so painting never looks at the live values.
+// The pixmaps, the canvas and the layers aren't copied; they only change in init() and orient2(), which wait for the
+// render in flight first.
+void AHRSCanvas::snapshotFrame()
+{
+    m_frame.situation = g_situation;
+    m_frame.traffic = g_trafficTable;       // Implicitly shared; whichever side changes its copy first pays for the detach
+    m_frame.airports = m_airports.current( &m_frame.iAirportsRequest );
+    m_frame.airspaces = m_airspaces.current( &m_frame.iAirspacesRequest );
+    m_frame.settings = m_settings;
+    m_frame.tanks = m_tanks;
+    m_frame.directAP = m_directAP;
+    m_frame.fromAP = m_fromAP;
+    m_frame.toAP = m_toAP;
+    m_frame.dZoomNM = m_dZoomNM;
+    m_frame.iMagDev = m_iMagDev;
+    m_frame.iHeadBugAngle = m_iHeadBugAngle;
+    m_frame.iWindBugAngle = m_iWindBugAngle;
+    m_frame.iWindBugSpeed = m_iWindBugSpeed;
+    m_frame.iAltBug = m_iAltBug;
+    m_frame.iTimerMin = m_iTimerMin;
+    m_frame.iTimerSec = m_iTimerSec;
+    m_frame.bPortrait = m_bPortrait;
+    m_frame.bDark = m_bDark;
+    m_frame.bShowGPSDetails = m_bShowGPSDetails;
+    m_frame.bShowCrosswind = m_bShowCrosswind;
+    m_frame.bDisplayTanksSwitchNotice = m_bDisplayTanksSwitchNotice;
+    m_frame.bFuelFlowStarted = m_bFuelFlowStarted;
+}
+
+
+// Paints m_frame; snapshotFrame() has to have been called for it first
+void AHRSCanvas::renderFrame( QPaintDevice *pDevice )
+{
     // Paint per orientation
-    if( m_bPortrait )
-        paintPortrait();
+    if( m_frame.bPortrait )
+        paintPortrait( pDevice );
     else
-        paintLandscape();
+        paintLandscape( pDevice );
 
-    if( m_bDark )
+    if( m_frame.bDark )
     {
-        QPainter darkPainter( this );
+        QPainter darkPainter( pDevice );
 
-        darkPainter.fillRect( rect(), QColor( 0, 0, 0, 200 ) );
+        darkPainter.fillRect( 0, 0, pDevice->width(), pDevice->height(), QColor( 0, 0, 0, 200 ) );
     }
 }
 
 
+// The frame is copied here on the GUI thread and the worker paints only the copy, so nothing has to wait for it but
+// the things that rebuild the pixmaps and canvas it paints with
+void AHRSCanvas::startRender()
+{
+    qreal dRatio = devicePixelRatioF();
+    QSize size = this->size() * dRatio;
+
+    if( (m_backImage.size() != size) || (m_backImage.devicePixelRatio() != dRatio) )
+    {
+        m_backImage = QImage( size, QImage::Format_RGB32 );
+        m_backImage.setDevicePixelRatio( dRatio );
+    }
+    m_background = palette().color( backgroundRole() );
+    snapshotFrame();
+    m_bRendering = true;
+    m_render = QtConcurrent::run( this, &AHRSCanvas::renderJob );
+}
+
+
+// Worker thread
+void AHRSCanvas::renderJob()
+{
+    m_backImage.fill( m_background );
+    renderFrame( &m_backImage );
+    QMetaObject::invokeMethod( this, "rendered", Qt::QueuedConnection );
+}
+
+
+// The finished frame goes in front and the one that was showing becomes the next one rendered into, so the next render
+// can start while this one is still waiting to be copied to the screen
+void AHRSCanvas::rendered()
+{
+    waitForRender();
+    m_bRendering = false;
+    if( m_bLogLayersPending )
+        logLayers();
+
+    // Beaten to the screen by the next render
+    if( m_bRenderShown )
+        m_iFramesDropped++;
+
+    m_frontImage.swap( m_backImage );
+    m_bRenderShown = true;
+    m_bPaintPending = true;
+    update();
+}
+
+
+void AHRSCanvas::waitForRender()
+{
+    if( m_bRendering )
+        m_render.waitForFinished();
+}
+
+
+// Reads and resets the layer counters, so only with no render in flight
+void AHRSCanvas::logLayers()
+{
+    QStringList layers;
+
+    for( int i = 0; i < Compositor::LayerCount; i++ )
+    {
+        Compositor::Layer eLayer = static_cast<Compositor::Layer>( i );
+        LayerStats        stats = m_layers.stats( eLayer );
+
+        layers.append( QString( "%1 %2 drawn %3 ms, %4 reused" )
+                           .arg( Compositor::name( eLayer ) ).arg( stats.iRedraws )
+                           .arg( stats.iRedrawNs / 1000000.0, 0, 'f', 1 ).arg( stats.iReused ) );
+    }
+    qInfo() << QString( "Layers: %1" ).arg( layers.join( ", " ) ).toLatin1().constData();
+    m_bLogLayersPending = false;
+}
+
+
+// For anything other than stream data that changes the display. With the render thread it's rendered on the next
+// frame tick along with any stream data, since a paint on the GUI thread would only copy out the last frame;
+// otherwise it's painted straight away.
+void AHRSCanvas::redraw()
+{
+    if( m_bRenderThread )
+        m_bFrameDirty = true;
+    else
+        update();
+}
+
+
+
+
+// Pull everything the stream thread has handed off since the last frame
+void AHRSCanvas::streamData()
+{
+    StreamReader           *pStream = static_cast<AHRSMainWin *>( parentWidget()->parentWidget() )->streamReader();
+    const StratuxSituation *pSituation;
+    StratuxTraffic          t;
+
+    pStream->drained();     // Re-arm first so anything pushed while draining raises a new notification
+    pSituation = pStream->takeSituation();
+    if( pSituation != nullptr )
+        situation( *pSituation );
+    while( pStream->takeTraffic( &t ) )
+        traffic( t );
+}
+
+
+// Traffic only; the situation is a mailbox that keeps the latest and waits for the frame
+void AHRSCanvas::drainTraffic()
+{
+    StreamReader  *pStream = static_cast<AHRSMainWin *>( parentWidget()->parentWidget() )->streamReader();
+    StratuxTraffic t;
+
+    pStream->drained();
+    while( pStream->takeTraffic( &t ) )
+        traffic( t );
+}
 
 
 // Situation (mostly AHRS data) update
@@ -321,57 +598,25 @@ void AHRSCanvas::situation( StratuxSituation s )
     else if( g_situation.dAHRSMagHeading > 360.0 )
         g_situation.dAHRSMagHeading -= 360.0;
     m_bUpdated = true;
-    update();
+    m_bFrameDirty = true;
 }
 
 
 // Traffic update
-void AHRSCanvas::traffic( StratuxTraffic t )
+void AHRSCanvas::traffic( const StratuxTraffic &t )
 {
-    int     i;
-    QString qsTail;
-
-    // Remove the old aircraft entry
-    for( i = 0; i < g_trafficList.count(); i++ )
-    {
-        if( g_trafficList.at( i ).qsTail == t.qsTail )
-        {
-            g_trafficList.removeAt( i );
-            break;
-        }
-    }
-
-    g_trafficList.append( t );
+    g_trafficTable.update( t, m_trafficClock.elapsed() );
     m_bUpdated = true;
-    update();
+    m_bFrameDirty = true;
     m_lastTrafficUpdate = QDateTime::currentDateTime();
 }
 
 
+// Drop traffic that hasn't reported within the timeout; the timing wheel makes this next to free when nothing has gone stale
 void AHRSCanvas::cullTrafficMap()
 {
-    if( g_trafficList.count() == 0 )
-        return;
-
-    bool           bTrafficRemoved = true;
-    QDateTime      now = QDateTime::currentDateTime();
-    StratuxTraffic thisTraffic;
-    int            i;
-
-    // Each time this is updated, remove any old entries
-    while( bTrafficRemoved )
-    {
-        bTrafficRemoved = false;
-        for( i = 0; i < g_trafficList.count(); i++ )
-        {
-            if( abs( g_trafficList.at( i ).lastActualReport.secsTo( now ) ) > 30.0 )
-            {
-                g_trafficList.removeAt( i );
-                bTrafficRemoved = true;
-                break;
-            }
-        }
-    }
+    if( g_trafficTable.expire( m_trafficClock.elapsed() ) > 0 )
+        m_bFrameDirty = true;
 }
 
 
@@ -427,7 +672,7 @@ void AHRSCanvas::mouseReleaseEvent( QMouseEvent *pEvent )
     if( m_bShowGPSDetails )
     {
         m_bShowGPSDetails = false;
-        update();
+        redraw();
         return;
     }
 
@@ -436,7 +681,7 @@ void AHRSCanvas::mouseReleaseEvent( QMouseEvent *pEvent )
         m_bDisplayTanksSwitchNotice = false;
         m_tanks.bOnLeftTank = (!m_tanks.bOnLeftTank);
         m_tanks.lastSwitch = qdtNow;
-        update();
+        redraw();
         return;
     }
 
@@ -444,7 +689,7 @@ void AHRSCanvas::mouseReleaseEvent( QMouseEvent *pEvent )
     {
         m_bShowCrosswind = (!m_bShowCrosswind);
         m_bLongPress = false;
-        update();
+        redraw();
     }
     else
     {
@@ -452,7 +697,7 @@ void AHRSCanvas::mouseReleaseEvent( QMouseEvent *pEvent )
         handleScreenPress( pt );
 
         m_bUpdated = true;
-        update();
+        redraw();
     }
 }
 
@@ -492,7 +737,7 @@ void AHRSCanvas::handleScreenPress( const QPoint &pressPt )
             m_iAltBug = static_cast<int>( keypad.value() );
         else
             m_iAltBug = -1;
-        update();
+        redraw();
     }
     // User pressed the GPS Lat/long area. This needs to be before the test for the heading indicator since it's within that area's rectangle
     else if( gpsRect.contains( pressPt ) )
@@ -520,40 +765,26 @@ void AHRSCanvas::handleScreenPress( const QPoint &pressPt )
         // Airport details requested
         else if( iButton == static_cast<int>( BugSelector::Airports ) )
         {
-            g_bNoAirportsUpdate = true;
-            g_apt.waitForFinished();
-
             AirportDialog airportDlg( this, &c, "SELECT AIRPORT" );
 
             airportDlg.setGeometry( 0, 0, c.dW, c.dH );
             if( airportDlg.exec() != QDialog::Rejected )
             {
-                Airport ap;
-                QString qsName = airportDlg.selectedAirport();
-                bool    bFound = false;
-
-                foreach( ap, g_airportCache )
-                {
-                    if( ap.qsName == qsName )
-                    {
-                        bFound = true;
-                        break;
-                    }
-                }
+                AirportDatabase::Ptr db = g_airportDB.current();
+                int                  iAirport = db->airports.findName( airportDlg.selectedAirport() );
 
-                if( bFound )
+                if( iAirport >= 0 )
                 {
+                    Airport       ap = db->airports.airport( iAirport );
                     DetailsDialog detailsDlg( this, &c, &ap );
 
                     detailsDlg.setGeometry( 0, 0, c.dW, c.dH );
 
                     detailsDlg.exec();
-                    g_bNoAirportsUpdate = false;
                     dark( false );
                     return;
                 }
             }
-            g_bNoAirportsUpdate = false;
         }
         // Bugs cleared - reset both to invalid and get out
         else if( iButton == static_cast<int>( BugSelector::ClearBugs ) )
@@ -637,9 +868,6 @@ void AHRSCanvas::handleScreenPress( const QPoint &pressPt )
     }
     else if( directRect.contains( pressPt ) )
     {
-        g_bNoAirportsUpdate = true;
-        g_apt.waitForFinished();
-
         AirportDialog dlg( this, &c, "DIRECT TO AIRPORT" );
 
         // This geometry works for both orientations
@@ -647,17 +875,11 @@ void AHRSCanvas::handleScreenPress( const QPoint &pressPt )
         // If the dialog wasn't cancelled then find the lat/long of the airport selected
         if( dlg.exec() != QDialog::Rejected )
         {
-            Airport ap;
-            QString qsName = dlg.selectedAirport();
+            AirportDatabase::Ptr db = g_airportDB.current();
+            int                  iAirport = db->airports.findName( dlg.selectedAirport() );
 
-            foreach( ap, g_airportCache )
-            {
-                if( ap.qsName == qsName )
-                {
-                    m_directAP = ap;
-                    break;
-                }
-            }
+            if( iAirport >= 0 )
+                m_directAP = db->airports.airport( iAirport );
             // Invalidate from-to in favor of direct-to
             m_fromAP.qsID = "NULL";
             m_fromAP.qsName = "NULL";
@@ -669,14 +891,9 @@ void AHRSCanvas::handleScreenPress( const QPoint &pressPt )
             m_directAP.qsID = "NULL";
             m_directAP.qsName = "NULL";
         }
-
-        g_bNoAirportsUpdate = false;
     }
     else if( fromtoRect.contains( pressPt ) )
     {
-        g_bNoAirportsUpdate = true;
-        g_apt.waitForFinished();
-
         AirportDialog dlgFrom( this, &c, "FROM AIRPORT" );
 
         // This geometry works for both orientations
@@ -684,34 +901,24 @@ void AHRSCanvas::handleScreenPress( const QPoint &pressPt )
         // If the dialog wasn't cancelled then find the lat/long of the airport selected
         if( dlgFrom.exec() != QDialog::Rejected )
         {
-            Airport ap;
-            QString qsName = dlgFrom.selectedAirport();
+            AirportDatabase::Ptr db = g_airportDB.current();
+            int                  iAirport = db->airports.findName( dlgFrom.selectedAirport() );
 
-            foreach( ap, g_airportCache )
-            {
-                if( ap.qsName == qsName )
-                {
-                    m_fromAP = ap;
-                    break;
-                }
-            }
+            if( iAirport >= 0 )
+                m_fromAP = db->airports.airport( iAirport );
 
             AirportDialog dlgTo( this, &c, "TO AIRPORT" );
 
             dlgTo.setGeometry( 0, 0, c.dW, c.dH );
             if( dlgTo.exec() != QDialog::Rejected )
             {
-                qsName = dlgTo.selectedAirport();
-
-                foreach( ap, g_airportCache )
+                db = g_airportDB.current();
+                iAirport = db->airports.findName( dlgTo.selectedAirport() );
+                if( iAirport >= 0 )
                 {
-                    if( ap.qsName == qsName )
-                    {
-                        m_directAP.qsID = "NULL";
-                        m_directAP.qsName = "NULL";
-                        m_toAP = ap;
-                        break;
-                    }
+                    m_directAP.qsID = "NULL";
+                    m_directAP.qsName = "NULL";
+                    m_toAP = db->airports.airport( iAirport );
                 }
             }
             // Invalidate direct-to in favor of from-to
@@ -734,8 +941,6 @@ void AHRSCanvas::handleScreenPress( const QPoint &pressPt )
             m_toAP.qsID = "NULL";
             m_toAP.qsName = "NULL";
         }
-
-        g_bNoAirportsUpdate = false;
     }
 }
 
@@ -769,6 +974,28 @@ void AHRSCanvas::mouseMoveEvent( QMouseEvent *pEvent )
 }
 
 
+// Starting a new request makes any still running stale, so they drop their results rather than publish them late.
+// Direct, from and to go to the worker as copies since the dialogs can change them while it runs.
+void AHRSCanvas::updateNearbyAirports()
+{
+    QList<Airport> nav;
+
+    nav << m_directAP << m_fromAP << m_toAP;
+    QtConcurrent::run( TrafficMath::updateNearbyAirports, &m_airports, m_airports.request(), nav, m_dZoomNM );
+}
+
+
+// The level of detail is picked to be about a pixel on the heading indicator at the current zoom
+void AHRSCanvas::updateNearbyAirspaces()
+{
+    double dNMPerPx = 0.0;
+
+    if( m_pCanvas != Q_NULLPTR )
+        dNMPerPx = (m_dZoomNM * 2.0) / m_pCanvas->constants().dHeadDiam;
+    QtConcurrent::run( TrafficMath::updateNearbyAirspaces, &m_airspaces, m_airspaces.request(), m_dZoomNM, dNMPerPx );
+}
+
+
 void AHRSCanvas::zoomIn()
 {
     m_dZoomNM -= 5.0;
@@ -776,7 +1003,8 @@ void AHRSCanvas::zoomIn()
         m_dZoomNM = 5.0;
     g_pSet->setValue( "ZoomNM", m_dZoomNM );
     g_pSet->sync();
-    QtConcurrent::run( TrafficMath::updateNearbyAirports, &m_airports, &m_directAP, &m_fromAP, &m_toAP, m_dZoomNM );
+    updateNearbyAirports();
+    updateNearbyAirspaces();
 }
 
 
@@ -787,7 +1015,8 @@ void AHRSCanvas::zoomOut()
         m_dZoomNM = 100.0;
     g_pSet->setValue( "ZoomNM", m_dZoomNM );
     g_pSet->sync();
-    QtConcurrent::run( TrafficMath::updateNearbyAirports, &m_airports, &m_directAP, &m_fromAP, &m_toAP, m_dZoomNM );
+    updateNearbyAirports();
+    updateNearbyAirspaces();
 }
 
 
@@ -796,7 +1025,7 @@ void AHRSCanvas::showAllTraffic( bool bAll )
     m_settings.bShowAllTraffic = bAll;
     g_pSet->setValue( "ShowAllTraffic", bAll );
     g_pSet->sync();
-    update();
+    redraw();
 }
 
 
@@ -805,7 +1034,7 @@ void AHRSCanvas::showAirports( Canvas::ShowAirports eShow )
     m_settings.eShowAirports = eShow;
     g_pSet->setValue( "ShowAirports", static_cast<int>( eShow ) );
     g_pSet->sync();
-    update();
+    redraw();
 }
 
 
@@ -814,7 +1043,7 @@ void AHRSCanvas::showPrivate( bool bShow )
     m_settings.bShowPrivate = bShow;
     g_pSet->setValue( "ShowPrivate", bShow );
     g_pSet->sync();
-    update();
+    redraw();
 }
 
 
@@ -823,7 +1052,7 @@ void AHRSCanvas::showRunways( bool bShow )
     m_settings.bShowRunways = bShow;
     g_pSet->setValue( "ShowRunways", bShow );
     g_pSet->sync();
-    update();
+    redraw();
 }
 
 
@@ -832,7 +1061,7 @@ void AHRSCanvas::showAirspaces( bool bShow )
     m_settings.bShowAirspaces = bShow;
     g_pSet->setValue( "ShowAirspaces", bShow );
     g_pSet->sync();
-    update();
+    redraw();
 }
 
 
@@ -841,24 +1070,23 @@ void AHRSCanvas::showAltitudes( bool bShow )
     m_settings.bShowAltitudes = bShow;
     g_pSet->setValue( "ShowAltitudes", bShow );
     g_pSet->sync();
-    update();
+    redraw();
 }
 
 
-void AHRSCanvas::paintPortrait()
+void AHRSCanvas::paintPortrait( QPaintDevice *pDevice )
 {
-    QPainter        ahrs( this );
+    QPainter        ahrs( pDevice );
     CanvasConstants c = m_pCanvas->constants();
     QPixmap         num( 320, 84 );
     QPolygon        shape;
     QPen            linePen( Qt::black );
-    double          dPitchH = c.dH4 + (g_situation.dAHRSpitch / 22.5 * c.dH4);     // The visible portion is only 1/4 of the 90 deg range
-    double          dSlipSkid = c.dW2 - ((g_situation.dAHRSSlipSkid / 8.0) * c.dW2);
+    double          dSlipSkid = c.dW2 - ((m_frame.situation.dAHRSSlipSkid / 8.0) * c.dW2);
     double          dPxPerVSpeed = c.dH2 / 40.0;
     double          dPxPerFt = static_cast<double>( m_AltTape.height() ) / 20000.0 * 0.99;
     double          dPxPerKnot = static_cast<double>( m_SpeedTape.height() ) / 300.0 * 0.99;
-    AHRSDraw        draw( &ahrs, &c, m_pCanvas, &m_directAP,
-                          &m_fromAP, &m_toAP, &m_airports, &m_airspaces, m_dZoomNM, &m_settings, m_iMagDev,
+    AHRSDraw        draw( &ahrs, &c, m_pCanvas, &m_numbers, &m_runwayLabels, &m_frame.situation, &m_frame.traffic,
+                          &m_frame.directAP, &m_frame.fromAP, &m_frame.toAP, m_frame.airports.get(), m_frame.airspaces.get(), m_frame.dZoomNM, &m_frame.settings, m_frame.iMagDev,
                           &m_trafficRed,
                           &m_trafficYellow,
                           &m_trafficGreen,
@@ -871,47 +1099,11 @@ void AHRSCanvas::paintPortrait()
 
     linePen.setWidth( c.iThinPen );
 
-    // Don't draw past the bottom of the fuel indicators
-    ahrs.setClipRect( 0, 0, c.dW, c.dH2 + c.dH5 );
-
     ahrs.setRenderHints( QPainter::Antialiasing | QPainter::TextAntialiasing, true );
 
-    // Translate to dead center and rotate by stratux/BADASP roll then translate back
-    ahrs.translate( c.dW2, c.dH4 );
-    ahrs.rotate( -g_situation.dAHRSroll );
-    ahrs.translate( -c.dW2, -c.dH4 );
-
-    // Top half sky blue gradient offset by stratux pitch
-    QLinearGradient skyGradient( 0.0, -c.dH2, 0.0, dPitchH );
-    skyGradient.setColorAt( 0, Qt::blue );
-    skyGradient.setColorAt( 1, QColor( 85, 170, 255 ) );
-    ahrs.fillRect( -400.0, -c.dH4, c.dW + 800.0, dPitchH + c.dH4, skyGradient );
-
-    // Draw brown gradient horizon half offset by stratux pitch
-    // Extreme overdraw accounts for extreme roll angles that might expose the corners
-    QLinearGradient groundGradient( 0.0, dPitchH, 0, c.dH2 );
-    groundGradient.setColorAt( 0, QColor( 170, 85, 0  ) );
-    groundGradient.setColorAt( 1, Qt::black );
-
-    ahrs.fillRect( -400.0, dPitchH, c.dW + 800.0, c.dH4 + c.dH5, groundGradient );
-    ahrs.setPen( linePen );
-    ahrs.drawLine( -400, dPitchH, c.dW + 800.0, dPitchH );
-
-    for( int i = 0; i < 20; i += 10 )
-    {
-        linePen.setColor( Qt::cyan );
-        ahrs.setPen( linePen );
-        ahrs.drawLine( c.dW2 - c.dW20, dPitchH - ((i + 2.5) / 45.0 * c.dH4), c.dW2 + c.dW20, dPitchH - ((i + 2.5) / 45.0 * c.dH4) );
-        ahrs.drawLine( c.dW2 - c.dW20, dPitchH - ((i + 5.0) / 45.0 * c.dH4), c.dW2 + c.dW20, dPitchH - ((i + 5.0) / 45.0 * c.dH4) );
-        ahrs.drawLine( c.dW2 - c.dW20, dPitchH - ((i + 7.5) / 45.0 * c.dH4), c.dW2 + c.dW20, dPitchH - ((i + 7.5) / 45.0 * c.dH4) );
-        ahrs.drawLine( c.dW2 - c.dW5, dPitchH - ((i + 10.0) / 45.0 * c.dH4), c.dW2 + c.dW5, dPitchH - (( i + 10.0) / 45.0 * c.dH4) );
-        linePen.setColor( QColor( 67, 33, 9 ) );
-        ahrs.setPen( linePen );
-        ahrs.drawLine( c.dW2 - c.dW20, dPitchH + ((i + 2.5) / 45.0 * c.dH4), c.dW2 + c.dW20, dPitchH + ((i + 2.5) / 45.0 * c.dH4) );
-        ahrs.drawLine( c.dW2 - c.dW20, dPitchH + ((i + 5.0) / 45.0 * c.dH4), c.dW2 + c.dW20, dPitchH + ((i + 5.0) / 45.0 * c.dH4) );
-        ahrs.drawLine( c.dW2 - c.dW20, dPitchH + ((i + 7.5) / 45.0 * c.dH4), c.dW2 + c.dW20, dPitchH + ((i + 7.5) / 45.0 * c.dH4) );
-        ahrs.drawLine( c.dW2 - c.dW5, dPitchH + ((i + 10.0) / 45.0 * c.dH4), c.dW2 + c.dW5, dPitchH + (( i + 10.0) / 45.0 * c.dH4) );
-    }
+    // Don't draw past the bottom of the fuel indicators
+    ahrs.setClipRect( 0, 0, c.dW, c.dH2 + c.dH5 );
+    paintPortraitAttitude( &ahrs, &c );
 
     // Reset rotation and clipping
     ahrs.resetTransform();
@@ -922,7 +1114,7 @@ void AHRSCanvas::paintPortrait()
 
     // Draw the top roll indicator
     ahrs.translate( c.dW2, c.dH20 + ((c.dW - c.dW5) / 2.0) );
-    ahrs.rotate( -g_situation.dAHRSroll );
+    ahrs.rotate( -m_frame.situation.dAHRSroll );
     ahrs.translate( -c.dW2, -(c.dH20 + ((c.dW - c.dW5) / 2.0)) );
     ahrs.drawPixmap( c.dW10, c.dH20, c.dW - c.dW5, c.dW - c.dW5, m_RollIndicator );
     ahrs.resetTransform();
@@ -961,36 +1153,36 @@ void AHRSCanvas::paintPortrait()
     QPainterPath maskPath, elipsePath;
 
     maskPath.addRect( 0.0, 0.0, c.dW, c.dH );
-    elipsePath.addEllipse( QPointF( (m_bPortrait ? 0.0 : c.dW) + c.dW2, c.dH - 10.0 - c.dHeadDiam2 ),
+    elipsePath.addEllipse( QPointF( (m_frame.bPortrait ? 0.0 : c.dW) + c.dW2, c.dH - 10.0 - c.dHeadDiam2 ),
                            c.dHeadDiam2, c.dHeadDiam2 );
     maskPath = maskPath.subtracted( elipsePath );
     ahrs.setClipPath( maskPath );
 
     ahrs.fillRect( c.dW - c.dW5, 0, c.dW5, c.dH2 + c.dH4, QColor( 0, 0, 0, 100 ) );
-    ahrs.drawPixmap( c.dW - c.dW5 + 5, c.dH4 + 10.0 - m_AltTape.height() + (g_situation.dBaroPressAlt * dPxPerFt), m_AltTape );
+    ahrs.drawPixmap( c.dW - c.dW5 + 5, c.dH4 + 10.0 - m_AltTape.height() + (m_frame.situation.dBaroPressAlt * dPxPerFt), m_AltTape );
 
     // Draw the Speed tape
     ahrs.fillRect( 0, 0, c.dW10 + 5.0, c.dH2, QColor( 0, 0, 0, 100 ) );
     ahrs.setClipRect( 2.0, 2.0, c.dW5 - 4.0, c.dH2 + c.dH4 );
-    if( g_situation.bHaveWTData )
-        ahrs.drawPixmap( 5, c.dH4 + 5.0 - m_SpeedTape.height() + (g_situation.dTAS * dPxPerKnot), m_SpeedTape );
+    if( m_frame.situation.bHaveWTData )
+        ahrs.drawPixmap( 5, c.dH4 + 5.0 - m_SpeedTape.height() + (m_frame.situation.dTAS * dPxPerKnot), m_SpeedTape );
     else
-        ahrs.drawPixmap( 5, c.dH4 + 5.0 - m_SpeedTape.height() + (g_situation.dGPSGroundSpeed * dPxPerKnot), m_SpeedTape );
+        ahrs.drawPixmap( 5, c.dH4 + 5.0 - m_SpeedTape.height() + (m_frame.situation.dGPSGroundSpeed * dPxPerKnot), m_SpeedTape );
     ahrs.setClipping( false );
 
     // Draw the current speed
-    if( g_situation.bHaveWTData )
+    if( m_frame.situation.bHaveWTData )
     {
-        Builder::buildNumber( &num, &c, static_cast<int>( g_situation.dTAS ), 0 );
+        Builder::buildNumber( &num, &m_numbers, static_cast<int>( m_frame.situation.dTAS ), 0 );
         draw.drawCurrSpeed( &num );
-        Builder::buildNumber( &num, &c, static_cast<int>( g_situation.dGPSGroundSpeed ), 0 );
+        Builder::buildNumber( &num, &m_numbers, static_cast<int>( m_frame.situation.dGPSGroundSpeed ), 0 );
 
         // Draw the ground speed just below the indicator since we have both, and both are useful
         draw.drawCurrSpeed( &num, true );
     }
     else
     {
-        Builder::buildNumber( &num, &c, static_cast<int>( g_situation.dGPSGroundSpeed ), 0 );
+        Builder::buildNumber( &num, &m_numbers, static_cast<int>( m_frame.situation.dGPSGroundSpeed ), 0 );
         draw.drawCurrSpeed( &num );
     }
 
@@ -1003,58 +1195,8 @@ void AHRSCanvas::paintPortrait()
 
     ahrs.setClipping( false );
 
-    // Left Tank indicators background
-    ahrs.drawPixmap( 0.0, c.dH2 + c.dH40, c.dW20, c.dH2 - c.dH5, m_Lfuel );
-    // Tank indicators level
-    QPen levelPen( Qt::black, c.dH40 + 4 );
-    levelPen.setCapStyle( Qt::RoundCap );
-    ahrs.setPen( levelPen );
-    ahrs.drawLine( 0.0,
-                   c.dH2 + c.dH40 + ((c.dH2 - c.dH5) * ((m_tanks.dLeftCapacity - m_tanks.dLeftRemaining) / m_tanks.dLeftCapacity)),
-                   c.dW40,
-                   c.dH2 + c.dH40 + ((c.dH2 - c.dH5) * ((m_tanks.dLeftCapacity - m_tanks.dLeftRemaining) / m_tanks.dLeftCapacity)) );
-    levelPen.setWidth( c.dH40 );
-    levelPen.setColor( QColor( 255, 150, 255 ) );
-    ahrs.setPen( levelPen );
-    ahrs.drawLine( 0.0,
-                   c.dH2 + c.dH40 + ((c.dH2 - c.dH5) * ((m_tanks.dLeftCapacity - m_tanks.dLeftRemaining) / m_tanks.dLeftCapacity)),
-                   c.dW40,
-                   c.dH2 + c.dH40 + ((c.dH2 - c.dH5) * ((m_tanks.dLeftCapacity - m_tanks.dLeftRemaining) / m_tanks.dLeftCapacity)) );
-
-    if( m_tanks.bDualTanks )
-    {
-        // Right Tank indicators background
-        ahrs.drawPixmap( c.dW - c.dW20 - 1, c.dH2 + c.dH40, c.dW20, c.dH2 - c.dH5, m_Rfuel );
-        // Right Tank indicators level
-        levelPen.setColor( Qt::black );
-        levelPen.setWidth( c.dH40 + 4 );
-        ahrs.setPen( levelPen );
-        ahrs.drawLine( c.dW,
-                       c.dH2 + c.dH40 + ((c.dH2 - c.dH5) * ((m_tanks.dRightCapacity - m_tanks.dRightRemaining) / m_tanks.dRightCapacity)),
-                       c.dW - c.dW40 - 1,
-                       c.dH2 + c.dH40 + ((c.dH2 - c.dH5) * ((m_tanks.dRightCapacity - m_tanks.dRightRemaining) / m_tanks.dRightCapacity)) );
-        levelPen.setWidth( c.dH40 );
-        levelPen.setColor( QColor( 255, 150, 255 ) );
-        ahrs.setPen( levelPen );
-        ahrs.drawLine( c.dW,
-                       c.dH2 + c.dH40 + ((c.dH2 - c.dH5) * ((m_tanks.dRightCapacity - m_tanks.dRightRemaining) / m_tanks.dRightCapacity)),
-                       c.dW - c.dW40 - 1,
-                       c.dH2 + c.dH40 + ((c.dH2 - c.dH5) * ((m_tanks.dRightCapacity - m_tanks.dRightRemaining) / m_tanks.dRightCapacity)) );
-    }
-
-    // Tank indicator active indicators
+    paintFuelLayer( &ahrs, &c );
     ahrs.setFont( large );
-    if( m_bFuelFlowStarted )
-    {
-        QPen fuelPen( Qt::yellow, c.dH80 );
-
-        ahrs.setPen( fuelPen );
-
-        if( m_tanks.bOnLeftTank || (!m_tanks.bDualTanks) )
-            ahrs.drawLine( 0, c.dH2 + c.dH40 - 15, c.dW10 - 2, c.dH2 + c.dH40 - 15 );
-        else
-            ahrs.drawLine( c.dW - c.dW10 + 2, c.dH2 + c.dH40 - 15, c.dW, c.dH2 + c.dH40 - 15 );
-    }
 
     // Arrow for heading position above heading dial
     arrow.clear();
@@ -1069,18 +1211,18 @@ void AHRSCanvas::paintPortrait()
     ahrs.setPen( QPen( Qt::white, c.iThinPen ) );
     ahrs.setBrush( Qt::black );
     ahrs.drawRect( c.dW2 - (c.dWNum * 3.0 / 2.0) - (c.dW * 0.0125), arrow.boundingRect().y() - c.dHNum - c.dH40 - (c.dH * 0.0075), (c.dWNum * 3.0) + (c.dW * 0.025), c.dHNum + (c.dH * 0.015) );
-    if( g_situation.bHaveWTData )
-        Builder::buildNumber( &num, &c, static_cast<int>( g_situation.dAHRSMagHeading ), 3 );
+    if( m_frame.situation.bHaveWTData )
+        Builder::buildNumber( &num, &m_numbers, static_cast<int>( m_frame.situation.dAHRSMagHeading ), 3 );
     else
-        Builder::buildNumber( &num, &c, static_cast<int>( g_situation.dAHRSGyroHeading ), 3 );
+        Builder::buildNumber( &num, &m_numbers, static_cast<int>( m_frame.situation.dAHRSGyroHeading ), 3 );
     ahrs.drawPixmap( c.dW2 - (c.dWNum * 3.0 / 2.0), arrow.boundingRect().y() - c.dHNum - c.dH40, num );
 
     // Draw the heading pixmap and rotate it to the current heading
     ahrs.translate( c.dW2, c.dH - 10.0 - c.dHeadDiam2 );
-    if( g_situation.bHaveWTData )
-        ahrs.rotate( -g_situation.dAHRSMagHeading );
+    if( m_frame.situation.bHaveWTData )
+        ahrs.rotate( -m_frame.situation.dAHRSMagHeading );
     else
-        ahrs.rotate( -g_situation.dAHRSGyroHeading );
+        ahrs.rotate( -m_frame.situation.dAHRSGyroHeading );
     ahrs.translate( -c.dW2, -(c.dH - 10.0 - c.dHeadDiam2) );
     ahrs.drawPixmap( c.dW2 - c.dHeadDiam2, c.dH - 10.0 - c.dHeadDiam, c.dHeadDiam, c.dHeadDiam,  m_HeadIndicator );
     ahrs.resetTransform();
@@ -1091,9 +1233,9 @@ void AHRSCanvas::paintPortrait()
     ahrs.drawPixmap( c.dW2 - c.dW20, c.dH - 10.0 - c.dHeadDiam2 - c.dW20, c.dW10, c.dW10, m_planeIcon );
 
     // Draw the altitude bug
-    if( m_iAltBug >= 0 )
+    if( m_frame.iAltBug >= 0 )
     {
-        double dAltTip = c.dH4 - 10.0 - ((static_cast<double>( m_iAltBug ) - g_situation.dBaroPressAlt) * dPxPerFt);
+        double dAltTip = c.dH4 - 10.0 - ((static_cast<double>( m_frame.iAltBug ) - m_frame.situation.dBaroPressAlt) * dPxPerFt);
 
         ahrs.drawPixmap( c.dW - c.dW5 - c.dW20, dAltTip - c.dH40, c.dW20, c.dH20, m_AltBug );
     }
@@ -1103,7 +1245,7 @@ void AHRSCanvas::paintPortrait()
     ahrs.drawPixmap( c.dW - c.dW20, 0, c.dW20, c.dH2, m_VertSpeedTape );
 
     // Draw the vertical speed indicator
-    ahrs.translate( 0.0, c.dH4 - (dPxPerVSpeed * g_situation.dGPSVertSpeed / 100.0 * 0.98) );   // 98% accounts for the slight margin on each end
+    ahrs.translate( 0.0, c.dH4 - (dPxPerVSpeed * m_frame.situation.dGPSVertSpeed / 100.0 * 0.98) );   // 98% accounts for the slight margin on each end
     arrow.clear();
     arrow.append( QPoint( c.dW - m_pCanvas->scaledH( 30.0 ), 0.0 ) );
     arrow.append( QPoint( c.dW - m_pCanvas->scaledH( 20.0 ), m_pCanvas->scaledV( -7.0 ) ) );
@@ -1114,7 +1256,7 @@ void AHRSCanvas::paintPortrait()
     ahrs.setBrush( Qt::white );
     ahrs.drawPolygon( arrow );
 
-    QString qsFullVspeed = QString::number( g_situation.dGPSVertSpeed / 100.0, 'f', 1 );
+    QString qsFullVspeed = QString::number( m_frame.situation.dGPSVertSpeed / 100.0, 'f', 1 );
     QString qsFracVspeed = qsFullVspeed.right( 1 );
     QString qsIntVspeed = qsFullVspeed.left( qsFullVspeed.length() - 2 );
     QFontMetrics weeMetrics( wee );
@@ -1128,7 +1270,7 @@ void AHRSCanvas::paintPortrait()
     ahrs.resetTransform();
 
     // Draw the current altitude
-    Builder::buildNumber( &num, &c, static_cast<int>( g_situation.dBaroPressAlt ), 0 );
+    Builder::buildNumber( &num, &m_numbers, static_cast<int>( m_frame.situation.dBaroPressAlt ), 0 );
     draw.drawCurrAlt( &num );
 
     // Draw the G-Force indicator scale
@@ -1149,16 +1291,12 @@ void AHRSCanvas::paintPortrait()
     arrow.append( QPoint( m_pCanvas->scaledH( 16.0 ), c.dH - c.iTinyFontHeight - m_pCanvas->scaledV( 25.0 ) ) );
     ahrs.setPen( Qt::black );
     ahrs.setBrush( Qt::white );
-    ahrs.translate( c.dW - c.dW5 + (c.iTinyFontWidth / 2) + (fabs( 1.0 - g_situation.dAHRSGLoad ) * c.dW5 * 20.0), -c.dH160 );
+    ahrs.translate( c.dW - c.dW5 + (c.iTinyFontWidth / 2) + (fabs( 1.0 - m_frame.situation.dAHRSGLoad ) * c.dW5 * 20.0), -c.dH160 );
     ahrs.drawPolygon( arrow );
     ahrs.resetTransform();
 
-    // Update the airspace positions
-    draw.updateAirspaces();
-
-    // Update the airport positions
-    if( m_settings.eShowAirports != Canvas::ShowNoAirports )
-        draw.updateAirports();
+    // Update the airspace and airport positions
+    paintNavLayer( &ahrs, &c, m_frame.airports.get(), m_frame.airspaces.get() );
 
     // Update the traffic positions
     draw.updateTraffic();
@@ -1168,27 +1306,27 @@ void AHRSCanvas::paintPortrait()
 
     // Draw the transparent overlay over the existing heading so the ticks and heading numbers are always visible
     ahrs.translate( c.dW2, c.dH - 10.0 - c.dHeadDiam2 );
-    if( g_situation.bHaveWTData )
-        ahrs.rotate( -g_situation.dAHRSMagHeading );
+    if( m_frame.situation.bHaveWTData )
+        ahrs.rotate( -m_frame.situation.dAHRSMagHeading );
     else
-        ahrs.rotate( -g_situation.dAHRSGyroHeading );
+        ahrs.rotate( -m_frame.situation.dAHRSGyroHeading );
     ahrs.translate( -c.dW2, -(c.dH - 10.0 - c.dHeadDiam2) );
     ahrs.drawPixmap( c.dW2 - c.dHeadDiam2, c.dH - 10.0 - c.dHeadDiam, c.dHeadDiam, c.dHeadDiam,  m_HeadIndicatorOverlay );
     ahrs.resetTransform();
 
     // Draw the heading bug
-    if( m_iHeadBugAngle >= 0 )
+    if( m_frame.iHeadBugAngle >= 0 )
     {
         ahrs.translate( c.dW2, c.dH - 10.0 - c.dHeadDiam2 );
-        if( g_situation.bHaveWTData )
-            ahrs.rotate( m_iHeadBugAngle - g_situation.dAHRSMagHeading );
+        if( m_frame.situation.bHaveWTData )
+            ahrs.rotate( m_frame.iHeadBugAngle - m_frame.situation.dAHRSMagHeading );
         else
-            ahrs.rotate( m_iHeadBugAngle - g_situation.dAHRSGyroHeading );
+            ahrs.rotate( m_frame.iHeadBugAngle - m_frame.situation.dAHRSGyroHeading );
         ahrs.translate( -c.dW2, -(c.dH - 10.0 - c.dHeadDiam2) );
         ahrs.drawPixmap( c.dW2 - (m_headIcon.width() / 2), c.dH - 10.0 - c.dHeadDiam - (m_headIcon.height() / 2), m_headIcon );
 
         // If long press triggered crosswind component display and the wind bug is set
-        if( m_bShowCrosswind && (m_iWindBugAngle >= 0) )
+        if( m_frame.bShowCrosswind && (m_frame.iWindBugAngle >= 0) )
         {
             linePen.setWidth( c.iThinPen );
             linePen.setColor( QColor( 0xFF, 0x90, 0x01 ) );
@@ -1200,17 +1338,17 @@ void AHRSCanvas::paintPortrait()
     }
 
     // Draw the wind bug
-    if( m_iWindBugAngle >= 0 )
+    if( m_frame.iWindBugAngle >= 0 )
     {
         ahrs.translate( c.dW2, c.dH - 10.0 - c.dHeadDiam2 );
-        if( g_situation.bHaveWTData )
-            ahrs.rotate( m_iWindBugAngle - g_situation.dAHRSMagHeading );
+        if( m_frame.situation.bHaveWTData )
+            ahrs.rotate( m_frame.iWindBugAngle - m_frame.situation.dAHRSMagHeading );
         else
-            ahrs.rotate( m_iWindBugAngle - g_situation.dAHRSGyroHeading );
+            ahrs.rotate( m_frame.iWindBugAngle - m_frame.situation.dAHRSGyroHeading );
         ahrs.translate( -c.dW2, -(c.dH - 10.0 - c.dHeadDiam2) );
         ahrs.drawPixmap( c.dW2 - (m_headIcon.width() / 2), c.dH - 10.0 - c.dHeadDiam - (m_headIcon.height() / 2), m_windIcon );
 
-        QString      qsWind = QString::number( m_iWindBugSpeed );
+        QString      qsWind = QString::number( m_frame.iWindBugSpeed );
         QFontMetrics windMetrics( tiny );
         QRect        windRect = windMetrics.boundingRect( qsWind );
 
@@ -1221,7 +1359,7 @@ void AHRSCanvas::paintPortrait()
         ahrs.drawText( c.dW2 - (windRect.width() / 2) - 1, c.dH - c.dHeadDiam - c.dH160 - 1, qsWind );
 
         // If long press triggered crosswind component display and the heading bug is set
-        if( m_bShowCrosswind && (m_iHeadBugAngle >= 0) )
+        if( m_frame.bShowCrosswind && (m_frame.iHeadBugAngle >= 0) )
         {
             linePen.setWidth( c.iThinPen );
             linePen.setColor( Qt::cyan );
@@ -1229,20 +1367,20 @@ void AHRSCanvas::paintPortrait()
             ahrs.drawLine( c.dW2, c.dH - 10 - c.dHeadDiam, c.dW2, c.dH - 10.0 - c.dHeadDiam2 );
 
             // Draw the crosswind component calculated from heading vs wind
-            double dAng = fabs( static_cast<double>( m_iWindBugAngle ) - static_cast<double>( m_iHeadBugAngle ) );
+            double dAng = fabs( static_cast<double>( m_frame.iWindBugAngle ) - static_cast<double>( m_frame.iHeadBugAngle ) );
             while( dAng > 180.0 )
                 dAng -= 360.0;
             dAng = fabs( dAng );
-            double dCrossComp = fabs( static_cast<double>( m_iWindBugSpeed ) * sin( dAng * ToRad ) );
+            double dCrossComp = fabs( static_cast<double>( m_frame.iWindBugSpeed ) * sin( dAng * ToRad ) );
             double dCrossPos = c.dH - (c.dW / 1.3) - 10.0;
             QString qsCrossAng = QString( "%1%2" ).arg( static_cast<int>( dAng ) ).arg( QChar( 176 ) );
 
             ahrs.resetTransform();
             ahrs.translate( c.dW2, c.dH - c.dW2 - 10.0 );
-            if( g_situation.bHaveWTData )
-                ahrs.rotate( m_iHeadBugAngle - g_situation.dAHRSMagHeading );
+            if( m_frame.situation.bHaveWTData )
+                ahrs.rotate( m_frame.iHeadBugAngle - m_frame.situation.dAHRSMagHeading );
             else
-                ahrs.rotate( m_iHeadBugAngle - g_situation.dAHRSGyroHeading );
+                ahrs.rotate( m_frame.iHeadBugAngle - m_frame.situation.dAHRSGyroHeading );
             ahrs.translate( -c.dW2, -(c.dH - c.dW2 - 10.0) );
             ahrs.setFont( large );
             ahrs.setPen( Qt::black );
@@ -1259,34 +1397,33 @@ void AHRSCanvas::paintPortrait()
         ahrs.resetTransform();
     }
 
-    if( (m_iTimerMin >= 0) && (m_iTimerSec >= 0) )
-        draw.paintTimer( m_iTimerMin, m_iTimerSec );
+    if( (m_frame.iTimerMin >= 0) && (m_frame.iTimerSec >= 0) )
+        draw.paintTimer( m_frame.iTimerMin, m_frame.iTimerSec );
 
     draw.paintTemp();
 
-    if( m_bShowGPSDetails )
+    if( m_frame.bShowGPSDetails )
         draw.paintInfo();
-    else if( m_bDisplayTanksSwitchNotice )
-        draw.paintSwitchNotice( &m_tanks );
+    else if( m_frame.bDisplayTanksSwitchNotice )
+        draw.paintSwitchNotice( &m_frame.tanks );
 }
 
 
 
-void AHRSCanvas::paintLandscape()
+void AHRSCanvas::paintLandscape( QPaintDevice *pDevice )
 {
-    QPainter        ahrs( this );
+    QPainter        ahrs( pDevice );
     CanvasConstants c = m_pCanvas->constants();
-    double          dPitchH = c.dH2 + (g_situation.dAHRSpitch / 22.5 * c.dH2);     // The visible portion is only 1/4 of the 90 deg range
     QPolygon        shape;
     QPen            linePen( Qt::black );
-    double          dSlipSkid = c.dW2 - ((g_situation.dAHRSSlipSkid / 100.0) * c.dW2);
+    double          dSlipSkid = c.dW2 - ((m_frame.situation.dAHRSSlipSkid / 100.0) * c.dW2);
     double          dPxPerVSpeed = c.dH / 40.0;
     double          dPxPerKnot = static_cast<double>( m_SpeedTape.height() ) / 300.0 * 0.99;
     double          dPxPerFt = static_cast<double>( m_AltTape.height() ) / 20000.0 * 0.99;  // 0.99 accounts for the few pixels above and below the numbers in the pixmap that offset the position at the extremes of the scale
     QFontMetrics    tinyMetrics( tiny );
     QPixmap         num( 320, 84 );
-    AHRSDraw        draw( &ahrs, &c, m_pCanvas,
-                          &m_directAP, &m_fromAP, &m_toAP, &m_airports, &m_airspaces, m_dZoomNM, &m_settings, m_iMagDev,
+    AHRSDraw        draw( &ahrs, &c, m_pCanvas, &m_numbers, &m_runwayLabels, &m_frame.situation, &m_frame.traffic,
+                          &m_frame.directAP, &m_frame.fromAP, &m_frame.toAP, m_frame.airports.get(), m_frame.airspaces.get(), m_frame.dZoomNM, &m_frame.settings, m_frame.iMagDev,
                           &m_trafficRed,
                           &m_trafficYellow,
                           &m_trafficGreen,
@@ -1304,52 +1441,10 @@ void AHRSCanvas::paintLandscape()
 
     // Clip the attitude to the left half of the display
     ahrs.setClipRect( 0, 0, c.dW, c.dH );
+    paintLandscapeAttitude( &ahrs, &c );
 
-    // Translate to dead center and rotate by stratux roll then translate back
-    ahrs.translate( c.dW2 - c.dW20, c.dH2 );
-    ahrs.rotate( -g_situation.dAHRSroll );
-    ahrs.translate( -(c.dW2 - c.dW20), -c.dH2 );
-
-    ahrs.translate( -c.dW20, 0.0 );
-
-    // Top half sky blue gradient offset by stratux pitch
-    QLinearGradient skyGradient( 0.0, -c.dH4, 0.0, dPitchH );
-    skyGradient.setColorAt( 0, Qt::blue );
-    skyGradient.setColorAt( 1, QColor( 85, 170, 255 ) );
-    ahrs.fillRect( -400.0, -c.dH4, c.dW + 800.0, dPitchH + c.dH4, skyGradient );
-
-    // Draw brown gradient horizon half offset by stratux pitch
-    // Extreme overdraw accounts for extreme roll angles that might expose the corners
-    QLinearGradient groundGradient( 0.0, c.dH2, 0, c.dH + c.dH4 );
-    groundGradient.setColorAt( 0, QColor( 170, 85, 0 ) );
-    groundGradient.setColorAt( 1, Qt::black );
-
-    ahrs.fillRect( -400.0, dPitchH, c.dW + 800.0, c.dH, groundGradient );
-    ahrs.setPen( linePen );
-    ahrs.drawLine( -400, dPitchH, c.dW + 800.0, dPitchH );
-
-    for( double i = 0.0; i < 20.0; i += 10.0 )
-    {
-        linePen.setColor( Qt::cyan );
-        ahrs.setPen( linePen );
-        ahrs.drawLine( c.dW2 - c.dW20, dPitchH - ((i + 2.5) / 45.0 * c.dH2), c.dW2 + c.dW20, dPitchH - ((i + 2.5) / 45.0 * c.dH2) );
-        ahrs.drawLine( c.dW2 - c.dW20, dPitchH - ((i + 5.0) / 45.0 * c.dH2), c.dW2 + c.dW20, dPitchH - ((i + 5.0) / 45.0 * c.dH2) );
-        ahrs.drawLine( c.dW2 - c.dW20, dPitchH - ((i + 7.5) / 45.0 * c.dH2), c.dW2 + c.dW20, dPitchH - ((i + 7.5) / 45.0 * c.dH2) );
-        ahrs.drawLine( c.dW2 - c.dW5, dPitchH - ((i + 10.0) / 45.0 * c.dH2), c.dW2 + c.dW5, dPitchH - (( i + 10.0) / 45.0 * c.dH2) );
-        linePen.setColor( QColor( 67, 33, 9 ) );
-        ahrs.setPen( linePen );
-        ahrs.drawLine( c.dW2 - c.dW20, dPitchH + ((i + 2.5) / 45.0 * c.dH2), c.dW2 + c.dW20, dPitchH + ((i + 2.5) / 45.0 * c.dH2) );
-        ahrs.drawLine( c.dW2 - c.dW20, dPitchH + ((i + 5.0) / 45.0 * c.dH2), c.dW2 + c.dW20, dPitchH + ((i + 5.0) / 45.0 * c.dH2) );
-        ahrs.drawLine( c.dW2 - c.dW20, dPitchH + ((i + 7.5) / 45.0 * c.dH2), c.dW2 + c.dW20, dPitchH + ((i + 7.5) / 45.0 * c.dH2) );
-        ahrs.drawLine( c.dW2 - c.dW5, dPitchH + ((i + 10.0) / 45.0 * c.dH2), c.dW2 + c.dW5, dPitchH + (( i + 10.0) / 45.0 * c.dH2) );
-    }
-
-    ahrs.translate( c.dW20, 0.0 );
-
-    // Reset rotation
+    // Reset rotation and remove the clipping rect
     ahrs.resetTransform();
-
-    // Remove the clipping rect
     ahrs.setClipping( false );
 
     ahrs.translate( -c.dW20, 0.0 );
@@ -1359,7 +1454,7 @@ void AHRSCanvas::paintLandscape()
 
     // Draw the top roll indicator
     ahrs.translate( c.dW2, c.dH20 + ((c.dW - c.dW5) / 2.0) );
-    ahrs.rotate( -g_situation.dAHRSroll );
+    ahrs.rotate( -m_frame.situation.dAHRSroll );
     ahrs.translate( -c.dW2, -(c.dH20 + ((c.dW - c.dW5) / 2.0)) );
     ahrs.drawPixmap( c.dW2 - ((c.dW - c.dW5) / 2.0), c.dH20, c.dW - c.dW5, c.dW - c.dW5, m_RollIndicator );
     ahrs.resetTransform();
@@ -1409,10 +1504,10 @@ void AHRSCanvas::paintLandscape()
 
     // Draw the heading pixmap and rotate it to the current heading
     ahrs.translate( c.dW + c.dW2, c.dH - 10.0 - c.dHeadDiam2 );
-    if( g_situation.bHaveWTData )
-        ahrs.rotate( -g_situation.dAHRSMagHeading );
+    if( m_frame.situation.bHaveWTData )
+        ahrs.rotate( -m_frame.situation.dAHRSMagHeading );
     else
-        ahrs.rotate( -g_situation.dAHRSGyroHeading );
+        ahrs.rotate( -m_frame.situation.dAHRSGyroHeading );
     ahrs.translate( -(c.dW + c.dW2), -(c.dH - 10.0 - c.dHeadDiam2) );
     ahrs.drawPixmap( c.dW + c.dW2 - c.dHeadDiam2, c.dH - 10.0 - c.dHeadDiam, c.dHeadDiam, c.dHeadDiam, m_HeadIndicator );
     ahrs.resetTransform();
@@ -1424,12 +1519,12 @@ void AHRSCanvas::paintLandscape()
 
     // Draw the Altitude tape
     ahrs.fillRect( c.dW - c.dW5 - c.dW40, 0, c.dW5 + c.dW40, c.dH, QColor( 0, 0, 0, 100 ) );
-    ahrs.drawPixmap( c.dW - c.dW5 - c.dW40 + 5, c.dH2 + 10.0 - m_AltTape.height() + (g_situation.dBaroPressAlt * dPxPerFt) , m_AltTape );
+    ahrs.drawPixmap( c.dW - c.dW5 - c.dW40 + 5, c.dH2 + 10.0 - m_AltTape.height() + (m_frame.situation.dBaroPressAlt * dPxPerFt) , m_AltTape );
 
     // Draw the altitude bug
-    if( m_iAltBug >= 0 )
+    if( m_frame.iAltBug >= 0 )
     {
-        double dAltTip = c.dH2 - 10.0 - ((static_cast<double>( m_iAltBug ) - g_situation.dBaroPressAlt) * dPxPerFt);
+        double dAltTip = c.dH2 - 10.0 - ((static_cast<double>( m_frame.iAltBug ) - m_frame.situation.dBaroPressAlt) * dPxPerFt);
 
         ahrs.drawPixmap( c.dW - c.dW5 - c.dW20 - c.dW40, dAltTip - c.dH40, c.dW20, c.dH20, m_AltBug );
     }
@@ -1439,7 +1534,7 @@ void AHRSCanvas::paintLandscape()
     ahrs.drawPixmap( c.dW - c.dW20, 0, c.dW20, c.dH, m_VertSpeedTape );
 
     // Draw the vertical speed indicator
-    ahrs.translate( 0.0, c.dH2 - (dPxPerVSpeed * g_situation.dGPSVertSpeed / 100.0 * 0.98) );   // 98% accounts for the slight margin on each end
+    ahrs.translate( 0.0, c.dH2 - (dPxPerVSpeed * m_frame.situation.dGPSVertSpeed / 100.0 * 0.98) );   // 98% accounts for the slight margin on each end
     arrow.clear();
     arrow.append( QPoint( c.dW - m_pCanvas->scaledH( 30.0 ), 0.0 ) );
     arrow.append( QPoint( c.dW - m_pCanvas->scaledH( 20.0 ), m_pCanvas->scaledV( -7.0 ) ) );
@@ -1450,7 +1545,7 @@ void AHRSCanvas::paintLandscape()
     ahrs.setBrush( Qt::white );
     ahrs.drawPolygon( arrow );
 
-    QString qsFullVspeed = QString::number( g_situation.dGPSVertSpeed / 100.0, 'f', 1 );
+    QString qsFullVspeed = QString::number( m_frame.situation.dGPSVertSpeed / 100.0, 'f', 1 );
     QString qsFracVspeed = qsFullVspeed.right( 1 );
     QString qsIntVspeed = qsFullVspeed.left( qsFullVspeed.length() - 2 );
     QFontMetrics weeMetrics( wee );
@@ -1465,26 +1560,26 @@ void AHRSCanvas::paintLandscape()
     ahrs.resetTransform();
 
     // Draw the current altitude
-    Builder::buildNumber( &num, &c, static_cast<int>( g_situation.dBaroPressAlt ), 0 );
+    Builder::buildNumber( &num, &m_numbers, static_cast<int>( m_frame.situation.dBaroPressAlt ), 0 );
     draw.drawCurrAlt( &num );
 
     // Draw the Speed tape
     ahrs.fillRect( 0, 0, c.dW10 + 5.0, c.dH, QColor( 0, 0, 0, 100 ) );
-    ahrs.drawPixmap( 5, c.dH2 + 5.0 - m_SpeedTape.height() + (g_situation.dGPSGroundSpeed * dPxPerKnot), m_SpeedTape );
+    ahrs.drawPixmap( 5, c.dH2 + 5.0 - m_SpeedTape.height() + (m_frame.situation.dGPSGroundSpeed * dPxPerKnot), m_SpeedTape );
 
     // Draw the current speed
-    if( g_situation.bHaveWTData )
+    if( m_frame.situation.bHaveWTData )
     {
-        Builder::buildNumber( &num, &c, static_cast<int>( g_situation.dTAS ), 0 );
+        Builder::buildNumber( &num, &m_numbers, static_cast<int>( m_frame.situation.dTAS ), 0 );
         draw.drawCurrSpeed( &num );
-        Builder::buildNumber( &num, &c, static_cast<int>( g_situation.dGPSGroundSpeed ), 0 );
+        Builder::buildNumber( &num, &m_numbers, static_cast<int>( m_frame.situation.dGPSGroundSpeed ), 0 );
 
         // Draw the ground speed just below the indicator since we have both, and both are useful
         draw.drawCurrSpeed( &num, true );
     }
     else
     {
-        Builder::buildNumber( &num, &c, static_cast<int>( g_situation.dGPSGroundSpeed ), 0 );
+        Builder::buildNumber( &num, &m_numbers, static_cast<int>( m_frame.situation.dGPSGroundSpeed ), 0 );
         draw.drawCurrSpeed( &num );
     }
 
@@ -1508,10 +1603,10 @@ void AHRSCanvas::paintLandscape()
     ahrs.setPen( QPen( Qt::white, c.iThinPen ) );
     ahrs.setBrush( Qt::black );
     ahrs.drawRect( c.dW + c.dW2 - (c.dWNum * 3.0 / 2.0) - (c.dW * 0.0125), 10.0, (c.dWNum * 3.0) + (c.dW * 0.025), c.dHNum + (c.dH * 0.015) );
-    if( g_situation.bHaveWTData )
-        Builder::buildNumber( &num, &c, static_cast<int>( g_situation.dAHRSMagHeading ), 3 );
+    if( m_frame.situation.bHaveWTData )
+        Builder::buildNumber( &num, &m_numbers, static_cast<int>( m_frame.situation.dAHRSMagHeading ), 3 );
     else
-        Builder::buildNumber( &num, &c, static_cast<int>( g_situation.dAHRSGyroHeading ), 3 );
+        Builder::buildNumber( &num, &m_numbers, static_cast<int>( m_frame.situation.dAHRSGyroHeading ), 3 );
     ahrs.drawPixmap( c.dW + c.dW2 - (c.dWNum * 3.0 / 2.0), 10.0 + (c.dH * 0.0075), num );
 
     // Draw the G-Force indicator box and scale
@@ -1532,73 +1627,15 @@ void AHRSCanvas::paintLandscape()
     arrow.append( QPoint( 16.0, c.dH - c.iTinyFontHeight - 25.0 ) );
     ahrs.setPen( Qt::black );
     ahrs.setBrush( Qt::white );
-    ahrs.translate( (fabs( 1.0 - g_situation.dAHRSGLoad ) * (c.dW5 + c.dW10) * 20.0) + c.dW2 - c.dW20 - c.dW10, -c.dH80 );
+    ahrs.translate( (fabs( 1.0 - m_frame.situation.dAHRSGLoad ) * (c.dW5 + c.dW10) * 20.0) + c.dW2 - c.dW20 - c.dW10, -c.dH80 );
     ahrs.drawPolygon( arrow );
     ahrs.resetTransform();
 
-    // Left Tank indicators background
-    ahrs.drawPixmap( c.dW10 + c.dW20, c.dH2 + c.dH10, c.dW20, c.dH2 - c.dH5, m_Lfuel );
-    // Tank indicators level
-    QPen levelPen( Qt::black, c.dH40 + 4 );
-    levelPen.setCapStyle( Qt::RoundCap );
-    ahrs.setPen( levelPen );
-    ahrs.drawLine( c.dW10 + c.dW20,
-                   c.dH2 + c.dH10 + ((c.dH2 - c.dH5) * ((m_tanks.dLeftCapacity - m_tanks.dLeftRemaining) / m_tanks.dLeftCapacity)),
-                   c.dW40 + c.dW10 + c.dW20,
-                   c.dH2 + c.dH10 + ((c.dH2 - c.dH5) * ((m_tanks.dLeftCapacity - m_tanks.dLeftRemaining) / m_tanks.dLeftCapacity)) );
-    levelPen.setWidth( c.dH40 );
-    levelPen.setColor( QColor( 255, 150, 255 ) );
-    ahrs.setPen( levelPen );
-    ahrs.drawLine( c.dW10 + c.dW20,
-                   c.dH2 + c.dH10 + ((c.dH2 - c.dH5) * ((m_tanks.dLeftCapacity - m_tanks.dLeftRemaining) / m_tanks.dLeftCapacity)),
-                   c.dW40 + c.dW10 + c.dW20,
-                   c.dH2 + c.dH10 + ((c.dH2 - c.dH5) * ((m_tanks.dLeftCapacity - m_tanks.dLeftRemaining) / m_tanks.dLeftCapacity)) );
-    // Right Tank indicators background
-    ahrs.drawPixmap( c.dW - c.dW5 - c.dW10 - 1, c.dH2 + c.dH10, c.dW20, c.dH2 - c.dH5, m_Rfuel );
-    // Right Tank indicators level
-    levelPen.setColor( Qt::black );
-    levelPen.setWidth( c.dH40 + 4 );
-    ahrs.setPen( levelPen );
-    ahrs.drawLine( c.dW - c.dW5 - c.dW20,
-                   c.dH2 + c.dH10 + ((c.dH2 - c.dH5) * ((m_tanks.dRightCapacity - m_tanks.dRightRemaining) / m_tanks.dRightCapacity)),
-                   c.dW - c.dW40 - c.dW5 - c.dW20 - 1,
-                   c.dH2 + c.dH10 + ((c.dH2 - c.dH5) * ((m_tanks.dRightCapacity - m_tanks.dRightRemaining) / m_tanks.dRightCapacity)) );
-    levelPen.setWidth( c.dH40 );
-    levelPen.setColor( QColor( 255, 150, 255 ) );
-    ahrs.setPen( levelPen );
-    ahrs.drawLine( c.dW - c.dW5 - c.dW20,
-                   c.dH2 + c.dH10 + ((c.dH2 - c.dH5) * ((m_tanks.dRightCapacity - m_tanks.dRightRemaining) / m_tanks.dRightCapacity)),
-                   c.dW - c.dW40 - c.dW5 - c.dW20 - 1,
-                   c.dH2 + c.dH10 + ((c.dH2 - c.dH5) * ((m_tanks.dRightCapacity - m_tanks.dRightRemaining) / m_tanks.dRightCapacity)) );
-
-    // Tank indicator active indicators
+    paintFuelLayer( &ahrs, &c );
     ahrs.setFont( large );
-    if( m_bFuelFlowStarted )
-    {
-        QPen fuelPen( Qt::yellow, c.dH80 );
-
-        ahrs.setPen( fuelPen );
-
-        if( !m_tanks.bDualTanks )
-        {
-            ahrs.drawLine( c.dW10, c.dH2 + c.dH10 - c.dH80 - 5, c.dW10, c.dH2 + c.dH10 - c.dH80 - 5 );
-            ahrs.drawLine( c.dW - c.dW5 - c.dW10, c.dH2 + c.dH10 - c.dH80 - 5, c.dW - c.dW5, c.dH2 + c.dH10 - c.dH80 - 5 );
-        }
-        else
-        {
-            if( m_tanks.bOnLeftTank )
-                ahrs.drawLine( c.dW10, c.dH2 + c.dH10 - 15, c.dW5, c.dH2 + c.dH10 - 15 );
-            else
-                ahrs.drawLine( c.dW - c.dW5 - c.dW10, c.dH2 + c.dH10 - 15, c.dW - c.dW5, c.dH2 + c.dH10 - 15 );
-        }
-    }
-
-    // Update the airspace positions
-    draw.updateAirspaces();
 
-    // Update the airport positions
-    if( m_settings.eShowAirports != Canvas::ShowNoAirports )
-        draw.updateAirports();
+    // Update the airspace and airport positions
+    paintNavLayer( &ahrs, &c, m_frame.airports.get(), m_frame.airspaces.get() );
 
     // Update the traffic positions
     draw.updateTraffic();
@@ -1608,27 +1645,27 @@ void AHRSCanvas::paintLandscape()
 
     // Draw the heading overlay so the markers aren't covered by other elements
     ahrs.translate( c.dW + c.dW2, c.dH - 10.0 - c.dHeadDiam2 );
-    if( g_situation.bHaveWTData )
-        ahrs.rotate( -g_situation.dAHRSMagHeading );
+    if( m_frame.situation.bHaveWTData )
+        ahrs.rotate( -m_frame.situation.dAHRSMagHeading );
     else
-        ahrs.rotate( -g_situation.dAHRSGyroHeading );
+        ahrs.rotate( -m_frame.situation.dAHRSGyroHeading );
     ahrs.translate( -(c.dW + c.dW2), -(c.dH - 10.0 - c.dHeadDiam2) );
     ahrs.drawPixmap( c.dW + c.dW2 - c.dHeadDiam2, c.dH - 10.0 - c.dHeadDiam, c.dHeadDiam, c.dHeadDiam,  m_HeadIndicatorOverlay );
     ahrs.resetTransform();
 
     // Draw the heading bug
-    if( m_iHeadBugAngle >= 0 )
+    if( m_frame.iHeadBugAngle >= 0 )
     {
         ahrs.translate( c.dW + c.dW2, c.dH - 10.0 - c.dHeadDiam2 );
-        if( g_situation.bHaveWTData )
-            ahrs.rotate( m_iHeadBugAngle - g_situation.dAHRSMagHeading );
+        if( m_frame.situation.bHaveWTData )
+            ahrs.rotate( m_frame.iHeadBugAngle - m_frame.situation.dAHRSMagHeading );
         else
-            ahrs.rotate( m_iHeadBugAngle - g_situation.dAHRSGyroHeading );
+            ahrs.rotate( m_frame.iHeadBugAngle - m_frame.situation.dAHRSGyroHeading );
         ahrs.translate( -(c.dW + c.dW2), -(c.dH - 10.0 - c.dHeadDiam2) );
         ahrs.drawPixmap( c.dW + c.dW2 - (m_headIcon.width() / 2), c.dH - 10.0 - c.dHeadDiam, m_headIcon );
 
         // If long press triggered crosswind component display and the wind bug is set
-        if( m_bShowCrosswind && (m_iWindBugAngle >= 0) )
+        if( m_frame.bShowCrosswind && (m_frame.iWindBugAngle >= 0) )
         {
             linePen.setWidth( c.iThinPen );
             linePen.setColor( QColor( 0xFF, 0x90, 0x01 ) );
@@ -1640,17 +1677,17 @@ void AHRSCanvas::paintLandscape()
     }
 
     // Draw the wind bug
-    if( m_iWindBugAngle >= 0 )
+    if( m_frame.iWindBugAngle >= 0 )
     {
         ahrs.translate( c.dW + c.dW2, c.dH - 10.0 - c.dHeadDiam2 );
-        if( g_situation.bHaveWTData )
-            ahrs.rotate( m_iWindBugAngle - g_situation.dAHRSMagHeading );
+        if( m_frame.situation.bHaveWTData )
+            ahrs.rotate( m_frame.iWindBugAngle - m_frame.situation.dAHRSMagHeading );
         else
-            ahrs.rotate( m_iWindBugAngle - g_situation.dAHRSGyroHeading );
+            ahrs.rotate( m_frame.iWindBugAngle - m_frame.situation.dAHRSGyroHeading );
         ahrs.translate( -(c.dW + c.dW2), -(c.dH - 10.0 - c.dHeadDiam2) );
         ahrs.drawPixmap( c.dW + c.dW2 - (m_headIcon.width() / 2), c.dH - 10.0 - c.dHeadDiam, m_windIcon );
 
-        QString      qsWind = QString::number( m_iWindBugSpeed );
+        QString      qsWind = QString::number( m_frame.iWindBugSpeed );
         QFontMetrics windMetrics( tiny );
         QRect        windRect = windMetrics.boundingRect( qsWind );
 
@@ -1661,7 +1698,7 @@ void AHRSCanvas::paintLandscape()
         ahrs.drawText( c.dW + c.dW2 - (windRect.width() / 2) - 1, c.dH - 10.0 - c.dHeadDiam, qsWind );
 
         // If long press triggered crosswind component display and the heading bug is set
-        if( m_bShowCrosswind && (m_iHeadBugAngle >= 0) )
+        if( m_frame.bShowCrosswind && (m_frame.iHeadBugAngle >= 0) )
         {
             linePen.setWidth( c.iThinPen );
             linePen.setColor( Qt::cyan );
@@ -1669,20 +1706,20 @@ void AHRSCanvas::paintLandscape()
             ahrs.drawLine( c.dW + c.dW2, c.dH - 10 - c.dHeadDiam, c.dW + c.dW2, c.dH - 10.0 - c.dHeadDiam );
 
             // Draw the crosswind component calculated from heading vs wind
-            double dAng = fabs( static_cast<double>( m_iWindBugAngle ) - static_cast<double>( m_iHeadBugAngle ) );
+            double dAng = fabs( static_cast<double>( m_frame.iWindBugAngle ) - static_cast<double>( m_frame.iHeadBugAngle ) );
             while( dAng > 180.0 )
                 dAng -= 360.0;
             dAng = fabs( dAng );
-            double dCrossComp = fabs( static_cast<double>( m_iWindBugSpeed ) * sin( dAng * ToRad ) );
+            double dCrossComp = fabs( static_cast<double>( m_frame.iWindBugSpeed ) * sin( dAng * ToRad ) );
             double dCrossPos = c.dH - (c.dW / 1.3) - 10.0;
             QString qsCrossAng = QString( "%1%2" ).arg( static_cast<int>( dAng ) ).arg( QChar( 176 ) );
 
             ahrs.resetTransform();
             ahrs.translate( c.dW + c.dW2, c.dH - 10.0 - c.dHeadDiam2 );
-            if( g_situation.bHaveWTData )
-                ahrs.rotate( m_iHeadBugAngle - g_situation.dAHRSMagHeading );
+            if( m_frame.situation.bHaveWTData )
+                ahrs.rotate( m_frame.iHeadBugAngle - m_frame.situation.dAHRSMagHeading );
             else
-                ahrs.rotate( m_iHeadBugAngle - g_situation.dAHRSGyroHeading );
+                ahrs.rotate( m_frame.iHeadBugAngle - m_frame.situation.dAHRSGyroHeading );
             ahrs.translate( -(c.dW + c.dW2), -(c.dH - 10.0 - c.dHeadDiam2) );
             ahrs.setFont( large );
             ahrs.setPen( Qt::black );
@@ -1699,15 +1736,302 @@ void AHRSCanvas::paintLandscape()
         ahrs.resetTransform();
     }
 
-    if( (m_iTimerMin >= 0) && (m_iTimerSec >= 0) )
-        draw.paintTimer( m_iTimerMin, m_iTimerSec );
+    if( (m_frame.iTimerMin >= 0) && (m_frame.iTimerSec >= 0) )
+        draw.paintTimer( m_frame.iTimerMin, m_frame.iTimerSec );
 
     draw.paintTemp();
 
-    if( m_bShowGPSDetails )
+    if( m_frame.bShowGPSDetails )
         draw.paintInfo();
-    else if( m_bDisplayTanksSwitchNotice )
-        draw.paintSwitchNotice( &m_tanks );
+    else if( m_frame.bDisplayTanksSwitchNotice )
+        draw.paintSwitchNotice( &m_frame.tanks );
+}
+
+
+// Sky, ground and pitch ladder straight onto the frame; pitch and roll change every frame so there's nothing to keep.
+// The caller sets the clip and resets the transform afterward.
+void AHRSCanvas::paintPortraitAttitude( QPainter *pAHRS, CanvasConstants *c )
+{
+    QPen   linePen( Qt::black );
+    double dPitchH = c->dH4 + (m_frame.situation.dAHRSpitch / 22.5 * c->dH4);     // The visible portion is only 1/4 of the 90 deg range
+
+    linePen.setWidth( c->iThinPen );
+    pAHRS->setRenderHints( QPainter::Antialiasing | QPainter::TextAntialiasing, true );
+
+    // Translate to dead center and rotate by stratux/BADASP roll then translate back
+    pAHRS->translate( c->dW2, c->dH4 );
+    pAHRS->rotate( -m_frame.situation.dAHRSroll );
+    pAHRS->translate( -c->dW2, -c->dH4 );
+
+    // Top half sky blue gradient offset by stratux pitch
+    QLinearGradient skyGradient( 0.0, -c->dH2, 0.0, dPitchH );
+    skyGradient.setColorAt( 0, Qt::blue );
+    skyGradient.setColorAt( 1, QColor( 85, 170, 255 ) );
+    pAHRS->fillRect( -400.0, -c->dH4, c->dW + 800.0, dPitchH + c->dH4, skyGradient );
+
+    // Draw brown gradient horizon half offset by stratux pitch
+    // Extreme overdraw accounts for extreme roll angles that might expose the corners
+    QLinearGradient groundGradient( 0.0, dPitchH, 0, c->dH2 );
+    groundGradient.setColorAt( 0, QColor( 170, 85, 0  ) );
+    groundGradient.setColorAt( 1, Qt::black );
+
+    pAHRS->fillRect( -400.0, dPitchH, c->dW + 800.0, c->dH4 + c->dH5, groundGradient );
+    pAHRS->setPen( linePen );
+    pAHRS->drawLine( -400, dPitchH, c->dW + 800.0, dPitchH );
+
+    for( int i = 0; i < 20; i += 10 )
+    {
+        linePen.setColor( Qt::cyan );
+        pAHRS->setPen( linePen );
+        pAHRS->drawLine( c->dW2 - c->dW20, dPitchH - ((i + 2.5) / 45.0 * c->dH4), c->dW2 + c->dW20, dPitchH - ((i + 2.5) / 45.0 * c->dH4) );
+        pAHRS->drawLine( c->dW2 - c->dW20, dPitchH - ((i + 5.0) / 45.0 * c->dH4), c->dW2 + c->dW20, dPitchH - ((i + 5.0) / 45.0 * c->dH4) );
+        pAHRS->drawLine( c->dW2 - c->dW20, dPitchH - ((i + 7.5) / 45.0 * c->dH4), c->dW2 + c->dW20, dPitchH - ((i + 7.5) / 45.0 * c->dH4) );
+        pAHRS->drawLine( c->dW2 - c->dW5, dPitchH - ((i + 10.0) / 45.0 * c->dH4), c->dW2 + c->dW5, dPitchH - (( i + 10.0) / 45.0 * c->dH4) );
+        linePen.setColor( QColor( 67, 33, 9 ) );
+        pAHRS->setPen( linePen );
+        pAHRS->drawLine( c->dW2 - c->dW20, dPitchH + ((i + 2.5) / 45.0 * c->dH4), c->dW2 + c->dW20, dPitchH + ((i + 2.5) / 45.0 * c->dH4) );
+        pAHRS->drawLine( c->dW2 - c->dW20, dPitchH + ((i + 5.0) / 45.0 * c->dH4), c->dW2 + c->dW20, dPitchH + ((i + 5.0) / 45.0 * c->dH4) );
+        pAHRS->drawLine( c->dW2 - c->dW20, dPitchH + ((i + 7.5) / 45.0 * c->dH4), c->dW2 + c->dW20, dPitchH + ((i + 7.5) / 45.0 * c->dH4) );
+        pAHRS->drawLine( c->dW2 - c->dW5, dPitchH + ((i + 10.0) / 45.0 * c->dH4), c->dW2 + c->dW5, dPitchH + (( i + 10.0) / 45.0 * c->dH4) );
+    }
+}
+
+
+void AHRSCanvas::paintLandscapeAttitude( QPainter *pAHRS, CanvasConstants *c )
+{
+    QPen   linePen( Qt::black );
+    double dPitchH = c->dH2 + (m_frame.situation.dAHRSpitch / 22.5 * c->dH2);     // The visible portion is only 1/4 of the 90 deg range
+
+    linePen.setWidth( c->iThinPen );
+    pAHRS->setRenderHints( QPainter::Antialiasing | QPainter::TextAntialiasing, true );
+
+    // Translate to dead center and rotate by stratux roll then translate back
+    pAHRS->translate( c->dW2 - c->dW20, c->dH2 );
+    pAHRS->rotate( -m_frame.situation.dAHRSroll );
+    pAHRS->translate( -(c->dW2 - c->dW20), -c->dH2 );
+
+    pAHRS->translate( -c->dW20, 0.0 );
+
+    // Top half sky blue gradient offset by stratux pitch
+    QLinearGradient skyGradient( 0.0, -c->dH4, 0.0, dPitchH );
+    skyGradient.setColorAt( 0, Qt::blue );
+    skyGradient.setColorAt( 1, QColor( 85, 170, 255 ) );
+    pAHRS->fillRect( -400.0, -c->dH4, c->dW + 800.0, dPitchH + c->dH4, skyGradient );
+
+    // Draw brown gradient horizon half offset by stratux pitch
+    // Extreme overdraw accounts for extreme roll angles that might expose the corners
+    QLinearGradient groundGradient( 0.0, c->dH2, 0, c->dH + c->dH4 );
+    groundGradient.setColorAt( 0, QColor( 170, 85, 0 ) );
+    groundGradient.setColorAt( 1, Qt::black );
+
+    pAHRS->fillRect( -400.0, dPitchH, c->dW + 800.0, c->dH, groundGradient );
+    pAHRS->setPen( linePen );
+    pAHRS->drawLine( -400, dPitchH, c->dW + 800.0, dPitchH );
+
+    for( double i = 0.0; i < 20.0; i += 10.0 )
+    {
+        linePen.setColor( Qt::cyan );
+        pAHRS->setPen( linePen );
+        pAHRS->drawLine( c->dW2 - c->dW20, dPitchH - ((i + 2.5) / 45.0 * c->dH2), c->dW2 + c->dW20, dPitchH - ((i + 2.5) / 45.0 * c->dH2) );
+        pAHRS->drawLine( c->dW2 - c->dW20, dPitchH - ((i + 5.0) / 45.0 * c->dH2), c->dW2 + c->dW20, dPitchH - ((i + 5.0) / 45.0 * c->dH2) );
+        pAHRS->drawLine( c->dW2 - c->dW20, dPitchH - ((i + 7.5) / 45.0 * c->dH2), c->dW2 + c->dW20, dPitchH - ((i + 7.5) / 45.0 * c->dH2) );
+        pAHRS->drawLine( c->dW2 - c->dW5, dPitchH - ((i + 10.0) / 45.0 * c->dH2), c->dW2 + c->dW5, dPitchH - (( i + 10.0) / 45.0 * c->dH2) );
+        linePen.setColor( QColor( 67, 33, 9 ) );
+        pAHRS->setPen( linePen );
+        pAHRS->drawLine( c->dW2 - c->dW20, dPitchH + ((i + 2.5) / 45.0 * c->dH2), c->dW2 + c->dW20, dPitchH + ((i + 2.5) / 45.0 * c->dH2) );
+        pAHRS->drawLine( c->dW2 - c->dW20, dPitchH + ((i + 5.0) / 45.0 * c->dH2), c->dW2 + c->dW20, dPitchH + ((i + 5.0) / 45.0 * c->dH2) );
+        pAHRS->drawLine( c->dW2 - c->dW20, dPitchH + ((i + 7.5) / 45.0 * c->dH2), c->dW2 + c->dW20, dPitchH + ((i + 7.5) / 45.0 * c->dH2) );
+        pAHRS->drawLine( c->dW2 - c->dW5, dPitchH + ((i + 10.0) / 45.0 * c->dH2), c->dW2 + c->dW5, dPitchH + (( i + 10.0) / 45.0 * c->dH2) );
+    }
+}
+
+
+// The tank gauges only change when the tanks do. The layer is the two strips the left and right gauges and their
+// active tank markers are in.
+void AHRSCanvas::paintFuelLayer( QPainter *pAHRS, CanvasConstants *c )
+{
+    QVector<QRect> parts;
+    LayerKey       key;
+
+    if( m_frame.bPortrait )
+        parts << QRect( 0, c->dH2 - c->dH20, c->dW10 + c->dW20, c->dH2 + c->dH20 )
+              << QRect( c->dW - c->dW10 - c->dW20, c->dH2 - c->dH20, c->dW10 + c->dW20, c->dH2 + c->dH20 );
+    else
+        parts << QRect( c->dW20, c->dH2, c->dW5, c->dH2 )
+              << QRect( c->dW - c->dW5 - c->dW10 - c->dW20, c->dH2, c->dW5, c->dH2 );
+    key << m_frame.tanks.dLeftCapacity << m_frame.tanks.dLeftRemaining << m_frame.tanks.dRightCapacity << m_frame.tanks.dRightRemaining
+        << m_frame.tanks.bDualTanks << m_frame.tanks.bOnLeftTank << m_frame.bFuelFlowStarted;
+
+    if( m_layers.begin( Compositor::FuelLayer, parts, key, pAHRS->device()->devicePixelRatioF() ) )
+    {
+        QPainter fuel( m_layers.image( Compositor::FuelLayer ) );
+
+        fuel.setRenderHints( QPainter::Antialiasing | QPainter::TextAntialiasing, true );
+        fuel.translate( -m_layers.origin( Compositor::FuelLayer ) );
+        if( m_frame.bPortrait )
+            paintPortraitFuel( &fuel, c );
+        else
+            paintLandscapeFuel( &fuel, c );
+        fuel.end();
+        m_layers.end( Compositor::FuelLayer );
+    }
+    m_layers.draw( pAHRS, Compositor::FuelLayer );
+}
+
+
+void AHRSCanvas::paintPortraitFuel( QPainter *pAHRS, CanvasConstants *c )
+{
+    // Left Tank indicators background
+    pAHRS->drawPixmap( 0.0, c->dH2 + c->dH40, c->dW20, c->dH2 - c->dH5, m_Lfuel );
+    // Tank indicators level
+    QPen levelPen( Qt::black, c->dH40 + 4 );
+    levelPen.setCapStyle( Qt::RoundCap );
+    pAHRS->setPen( levelPen );
+    pAHRS->drawLine( 0.0,
+                     c->dH2 + c->dH40 + ((c->dH2 - c->dH5) * ((m_frame.tanks.dLeftCapacity - m_frame.tanks.dLeftRemaining) / m_frame.tanks.dLeftCapacity)),
+                     c->dW40,
+                     c->dH2 + c->dH40 + ((c->dH2 - c->dH5) * ((m_frame.tanks.dLeftCapacity - m_frame.tanks.dLeftRemaining) / m_frame.tanks.dLeftCapacity)) );
+    levelPen.setWidth( c->dH40 );
+    levelPen.setColor( QColor( 255, 150, 255 ) );
+    pAHRS->setPen( levelPen );
+    pAHRS->drawLine( 0.0,
+                     c->dH2 + c->dH40 + ((c->dH2 - c->dH5) * ((m_frame.tanks.dLeftCapacity - m_frame.tanks.dLeftRemaining) / m_frame.tanks.dLeftCapacity)),
+                     c->dW40,
+                     c->dH2 + c->dH40 + ((c->dH2 - c->dH5) * ((m_frame.tanks.dLeftCapacity - m_frame.tanks.dLeftRemaining) / m_frame.tanks.dLeftCapacity)) );
+
+    if( m_frame.tanks.bDualTanks )
+    {
+        // Right Tank indicators background
+        pAHRS->drawPixmap( c->dW - c->dW20 - 1, c->dH2 + c->dH40, c->dW20, c->dH2 - c->dH5, m_Rfuel );
+        // Right Tank indicators level
+        levelPen.setColor( Qt::black );
+        levelPen.setWidth( c->dH40 + 4 );
+        pAHRS->setPen( levelPen );
+        pAHRS->drawLine( c->dW,
+                         c->dH2 + c->dH40 + ((c->dH2 - c->dH5) * ((m_frame.tanks.dRightCapacity - m_frame.tanks.dRightRemaining) / m_frame.tanks.dRightCapacity)),
+                         c->dW - c->dW40 - 1,
+                         c->dH2 + c->dH40 + ((c->dH2 - c->dH5) * ((m_frame.tanks.dRightCapacity - m_frame.tanks.dRightRemaining) / m_frame.tanks.dRightCapacity)) );
+        levelPen.setWidth( c->dH40 );
+        levelPen.setColor( QColor( 255, 150, 255 ) );
+        pAHRS->setPen( levelPen );
+        pAHRS->drawLine( c->dW,
+                         c->dH2 + c->dH40 + ((c->dH2 - c->dH5) * ((m_frame.tanks.dRightCapacity - m_frame.tanks.dRightRemaining) / m_frame.tanks.dRightCapacity)),
+                         c->dW - c->dW40 - 1,
+                         c->dH2 + c->dH40 + ((c->dH2 - c->dH5) * ((m_frame.tanks.dRightCapacity - m_frame.tanks.dRightRemaining) / m_frame.tanks.dRightCapacity)) );
+    }
+
+    // Tank indicator active indicators
+    if( m_frame.bFuelFlowStarted )
+    {
+        QPen fuelPen( Qt::yellow, c->dH80 );
+
+        pAHRS->setPen( fuelPen );
+
+        if( m_frame.tanks.bOnLeftTank || (!m_frame.tanks.bDualTanks) )
+            pAHRS->drawLine( 0, c->dH2 + c->dH40 - 15, c->dW10 - 2, c->dH2 + c->dH40 - 15 );
+        else
+            pAHRS->drawLine( c->dW - c->dW10 + 2, c->dH2 + c->dH40 - 15, c->dW, c->dH2 + c->dH40 - 15 );
+    }
+}
+
+
+void AHRSCanvas::paintLandscapeFuel( QPainter *pAHRS, CanvasConstants *c )
+{
+    // Left Tank indicators background
+    pAHRS->drawPixmap( c->dW10 + c->dW20, c->dH2 + c->dH10, c->dW20, c->dH2 - c->dH5, m_Lfuel );
+    // Tank indicators level
+    QPen levelPen( Qt::black, c->dH40 + 4 );
+    levelPen.setCapStyle( Qt::RoundCap );
+    pAHRS->setPen( levelPen );
+    pAHRS->drawLine( c->dW10 + c->dW20,
+                     c->dH2 + c->dH10 + ((c->dH2 - c->dH5) * ((m_frame.tanks.dLeftCapacity - m_frame.tanks.dLeftRemaining) / m_frame.tanks.dLeftCapacity)),
+                     c->dW40 + c->dW10 + c->dW20,
+                     c->dH2 + c->dH10 + ((c->dH2 - c->dH5) * ((m_frame.tanks.dLeftCapacity - m_frame.tanks.dLeftRemaining) / m_frame.tanks.dLeftCapacity)) );
+    levelPen.setWidth( c->dH40 );
+    levelPen.setColor( QColor( 255, 150, 255 ) );
+    pAHRS->setPen( levelPen );
+    pAHRS->drawLine( c->dW10 + c->dW20,
+                     c->dH2 + c->dH10 + ((c->dH2 - c->dH5) * ((m_frame.tanks.dLeftCapacity - m_frame.tanks.dLeftRemaining) / m_frame.tanks.dLeftCapacity)),
+                     c->dW40 + c->dW10 + c->dW20,
+                     c->dH2 + c->dH10 + ((c->dH2 - c->dH5) * ((m_frame.tanks.dLeftCapacity - m_frame.tanks.dLeftRemaining) / m_frame.tanks.dLeftCapacity)) );
+    // Right Tank indicators background
+    pAHRS->drawPixmap( c->dW - c->dW5 - c->dW10 - 1, c->dH2 + c->dH10, c->dW20, c->dH2 - c->dH5, m_Rfuel );
+    // Right Tank indicators level
+    levelPen.setColor( Qt::black );
+    levelPen.setWidth( c->dH40 + 4 );
+    pAHRS->setPen( levelPen );
+    pAHRS->drawLine( c->dW - c->dW5 - c->dW20,
+                     c->dH2 + c->dH10 + ((c->dH2 - c->dH5) * ((m_frame.tanks.dRightCapacity - m_frame.tanks.dRightRemaining) / m_frame.tanks.dRightCapacity)),
+                     c->dW - c->dW40 - c->dW5 - c->dW20 - 1,
+                     c->dH2 + c->dH10 + ((c->dH2 - c->dH5) * ((m_frame.tanks.dRightCapacity - m_frame.tanks.dRightRemaining) / m_frame.tanks.dRightCapacity)) );
+    levelPen.setWidth( c->dH40 );
+    levelPen.setColor( QColor( 255, 150, 255 ) );
+    pAHRS->setPen( levelPen );
+    pAHRS->drawLine( c->dW - c->dW5 - c->dW20,
+                     c->dH2 + c->dH10 + ((c->dH2 - c->dH5) * ((m_frame.tanks.dRightCapacity - m_frame.tanks.dRightRemaining) / m_frame.tanks.dRightCapacity)),
+                     c->dW - c->dW40 - c->dW5 - c->dW20 - 1,
+                     c->dH2 + c->dH10 + ((c->dH2 - c->dH5) * ((m_frame.tanks.dRightCapacity - m_frame.tanks.dRightRemaining) / m_frame.tanks.dRightCapacity)) );
+
+    // Tank indicator active indicators
+    if( m_frame.bFuelFlowStarted )
+    {
+        QPen fuelPen( Qt::yellow, c->dH80 );
+
+        pAHRS->setPen( fuelPen );
+
+        if( !m_frame.tanks.bDualTanks )
+        {
+            pAHRS->drawLine( c->dW10, c->dH2 + c->dH10 - c->dH80 - 5, c->dW10, c->dH2 + c->dH10 - c->dH80 - 5 );
+            pAHRS->drawLine( c->dW - c->dW5 - c->dW10, c->dH2 + c->dH10 - c->dH80 - 5, c->dW - c->dW5, c->dH2 + c->dH10 - c->dH80 - 5 );
+        }
+        else
+        {
+            if( m_frame.tanks.bOnLeftTank )
+                pAHRS->drawLine( c->dW10, c->dH2 + c->dH10 - 15, c->dW5, c->dH2 + c->dH10 - 15 );
+            else
+                pAHRS->drawLine( c->dW - c->dW5 - c->dW10, c->dH2 + c->dH10 - 15, c->dW - c->dW5, c->dH2 + c->dH10 - 15 );
+        }
+    }
+}
+
+
+// Airspace and airports on the heading indicator only change with a new nearby list (the aircraft moved), the heading,
+// the zoom or what's been picked to show. The heading is taken to the nearest half degree, both for the key and for
+// drawing, so sensor noise doesn't redraw it every frame and it's never more than a quarter degree off the dial.
+void AHRSCanvas::paintNavLayer( QPainter *pAHRS, CanvasConstants *c, const QList<Airport> *pAirports, const QList<Airspace> *pAirspaces )
+{
+    StratuxSituation situ = m_frame.situation;
+    int              iHalfDegrees = qRound( (situ.bHaveWTData ? situ.dAHRSMagHeading : situ.dAHRSGyroHeading) * 2.0 );
+    QRect            dial( (m_frame.bPortrait ? 0.0 : c->dW) + c->dW2 - c->dHeadDiam2 - 1.0, c->dH - 10.0 - c->dHeadDiam - 1.0, c->dHeadDiam + 2.0, c->dHeadDiam + 2.0 );
+    LayerKey         key;
+
+    if( situ.bHaveWTData )
+        situ.dAHRSMagHeading = iHalfDegrees / 2.0;
+    else
+        situ.dAHRSGyroHeading = iHalfDegrees / 2.0;
+    key << m_frame.iAirportsRequest << m_frame.iAirspacesRequest << iHalfDegrees << m_frame.dZoomNM << static_cast<int>( m_frame.settings.eShowAirports ) << m_frame.settings.bShowPrivate
+        << m_frame.settings.bShowRunways << m_frame.settings.bShowAirspaces << m_frame.settings.bShowAltitudes << m_frame.iMagDev;
+
+    if( m_layers.begin( Compositor::NavLayer, QVector<QRect>() << dial, key, pAHRS->device()->devicePixelRatioF() ) )
+    {
+        QPainter nav( m_layers.image( Compositor::NavLayer ) );
+        AHRSDraw draw( &nav, c, m_pCanvas, &m_numbers, &m_runwayLabels, &situ, &m_frame.traffic,
+                       &m_frame.directAP, &m_frame.fromAP, &m_frame.toAP, pAirports, pAirspaces, m_frame.dZoomNM, &m_frame.settings, m_frame.iMagDev,
+                       &m_trafficRed,
+                       &m_trafficYellow,
+                       &m_trafficGreen,
+                       &m_trafficCyan,
+                       &m_trafficOrange );
+
+        nav.setRenderHints( QPainter::Antialiasing | QPainter::TextAntialiasing, true );
+        nav.translate( -m_layers.origin( Compositor::NavLayer ) );
+        draw.updateAirspaces();
+        if( m_frame.settings.eShowAirports != Canvas::ShowNoAirports )
+            draw.updateAirports();
+        nav.end();
+        m_layers.end( Compositor::NavLayer );
+    }
+    m_layers.draw( pAHRS, Compositor::NavLayer );
 }
 
 
@@ -1749,6 +2073,8 @@ void AHRSCanvas::orient( bool bPortrait )
 
 void AHRSCanvas::orient2()
 {
+    waitForRender();
+    m_bRenderShown = false;     // Whatever finished last was rendered for the old orientation
     if( !m_bInitialized )
         return;
 
@@ -1759,6 +2085,11 @@ void AHRSCanvas::orient2()
     CanvasConstants c = m_pCanvas->constants();
     int             iBugSize = static_cast<int>( c.dWa * (m_bPortrait ? 0.1333 : 0.08) );
 
+    // The digit sizes change with the orientation
+    m_numbers.build( &c );
+    m_runwayLabels.clear();
+    m_layers.invalidateAll();
+
     // Reload the icons so we don't loose resolution
     m_headIcon.load( ":/icons/resources/HeadingIcon.png" );
     m_windIcon.load( ":/icons/resources/WindIcon.png" );
@@ -1781,6 +2112,7 @@ void AHRSCanvas::orient2()
     flipper.scale( -1, 1 );
     m_Rfuel = m_Lfuel.transformed( flipper );
 
+    m_bFrameDirty = true;   // Whatever's in front was rendered at the old size
     m_bInitialized = true;
 }
 
@@ -1790,27 +2122,27 @@ void AHRSCanvas::swipeLeft()
     AHRSMainWin *pMainWin = static_cast<AHRSMainWin *>( parentWidget()->parentWidget() );
 
     pMainWin->menu();
-    update();
+    redraw();
 }
 
 
 void AHRSCanvas::swipeRight()
 {
-    update();
+    redraw();
 }
 
 
 void AHRSCanvas::swipeUp()
 {
     zoomOut();
-    update();
+    redraw();
 }
 
 
 void AHRSCanvas::swipeDown()
 {
     zoomIn();
-    update();
+    redraw();
 }
 
 
@@ -1828,7 +2160,7 @@ void AHRSCanvas::setSwitchableTanks( bool bSwitchable )
 void AHRSCanvas::setMagDev( int iMagDev )
 {
     m_iMagDev = iMagDev;
-    update();
+    redraw();
 }
 
 
@@ -1856,6 +2188,12 @@ const QString AHRSCanvas::speedUnits()
 void AHRSCanvas::dark( bool bDark )
 {
     m_bDark = bDark;
+    // The dialogs that darken the display run their own event loop, so the frame ticks carry on and render it
+    if( m_bRenderThread )
+    {
+        redraw();
+        return;
+    }
     repaint();
     QApplication::processEvents();
 }
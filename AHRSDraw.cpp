@@ -17,6 +17,7 @@ Stratofier Stratux AHRS Display
 #include "AHRSDraw.h"
 #include "StratuxStreams.h"
 #include "TrafficMath.h"
+#include "TrafficTable.h"
 #include "Builder.h"
 
 
@@ -27,20 +28,22 @@ extern QFont small;
 extern QFont med;
 extern QFont large;
 
-extern StratuxSituation      g_situation;
 extern QSettings            *g_pSet;
-extern QList<StratuxTraffic> g_trafficList;
 extern QString               g_qsStratofierVersion;
 
 
 AHRSDraw::AHRSDraw( QPainter *pAHRS,
                     CanvasConstants *pC,
                     Canvas *pCanvas,
+                    const NumberAtlas *pNumbers,
+                    RunwayLabels *pRunwayLabels,
+                    const StratuxSituation *pSituation,
+                    TrafficTable *pTraffic,
                     Airport *pDirectAP,
                     Airport *pFromAP,
                     Airport *pToAP,
-                    QList<Airport> *pAirports,
-                    QList<Airspace> *pAirspaces,
+                    const QList<Airport> *pAirports,
+                    const QList<Airspace> *pAirspaces,
                     double dZoomNM,
                     StratofierSettings *pSettings,
                     int iMagDev,
@@ -52,6 +55,10 @@ AHRSDraw::AHRSDraw( QPainter *pAHRS,
     : m_pAHRS( pAHRS ),
       m_pC( pC ),
       m_pCanvas( pCanvas ),
+      m_pNumbers( pNumbers ),
+      m_pRunwayLabels( pRunwayLabels ),
+      m_pSituation( pSituation ),
+      m_pTraffic( pTraffic ),
       m_pDirectAP( pDirectAP ),
       m_pFromAP( pFromAP ),
       m_pToAP( pToAP ),
@@ -143,17 +150,17 @@ void AHRSDraw::drawDirectOrFromTo()
         if( iAP >= m_pAirports->count() )
             return;
 
-        Airport ap = m_pAirports->at( iAP );
+        const Airport &ap = m_pAirports->at( iAP );
 
         if( m_pC->bPortrait )
         {
             ball.setP1( QPointF( m_pC->dW2, m_pC->dH - m_pC->dW2 - 10.0 ) );
-            ball.setP2( ap.logicalPt );
+            ball.setP2( airportPoint( ap.bd ) );
         }
         else
         {
             ball.setP1( QPointF( m_pC->dW + m_pC->dW2, m_pC->dH - m_pC->dW2 - 10.0 ) );
-            ball.setP2( ap.logicalPt );
+            ball.setP2( airportPoint( ap.bd ) );
         }
         if( ball.length() > (m_pC->dW2 - 30.0) )
             ball.setLength( m_pC->dW2 - 30.0 );
@@ -167,9 +174,9 @@ void AHRSDraw::drawDirectOrFromTo()
         if( dDispBearing < 0.0 )
             dDispBearing += 360.0;
 
-        Builder::buildNumber( &num, m_pC, dDispBearing, 0 );
+        Builder::buildNumber( &num, m_pNumbers, dDispBearing, 0 );
         m_pAHRS->drawPixmap( m_pC->dW10 + m_pC->dW80, m_pC->dH80 + (m_pC->bPortrait ? 0.0 : m_pC->dH40), num );
-        Builder::buildNumber( &num, m_pC, ap.bd.dDistance, 1 );
+        Builder::buildNumber( &num, m_pNumbers, ap.bd.dDistance, 1 );
         m_pAHRS->drawPixmap( m_pC->dW10 + m_pC->dW80, m_pC->dH80 + m_pC->dH20 + (m_pC->bPortrait ? 0.0 : m_pC->dH40), num );
     }
     else if( m_pFromAP->qsID != "NULL" )
@@ -180,11 +187,11 @@ void AHRSDraw::drawDirectOrFromTo()
         if( (iFromAP >= m_pAirports->count()) || (iToAP >= m_pAirports->count() ) )
             return;
 
-        Airport apFrom = m_pAirports->at( iFromAP );
-        Airport apTo = m_pAirports->at( iToAP );
+        const Airport &apFrom = m_pAirports->at( iFromAP );
+        const Airport &apTo = m_pAirports->at( iToAP );
 
         m_pAHRS->setPen( coursePen );
-        m_pAHRS->drawLine( apFrom.logicalPt, apTo.logicalPt );
+        m_pAHRS->drawLine( airportPoint( apFrom.bd ), airportPoint( apTo.bd ) );
 
         double dDispBearing = apTo.bd.dBearing;
         QPixmap num( 320, 84 );
@@ -192,9 +199,9 @@ void AHRSDraw::drawDirectOrFromTo()
         if( dDispBearing < 0.0 )
             dDispBearing += 360.0;
 
-        Builder::buildNumber( &num, m_pC, dDispBearing, 0 );
+        Builder::buildNumber( &num, m_pNumbers, dDispBearing, 0 );
         m_pAHRS->drawPixmap( m_pC->dW10 + m_pC->dW80, m_pC->dH80 + (m_pC->bPortrait ? 0.0 : m_pC->dH40), num );
-        Builder::buildNumber( &num, m_pC, apTo.bd.dDistance, 1 );
+        Builder::buildNumber( &num, m_pNumbers, apTo.bd.dDistance, 1 );
         m_pAHRS->drawPixmap( m_pC->dW10 + m_pC->dW80, m_pC->dH80 + m_pC->dH20 + (m_pC->bPortrait ? 0.0 : m_pC->dH40), num );
     }
 
@@ -202,23 +209,68 @@ void AHRSDraw::drawDirectOrFromTo()
 }
 
 
+// Smooth scaling is slow on a Pi, so each runway number is made once and kept in the canvas's labels until it
+// changes size or orientation; anything that isn't a real designator is made on the spot
+QPixmap AHRSDraw::runwayLabel( int iDesignator )
+{
+    QPixmap num;
+    bool    bKeep = (iDesignator >= 0) && (iDesignator < RunwayLabels::Count);
+
+    if( bKeep && (!m_pRunwayLabels->labels[iDesignator].isNull()) )
+        return m_pRunwayLabels->labels[iDesignator];
+
+    num = QPixmap( 128, 84 );
+    num.fill( Qt::transparent );
+    Builder::buildNumber( &num, m_pNumbers, iDesignator, 2 );
+    num = num.scaledToWidth( m_pC->dW20, Qt::SmoothTransformation );
+    if( bKeep )
+        m_pRunwayLabels->labels[iDesignator] = num;
+
+    return num;
+}
+
+
+// Heading the airport and airspace positions are drawn relative to
+double AHRSDraw::heading()
+{
+    if( m_pSituation->bHaveWTData )
+        return m_pSituation->dAHRSMagHeading;
+
+    return m_pSituation->dAHRSGyroHeading;
+}
+
+
+// Where an airport at this bearing and distance from ownship is on the heading indicator
+QPointF AHRSDraw::airportPoint( const BearingDist &bd )
+{
+    QLineF ball;
+    double dPxPerNM = static_cast<double>( m_pC->dW - 30.0 ) / (m_dZoomNM * 2.0);	// Pixels per nautical mile; the outer limit of the heading indicator is calibrated to the zoom level in NM
+    double dAPDist = bd.dDistance * dPxPerNM;
+    double deltaY;
+
+    ball.setP1( QPointF( (m_pC->bPortrait ? 0.0 : m_pC->dW) + m_pC->dW2, m_pC->dH - m_pC->dHeadDiam2 - 10.0 ) );
+    ball.setP2( QPointF( (m_pC->bPortrait ? 0.0 : m_pC->dW) + m_pC->dW2, m_pC->dH - m_pC->dHeadDiam2 - 10.0 + dAPDist ) );
+
+    // Airport angle in reference to you (which clock position it's at)
+    ball.setAngle( bd.dBearing - heading() - 90.0 );
+    // Qt Y coords are backward
+    deltaY = ball.p2().y() - (m_pC->dH - m_pC->dHeadDiam2 - 10.0);
+
+    return QPointF( ball.p2().x(), m_pC->dH - m_pC->dHeadDiam2 - 10.0 - deltaY );
+}
+
+
+// Draws from the published list without touching it; the direct and from-to course lines work their end points out
+// again from the bearings rather than keeping this frame's positions in the list
 void AHRSDraw::updateAirports()
 {
-    Airport      ap;
-    QLineF       ball;
-    double	     dPxPerNM = static_cast<double>( m_pC->dW - 30.0 ) / (m_dZoomNM * 2.0);	// Pixels per nautical mile; the outer limit of the heading indicator is calibrated to the zoom level in NM
-    double       dAPDist;
+    QPointF      apPt;
     QPen         apPen( Qt::magenta );
     QLineF       runwayLine;
     int          iRunway, iAPRunway;
     double       dAirportDiam = m_pC->dWa * (m_pC->bPortrait ? 0.03125 : 0.01875);
     QRect        apRect;
-    double       deltaY;
-    double       dHead = g_situation.dAHRSGyroHeading;
-    int          iAP = 0;
-
-    if( g_situation.bHaveWTData )
-        dHead = g_situation.dAHRSMagHeading;
+    double       dHead = heading();
 
     QFontMetrics apMetrics( tiny );
 
@@ -229,8 +281,10 @@ void AHRSDraw::updateAirports()
     apPen.setWidth( m_pC->iThinPen );
     m_pAHRS->setBrush( Qt::NoBrush );
 
-    foreach( ap, *m_pAirports )
+    for( int iAP = 0; iAP < m_pAirports->count(); iAP++ )
     {
+        const Airport &ap = m_pAirports->at( iAP );
+
         if( ap.bGrass && (m_pSettings->eShowAirports == Canvas::ShowPavedAirports) )
             continue;
         else if( (!ap.bGrass) && (m_pSettings->eShowAirports == Canvas::ShowGrassAirports) )
@@ -239,38 +293,26 @@ void AHRSDraw::updateAirports()
             continue;
 
         apRect = apMetrics.boundingRect( ap.qsID );
-
-        dAPDist = ap.bd.dDistance * dPxPerNM;
-
-        ball.setP1( QPointF( (m_pC->bPortrait ? 0.0 : m_pC->dW) + m_pC->dW2, m_pC->dH - m_pC->dHeadDiam2 - 10.0 ) );
-        ball.setP2( QPointF( (m_pC->bPortrait ? 0.0 : m_pC->dW) + m_pC->dW2, m_pC->dH - m_pC->dHeadDiam2 - 10.0 + dAPDist ) );
-
-        // Airport angle in reference to you (which clock position it's at)
-        ball.setAngle( ap.bd.dBearing - dHead - 90.0 );
-        // Qt Y coords are backward
-        deltaY = ball.p2().y() - (m_pC->dH - m_pC->dHeadDiam2 - 10.0);
-        ball.setP2( QPointF( ball.p2().x(), m_pC->dH - m_pC->dHeadDiam2 - 10.0 - deltaY ) );
+        apPt = airportPoint( ap.bd );
 
         apPen.setWidth( m_pC->iThinPen );
         apPen.setColor( Qt::black );
         m_pAHRS->setPen( apPen );
-        ap.logicalPt.setX( ball.p2().x() );
-        ap.logicalPt.setY( ball.p2().y() );
-        m_pAHRS->drawEllipse( ap.logicalPt.x() - (dAirportDiam / 2.0) + 1.0, ap.logicalPt.y()- (dAirportDiam / 2.0) + 1.0, dAirportDiam, dAirportDiam );
+        m_pAHRS->drawEllipse( apPt.x() - (dAirportDiam / 2.0) + 1.0, apPt.y()- (dAirportDiam / 2.0) + 1.0, dAirportDiam, dAirportDiam );
         apPen.setColor( Qt::magenta );
         m_pAHRS->setPen( apPen );
-        m_pAHRS->drawEllipse( ap.logicalPt.x() - (dAirportDiam / 2.0), ap.logicalPt.y() - (dAirportDiam / 2.0), dAirportDiam, dAirportDiam );
+        m_pAHRS->drawEllipse( apPt.x() - (dAirportDiam / 2.0), apPt.y() - (dAirportDiam / 2.0), dAirportDiam, dAirportDiam );
         apPen.setColor( Qt::black );
         m_pAHRS->setPen( apPen );
-        m_pAHRS->drawText( ball.p2().x() - (dAirportDiam / 2.0) - (apRect.width() / 2) + 2, ball.p2().y() - (dAirportDiam / 2.0) + apRect.height() - 1, ap.qsID );
+        m_pAHRS->drawText( apPt.x() - (dAirportDiam / 2.0) - (apRect.width() / 2) + 2, apPt.y() - (dAirportDiam / 2.0) + apRect.height() - 1, ap.qsID );
         // Draw the runways and tiny headings after the black ID shadow but before the yellow ID text
         if( (m_dZoomNM <= 30) && m_pSettings->bShowRunways )
         {
             for( iRunway = 0; iRunway < ap.runways.count(); iRunway++ )
             {
                 iAPRunway = ap.runways.at( iRunway );
-                runwayLine.setP1( QPointF( ball.p2().x(), ball.p2().y() ) );
-                runwayLine.setP2( QPointF( ball.p2().x(), ball.p2().y() + (dAirportDiam * 2.0) ) );
+                runwayLine.setP1( apPt );
+                runwayLine.setP2( QPointF( apPt.x(), apPt.y() + (dAirportDiam * 2.0) ) );
                 runwayLine.setAngle( 270.0 - static_cast<double>( iAPRunway ) );
                 apPen.setColor( Qt::magenta );
                 apPen.setWidth( m_pC->iThickPen );
@@ -278,19 +320,12 @@ void AHRSDraw::updateAirports()
                 m_pAHRS->drawLine( runwayLine );
                 if( ((iAPRunway - dHead) > 90) && ((iAPRunway - dHead) < 270) )
                     runwayLine.setLength( runwayLine.length() + m_pC->dW80 );
-                QPixmap num( 128, 84 ); // It would need to be resized back anyway so creating a new one each time is faster
-                num.fill( Qt::transparent );
-                Builder::buildNumber( &num, m_pC, iAPRunway / 10, 2 );
-                num = num.scaledToWidth( m_pC->dW20, Qt::SmoothTransformation );
-                m_pAHRS->drawPixmap( runwayLine.p2(), num );
+                m_pAHRS->drawPixmap( runwayLine.p2(), runwayLabel( iAPRunway / 10 ) );
             }
         }
         apPen.setColor( Qt::yellow );
         m_pAHRS->setPen( apPen );
-        m_pAHRS->drawText( ball.p2().x() - (dAirportDiam / 2.0) - (apRect.width() / 2) + 1, ball.p2().y() - (dAirportDiam / 2.0) + apRect.height() - 2, ap.qsID );
-
-        m_pAirports->replace( iAP, ap );    // Update airports with logical coords for painting DirectTo and FromTo
-        iAP++;
+        m_pAHRS->drawText( apPt.x() - (dAirportDiam / 2.0) - (apRect.width() / 2) + 1, apPt.y() - (dAirportDiam / 2.0) + apRect.height() - 2, ap.qsID );
     }
 
     m_pAHRS->setClipping( false );
@@ -302,7 +337,6 @@ void AHRSDraw::updateAirspaces()
     if( !m_pSettings->bShowAirspaces )
         return;
 
-    Airspace     as;
     QLineF       ball;
     double	     dPxPerNM = static_cast<double>( m_pC->dHeadDiam ) / (m_dZoomNM * 2.0);	// Pixels per nautical mile; the outer limit of the heading indicator is calibrated to the zoom level in NM
     double       dASDist;
@@ -310,26 +344,31 @@ void AHRSDraw::updateAirspaces()
     BearingDist  bd;
     QPolygonF    airspacePoly;
     double       deltaY;
+    double       dHead = heading();
+    int          iLevel = TrafficMath::shapeLevel( 1.0 / dPxPerNM );
 
     maskHeading();
 
     asPen.setWidth( m_pC->iThinPen );
 
-    foreach( as, *m_pAirspaces )
+    for( int iAS = 0; iAS < m_pAirspaces->count(); iAS++ )
     {
+        const Airspace &as = m_pAirspaces->at( iAS );
+
+        // The snapshot may be from before a zoom out, in which case it has more detail than is needed now
         airspacePoly.clear();
-        foreach( bd, as.shapeHav )
+        for( int iVertex = 0; iVertex < as.shapeHav.count(); iVertex++ )
         {
+            if( as.shapeHavLevels.at( iVertex ) < iLevel )
+                continue;
+            bd = as.shapeHav.at( iVertex );
             dASDist = bd.dDistance * dPxPerNM;
 
             ball.setP1( QPointF( (m_pC->bPortrait ? 0.0 : m_pC->dW) + m_pC->dW2, m_pC->dH - 10.0 - m_pC->dHeadDiam2 ) );
             ball.setP2( QPointF( (m_pC->bPortrait ? 0.0 : m_pC->dW) + m_pC->dW2, m_pC->dH - 10.0 - m_pC->dHeadDiam2 - dASDist ) );
 
             // Airspace polygon point angle in reference to you (which clock position it's at)
-            if( g_situation.bHaveWTData )
-                ball.setAngle( bd.dBearing - g_situation.dAHRSMagHeading - 90.0 );
-            else
-                ball.setAngle( bd.dBearing - g_situation.dAHRSGyroHeading - 90.0 );
+            ball.setAngle( bd.dBearing - dHead - 90.0 );
             // Qt Y coords are backward
             deltaY = ball.p2().y() - (m_pC->dH - 10.0 - m_pC->dHeadDiam2);
             ball.setP2( QPointF( ball.p2().x(), m_pC->dH - 10.0 - m_pC->dHeadDiam2 - deltaY ) );
@@ -401,42 +440,58 @@ void AHRSDraw::updateAirspaces()
 // Draw the traffic onto the heading indicator and the tail numbers on the side
 void AHRSDraw::updateTraffic()
 {
-    StratuxTraffic traffic;
-    QPen           stickPen( Qt::green, 2 );
-    double		   dPxPerNM = m_pC->dHeadDiam / (m_dZoomNM * 2.0);     // Pixels per nautical mile; the outer limit of the heading indicator is calibrated to the zoom level in NM
-    QLineF		   ball, info, stick;
-    double         dAlt;
-    QString        qsSign;
-    QFontMetrics   smallMetrics( small );
-    QColor         closenessColor( Qt::green );
-    QRectF         trafficRect( 0.0, 0.0, m_pC->dW20, m_pC->dW20 );
-    QPointF        unBall;
-    double         dHead = g_situation.dAHRSGyroHeading;
-
-    if( g_situation.bHaveWTData )
-        dHead = g_situation.dAHRSMagHeading;
+    const StratuxTraffic *pTraffic;
+    int                   iSlot;
+    QPen                  stickPen( Qt::green, 2 );
+    double                dPxPerNM = m_pC->dHeadDiam / (m_dZoomNM * 2.0);     // Pixels per nautical mile; the outer limit of the heading indicator is calibrated to the zoom level in NM
+    QLineF                ball, info, stick;
+    double                dAlt;
+    QString               qsSign;
+    QFontMetrics          smallMetrics( small );
+    QColor                closenessColor( Qt::green );
+    QRectF                trafficRect( 0.0, 0.0, m_pC->dW20, m_pC->dW20 );
+    QPointF               unBall;
+    double                dHead = m_pSituation->dAHRSGyroHeading;
+    TrafficView           view;
+
+    if( m_pSituation->bHaveWTData )
+        dHead = m_pSituation->dAHRSMagHeading;
 
     maskHeading();
 
+    // Position everything in one pass; this is where they are now relative to where we are now rather than as of their last report
+    view.dLat = m_pSituation->dGPSlat;
+    view.dLong = m_pSituation->dGPSlong;
+    view.dAlt = m_pSituation->dBaroPressAlt;
+    view.dHeading = dHead;
+    view.dPxPerNM = dPxPerNM;
+    view.dCenterX = (m_pC->bPortrait ? 0 : m_pC->dW) + m_pC->dW2;
+    view.dCenterY = m_pC->dH - 10.0 - m_pC->dHeadDiam2;
+
+    const TrafficPlot   &plot = m_pTraffic->project( view );
+    const TrafficArrays &arrays = m_pTraffic->arrays();
+
     // Draw a chevron for each aircraft; the outer edge of the heading indicator is calibrated to be 20 NM out from your position
-    foreach( traffic, g_trafficList )
+    for( iSlot = 0; iSlot < m_pTraffic->slots(); iSlot++ )
     {
         // If bearing and distance were able to be calculated then show relative position
-        if( traffic.bHasADSB && (traffic.qsTail != m_pSettings->qsOwnshipID) )
+        if( (arrays.uiFlags.at( iSlot ) & (TrafficUsed | TrafficHasPos)) != (TrafficUsed | TrafficHasPos) )
+            continue;
+
+        pTraffic = m_pTraffic->slot( iSlot );
+
+        const StratuxTraffic &traffic = *pTraffic;
+
+        if( traffic.qsTail != m_pSettings->qsOwnshipID )
         {
-            double dTrafficDist = traffic.dDist * dPxPerNM;
-            double dAltDist = traffic.dAlt - g_situation.dBaroPressAlt;
-            double dAltDistAbs = fabs( dAltDist );
+            double dAltDistAbs = fabs( plot.fAltDelta.at( iSlot ) );
 
             if( m_pSettings->bShowAllTraffic || (dAltDistAbs < 5000) )
             {
                 closenessColor = Qt::green;
 
-                ball.setP1( QPointF( (m_pC->bPortrait ? 0 : m_pC->dW) + m_pC->dW2, m_pC->dH - 10.0 - m_pC->dHeadDiam2 ) );
-                ball.setP2( QPointF( (m_pC->bPortrait ? 0 : m_pC->dW) + m_pC->dW2, m_pC->dH - 10.0 - m_pC->dHeadDiam2 - dTrafficDist ) );
-
-                // Traffic angle in reference to you (which clock position they're at regardless of their own course)
-                ball.setAngle( -(traffic.dBearing - dHead - 90.0) );
+                // Traffic position in reference to you (which clock position they're at regardless of their own course)
+                ball.setP2( QPointF( plot.fX.at( iSlot ), plot.fY.at( iSlot ) ) );
 
                 // Draw the arrow
                 trafficRect.moveCenter( ball.p2() );
@@ -446,7 +501,7 @@ void AHRSDraw::updateTraffic()
                 unBall.setY( -ball.p2().y() );
                 m_pAHRS->translate( unBall );
 
-                if( traffic.bOnGround )
+                if( arrays.uiFlags.at( iSlot ) & TrafficOnGround )
                 {
                     m_pAHRS->drawPixmap( trafficRect.toRect(), *m_trafficCyan );
                     stickPen.setColor( Qt::cyan );
@@ -484,7 +539,7 @@ void AHRSDraw::updateTraffic()
                 m_pAHRS->resetTransform();
 
                 // Draw the ID, numerical track heading and altitude delta
-                dAlt = (traffic.dAlt - g_situation.dBaroPressAlt) / 100.0;
+                dAlt = plot.fAltDelta.at( iSlot ) / 100.0;
                 if( dAlt > 0 )
                     qsSign = "+";
                 else if( dAlt < 0 )
@@ -549,12 +604,12 @@ void AHRSDraw::updateTraffic()
 void AHRSDraw::paintTemp()
 {
     // Draw the outside temp if we have it
-    if( g_situation.bHaveWTData )
+    if( m_pSituation->bHaveWTData )
     {
         m_pAHRS->setPen( Qt::yellow );
         m_pAHRS->setFont( small );
         m_pAHRS->drawText( m_pC->dW - m_pC->dW5 - m_pC->dW5, m_pC->dH20 + m_pC->dH80,
-                           QString( "%1%2" ).arg( g_situation.dBaroTemp, 0, 'f', 1 ).arg( QChar( 0xB0 ) ) );
+                           QString( "%1%2" ).arg( m_pSituation->dBaroTemp, 0, 'f', 1 ).arg( QChar( 0xB0 ) ) );
     }
 }
 
@@ -594,7 +649,7 @@ void AHRSDraw::paintTimer( int iTimerMin, int iTimerSec )
     m_pAHRS->setPen( linePen );
     m_pAHRS->setBrush( Qt::black );
 
-    Builder::buildNumber( &Num, m_pC, qsTimer );
+    Builder::buildNumber( &Num, m_pNumbers, qsTimer );
     timerNum.fill( Qt::cyan );
     timerNum.setMask( Num.createMaskFromColor( Qt::transparent ) );
 
@@ -633,20 +688,27 @@ void AHRSDraw::paintInfo()
 
     m_pAHRS->drawText( 75, 95, "GPS Status" );
     m_pAHRS->setFont( small );
-    m_pAHRS->drawText( 75, 95 + iMedFontHeight,  QString( "GPS Satellites Seen: %1" ).arg( g_situation.iGPSSatsSeen ) );
-    m_pAHRS->drawText( 75, 95 + (iMedFontHeight * 2),  QString( "GPS Satellites Tracked: %1" ).arg( g_situation.iGPSSatsTracked ) );
-    m_pAHRS->drawText( 75, 95 + (iMedFontHeight * 3),  QString( "GPS Satellites Locked: %1" ).arg( g_situation.iGPSSats ) );
-    m_pAHRS->drawText( 75, 95 + (iMedFontHeight * 4),  QString( "GPS Fix Quality: %1" ).arg( g_situation.iGPSFixQuality ) );
+    m_pAHRS->drawText( 75, 95 + iMedFontHeight,  QString( "GPS Satellites Seen: %1" ).arg( m_pSituation->iGPSSatsSeen ) );
+    m_pAHRS->drawText( 75, 95 + (iMedFontHeight * 2),  QString( "GPS Satellites Tracked: %1" ).arg( m_pSituation->iGPSSatsTracked ) );
+    m_pAHRS->drawText( 75, 95 + (iMedFontHeight * 3),  QString( "GPS Satellites Locked: %1" ).arg( m_pSituation->iGPSSats ) );
+    m_pAHRS->drawText( 75, 95 + (iMedFontHeight * 4),  QString( "GPS Fix Quality: %1" ).arg( m_pSituation->iGPSFixQuality ) );
 
-    StratuxTraffic traffic;
-    int            iY = 0;
-    int            iLine;
+    const StratuxTraffic *pTraffic;
+    int                   iSlot;
+    int                   iY = 0;
+    int                   iLine;
 
     m_pAHRS->setFont( med_bu );
     m_pAHRS->drawText( m_pC->bPortrait ? 75 : m_pC->dW, m_pC->bPortrait ? m_pC->dH2 : 95, "Non-ADS-B Traffic" );
     m_pAHRS->setFont( small );
-    foreach( traffic, g_trafficList )
+    for( iSlot = 0; iSlot < m_pTraffic->slots(); iSlot++ )
     {
+        pTraffic = m_pTraffic->slot( iSlot );
+        if( pTraffic == nullptr )
+            continue;
+
+        const StratuxTraffic &traffic = *pTraffic;
+
         // If bearing and distance were able to be calculated then show relative position
         if( !traffic.bHasADSB && (!traffic.qsTail.isEmpty()) )
         {
@@ -664,8 +726,8 @@ void AHRSDraw::paintInfo()
     m_pAHRS->setFont( med );
     m_pAHRS->setPen( Qt::blue );
     m_pAHRS->drawText( 75, m_pC->bPortrait ? m_pCanvas->scaledV( 700.0 ) : m_pCanvas->scaledV( 390.0 ), QString( "Version: %1" ).arg( g_qsStratofierVersion ) );
-    if( g_situation.bHaveWTData )
-        m_pAHRS->drawText( 75, m_pC->bPortrait ? m_pCanvas->scaledV( 750.0 ) : m_pCanvas->scaledV( 440.0 ), QString( "BADASP: %1" ).arg( g_situation.qsBADASPversion ) );
+    if( m_pSituation->bHaveWTData )
+        m_pAHRS->drawText( 75, m_pC->bPortrait ? m_pCanvas->scaledV( 750.0 ) : m_pCanvas->scaledV( 440.0 ), QString( "BADASP: %1" ).arg( m_pSituation->qsBADASPversion ) );
 }
 
 
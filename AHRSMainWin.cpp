@@ -58,9 +58,11 @@ AHRSMainWin::AHRSMainWin( const QString &qsIP, bool bPortrait, StreamReader *pSt
       m_bTimerActive( false ),
       m_iReconnectTimer( -1 ),
       m_iTimerTimer( -1 ),
-      m_bRecording( false )
+      m_bRecording( false ),
+      m_bLogHandoff( false )
 {
     m_pStratuxStream->setUnits( static_cast<Canvas::Units>( g_pSet->value( "UnitsAirspeed" ).toInt() ) );
+    m_bLogHandoff = g_pSet->value( "LogHandoff", false ).toBool();
 
     itsy.setLetterSpacing( QFont::PercentageSpacing, 120.0 );
     wee.setLetterSpacing( QFont::PercentageSpacing, 120.0 );
@@ -76,8 +78,9 @@ AHRSMainWin::AHRSMainWin( const QString &qsIP, bool bPortrait, StreamReader *pSt
 
     m_lastStatusUpdate = QDateTime::currentDateTime();
 
-    connect( m_pStratuxStream, SIGNAL( newSituation( StratuxSituation ) ), m_pAHRSDisp, SLOT( situation( StratuxSituation ) ) );
-    connect( m_pStratuxStream, SIGNAL( newTraffic( StratuxTraffic ) ), m_pAHRSDisp, SLOT( traffic( StratuxTraffic ) ) );
+    // Situation and traffic come through the lock-free hand-off and are collected by the canvas once per frame; traffic
+    // is also pulled as soon as it arrives so a burst can't overrun the ring between frames
+    connect( m_pStratuxStream, SIGNAL( dataReady() ), m_pAHRSDisp, SLOT( drainTraffic() ) );
     connect( m_pStratuxStream, SIGNAL( newStatus( bool, bool, bool, bool ) ), this, SLOT( statusUpdate( bool, bool, bool, bool ) ) );
     connect( m_pStratuxStream, SIGNAL( newWTStatus( bool ) ), this, SLOT( WTUpdate( bool ) ) );
 
@@ -103,10 +106,9 @@ void AHRSMainWin::init()
 }
 
 
-// Delete the stream reader
+// The stream reader is owned by main() and deleted on its own thread
 AHRSMainWin::~AHRSMainWin()
 {
-    delete m_pStratuxStream;
     m_pStratuxStream = nullptr;
 
     delete m_pAHRSDisp;
@@ -266,6 +268,8 @@ void AHRSMainWin::timerEvent( QTimerEvent *pEvent )
             m_pStratuxStream->disconnectStreams();
             QTimer::singleShot( 1000, m_pStratuxStream, SLOT( connectStreams() ) );
         }
+        if( m_bLogHandoff )
+            logHandoff();
     }
     else if( pEvent->timerId() == m_iTimerTimer )
     {
@@ -279,6 +283,21 @@ void AHRSMainWin::timerEvent( QTimerEvent *pEvent )
 }
 
 
+// Depth and age of the stream thread to GUI hand-off since the last report
+void AHRSMainWin::logHandoff()
+{
+    HandoffStats sit = m_pStratuxStream->situationStats();
+    HandoffStats traf = m_pStratuxStream->trafficStats();
+
+    qInfo() << QString( "Situation: %1 in %2 out %3 merged, age %4 ms avg %5 ms max" )
+                   .arg( sit.uiPushed ).arg( sit.uiTaken ).arg( sit.uiMerged )
+                   .arg( sit.dMeanAgeMs, 0, 'f', 2 ).arg( sit.dMaxAgeMs, 0, 'f', 2 ).toLatin1().constData();
+    qInfo() << QString( "Traffic: %1 in %2 out %3 dropped, depth %4 (max %5), age %6 ms avg %7 ms max" )
+                   .arg( traf.uiPushed ).arg( traf.uiTaken ).arg( traf.uiDropped ).arg( traf.iDepth ).arg( traf.iMaxDepth )
+                   .arg( traf.dMeanAgeMs, 0, 'f', 2 ).arg( traf.dMaxAgeMs, 0, 'f', 2 ).toLatin1().constData();
+}
+
+
 void AHRSMainWin::changeTimer()
 {
     Keypad keypad( this, "TIMER", true );
@@ -333,7 +352,7 @@ void AHRSMainWin::fuelTanks( FuelTanks tanks )
         tanks.dRightRemaining = 0.0;
     }
     m_pAHRSDisp->setFuelTanks( tanks );
-    m_pAHRSDisp->m_bFuelFlowStarted = true;
+    m_pAHRSDisp->setFuelFlowStarted( true );
     QTimer::singleShot( 10, this, SLOT( fuelTanks2() ) );
 }
 
@@ -347,7 +366,7 @@ void AHRSMainWin::fuelTanks2()
 
 void AHRSMainWin::stopFuelFlow()
 {
-    m_pAHRSDisp->m_bFuelFlowStarted = false;
+    m_pAHRSDisp->setFuelFlowStarted( false );
     QTimer::singleShot( 10, this, SLOT( fuelTanks2() ) );
 }
 
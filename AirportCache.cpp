@@ -0,0 +1,190 @@
+/*
+Stratofier Stratux AHRS Display
+(c) 2018 Allen K. Lair, Sky Fun
+*/
+
+#include <string.h>
+
+#include "AirportCache.h"
+
+
+AirportCache::AirportCache()
+{
+}
+
+
+void AirportCache::clear()
+{
+    m_airports.clear();
+    m_runways.clear();
+    m_frequencies.clear();
+    m_strings.clear();
+}
+
+
+// Once loading is finished; gives back the slack in the arrays and the string interning lookup
+void AirportCache::squeeze()
+{
+    m_airports.squeeze();
+    m_runways.squeeze();
+    m_frequencies.squeeze();
+    m_strings.squeeze();
+}
+
+
+void AirportCache::append( const Airport &ap )
+{
+    CachedAirport   rec;
+    CachedFrequency freq;
+    QByteArray      id = ap.qsID.toLatin1();
+    int             i;
+
+    memset( &rec, 0, sizeof( rec ) );
+    rec.dLat = ap.dLat;
+    rec.dLong = ap.dLong;
+    rec.dElev = ap.dElev;
+    strncpy( rec.szID, id.constData(), sizeof( rec.szID ) - 1 );
+    rec.uiName = m_strings.add( ap.qsName );
+    rec.uiFirstRunway = static_cast<quint32>( m_runways.count() );
+    rec.uiRunways = static_cast<quint8>( qMin( ap.runways.count(), 255 ) );
+    rec.uiFirstFrequency = static_cast<quint32>( m_frequencies.count() );
+    rec.uiFrequencies = static_cast<quint8>( qMin( ap.frequencies.count(), 255 ) );
+    rec.bGrass = ap.bGrass;
+    m_airports.append( rec );
+
+    for( i = 0; i < rec.uiRunways; i++ )
+        m_runways.append( ap.runways.at( i ) );
+
+    memset( &freq, 0, sizeof( freq ) );
+    for( i = 0; i < rec.uiFrequencies; i++ )
+    {
+        freq.dFreq = ap.frequencies.at( i ).dFreq;
+        freq.uiDescription = m_strings.add( ap.frequencies.at( i ).qsDescription );
+        m_frequencies.append( freq );
+    }
+}
+
+
+// Another country's airports after these; its strings are copied as a block rather than interned again
+void AirportCache::append( const AirportCache &other )
+{
+    quint32 uiRunwayBase, uiFreqBase, uiStringBase;
+    int     iFirst, i;
+
+    if( isEmpty() )
+    {
+        *this = other;
+        return;
+    }
+
+    uiRunwayBase = static_cast<quint32>( m_runways.count() );
+    uiFreqBase = static_cast<quint32>( m_frequencies.count() );
+    uiStringBase = m_strings.append( other.m_strings );
+    iFirst = m_airports.count();
+    m_airports += other.m_airports;
+    m_runways += other.m_runways;
+    m_frequencies += other.m_frequencies;
+
+    for( i = iFirst; i < m_airports.count(); i++ )
+    {
+        CachedAirport &rec = m_airports[i];
+
+        rec.uiName += uiStringBase;
+        rec.uiFirstRunway += uiRunwayBase;
+        rec.uiFirstFrequency += uiFreqBase;
+    }
+    for( i = static_cast<int>( uiFreqBase ); i < m_frequencies.count(); i++ )
+        m_frequencies[i].uiDescription += uiStringBase;
+}
+
+
+// Straight from the arrays of a compiled database, after checking every offset in them lands inside its array
+bool AirportCache::load( const CachedAirport *pAirports, int iAirports, const qint32 *pRunways, int iRunways, const CachedFrequency *pFrequencies, int iFrequencies, const QByteArray &strings )
+{
+    quint32 uiStrings = static_cast<quint32>( strings.size() );
+    int     i;
+
+    clear();
+    if( (uiStrings == 0) || (strings.at( strings.size() - 1 ) != '\0') )
+        return false;
+    for( i = 0; i < iAirports; i++ )
+    {
+        const CachedAirport &rec = pAirports[i];
+
+        if( (rec.uiName >= uiStrings) || (rec.szID[sizeof( rec.szID ) - 1] != '\0') ||
+            ((static_cast<qint64>( rec.uiFirstRunway ) + rec.uiRunways) > iRunways) ||
+            ((static_cast<qint64>( rec.uiFirstFrequency ) + rec.uiFrequencies) > iFrequencies) )
+            return false;
+    }
+    for( i = 0; i < iFrequencies; i++ )
+    {
+        if( pFrequencies[i].uiDescription >= uiStrings )
+            return false;
+    }
+
+    m_airports.resize( iAirports );
+    m_runways.resize( iRunways );
+    m_frequencies.resize( iFrequencies );
+    memcpy( m_airports.data(), pAirports, iAirports * sizeof( CachedAirport ) );
+    memcpy( m_runways.data(), pRunways, iRunways * sizeof( qint32 ) );
+    memcpy( m_frequencies.data(), pFrequencies, iFrequencies * sizeof( CachedFrequency ) );
+    m_strings.setData( strings );
+
+    return true;
+}
+
+
+// The full struct for one airport, with no bearing and distance; those depend on where ownship is
+Airport AirportCache::airport( int i ) const
+{
+    const CachedAirport &rec = m_airports.at( i );
+    Airport              ap;
+    Frequency            f;
+    int                  j;
+
+    ap.qsID = QString::fromLatin1( rec.szID );
+    ap.qsName = m_strings.string( rec.uiName );
+    ap.dLat = rec.dLat;
+    ap.dLong = rec.dLong;
+    ap.dElev = rec.dElev;
+    ap.bGrass = rec.bGrass;
+    ap.bd.dBearing = 0.0;
+    ap.bd.dDistance = 0.0;
+    for( j = 0; j < rec.uiRunways; j++ )
+        ap.runways.append( m_runways.at( static_cast<int>( rec.uiFirstRunway ) + j ) );
+    for( j = 0; j < rec.uiFrequencies; j++ )
+    {
+        const CachedFrequency &freq = m_frequencies.at( static_cast<int>( rec.uiFirstFrequency ) + j );
+
+        f.dFreq = freq.dFreq;
+        f.qsDescription = m_strings.string( freq.uiDescription );
+        ap.frequencies.append( f );
+    }
+
+    return ap;
+}
+
+
+// First airport with exactly this name, or -1; compares in place against the string table
+int AirportCache::findName( const QString &qsName ) const
+{
+    QByteArray utf8 = qsName.toUtf8();
+
+    for( int i = 0; i < m_airports.count(); i++ )
+    {
+        if( strcmp( m_strings.at( m_airports.at( i ).uiName ), utf8.constData() ) == 0 )
+            return i;
+    }
+
+    return -1;
+}
+
+
+// Heap the cache holds, for comparing against what the same airports cost as a QList<Airport>
+qint64 AirportCache::bytes() const
+{
+    return (static_cast<qint64>( m_airports.capacity() ) * static_cast<qint64>( sizeof( CachedAirport ) )) +
+           (static_cast<qint64>( m_runways.capacity() ) * static_cast<qint64>( sizeof( qint32 ) )) +
+           (static_cast<qint64>( m_frequencies.capacity() ) * static_cast<qint64>( sizeof( CachedFrequency ) )) +
+           m_strings.data().capacity();
+}
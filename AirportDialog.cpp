@@ -7,12 +7,16 @@ Stratofier Stratux AHRS Display
 #include <QtDebug>
 #include <QTableWidget>
 
+#include <string.h>
+
 #include "AirportDialog.h"
 #include "TrafficMath.h"
+#include "AirportCache.h"
+#include "AirportIndex.h"
 #include "StratuxStreams.h"
 
 
-extern QList<Airport>   g_airportCache;
+extern AirportDatabase  g_airportDB;
 extern StratuxSituation g_situation;
 
 
@@ -90,29 +94,30 @@ void AirportDialog::toggle( QObject *pObj )
 
 void AirportDialog::updateAirports()
 {
-    Airport      ap;
-    QFontMetrics lineMetric( m_pAirportsTable->font() );
-    int          iRowHeight = static_cast<int>( static_cast<double>( lineMetric.boundingRect( "K" ).height() * 1.5 ) );
+    QFontMetrics         lineMetric( m_pAirportsTable->font() );
+    int                  iRowHeight = static_cast<int>( static_cast<double>( lineMetric.boundingRect( "K" ).height() * 1.5 ) );
+    QVector<AirportHit>  hits;
+    AirportDatabase::Ptr db = g_airportDB.current();
 
     // Clear the table
     while( m_pAirportsTable->rowCount() > 0 )
         m_pAirportsTable->removeRow( 0 );
 
+    db->index.withinRange( g_situation.dGPSlat, g_situation.dGPSlong, m_dDist, &hits );
+
     // Populate the table
-    foreach( ap, g_airportCache )
+    for( int i = 0; i < hits.count(); i++ )
     {
-        ap.bd = TrafficMath::haversine( g_situation.dGPSlat, g_situation.dGPSlong, ap.dLat, ap.dLong );
+        const AirportHit &hit = hits.at( i );
 
-        if( ap.bd.dDistance <= m_dDist )
+        // Only the name and ID are shown so there's no need to expand the whole airport
+        if( m_bAllAirports || (strcmp( db->airports.at( hit.iAirport ).szID, "R" ) != 0) )
         {
-            if( m_bAllAirports || ((!m_bAllAirports) && (ap.qsID != "R")) )
-            {
-                m_pAirportsTable->setRowCount( m_pAirportsTable->rowCount() + 1 );
-                m_pAirportsTable->setRowHeight( m_pAirportsTable->rowCount() - 1, iRowHeight );
-                m_pAirportsTable->setItem( m_pAirportsTable->rowCount() - 1, 0, new QTableWidgetItem( ap.qsName ) );
-                m_pAirportsTable->setItem( m_pAirportsTable->rowCount() - 1, 1, new QTableWidgetItem( "  " + ap.qsID ) );
-                m_pAirportsTable->setItem( m_pAirportsTable->rowCount() - 1, 2, new QTableWidgetItem( QString( "  %1" ).arg( static_cast<int>( ap.bd.dDistance ), 3, 10, QChar( '0' ) ) ) );
-            }
+            m_pAirportsTable->setRowCount( m_pAirportsTable->rowCount() + 1 );
+            m_pAirportsTable->setRowHeight( m_pAirportsTable->rowCount() - 1, iRowHeight );
+            m_pAirportsTable->setItem( m_pAirportsTable->rowCount() - 1, 0, new QTableWidgetItem( db->airports.name( hit.iAirport ) ) );
+            m_pAirportsTable->setItem( m_pAirportsTable->rowCount() - 1, 1, new QTableWidgetItem( "  " + db->airports.id( hit.iAirport ) ) );
+            m_pAirportsTable->setItem( m_pAirportsTable->rowCount() - 1, 2, new QTableWidgetItem( QString( "  %1" ).arg( static_cast<int>( hit.bd.dDistance ), 3, 10, QChar( '0' ) ) ) );
         }
     }
     m_pAirportsTable->resizeColumnsToContents();
@@ -0,0 +1,290 @@
+/*
+Stratofier Stratux AHRS Display
+(c) 2018 Allen K. Lair, Sky Fun
+*/
+
+#include <math.h>
+#include <string.h>
+
+#include <algorithm>
+
+#include "AirportIndex.h"
+#include "TrafficMath.h"
+
+
+static const double s_dCellDeg = 0.25;                                     // About 15 NM north to south
+static const int    s_iMaxCells = 1 << 20;
+
+
+// How the grid is laid out in a saved index; the arrays follow it in order
+struct SavedGrid
+{
+    double dCellDeg;
+    double dMinLat;
+    double dMinLong;
+    qint32 iRows;
+    qint32 iCols;
+    qint32 iItems;
+    qint32 iReserved;
+};
+
+
+static bool closer( const AirportHit &a, const AirportHit &b )
+{
+    return a.bd.dDistance < b.bd.dDistance;
+}
+
+
+static bool earlier( const AirportHit &a, const AirportHit &b )
+{
+    return a.iAirport < b.iAirport;
+}
+
+
+AirportIndex::AirportIndex()
+    : m_dCellDeg( s_dCellDeg ),
+      m_dMinLat( 0.0 ),
+      m_dMinLong( 0.0 ),
+      m_iRows( 0 ),
+      m_iCols( 0 )
+{
+}
+
+
+void AirportIndex::clear()
+{
+    m_iRows = 0;
+    m_iCols = 0;
+    m_cellStart.clear();
+    m_items.clear();
+    m_lat.clear();
+    m_long.clear();
+}
+
+
+// Grid over the bounding box of the airports, coarsened if the box is big enough to make the cell table silly
+void AirportIndex::build( const AirportCache &airports )
+{
+    double       dMaxLat = -90.0, dMaxLong = -180.0;
+    QVector<int> cells( airports.count() );
+    QVector<int> fill;
+    int          i, iCell;
+
+    clear();
+    if( airports.isEmpty() )
+        return;
+
+    m_dMinLat = 90.0;
+    m_dMinLong = 180.0;
+    for( i = 0; i < airports.count(); i++ )
+    {
+        const CachedAirport &ap = airports.at( i );
+
+        m_dMinLat = qMin( m_dMinLat, ap.dLat );
+        m_dMinLong = qMin( m_dMinLong, ap.dLong );
+        dMaxLat = qMax( dMaxLat, ap.dLat );
+        dMaxLong = qMax( dMaxLong, ap.dLong );
+    }
+
+    m_dCellDeg = s_dCellDeg;
+    do
+    {
+        m_iRows = static_cast<int>( (dMaxLat - m_dMinLat) / m_dCellDeg ) + 1;
+        m_iCols = static_cast<int>( (dMaxLong - m_dMinLong) / m_dCellDeg ) + 1;
+        if( (m_iRows * m_iCols) > s_iMaxCells )
+            m_dCellDeg *= 2.0;
+    } while( (m_iRows * m_iCols) > s_iMaxCells );
+
+    // Counting sort by cell
+    m_cellStart.fill( 0, (m_iRows * m_iCols) + 1 );
+    for( i = 0; i < airports.count(); i++ )
+    {
+        iCell = (row( airports.at( i ).dLat ) * m_iCols) + col( airports.at( i ).dLong );
+        cells[i] = iCell;
+        m_cellStart[iCell + 1]++;
+    }
+    for( i = 0; i < (m_iRows * m_iCols); i++ )
+        m_cellStart[i + 1] += m_cellStart.at( i );
+
+    fill = m_cellStart;
+    m_items.resize( airports.count() );
+    m_lat.resize( airports.count() );
+    m_long.resize( airports.count() );
+    for( i = 0; i < airports.count(); i++ )
+    {
+        int iPos = fill[cells.at( i )]++;
+
+        m_items[iPos] = i;
+        m_lat[iPos] = airports.at( i ).dLat;
+        m_long[iPos] = airports.at( i ).dLong;
+    }
+}
+
+
+// Flat copy for the compiled database, in native byte order
+void AirportIndex::save( QByteArray *pData ) const
+{
+    SavedGrid grid;
+
+    memset( &grid, 0, sizeof( grid ) );
+    grid.dCellDeg = m_dCellDeg;
+    grid.dMinLat = m_dMinLat;
+    grid.dMinLong = m_dMinLong;
+    grid.iRows = m_iRows;
+    grid.iCols = m_iCols;
+    grid.iItems = m_items.count();
+
+    pData->clear();
+    pData->append( reinterpret_cast<const char *>( &grid ), sizeof( grid ) );
+    pData->append( reinterpret_cast<const char *>( m_cellStart.constData() ), m_cellStart.count() * static_cast<int>( sizeof( int ) ) );
+    pData->append( reinterpret_cast<const char *>( m_items.constData() ), m_items.count() * static_cast<int>( sizeof( int ) ) );
+    pData->append( reinterpret_cast<const char *>( m_lat.constData() ), m_lat.count() * static_cast<int>( sizeof( double ) ) );
+    pData->append( reinterpret_cast<const char *>( m_long.constData() ), m_long.count() * static_cast<int>( sizeof( double ) ) );
+}
+
+
+// Back from save(); anything inconsistent leaves the index empty
+bool AirportIndex::load( const uchar *pData, int iSize )
+{
+    SavedGrid grid;
+    qint64    iCells, iNeeded;
+
+    clear();
+    if( iSize < static_cast<int>( sizeof( grid ) ) )
+        return false;
+    memcpy( &grid, pData, sizeof( grid ) );
+    pData += sizeof( grid );
+
+    if( grid.iItems == 0 )
+        return (grid.iRows == 0) && (grid.iCols == 0);
+    if( (grid.iRows <= 0) || (grid.iCols <= 0) || (grid.iItems < 0) || !(grid.dCellDeg > 0.0) )
+        return false;
+    iCells = static_cast<qint64>( grid.iRows ) * grid.iCols;
+    if( iCells > s_iMaxCells )
+        return false;
+    iNeeded = static_cast<qint64>( sizeof( grid ) ) + ((iCells + 1) * static_cast<qint64>( sizeof( int ) )) +
+              (grid.iItems * static_cast<qint64>( sizeof( int ) + (2 * sizeof( double )) ));
+    if( iNeeded != iSize )
+        return false;
+
+    m_dCellDeg = grid.dCellDeg;
+    m_dMinLat = grid.dMinLat;
+    m_dMinLong = grid.dMinLong;
+    m_iRows = grid.iRows;
+    m_iCols = grid.iCols;
+    m_cellStart.resize( static_cast<int>( iCells ) + 1 );
+    m_items.resize( grid.iItems );
+    m_lat.resize( grid.iItems );
+    m_long.resize( grid.iItems );
+    memcpy( m_cellStart.data(), pData, m_cellStart.count() * sizeof( int ) );
+    pData += m_cellStart.count() * sizeof( int );
+    memcpy( m_items.data(), pData, m_items.count() * sizeof( int ) );
+    pData += m_items.count() * sizeof( int );
+    memcpy( m_lat.data(), pData, m_lat.count() * sizeof( double ) );
+    pData += m_lat.count() * sizeof( double );
+    memcpy( m_long.data(), pData, m_long.count() * sizeof( double ) );
+
+    // The queries index straight into the arrays with these
+    if( (m_cellStart.first() != 0) || (m_cellStart.last() != grid.iItems) )
+    {
+        clear();
+        return false;
+    }
+    for( int i = 0; i < static_cast<int>( iCells ); i++ )
+    {
+        if( m_cellStart.at( i ) > m_cellStart.at( i + 1 ) )
+        {
+            clear();
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+int AirportIndex::row( double dLat ) const
+{
+    return qBound( 0, static_cast<int>( floor( (dLat - m_dMinLat) / m_dCellDeg ) ), m_iRows - 1 );
+}
+
+
+int AirportIndex::col( double dLong ) const
+{
+    return qBound( 0, static_cast<int>( floor( (dLong - m_dMinLong) / m_dCellDeg ) ), m_iCols - 1 );
+}
+
+
+// Every airport within dRangeNM of the point, in the order of the list the index was built from
+void AirportIndex::withinRange( double dLat, double dLong, double dRangeNM, QVector<AirportHit> *pHits ) const
+{
+    QVector<BearingDist> scratch;
+    QRectF               boxes[2];
+    int                  iBoxes, iRow, i;
+
+    pHits->clear();
+    if( m_items.isEmpty() )
+        return;
+
+    iBoxes = TrafficMath::rangeBoxes( dLat, dLong, dRangeNM, boxes );
+    for( iRow = row( boxes[0].top() ); iRow <= row( boxes[0].bottom() ); iRow++ )
+    {
+        for( i = 0; i < iBoxes; i++ )
+            scanRow( iRow, boxes[i].left(), boxes[i].right(), dLat, dLong, dRangeNM, &scratch, pHits );
+    }
+
+    std::sort( pHits->begin(), pHits->end(), earlier );
+}
+
+
+// The cells from dLongFrom to dLongTo in one row are one run of the sorted arrays
+void AirportIndex::scanRow( int iRow, double dLongFrom, double dLongTo, double dLat, double dLong, double dRangeNM, QVector<BearingDist> *pScratch, QVector<AirportHit> *pHits ) const
+{
+    AirportHit hit;
+    int        iFrom, iTo, i;
+
+    if( (dLongTo < m_dMinLong) || (dLongFrom > (m_dMinLong + (m_iCols * m_dCellDeg))) )
+        return;
+
+    iFrom = m_cellStart.at( (iRow * m_iCols) + col( dLongFrom ) );
+    iTo = m_cellStart.at( (iRow * m_iCols) + col( dLongTo ) + 1 );
+    if( iFrom >= iTo )
+        return;
+
+    pScratch->resize( iTo - iFrom );
+    TrafficMath::haversine( dLat, dLong, m_lat.constData() + iFrom, m_long.constData() + iFrom, pScratch->data(), iTo - iFrom );
+    for( i = iFrom; i < iTo; i++ )
+    {
+        if( pScratch->at( i - iFrom ).dDistance <= dRangeNM )
+        {
+            hit.iAirport = m_items.at( i );
+            hit.bd = pScratch->at( i - iFrom );
+            pHits->append( hit );
+        }
+    }
+}
+
+
+// The iK closest airports, closest first. Widens the search until it has enough, so it costs a few range queries
+// rather than a pass over everything.
+void AirportIndex::nearest( double dLat, double dLong, int iK, QVector<AirportHit> *pHits ) const
+{
+    double dRangeNM = 10.0;
+
+    pHits->clear();
+    if( (iK <= 0) || m_items.isEmpty() )
+        return;
+
+    // Anything past the flat earth diagonal of the whole globe means the last pass already saw every airport
+    for( ;; )
+    {
+        withinRange( dLat, dLong, dRangeNM, pHits );
+        if( (pHits->count() >= iK) || (dRangeNM > 20000.0) )
+            break;
+        dRangeNM *= 4.0;
+    }
+
+    std::sort( pHits->begin(), pHits->end(), closer );
+    if( pHits->count() > iK )
+        pHits->resize( iK );
+}
@@ -0,0 +1,308 @@
+/*
+Stratofier Stratux AHRS Display
+(c) 2018 Allen K. Lair, Sky Fun
+*/
+
+#include <math.h>
+#include <string.h>
+
+#include <algorithm>
+
+#include "AirspaceIndex.h"
+#include "TrafficMath.h"
+
+
+static const int s_iFanOut = 16;
+
+
+// Layout of a saved index: counts, then the nodes, item positions and item boxes
+struct SavedTree
+{
+    qint32 iNodes;
+    qint32 iItems;
+};
+
+
+struct SavedNode
+{
+    double dLeft;
+    double dTop;
+    double dRight;
+    double dBottom;
+    qint32 iFirst;
+    qint32 iCount;
+    qint32 iLeaf;
+    qint32 iReserved;
+};
+
+
+// QRectF::intersects() and united() treat zero width or height as empty, which a box around a line or a point can be
+static inline bool overlaps( const QRectF &a, const QRectF &b )
+{
+    return (a.left() <= b.right()) && (b.left() <= a.right()) && (a.top() <= b.bottom()) && (b.top() <= a.bottom());
+}
+
+
+static inline QRectF unite( const QRectF &a, const QRectF &b )
+{
+    QRectF box;
+
+    box.setCoords( qMin( a.left(), b.left() ), qMin( a.top(), b.top() ), qMax( a.right(), b.right() ), qMax( a.bottom(), b.bottom() ) );
+
+    return box;
+}
+
+
+// Orders positions in a list of boxes by the boxes' centers in either direction
+class BoxOrder
+{
+public:
+    BoxOrder( const QVector<QRectF> &boxes, bool bByX ) : m_boxes( boxes ), m_bByX( bByX ) {}
+
+    bool operator()( int a, int b ) const
+    {
+        if( m_bByX )
+            return (m_boxes.at( a ).left() + m_boxes.at( a ).right()) < (m_boxes.at( b ).left() + m_boxes.at( b ).right());
+
+        return (m_boxes.at( a ).top() + m_boxes.at( a ).bottom()) < (m_boxes.at( b ).top() + m_boxes.at( b ).bottom());
+    }
+
+private:
+    const QVector<QRectF> &m_boxes;
+    bool                   m_bByX;
+};
+
+
+// Sort-tile-recursive order: slices by longitude, each slice by latitude, so runs of s_iFanOut are compact tiles
+static void tileOrder( QVector<int> *pOrder, const QVector<QRectF> &boxes )
+{
+    int iCount = pOrder->count();
+    int iGroups = (iCount + s_iFanOut - 1) / s_iFanOut;
+    int iSlice = static_cast<int>( ceil( sqrt( static_cast<double>( iGroups ) ) ) ) * s_iFanOut;
+
+    std::sort( pOrder->begin(), pOrder->end(), BoxOrder( boxes, true ) );
+    for( int i = 0; i < iCount; i += iSlice )
+        std::sort( pOrder->begin() + i, pOrder->begin() + qMin( i + iSlice, iCount ), BoxOrder( boxes, false ) );
+}
+
+
+AirspaceIndex::AirspaceIndex()
+{
+}
+
+
+void AirspaceIndex::clear()
+{
+    m_nodes.clear();
+    m_items.clear();
+    m_itemBoxes.clear();
+}
+
+
+void AirspaceIndex::build( const QList<Airspace> &airspaces )
+{
+    QVector<QRectF> boxes( airspaces.count() );
+    QVector<int>    order( airspaces.count() );
+    QVector<Node>   level;
+    Node            node;
+    int             iLevelFrom, iLevelCount;
+    int             i, j;
+
+    clear();
+    if( airspaces.isEmpty() )
+        return;
+
+    for( i = 0; i < airspaces.count(); i++ )
+    {
+        boxes[i] = airspaces.at( i ).bounds;
+        order[i] = i;
+    }
+    tileOrder( &order, boxes );
+    m_items = order;
+    m_itemBoxes.resize( order.count() );
+    for( i = 0; i < order.count(); i++ )
+        m_itemBoxes[i] = boxes.at( order.at( i ) );
+
+    // Leaves over runs of airspaces
+    node.bLeaf = true;
+    for( i = 0; i < m_items.count(); i += s_iFanOut )
+    {
+        node.iFirst = i;
+        node.iCount = qMin( s_iFanOut, m_items.count() - i );
+        node.box = m_itemBoxes.at( i );
+        for( j = 1; j < node.iCount; j++ )
+            node.box = unite( node.box, m_itemBoxes.at( i + j ) );
+        m_nodes.append( node );
+    }
+
+    // Then each level over runs of the one below, after tiling that level in place so its runs are compact too
+    iLevelFrom = 0;
+    iLevelCount = m_nodes.count();
+    node.bLeaf = false;
+    while( iLevelCount > 1 )
+    {
+        boxes.resize( iLevelCount );
+        order.resize( iLevelCount );
+        level.resize( iLevelCount );
+        for( i = 0; i < iLevelCount; i++ )
+        {
+            boxes[i] = m_nodes.at( iLevelFrom + i ).box;
+            order[i] = i;
+            level[i] = m_nodes.at( iLevelFrom + i );
+        }
+        tileOrder( &order, boxes );
+        for( i = 0; i < iLevelCount; i++ )
+            m_nodes[iLevelFrom + i] = level.at( order.at( i ) );
+
+        for( i = 0; i < iLevelCount; i += s_iFanOut )
+        {
+            node.iFirst = iLevelFrom + i;
+            node.iCount = qMin( s_iFanOut, iLevelCount - i );
+            node.box = m_nodes.at( node.iFirst ).box;
+            for( j = 1; j < node.iCount; j++ )
+                node.box = unite( node.box, m_nodes.at( node.iFirst + j ).box );
+            m_nodes.append( node );
+        }
+        iLevelFrom += iLevelCount;
+        iLevelCount = m_nodes.count() - iLevelFrom;
+    }
+}
+
+
+// Flat copy for the compiled database, in native byte order
+void AirspaceIndex::save( QByteArray *pData ) const
+{
+    SavedTree tree;
+    SavedNode saved;
+    double    dBox[4];
+    int       i;
+
+    tree.iNodes = m_nodes.count();
+    tree.iItems = m_items.count();
+    pData->clear();
+    pData->append( reinterpret_cast<const char *>( &tree ), sizeof( tree ) );
+
+    memset( &saved, 0, sizeof( saved ) );
+    for( i = 0; i < m_nodes.count(); i++ )
+    {
+        const Node &node = m_nodes.at( i );
+
+        saved.dLeft = node.box.left();
+        saved.dTop = node.box.top();
+        saved.dRight = node.box.right();
+        saved.dBottom = node.box.bottom();
+        saved.iFirst = node.iFirst;
+        saved.iCount = node.iCount;
+        saved.iLeaf = node.bLeaf ? 1 : 0;
+        pData->append( reinterpret_cast<const char *>( &saved ), sizeof( saved ) );
+    }
+    pData->append( reinterpret_cast<const char *>( m_items.constData() ), m_items.count() * static_cast<int>( sizeof( int ) ) );
+    for( i = 0; i < m_itemBoxes.count(); i++ )
+    {
+        m_itemBoxes.at( i ).getCoords( &dBox[0], &dBox[1], &dBox[2], &dBox[3] );
+        pData->append( reinterpret_cast<const char *>( dBox ), sizeof( dBox ) );
+    }
+}
+
+
+// Back from save(); anything inconsistent leaves the index empty
+bool AirspaceIndex::load( const uchar *pData, int iSize )
+{
+    SavedTree tree;
+    SavedNode saved;
+    double    dBox[4];
+    Node      node;
+    int       i;
+
+    clear();
+    if( iSize < static_cast<int>( sizeof( tree ) ) )
+        return false;
+    memcpy( &tree, pData, sizeof( tree ) );
+    pData += sizeof( tree );
+    if( (tree.iNodes < 0) || (tree.iItems < 0) || ((tree.iNodes == 0) != (tree.iItems == 0)) )
+        return false;
+    if( (static_cast<qint64>( sizeof( tree ) ) + (tree.iNodes * static_cast<qint64>( sizeof( SavedNode ) )) +
+         (tree.iItems * static_cast<qint64>( sizeof( int ) + sizeof( dBox ) ))) != iSize )
+        return false;
+
+    m_nodes.resize( tree.iNodes );
+    for( i = 0; i < tree.iNodes; i++ )
+    {
+        memcpy( &saved, pData, sizeof( saved ) );
+        pData += sizeof( saved );
+
+        // Children always come before their parent, which is what keeps the query's walk finite
+        node.bLeaf = (saved.iLeaf != 0);
+        node.iFirst = saved.iFirst;
+        node.iCount = saved.iCount;
+        node.box.setCoords( saved.dLeft, saved.dTop, saved.dRight, saved.dBottom );
+        if( (node.iFirst < 0) || (node.iCount < 0) || ((node.iFirst + node.iCount) > (node.bLeaf ? tree.iItems : i)) )
+        {
+            clear();
+            return false;
+        }
+        m_nodes[i] = node;
+    }
+
+    m_items.resize( tree.iItems );
+    memcpy( m_items.data(), pData, m_items.count() * sizeof( int ) );
+    pData += m_items.count() * sizeof( int );
+    m_itemBoxes.resize( tree.iItems );
+    for( i = 0; i < tree.iItems; i++ )
+    {
+        memcpy( dBox, pData, sizeof( dBox ) );
+        pData += sizeof( dBox );
+        m_itemBoxes[i].setCoords( dBox[0], dBox[1], dBox[2], dBox[3] );
+    }
+
+    return true;
+}
+
+
+// Every airspace whose bounding box comes within dRangeNM of the point, in the order of the list the index was built from
+void AirspaceIndex::overlapping( double dLat, double dLong, double dRangeNM, QVector<int> *pHits ) const
+{
+    QRectF       boxes[2];
+    QVector<int> side;
+    int          iBoxes = TrafficMath::rangeBoxes( dLat, dLong, dRangeNM, boxes );
+
+    overlapping( boxes[0], pHits );
+    if( iBoxes < 2 )
+        return;
+
+    // Something spanning the antimeridian can be in both halves
+    overlapping( boxes[1], &side );
+    *pHits += side;
+    std::sort( pHits->begin(), pHits->end() );
+    pHits->erase( std::unique( pHits->begin(), pHits->end() ), pHits->end() );
+}
+
+
+// Every airspace whose bounding box overlaps the box, in list order
+void AirspaceIndex::overlapping( const QRectF &box, QVector<int> *pHits ) const
+{
+    QVector<int> stack;
+    int          i;
+
+    pHits->clear();
+    if( m_nodes.isEmpty() )
+        return;
+
+    stack.append( m_nodes.count() - 1 );
+    while( !stack.isEmpty() )
+    {
+        const Node &node = m_nodes.at( stack.takeLast() );
+
+        if( !overlaps( node.box, box ) )
+            continue;
+        for( i = node.iFirst; i < (node.iFirst + node.iCount); i++ )
+        {
+            if( !node.bLeaf )
+                stack.append( i );
+            else if( overlaps( m_itemBoxes.at( i ), box ) )
+                pHits->append( m_items.at( i ) );
+        }
+    }
+
+    std::sort( pHits->begin(), pHits->end() );
+}
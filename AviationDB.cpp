@@ -0,0 +1,827 @@
+/*
+Stratofier Stratux AHRS Display
+(c) 2018 Allen K. Lair, Sky Fun
+*/
+
+#include <QtDebug>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QXmlStreamReader>
+#include <QVector>
+#include <QStringRef>
+
+#include <string.h>
+
+#include "AviationDB.h"
+#include "AirportIndex.h"
+#include "AirspaceIndex.h"
+#include "AirportCache.h"
+#include "StringTable.h"
+#include "TrafficMath.h"
+#include "StratofierDefs.h"
+
+
+static const char    s_szMagic[8] = { 'S', 'T', 'R', 'F', 'A', 'D', 'B', '\0' };
+static const quint32 s_uiVersion = 4;
+static const quint32 s_uiByteOrder = 0x01020304;     // Reads back differently on a machine of the other endianness
+static const int     s_iMaxSections = 8;
+
+
+struct DBHeader
+{
+    char    szMagic[8];
+    quint32 uiVersion;
+    quint32 uiByteOrder;
+    quint32 uiKind;             // AviationDB::Kind
+    quint32 uiSections;
+    qint64  iSourceSize;        // Of the .aip it was compiled from, to tell when it's out of date
+    qint64  iSourceModified;    // Milliseconds since the epoch
+    quint32 uiChecksum;         // CRC-32 of the section table
+    quint32 uiReserved;
+};
+
+
+struct DBSection
+{
+    quint32 uiType;
+    quint32 uiCount;            // Records, where that means anything
+    quint64 uiOffset;           // From the start of the file, 8 byte aligned
+    quint64 uiSize;
+    quint32 uiChecksum;         // CRC-32 of the section itself, so a mismatch says which one
+    quint32 uiReserved;
+};
+
+
+enum DBSectionType
+{
+    StringsSection = 1,         // UTF-8, each NUL terminated; offset 0 is always the empty string
+    AirportSection,             // AirportCache's arrays as they are in memory
+    RunwaySection,
+    FrequencySection,
+    AirspaceSection,
+    VertexSection,              // Longitude and latitude pairs as doubles
+    IndexSection,               // AirportIndex or AirspaceIndex as saved
+    VertexLevelSection          // One byte per vertex, the level of detail from TrafficMath::simplifyShape()
+};
+
+
+struct AirspaceRecord
+{
+    double  dLeft;              // Bounds
+    double  dTop;
+    double  dRight;
+    double  dBottom;
+    quint32 uiName;
+    qint32  iType;              // Canvas::AirspaceType
+    qint32  iAltTop;
+    qint32  iAltBottom;
+    quint32 uiFirstVertex;
+    quint32 uiVertices;
+};
+
+
+// A mapped and validated database file
+class DBView
+{
+public:
+    DBView() : m_pMap( nullptr ), m_iSize( 0 ), m_pSections( nullptr ), m_iSections( 0 ), m_pStrings( nullptr ), m_uiStringsSize( 0 ) {}
+    ~DBView() { close(); }
+
+    bool open( const QString &qsAipFile, AviationDB::Kind eKind );
+    void close();
+
+    const uchar *section( DBSectionType eType, quint64 uiRecordSize, quint32 *pCount, quint64 *pSize = nullptr ) const;
+    QString      string( quint32 uiOffset ) const;
+
+private:
+    QFile            m_file;
+    const uchar     *m_pMap;
+    qint64           m_iSize;
+    const DBSection *m_pSections;
+    int              m_iSections;
+    const char      *m_pStrings;
+    quint64          m_uiStringsSize;
+};
+
+
+// Reflected CRC-32 table; a function static so it's built once, safely, whichever thread gets there first
+class CRCTable
+{
+public:
+    CRCTable()
+    {
+        for( quint32 i = 0; i < 256; i++ )
+        {
+            quint32 c = i;
+
+            for( int k = 0; k < 8; k++ )
+                c = (c & 1) ? (0xEDB88320 ^ (c >> 1)) : (c >> 1);
+            uiTable[i] = c;
+        }
+    }
+
+    quint32 uiTable[256];
+};
+
+
+static quint32 crc32( const uchar *p, qint64 iSize )
+{
+    static const CRCTable s_crc;
+    quint32               uiCRC = 0xFFFFFFFF;
+
+    for( qint64 i = 0; i < iSize; i++ )
+        uiCRC = s_crc.uiTable[(uiCRC ^ p[i]) & 0xFF] ^ (uiCRC >> 8);
+
+    return uiCRC ^ 0xFFFFFFFF;
+}
+
+
+bool DBView::open( const QString &qsAipFile, AviationDB::Kind eKind )
+{
+    QFileInfo source( qsAipFile );
+    DBHeader  header;
+    int       i;
+
+    close();
+    m_file.setFileName( AviationDB::dbFile( qsAipFile ) );
+    if( !m_file.open( QIODevice::ReadOnly ) )
+        return false;
+    m_iSize = m_file.size();
+    if( m_iSize < static_cast<qint64>( sizeof( DBHeader ) ) )
+        return false;
+    m_pMap = m_file.map( 0, m_iSize );
+    if( m_pMap == nullptr )
+        return false;
+
+    memcpy( &header, m_pMap, sizeof( header ) );
+    if( (memcmp( header.szMagic, s_szMagic, sizeof( s_szMagic ) ) != 0) || (header.uiVersion != s_uiVersion) ||
+        (header.uiByteOrder != s_uiByteOrder) || (header.uiKind != static_cast<quint32>( eKind )) ||
+        (header.uiSections > static_cast<quint32>( s_iMaxSections )) )
+        return false;
+
+    // Recompile if the download has changed since; if the .aip has gone, this is all there is
+    if( source.exists() && ((source.size() != header.iSourceSize) || (source.lastModified().toMSecsSinceEpoch() != header.iSourceModified)) )
+        return false;
+
+    // The whole file is checked here: the section table, then every section against its own checksum
+    if( m_iSize < static_cast<qint64>( sizeof( DBHeader ) + (header.uiSections * sizeof( DBSection )) ) )
+        return false;
+    if( crc32( m_pMap + sizeof( DBHeader ), header.uiSections * sizeof( DBSection ) ) != header.uiChecksum )
+    {
+        qWarning() << "Checksum mismatch in" << m_file.fileName();
+        return false;
+    }
+
+    m_pSections = reinterpret_cast<const DBSection *>( m_pMap + sizeof( DBHeader ) );
+    m_iSections = static_cast<int>( header.uiSections );
+    for( i = 0; i < m_iSections; i++ )
+    {
+        if( (m_pSections[i].uiOffset > static_cast<quint64>( m_iSize )) || (m_pSections[i].uiSize > (static_cast<quint64>( m_iSize ) - m_pSections[i].uiOffset)) )
+            return false;
+        if( crc32( m_pMap + m_pSections[i].uiOffset, static_cast<qint64>( m_pSections[i].uiSize ) ) != m_pSections[i].uiChecksum )
+        {
+            qWarning() << "Checksum mismatch in section" << m_pSections[i].uiType << "of" << m_file.fileName();
+            return false;
+        }
+    }
+
+    // Every string lookup relies on the table ending in a terminator
+    m_pStrings = reinterpret_cast<const char *>( section( StringsSection, 1, nullptr, &m_uiStringsSize ) );
+    if( (m_pStrings == nullptr) || (m_uiStringsSize == 0) || (m_pStrings[m_uiStringsSize - 1] != '\0') )
+        return false;
+
+    return true;
+}
+
+
+void DBView::close()
+{
+    if( m_pMap != nullptr )
+        m_file.unmap( const_cast<uchar *>( m_pMap ) );
+    m_pMap = nullptr;
+    m_pSections = nullptr;
+    m_iSections = 0;
+    m_file.close();
+}
+
+
+// Start of a section, or null if it's missing or isn't a whole number of records
+const uchar *DBView::section( DBSectionType eType, quint64 uiRecordSize, quint32 *pCount, quint64 *pSize ) const
+{
+    for( int i = 0; i < m_iSections; i++ )
+    {
+        const DBSection &sect = m_pSections[i];
+
+        if( sect.uiType != static_cast<quint32>( eType ) )
+            continue;
+        if( (pCount != nullptr) && ((sect.uiSize / uiRecordSize) != sect.uiCount) )
+            return nullptr;
+        if( pCount != nullptr )
+            *pCount = sect.uiCount;
+        if( pSize != nullptr )
+            *pSize = sect.uiSize;
+
+        return m_pMap + sect.uiOffset;
+    }
+
+    return nullptr;
+}
+
+
+QString DBView::string( quint32 uiOffset ) const
+{
+    if( uiOffset >= m_uiStringsSize )
+        return QString();
+
+    return QString::fromUtf8( m_pStrings + uiOffset );
+}
+
+
+// Header, section table and sections, each checksummed, written to a temporary and renamed over the old one
+static bool writeDB( const QString &qsAipFile, AviationDB::Kind eKind, const QList<DBSection> &sectionList, const QList<QByteArray> &sectionData )
+{
+    QFileInfo  source( qsAipFile );
+    QSaveFile  file( AviationDB::dbFile( qsAipFile ) );
+    DBHeader   header;
+    QByteArray table, body;
+    DBSection  sect;
+    quint64    uiOffset;
+    int        i;
+
+    memset( &header, 0, sizeof( header ) );
+    memcpy( header.szMagic, s_szMagic, sizeof( s_szMagic ) );
+    header.uiVersion = s_uiVersion;
+    header.uiByteOrder = s_uiByteOrder;
+    header.uiKind = static_cast<quint32>( eKind );
+    header.uiSections = static_cast<quint32>( sectionList.count() );
+    header.iSourceSize = source.size();
+    header.iSourceModified = source.lastModified().toMSecsSinceEpoch();
+
+    uiOffset = sizeof( DBHeader ) + (sectionList.count() * sizeof( DBSection ));
+    for( i = 0; i < sectionList.count(); i++ )
+    {
+        uiOffset = (uiOffset + 7) & ~static_cast<quint64>( 7 );
+        sect = sectionList.at( i );
+        sect.uiOffset = uiOffset;
+        sect.uiSize = static_cast<quint64>( sectionData.at( i ).size() );
+        sect.uiChecksum = crc32( reinterpret_cast<const uchar *>( sectionData.at( i ).constData() ), sectionData.at( i ).size() );
+        table.append( reinterpret_cast<const char *>( &sect ), sizeof( sect ) );
+        uiOffset += sect.uiSize;
+    }
+    header.uiChecksum = crc32( reinterpret_cast<const uchar *>( table.constData() ), table.size() );
+    body = table;
+    for( i = 0; i < sectionData.count(); i++ )
+    {
+        while( ((sizeof( DBHeader ) + body.size()) & 7) != 0 )
+            body.append( '\0' );
+        body.append( sectionData.at( i ) );
+    }
+
+    if( !file.open( QIODevice::WriteOnly ) )
+        return false;
+    file.write( reinterpret_cast<const char *>( &header ), sizeof( header ) );
+    file.write( body );
+
+    return file.commit();
+}
+
+
+static DBSection sectionEntry( DBSectionType eType, int iCount )
+{
+    DBSection sect;
+
+    sect.uiType = static_cast<quint32>( eType );
+    sect.uiCount = static_cast<quint32>( iCount );
+    sect.uiOffset = 0;
+    sect.uiSize = 0;
+    sect.uiChecksum = 0;
+    sect.uiReserved = 0;
+
+    return sect;
+}
+
+
+// The compiled database sits next to the download with a different extension
+QString AviationDB::dbFile( const QString &qsAipFile )
+{
+    QString qsFile = qsAipFile;
+
+    if( qsFile.endsWith( ".aip" ) )
+        qsFile.chop( 4 );
+
+    return qsFile + ".adb";
+}
+
+
+// Compile an .aip into its database; which kind it is comes from the XML itself
+bool AviationDB::convert( const QString &qsAipFile )
+{
+    QFile      aip( qsAipFile );
+    QByteArray start;
+
+    if( !aip.open( QIODevice::ReadOnly ) )
+        return false;
+    start = aip.read( 4096 );
+    aip.close();
+
+    if( start.contains( "<AIRSPACES" ) )
+    {
+        QList<Airspace> airspaces;
+        AirspaceIndex   index;
+
+        if( !parseAirspaces( qsAipFile, &airspaces ) )
+            return false;
+        index.build( airspaces );
+
+        return writeAirspaces( qsAipFile, airspaces, index );
+    }
+    else
+    {
+        AirportCache airports;
+        AirportIndex index;
+
+        if( !parseAirports( qsAipFile, &airports ) )
+            return false;
+        index.build( airports );
+
+        return writeAirports( qsAipFile, airports, index );
+    }
+}
+
+
+// From the compiled database if it's there and current, otherwise from the XML, compiling it for next time
+bool AviationDB::loadAirports( const QString &qsAipFile, AirportCache *pAirports, AirportIndex *pIndex )
+{
+    if( readAirports( qsAipFile, pAirports, pIndex ) )
+        return true;
+    if( !parseAirports( qsAipFile, pAirports ) )
+        return false;
+    pIndex->build( *pAirports );
+    if( !writeAirports( qsAipFile, *pAirports, *pIndex ) )
+        qWarning() << "Unable to write" << dbFile( qsAipFile );
+
+    return true;
+}
+
+
+bool AviationDB::loadAirspaces( const QString &qsAipFile, QList<Airspace> *pAirspaces, AirspaceIndex *pIndex )
+{
+    if( readAirspaces( qsAipFile, pAirspaces, pIndex ) )
+        return true;
+    if( !parseAirspaces( qsAipFile, pAirspaces ) )
+        return false;
+    pIndex->build( *pAirspaces );
+    if( !writeAirspaces( qsAipFile, *pAirspaces, *pIndex ) )
+        qWarning() << "Unable to write" << dbFile( qsAipFile );
+
+    return true;
+}
+
+
+bool AviationDB::writeAirports( const QString &qsAipFile, const AirportCache &airports, const AirportIndex &index )
+{
+    QList<DBSection>  sectionList;
+    QList<QByteArray> sectionData;
+    QByteArray        indexData;
+
+    index.save( &indexData );
+
+    sectionList << sectionEntry( AirportSection, airports.count() ) << sectionEntry( RunwaySection, airports.runways().count() )
+                << sectionEntry( FrequencySection, airports.frequencies().count() ) << sectionEntry( StringsSection, airports.strings().data().size() )
+                << sectionEntry( IndexSection, index.count() );
+    sectionData << QByteArray( reinterpret_cast<const char *>( airports.airports().constData() ), airports.count() * static_cast<int>( sizeof( CachedAirport ) ) )
+                << QByteArray( reinterpret_cast<const char *>( airports.runways().constData() ), airports.runways().count() * static_cast<int>( sizeof( qint32 ) ) )
+                << QByteArray( reinterpret_cast<const char *>( airports.frequencies().constData() ), airports.frequencies().count() * static_cast<int>( sizeof( CachedFrequency ) ) )
+                << airports.strings().data() << indexData;
+
+    return writeDB( qsAipFile, Airports, sectionList, sectionData );
+}
+
+
+bool AviationDB::writeAirspaces( const QString &qsAipFile, const QList<Airspace> &airspaces, const AirspaceIndex &index )
+{
+    StringTable       strings;
+    QByteArray        records, vertices, levels, indexData;
+    AirspaceRecord    rec;
+    QList<DBSection>  sectionList;
+    QList<QByteArray> sectionData;
+    int               iVertices = 0;
+    int               i, j;
+
+    memset( &rec, 0, sizeof( rec ) );
+    for( i = 0; i < airspaces.count(); i++ )
+    {
+        const Airspace &as = airspaces.at( i );
+
+        rec.dLeft = as.bounds.left();
+        rec.dTop = as.bounds.top();
+        rec.dRight = as.bounds.right();
+        rec.dBottom = as.bounds.bottom();
+        rec.uiName = strings.add( as.qsName );
+        rec.iType = static_cast<qint32>( as.eType );
+        rec.iAltTop = as.iAltTop;
+        rec.iAltBottom = as.iAltBottom;
+        rec.uiFirstVertex = static_cast<quint32>( iVertices );
+        rec.uiVertices = static_cast<quint32>( as.shape.count() );
+        records.append( reinterpret_cast<const char *>( &rec ), sizeof( rec ) );
+
+        for( j = 0; j < as.shape.count(); j++ )
+        {
+            double dXY[2] = { as.shape.at( j ).x(), as.shape.at( j ).y() };
+
+            vertices.append( reinterpret_cast<const char *>( dXY ), sizeof( dXY ) );
+        }
+        levels.append( reinterpret_cast<const char *>( as.shapeLevels.constData() ), as.shapeLevels.count() );
+        iVertices += as.shape.count();
+    }
+    index.save( &indexData );
+
+    sectionList << sectionEntry( AirspaceSection, airspaces.count() ) << sectionEntry( VertexSection, iVertices )
+                << sectionEntry( VertexLevelSection, iVertices ) << sectionEntry( StringsSection, strings.data().size() )
+                << sectionEntry( IndexSection, index.count() );
+    sectionData << records << vertices << levels << strings.data() << indexData;
+
+    return writeDB( qsAipFile, Airspaces, sectionList, sectionData );
+}
+
+
+bool AviationDB::readAirports( const QString &qsAipFile, AirportCache *pAirports, AirportIndex *pIndex )
+{
+    DBView                 db;
+    const CachedAirport   *pRecs;
+    const qint32          *pRunways;
+    const CachedFrequency *pFreqs;
+    const char            *pStrings;
+    const uchar           *pIndexData;
+    quint32                uiAirports, uiRunways, uiFreqs;
+    quint64                uiStringsSize, uiIndexSize;
+    AirportIndex           index;
+
+    pAirports->clear();
+    if( !db.open( qsAipFile, Airports ) )
+        return false;
+
+    pRecs = reinterpret_cast<const CachedAirport *>( db.section( AirportSection, sizeof( CachedAirport ), &uiAirports ) );
+    pRunways = reinterpret_cast<const qint32 *>( db.section( RunwaySection, sizeof( qint32 ), &uiRunways ) );
+    pFreqs = reinterpret_cast<const CachedFrequency *>( db.section( FrequencySection, sizeof( CachedFrequency ), &uiFreqs ) );
+    pStrings = reinterpret_cast<const char *>( db.section( StringsSection, 1, nullptr, &uiStringsSize ) );
+    pIndexData = db.section( IndexSection, 1, nullptr, &uiIndexSize );
+    if( (pRecs == nullptr) || (pRunways == nullptr) || (pFreqs == nullptr) || (pStrings == nullptr) || (pIndexData == nullptr) )
+        return false;
+    if( !index.load( pIndexData, static_cast<int>( uiIndexSize ) ) || (index.count() != static_cast<int>( uiAirports )) )
+        return false;
+
+    // The records are already in the cache's layout so this is a handful of block copies
+    if( !pAirports->load( pRecs, static_cast<int>( uiAirports ), pRunways, static_cast<int>( uiRunways ), pFreqs, static_cast<int>( uiFreqs ),
+                          QByteArray( pStrings, static_cast<int>( uiStringsSize ) ) ) )
+        return false;
+
+    // The caller's index is only touched once everything has checked out
+    *pIndex = index;
+
+    return true;
+}
+
+
+bool AviationDB::readAirspaces( const QString &qsAipFile, QList<Airspace> *pAirspaces, AirspaceIndex *pIndex )
+{
+    DBView                db;
+    const AirspaceRecord *pRecs;
+    const double         *pVertices;
+    const quint8         *pLevels;
+    const uchar          *pIndexData;
+    quint32               uiAirspaces, uiVertices, uiLevels, i, j;
+    quint64               uiIndexSize;
+    Airspace              as;
+    AirspaceIndex         index;
+
+    pAirspaces->clear();
+    if( !db.open( qsAipFile, Airspaces ) )
+        return false;
+
+    pRecs = reinterpret_cast<const AirspaceRecord *>( db.section( AirspaceSection, sizeof( AirspaceRecord ), &uiAirspaces ) );
+    pVertices = reinterpret_cast<const double *>( db.section( VertexSection, 2 * sizeof( double ), &uiVertices ) );
+    pLevels = db.section( VertexLevelSection, 1, &uiLevels );
+    pIndexData = db.section( IndexSection, 1, nullptr, &uiIndexSize );
+    if( (pRecs == nullptr) || (pVertices == nullptr) || (pLevels == nullptr) || (pIndexData == nullptr) || (uiLevels != uiVertices) )
+        return false;
+    if( !index.load( pIndexData, static_cast<int>( uiIndexSize ) ) || (index.count() != static_cast<int>( uiAirspaces )) )
+        return false;
+
+    pAirspaces->reserve( static_cast<int>( uiAirspaces ) );
+    for( i = 0; i < uiAirspaces; i++ )
+    {
+        const AirspaceRecord &rec = pRecs[i];
+
+        if( (rec.uiFirstVertex + rec.uiVertices) > uiVertices )
+        {
+            pAirspaces->clear();
+            return false;
+        }
+
+        as.qsName = db.string( rec.uiName );
+        as.eType = static_cast<Canvas::AirspaceType>( rec.iType );
+        as.iAltTop = rec.iAltTop;
+        as.iAltBottom = rec.iAltBottom;
+        as.bounds.setCoords( rec.dLeft, rec.dTop, rec.dRight, rec.dBottom );
+        as.center = as.bounds.center();
+        as.shape.resize( static_cast<int>( rec.uiVertices ) );
+        for( j = 0; j < rec.uiVertices; j++ )
+            as.shape[static_cast<int>( j )] = QPointF( pVertices[(rec.uiFirstVertex + j) * 2], pVertices[((rec.uiFirstVertex + j) * 2) + 1] );
+        as.shapeLevels.resize( static_cast<int>( rec.uiVertices ) );
+        memcpy( as.shapeLevels.data(), pLevels + rec.uiFirstVertex, rec.uiVertices );
+        pAirspaces->append( as );
+    }
+    *pIndex = index;
+
+    return true;
+}
+
+
+// Element text the way QDomElement::text() gave it, markup inside and all
+static QString elementText( QXmlStreamReader *pXml )
+{
+    return pXml->readElementText( QXmlStreamReader::IncludeChildElements );
+}
+
+
+// One AIRPORT element, from just after its start tag to just after its end tag
+static void readAirport( QXmlStreamReader *pXml, Airport *pAirport )
+{
+    Frequency f;
+
+    pAirport->bd.dBearing = 0.0;
+    pAirport->bd.dDistance = 0.0;
+    pAirport->dLat = 0.0;
+    pAirport->dLong = 0.0;
+    pAirport->dElev = 0.0;
+    pAirport->bGrass = false;
+    pAirport->qsID.clear();
+    pAirport->qsName.clear();
+    pAirport->runways.clear();
+    pAirport->frequencies.clear();
+
+    while( pXml->readNextStartElement() )
+    {
+        if( pXml->name() == "ICAO" )
+            pAirport->qsID = elementText( pXml );
+        else if( pXml->name() == "NAME" )
+        {
+            pAirport->qsName = elementText( pXml );
+            // Clean up really long names
+            pAirport->qsName.replace( "REGIONAL", "RGNL" );
+            pAirport->qsName.replace( "EXECUTIVE", "EXEC" );
+            pAirport->qsName.replace( "INTERNATIONAL", "INTL" );
+            pAirport->qsName.replace( "AERODROME", "AERO" );
+            pAirport->qsName.replace( "BALLOONPORT", "BALLOON" );
+            pAirport->qsName.remove( "AIRPORT" );
+            pAirport->qsName.remove( "FIELD" );
+        }
+        else if( pXml->name() == "GEOLOCATION" )
+        {
+            while( pXml->readNextStartElement() )
+            {
+                if( pXml->name() == "LAT" )
+                    pAirport->dLat = elementText( pXml ).toDouble();
+                else if( pXml->name() == "LON" )
+                    pAirport->dLong = elementText( pXml ).toDouble();
+                else if( pXml->name() == "ELEV" )
+                {
+                    // The attribute has to be read before the text moves the reader past it
+                    bool bMeters = pXml->attributes().value( "UNIT" ).contains( "M", Qt::CaseInsensitive );
+
+                    pAirport->dElev = elementText( pXml ).toDouble();
+                    if( bMeters )
+                        pAirport->dElev *= MetersToFeet;
+                }
+                else
+                    pXml->skipCurrentElement();
+            }
+        }
+        else if( pXml->name() == "RWY" )
+        {
+            while( pXml->readNextStartElement() )
+            {
+                if( pXml->name() == "SFC" )
+                {
+                    if( elementText( pXml ) == "GRAS" )
+                        pAirport->bGrass = true;
+                }
+                else if( pXml->name() == "DIRECTION" )
+                {
+                    pAirport->runways.append( pXml->attributes().value( "TC" ).toInt() );
+                    pXml->skipCurrentElement();
+                }
+                else
+                    pXml->skipCurrentElement();
+            }
+        }
+        else if( pXml->name() == "RADIO" )
+        {
+            f.dFreq = 0.0;
+            f.qsDescription.clear();
+            while( pXml->readNextStartElement() )
+            {
+                if( pXml->name() == "FREQUENCY" )
+                    f.dFreq = elementText( pXml ).toDouble();
+                else if( pXml->name() == "DESCRIPTION" )
+                    f.qsDescription = elementText( pXml );
+                else
+                    pXml->skipCurrentElement();
+            }
+            pAirport->frequencies.append( f );
+        }
+        else
+            pXml->skipCurrentElement();
+    }
+
+    if( pAirport->qsID.isEmpty() )
+        pAirport->qsID = "R";
+}
+
+
+// Altitude from an ALTLIMIT_TOP or ALTLIMIT_BOTTOM element
+static void readAltitude( QXmlStreamReader *pXml, int *pAlt )
+{
+    while( pXml->readNextStartElement() )
+    {
+        if( pXml->name() == "ALT" )
+            *pAlt = elementText( pXml ).toInt();  // Assume feet
+        else
+            pXml->skipCurrentElement();
+    }
+}
+
+
+// One ASP element, from just after its start tag to just after its end tag
+static void readAirspace( QXmlStreamReader *pXml, Airspace *pAirspace )
+{
+    QStringRef qsCategory = pXml->attributes().value( "CATEGORY" );
+
+    pAirspace->qsName.clear();
+    pAirspace->eType = Canvas::Airspace_Class_G;
+    pAirspace->iAltTop = 0;
+    pAirspace->iAltBottom = 0;
+    pAirspace->shape.clear();
+
+    if( qsCategory == "G" )
+        pAirspace->eType = Canvas::Airspace_Class_G;
+    else if( qsCategory == "E" )
+        pAirspace->eType = Canvas::Airspace_Class_E;
+    else if( qsCategory == "D" )
+        pAirspace->eType = Canvas::Airspace_Class_D;
+    else if( qsCategory == "C" )
+        pAirspace->eType = Canvas::Airspace_Class_C;
+    // The AIP database doesn't distinguish between MOA, TFR and SFRA types; most can be resolved by the name but those that can't will
+    // remain assigned to this unofficial type and should probably be colored the same as Restricted or Prohibited
+    else if( qsCategory == "DANGER" )
+        pAirspace->eType = Canvas::Airspace_Danger;
+    else if( qsCategory == "PROHIBITED" )
+        pAirspace->eType = Canvas::Airspace_Prohibited;
+    else if( qsCategory == "RESTRICTED" )
+        pAirspace->eType = Canvas::Airspace_Restricted;
+
+    while( pXml->readNextStartElement() )
+    {
+        if( pXml->name() == "NAME" )
+        {
+            pAirspace->qsName = elementText( pXml );
+            // Try to resolve the ambiguous "DANGER" category to what it really is
+            if( pAirspace->qsName.contains( "MOA" ) || pAirspace->qsName.contains( "BY NOTAM" ) )
+                pAirspace->eType = Canvas::Airspace_MOA;
+            else if( pAirspace->qsName.contains( "TFR" ) )
+                pAirspace->eType = Canvas::Airspace_TFR;
+            else if( pAirspace->qsName.contains( "SFRA" ) )
+                pAirspace->eType = Canvas::Airspace_SFRA;
+        }
+        else if( pXml->name() == "ALTLIMIT_TOP" )
+            readAltitude( pXml, &pAirspace->iAltTop );
+        else if( pXml->name() == "ALTLIMIT_BOTTOM" )
+            readAltitude( pXml, &pAirspace->iAltBottom );
+        else if( pXml->name() == "GEOMETRY" )
+        {
+            while( pXml->readNextStartElement() )
+            {
+                if( pXml->name() == "POLYGON" )
+                {
+                    // "lon lat, lon lat, ..." split in place rather than into a list of copies
+                    QString             qsPoly = elementText( pXml );
+                    QVector<QStringRef> pairs = qsPoly.splitRef( ',' );
+                    QStringRef          pair;
+
+                    pAirspace->shape.reserve( pAirspace->shape.count() + pairs.count() );
+                    foreach( pair, pairs )
+                    {
+                        QVector<QStringRef> coords = pair.trimmed().split( ' ' );
+
+                        if( coords.count() == 2 )
+                            pAirspace->shape.append( QPointF( coords.first().toDouble(), coords.last().toDouble() ) );
+                    }
+                }
+                else
+                    pXml->skipCurrentElement();
+            }
+        }
+        else
+            pXml->skipCurrentElement();
+    }
+
+    pAirspace->bounds = pAirspace->shape.boundingRect();
+    pAirspace->center = pAirspace->bounds.center();
+    TrafficMath::simplifyShape( pAirspace->shape, &pAirspace->shapeLevels );
+}
+
+
+// Straight from the OpenAIP XML in one streaming pass; records are filled in as their elements go by so memory
+// stays at the size of the result rather than a document tree several times the size of the file
+bool AviationDB::parseAirports( const QString &qsAipFile, AirportCache *pAirports )
+{
+    QFile            aipDatabase( qsAipFile );
+    QXmlStreamReader xml;
+    Airport          ap;
+
+    pAirports->clear();
+    if( !aipDatabase.open( QIODevice::ReadOnly ) )
+        return false;
+    xml.setDevice( &aipDatabase );
+
+    // Don't proceed if this isn't an OpenAIP file
+    if( !xml.readNextStartElement() || (xml.name() != "OPENAIP") )
+        return false;
+
+    while( xml.readNextStartElement() )
+    {
+        if( xml.name() != "WAYPOINTS" )
+        {
+            xml.skipCurrentElement();
+            continue;
+        }
+        while( xml.readNextStartElement() )
+        {
+            if( (xml.name() == "AIRPORT") && (xml.attributes().value( "TYPE" ) != "HELI_CIVIL") )
+            {
+                readAirport( &xml, &ap );
+                pAirports->append( ap );
+            }
+            else
+                xml.skipCurrentElement();
+        }
+    }
+
+    // A file that's cut off or malformed is rejected whole, same as the document parse did
+    if( xml.hasError() )
+    {
+        qDebug() << xml.errorString() << xml.lineNumber() << xml.columnNumber();
+        pAirports->clear();
+        return false;
+    }
+    pAirports->squeeze();
+
+    return true;
+}
+
+
+bool AviationDB::parseAirspaces( const QString &qsAipFile, QList<Airspace> *pAirspaces )
+{
+    QFile            aipDatabase( qsAipFile );
+    QXmlStreamReader xml;
+    Airspace         as;
+
+    pAirspaces->clear();
+    if( !aipDatabase.open( QIODevice::ReadOnly ) )
+        return false;
+    xml.setDevice( &aipDatabase );
+
+    // Don't proceed if this isn't an OpenAIP file
+    if( !xml.readNextStartElement() || (xml.name() != "OPENAIP") )
+        return false;
+
+    while( xml.readNextStartElement() )
+    {
+        if( xml.name() != "AIRSPACES" )
+        {
+            xml.skipCurrentElement();
+            continue;
+        }
+        while( xml.readNextStartElement() )
+        {
+            if( xml.name() == "ASP" )
+            {
+                readAirspace( &xml, &as );
+                pAirspaces->append( as );    // Note there are no haversine transforms to get the bearing and distance since that's handled by updateNearbyAirspaces
+            }
+            else
+                xml.skipCurrentElement();
+        }
+    }
+
+    if( xml.hasError() )
+    {
+        qDebug() << xml.errorString() << xml.lineNumber() << xml.columnNumber();
+        pAirspaces->clear();
+        return false;
+    }
+
+    return true;
+}
@@ -12,6 +12,7 @@ Stratofier Stratux AHRS Display
 
 #include "Builder.h"
 #include "Canvas.h"
+#include "NumberAtlas.h"
 
 
 extern QFont wee;
@@ -26,7 +27,7 @@ Builder::Builder()
 }
 
 
-void Builder::buildNumber( QPixmap *pNumber, CanvasConstants *c, int iNum, int iFieldWidth )
+void Builder::buildNumber( QPixmap *pNumber, const NumberAtlas *pAtlas, int iNum, int iFieldWidth )
 {
     pNumber->fill( Qt::transparent );
 
@@ -37,60 +38,48 @@ void Builder::buildNumber( QPixmap *pNumber, CanvasConstants *c, int iNum, int i
 
     foreach( cNum, qsNum )
     {
-        QPixmap num( QString( ":/num/resources/%1.png" ).arg( cNum ) );
-
-        numPainter.drawPixmap( iX, 0, c->dWNum, c->dHNum, num );
-        iX += static_cast<int>( c->dWNum );
+        pAtlas->draw( &numPainter, iX, 0, cNum, NumberAtlas::Plain );
+        iX += pAtlas->width( NumberAtlas::Plain );
     }
 }
 
 
-void Builder::buildNumber( QPixmap *pNumber, CanvasConstants *c, const QString &qsNum )
+void Builder::buildNumber( QPixmap *pNumber, const NumberAtlas *pAtlas, const QString &qsNum )
 {
     pNumber->fill( Qt::transparent );
 
     QPainter numPainter( pNumber );
     QChar    cNum;
     int      iX = 0;
-    QString  qsDigit;
 
     foreach( cNum, qsNum )
     {
-        if( cNum == ':' )
-            qsDigit = ":/num/resources/colon.png";
-        else
-            qsDigit = QString( ":/num/resources/%1.png" ).arg( cNum );
-        QPixmap num( qsDigit );
-        numPainter.drawPixmap( iX, 0, c->dWNum, c->dHNum, num );
-        iX += static_cast<int>( c->dWNum );
+        pAtlas->draw( &numPainter, iX, 0, cNum, NumberAtlas::Plain );
+        iX += pAtlas->width( NumberAtlas::Plain );
     }
 }
 
 
-void Builder::buildNumber(QPixmap *pNumber, CanvasConstants *c, double dNum, int iPrec )
+void Builder::buildNumber( QPixmap *pNumber, const NumberAtlas *pAtlas, double dNum, int iPrec )
 {
     pNumber->fill( Qt::transparent );
 
-    QPainter numPainter( pNumber );
-    QString  qsNum = QString::number( dNum, 'f', iPrec );
-    QChar    cNum;
-    int      iX = 0;
-    bool     bMantissa = false;
-    int      iFull = static_cast<int>( c->dWNum );
-    int      iHalf = static_cast<int>( c->dWNum / 1.5 );
+    QPainter           numPainter( pNumber );
+    QString            qsNum = QString::number( dNum, 'f', iPrec );
+    QChar              cNum;
+    int                iX = 0;
+    NumberAtlas::Style eStyle = NumberAtlas::Bold;
 
     foreach( cNum, qsNum )
     {
         if( cNum == '.' )
         {
-            bMantissa = true;
+            eStyle = NumberAtlas::BoldSmall;
             continue;
         }
 
-        QPixmap num( QString( ":/num/resources/%1b.png" ).arg( cNum ) );
-
-        numPainter.drawPixmap( static_cast<double>( iX ), bMantissa ? (c->dHNum * 0.25) - 1.0 : 0.0, (bMantissa ? c->dWNum / 1.5 : c->dWNum), (bMantissa ? c->dHNum / 1.5 : c->dHNum), num );
-        iX += (bMantissa ? iHalf : iFull);
+        pAtlas->draw( &numPainter, iX, (eStyle == NumberAtlas::BoldSmall) ? pAtlas->mantissaY() : 0, cNum, eStyle );
+        iX += pAtlas->width( eStyle );
     }
 }
 
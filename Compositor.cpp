@@ -0,0 +1,147 @@
+/*
+Stratofier Stratux AHRS Display
+(c) 2018 Allen K. Lair, Sky Fun
+*/
+
+#include <QPainter>
+
+#include <string.h>
+
+#include "Compositor.h"
+
+
+LayerKey &LayerKey::operator<<( double d )
+{
+    quint64 uiBits;
+
+    memcpy( &uiBits, &d, sizeof( d ) );
+    m_parts.append( uiBits );
+
+    return *this;
+}
+
+
+LayerKey &LayerKey::operator<<( int i )
+{
+    m_parts.append( static_cast<quint64>( static_cast<qint64>( i ) ) );
+
+    return *this;
+}
+
+
+LayerKey &LayerKey::operator<<( bool b )
+{
+    m_parts.append( b ? 1 : 0 );
+
+    return *this;
+}
+
+
+Compositor::Compositor()
+{
+    for( int i = 0; i < LayerCount; i++ )
+    {
+        m_layers[i].bDirty = true;
+        memset( &m_layers[i].stats, 0, sizeof( LayerStats ) );
+    }
+}
+
+
+const char *Compositor::name( Layer eLayer )
+{
+    switch( eLayer )
+    {
+        case FuelLayer:
+            return "fuel";
+        case NavLayer:
+            return "nav";
+        default:
+            return "?";
+    }
+}
+
+
+// Redrawn next frame whatever the key says, e.g. for a pixmap it draws that's been reloaded
+void Compositor::invalidate( Layer eLayer )
+{
+    m_layers[eLayer].bDirty = true;
+}
+
+
+void Compositor::invalidateAll()
+{
+    for( int i = 0; i < LayerCount; i++ )
+        m_layers[i].bDirty = true;
+}
+
+
+// True if the layer needs drawing this frame, in which case its image is cleared for it and end() has to follow once
+// it's drawn; the image is in canvas coordinates offset by origin().
+// False means what's in the image already will do.
+bool Compositor::begin( Layer eLayer, const QVector<QRect> &parts, const LayerKey &key, qreal dPixelRatio )
+{
+    Entry &layer = m_layers[eLayer];
+    QRect  bounds;
+    int    i;
+
+    for( i = 0; i < parts.count(); i++ )
+        bounds = bounds.united( parts.at( i ) );
+    layer.parts = parts;
+
+    // New geometry is a new image
+    if( (bounds != layer.bounds) || layer.image.isNull() || (layer.image.devicePixelRatio() != dPixelRatio) )
+    {
+        layer.bounds = bounds;
+        layer.image = QImage( bounds.size() * dPixelRatio, QImage::Format_ARGB32_Premultiplied );
+        layer.image.setDevicePixelRatio( dPixelRatio );
+        layer.bDirty = true;
+    }
+
+    if( (!layer.bDirty) && (key == layer.key) )
+    {
+        layer.stats.iReused++;
+        return false;
+    }
+
+    layer.key = key;
+    layer.image.fill( Qt::transparent );
+    layer.drawTime.start();
+
+    return true;
+}
+
+
+void Compositor::end( Layer eLayer )
+{
+    Entry &layer = m_layers[eLayer];
+
+    layer.stats.iRedraws++;
+    layer.stats.iRedrawNs += layer.drawTime.nsecsElapsed();
+    layer.bDirty = false;
+}
+
+
+// Copies the layer's rectangles into place; the painter should have no transform or clipping
+void Compositor::draw( QPainter *pPainter, Layer eLayer ) const
+{
+    const Entry &layer = m_layers[eLayer];
+    qreal        dRatio = layer.image.devicePixelRatio();
+    QRect        part;
+
+    for( int i = 0; i < layer.parts.count(); i++ )
+    {
+        part = layer.parts.at( i );
+        pPainter->drawImage( QRectF( part ), layer.image,
+                             QRectF( (part.x() - layer.bounds.x()) * dRatio, (part.y() - layer.bounds.y()) * dRatio, part.width() * dRatio, part.height() * dRatio ) );
+    }
+}
+
+
+LayerStats Compositor::stats( Layer eLayer )
+{
+    LayerStats stats = m_layers[eLayer].stats;
+
+    memset( &m_layers[eLayer].stats, 0, sizeof( LayerStats ) );
+
+    return stats;
+}
@@ -0,0 +1,365 @@
+/*
+Stratofier Stratux AHRS Display
+(c) 2018 Allen K. Lair, Sky Fun
+*/
+
+#include <math.h>
+
+#include "GDL90.h"
+
+
+#define GDL90_FLAG    0x7E
+#define GDL90_ESCAPE  0x7D
+
+
+// CRC-CCITT lookup table from section 2.2.3 of the spec
+struct CrcTable
+{
+    quint16 uiTable[256];
+
+    CrcTable()
+    {
+        for( int i = 0; i < 256; i++ )
+        {
+            quint16 uiCrc = static_cast<quint16>( i << 8 );
+
+            for( int iBit = 0; iBit < 8; iBit++ )
+                uiCrc = static_cast<quint16>( (uiCrc << 1) ^ ((uiCrc & 0x8000) ? 0x1021 : 0) );
+            uiTable[i] = uiCrc;
+        }
+    }
+};
+
+static const CrcTable s_crc;
+
+
+static inline quint8 byteAt( const QByteArray &msg, int i )
+{
+    return static_cast<quint8>( msg.at( i ) );
+}
+
+
+// Signed big endian 16 bit field
+static inline int int16At( const QByteArray &msg, int i )
+{
+    return static_cast<qint16>( (byteAt( msg, i ) << 8) | byteAt( msg, i + 1 ) );
+}
+
+
+// Signed 24 bit semicircle field to degrees
+static inline double semicircles( const QByteArray &msg, int i )
+{
+    int iVal = (byteAt( msg, i ) << 16) | (byteAt( msg, i + 1 ) << 8) | byteAt( msg, i + 2 );
+
+    if( iVal & 0x800000 )
+        iVal -= 0x1000000;
+
+    return static_cast<double>( iVal ) * 180.0 / 8388608.0;
+}
+
+
+quint16 GDL90::crc( const char *pData, int iLen )
+{
+    quint16 uiCrc = 0;
+
+    for( int i = 0; i < iLen; i++ )
+        uiCrc = static_cast<quint16>( s_crc.uiTable[uiCrc >> 8] ^ (uiCrc << 8) ^ static_cast<quint8>( pData[i] ) );
+
+    return uiCrc;
+}
+
+
+// Pull the next complete message out of the buffer starting at *pPos.
+// The message is returned unescaped with the CRC stripped; frames that fail the CRC are skipped.
+// Returns false when no complete frame is left, with *pPos on the start of any partial frame so the caller can keep the remainder.
+bool GDL90::nextMessage( const QByteArray &buffer, int *pPos, QByteArray *pMsg )
+{
+    const char *pData = buffer.constData();
+    int         iLen = buffer.size();
+    int         iStart = *pPos;
+    int         iEnd;
+    int         i;
+
+    for( ;; )
+    {
+        while( (iStart < iLen) && (static_cast<quint8>( pData[iStart] ) != GDL90_FLAG) )
+            iStart++;
+        iEnd = iStart + 1;
+        while( (iEnd < iLen) && (static_cast<quint8>( pData[iEnd] ) != GDL90_FLAG) )
+            iEnd++;
+        if( iEnd >= iLen )
+        {
+            *pPos = (iStart < iLen) ? iStart : iLen;
+            return false;
+        }
+
+        // Unescape the bytes between the flags
+        pMsg->resize( 0 );
+        for( i = iStart + 1; i < iEnd; i++ )
+        {
+            if( (static_cast<quint8>( pData[i] ) == GDL90_ESCAPE) && ((i + 1) < iEnd) )
+            {
+                i++;
+                pMsg->append( static_cast<char>( pData[i] ^ 0x20 ) );
+            }
+            else
+                pMsg->append( pData[i] );
+        }
+
+        // The closing flag may also be the opening flag of the next frame
+        iStart = iEnd;
+
+        // Message ID plus the CRC at the very least
+        if( pMsg->size() < 3 )
+            continue;
+        if( crc( pMsg->constData(), pMsg->size() - 2 ) == (byteAt( *pMsg, pMsg->size() - 2 ) | (byteAt( *pMsg, pMsg->size() - 1 ) << 8)) )
+        {
+            pMsg->chop( 2 );
+            *pPos = iEnd;
+            return true;
+        }
+    }
+}
+
+
+// Add the CRC, escape and wrap a message in flags
+QByteArray GDL90::frame( const QByteArray &msg )
+{
+    QByteArray raw( msg );
+    QByteArray out;
+    quint16    uiCrc = crc( msg.constData(), msg.size() );
+
+    raw.append( static_cast<char>( uiCrc & 0xFF ) );
+    raw.append( static_cast<char>( uiCrc >> 8 ) );
+
+    out.reserve( (raw.size() * 2) + 2 );
+    out.append( static_cast<char>( GDL90_FLAG ) );
+    for( int i = 0; i < raw.size(); i++ )
+    {
+        quint8 c = byteAt( raw, i );
+
+        if( (c == GDL90_FLAG) || (c == GDL90_ESCAPE) )
+        {
+            out.append( static_cast<char>( GDL90_ESCAPE ) );
+            out.append( static_cast<char>( c ^ 0x20 ) );
+        }
+        else
+            out.append( static_cast<char>( c ) );
+    }
+    out.append( static_cast<char>( GDL90_FLAG ) );
+
+    return out;
+}
+
+
+bool GDL90::heartbeat( const QByteArray &msg, GDL90Heartbeat *pHeartbeat )
+{
+    if( (msg.size() < 7) || (byteAt( msg, 0 ) != Heartbeat) )
+        return false;
+
+    pHeartbeat->bGPSValid = ((byteAt( msg, 1 ) & 0x80) != 0);
+    pHeartbeat->bUATInit = ((byteAt( msg, 1 ) & 0x01) != 0);
+    pHeartbeat->bUTCValid = ((byteAt( msg, 2 ) & 0x01) != 0);
+    pHeartbeat->iTimestamp = ((byteAt( msg, 2 ) & 0x80) << 9) | (byteAt( msg, 4 ) << 8) | byteAt( msg, 3 );
+    pHeartbeat->iUplinkCount = byteAt( msg, 5 ) >> 3;
+    pHeartbeat->iBasicLongCount = ((byteAt( msg, 5 ) & 0x03) << 8) | byteAt( msg, 6 );
+
+    return true;
+}
+
+
+// Ownship or traffic report (section 3.5.1)
+bool GDL90::targetReport( const QByteArray &msg, GDL90Target *pTarget )
+{
+    int iAlt, iSpeed, iVVel;
+
+    if( (msg.size() < 28) || ((byteAt( msg, 0 ) != Ownship) && (byteAt( msg, 0 ) != Traffic)) )
+        return false;
+
+    pTarget->iAlertStatus = byteAt( msg, 1 ) >> 4;
+    pTarget->iAddrType = byteAt( msg, 1 ) & 0x0F;
+    pTarget->iAddress = (byteAt( msg, 2 ) << 16) | (byteAt( msg, 3 ) << 8) | byteAt( msg, 4 );
+    pTarget->dLat = semicircles( msg, 5 );
+    pTarget->dLong = semicircles( msg, 8 );
+
+    iAlt = (byteAt( msg, 11 ) << 4) | (byteAt( msg, 12 ) >> 4);
+    pTarget->bAltValid = (iAlt != 0xFFF);
+    pTarget->dAlt = pTarget->bAltValid ? static_cast<double>( (iAlt * 25) - 1000 ) : 0.0;
+    pTarget->bAirborne = ((byteAt( msg, 12 ) & 0x08) != 0);
+    pTarget->iTrackType = byteAt( msg, 12 ) & 0x03;
+    pTarget->iNIC = byteAt( msg, 13 ) >> 4;
+    pTarget->iNACp = byteAt( msg, 13 ) & 0x0F;
+
+    // Zero lat, long and NIC together is the spec's "no position"
+    pTarget->bPosValid = !((pTarget->dLat == 0.0) && (pTarget->dLong == 0.0) && (pTarget->iNIC == 0));
+
+    iSpeed = (byteAt( msg, 14 ) << 4) | (byteAt( msg, 15 ) >> 4);
+    pTarget->bSpeedValid = (iSpeed != 0xFFF);
+    pTarget->dSpeed = pTarget->bSpeedValid ? static_cast<double>( iSpeed ) : 0.0;
+
+    iVVel = ((byteAt( msg, 15 ) & 0x0F) << 8) | byteAt( msg, 16 );
+    pTarget->bVertSpeedValid = (iVVel != 0x800);
+    if( iVVel & 0x800 )
+        iVVel -= 0x1000;
+    pTarget->dVertSpeed = pTarget->bVertSpeedValid ? static_cast<double>( iVVel * 64 ) : 0.0;
+
+    pTarget->dTrack = static_cast<double>( byteAt( msg, 17 ) ) * 360.0 / 256.0;
+    pTarget->iEmitter = byteAt( msg, 18 );
+    pTarget->qsCallsign = QString::fromLatin1( msg.constData() + 19, 8 ).trimmed();
+    pTarget->iPriority = byteAt( msg, 27 ) >> 4;
+
+    return true;
+}
+
+
+// Ownship geometric altitude in feet (section 3.8)
+bool GDL90::geoAltitude( const QByteArray &msg, double *pAlt )
+{
+    if( (msg.size() < 5) || (byteAt( msg, 0 ) != OwnshipGeoAlt) )
+        return false;
+
+    *pAlt = static_cast<double>( int16At( msg, 1 ) * 5 );
+
+    return true;
+}
+
+
+// Stratux AHRS report - see https://github.com/cyoung/stratux/blob/master/notes/app-vendor-integration.md
+// Values are signed 16 bit big endian in tenths except airspeed (knots), pressure altitude (feet + 5000) and vertical speed (fpm).
+// 0x7FFF marks a value that isn't available (0xFFFF for the unsigned pressure altitude).
+bool GDL90::stratuxAHRS( const QByteArray &msg, GDL90AHRS *pAHRS )
+{
+    int iRoll, iPitch, iVal;
+
+    if( (msg.size() < 24) || (byteAt( msg, 0 ) != StratuxAHRS) || (byteAt( msg, 1 ) != 0x45) || (byteAt( msg, 2 ) != 0x01) )
+        return false;
+
+    iRoll = int16At( msg, 4 );
+    iPitch = int16At( msg, 6 );
+    pAHRS->bAttValid = (iRoll != 0x7FFF) && (iPitch != 0x7FFF);
+    pAHRS->dRoll = pAHRS->bAttValid ? iRoll / 10.0 : 0.0;
+    pAHRS->dPitch = pAHRS->bAttValid ? iPitch / 10.0 : 0.0;
+
+    iVal = int16At( msg, 8 );
+    pAHRS->bHeadingValid = (iVal != 0x7FFF);
+    pAHRS->dHeading = pAHRS->bHeadingValid ? iVal / 10.0 : 0.0;
+    if( pAHRS->dHeading < 0.0 )
+        pAHRS->dHeading += 360.0;
+
+    // Stratux sends the slip/skid negated relative to its situation message
+    iVal = int16At( msg, 10 );
+    pAHRS->dSlipSkid = (iVal != 0x7FFF) ? -iVal / 10.0 : 0.0;
+    iVal = int16At( msg, 12 );
+    pAHRS->dTurnRate = (iVal != 0x7FFF) ? iVal / 10.0 : 0.0;
+
+    iVal = int16At( msg, 14 );
+    pAHRS->bGLoadValid = (iVal != 0x7FFF);
+    pAHRS->dGLoad = pAHRS->bGLoadValid ? iVal / 10.0 : 1.0;
+
+    iVal = int16At( msg, 16 );
+    pAHRS->bIASValid = (iVal != 0x7FFF);
+    pAHRS->dIAS = pAHRS->bIASValid ? static_cast<double>( iVal ) : 0.0;
+
+    iVal = (byteAt( msg, 18 ) << 8) | byteAt( msg, 19 );
+    pAHRS->bPressAltValid = (iVal != 0xFFFF);
+    pAHRS->dPressAlt = pAHRS->bPressAltValid ? static_cast<double>( iVal - 5000 ) : 0.0;
+
+    iVal = int16At( msg, 20 );
+    pAHRS->bVertSpeedValid = (iVal != 0x7FFF);
+    pAHRS->dVertSpeed = pAHRS->bVertSpeedValid ? static_cast<double>( iVal ) : 0.0;
+
+    return true;
+}
+
+
+static inline void appendInt16( QByteArray *pMsg, int iVal )
+{
+    pMsg->append( static_cast<char>( (iVal >> 8) & 0xFF ) );
+    pMsg->append( static_cast<char>( iVal & 0xFF ) );
+}
+
+
+static inline void appendSemicircles( QByteArray *pMsg, double dDeg )
+{
+    int iVal = static_cast<int>( floor( (dDeg * 8388608.0 / 180.0) + 0.5 ) ) & 0xFFFFFF;
+
+    pMsg->append( static_cast<char>( iVal >> 16 ) );
+    pMsg->append( static_cast<char>( (iVal >> 8) & 0xFF ) );
+    pMsg->append( static_cast<char>( iVal & 0xFF ) );
+}
+
+
+static inline int tenths( double dVal )
+{
+    return static_cast<int>( floor( (dVal * 10.0) + 0.5 ) );
+}
+
+
+QByteArray GDL90::encodeHeartbeat( const GDL90Heartbeat &heartbeat )
+{
+    QByteArray msg;
+
+    msg.append( static_cast<char>( Heartbeat ) );
+    msg.append( static_cast<char>( (heartbeat.bGPSValid ? 0x80 : 0) | (heartbeat.bUATInit ? 0x01 : 0) ) );
+    msg.append( static_cast<char>( ((heartbeat.iTimestamp >> 9) & 0x80) | (heartbeat.bUTCValid ? 0x01 : 0) ) );
+    msg.append( static_cast<char>( heartbeat.iTimestamp & 0xFF ) );
+    msg.append( static_cast<char>( (heartbeat.iTimestamp >> 8) & 0xFF ) );
+    msg.append( static_cast<char>( ((heartbeat.iUplinkCount & 0x1F) << 3) | ((heartbeat.iBasicLongCount >> 8) & 0x03) ) );
+    msg.append( static_cast<char>( heartbeat.iBasicLongCount & 0xFF ) );
+
+    return msg;
+}
+
+
+QByteArray GDL90::encodeTargetReport( MessageID eID, const GDL90Target &target )
+{
+    QByteArray msg;
+    QByteArray callsign = target.qsCallsign.toLatin1().leftJustified( 8, ' ', true );
+    int        iAlt = target.bAltValid ? qBound( 0, static_cast<int>( (target.dAlt + 1000.0) / 25.0 + 0.5 ), 0xFFE ) : 0xFFF;
+    int        iSpeed = target.bSpeedValid ? qBound( 0, static_cast<int>( target.dSpeed + 0.5 ), 0xFFE ) : 0xFFF;
+    int        iVVel = target.bVertSpeedValid ? (qBound( -0x7FF, static_cast<int>( floor( (target.dVertSpeed / 64.0) + 0.5 ) ), 0x7FF ) & 0xFFF) : 0x800;
+    int        iTrack = static_cast<int>( floor( (target.dTrack * 256.0 / 360.0) + 0.5 ) ) & 0xFF;
+
+    msg.append( static_cast<char>( eID ) );
+    msg.append( static_cast<char>( ((target.iAlertStatus & 0x0F) << 4) | (target.iAddrType & 0x0F) ) );
+    msg.append( static_cast<char>( (target.iAddress >> 16) & 0xFF ) );
+    msg.append( static_cast<char>( (target.iAddress >> 8) & 0xFF ) );
+    msg.append( static_cast<char>( target.iAddress & 0xFF ) );
+    appendSemicircles( &msg, target.bPosValid ? target.dLat : 0.0 );
+    appendSemicircles( &msg, target.bPosValid ? target.dLong : 0.0 );
+    msg.append( static_cast<char>( iAlt >> 4 ) );
+    msg.append( static_cast<char>( ((iAlt & 0x0F) << 4) | (target.bAirborne ? 0x08 : 0) | (target.iTrackType & 0x03) ) );
+    msg.append( static_cast<char>( ((target.iNIC & 0x0F) << 4) | (target.iNACp & 0x0F) ) );
+    msg.append( static_cast<char>( iSpeed >> 4 ) );
+    msg.append( static_cast<char>( ((iSpeed & 0x0F) << 4) | (iVVel >> 8) ) );
+    msg.append( static_cast<char>( iVVel & 0xFF ) );
+    msg.append( static_cast<char>( iTrack ) );
+    msg.append( static_cast<char>( target.iEmitter ) );
+    msg.append( callsign );
+    msg.append( static_cast<char>( (target.iPriority & 0x0F) << 4 ) );
+
+    return msg;
+}
+
+
+QByteArray GDL90::encodeStratuxAHRS( const GDL90AHRS &ahrs )
+{
+    QByteArray msg;
+
+    msg.append( static_cast<char>( StratuxAHRS ) );
+    msg.append( static_cast<char>( 0x45 ) );
+    msg.append( static_cast<char>( 0x01 ) );
+    msg.append( static_cast<char>( 0x01 ) );
+    appendInt16( &msg, ahrs.bAttValid ? tenths( ahrs.dRoll ) : 0x7FFF );
+    appendInt16( &msg, ahrs.bAttValid ? tenths( ahrs.dPitch ) : 0x7FFF );
+    appendInt16( &msg, ahrs.bHeadingValid ? tenths( ahrs.dHeading ) : 0x7FFF );
+    appendInt16( &msg, tenths( -ahrs.dSlipSkid ) );
+    appendInt16( &msg, tenths( ahrs.dTurnRate ) );
+    appendInt16( &msg, ahrs.bGLoadValid ? tenths( ahrs.dGLoad ) : 0x7FFF );
+    appendInt16( &msg, ahrs.bIASValid ? static_cast<int>( ahrs.dIAS + 0.5 ) : 0x7FFF );
+    appendInt16( &msg, ahrs.bPressAltValid ? static_cast<int>( ahrs.dPressAlt + 5000.5 ) : 0xFFFF );
+    appendInt16( &msg, ahrs.bVertSpeedValid ? static_cast<int>( floor( ahrs.dVertSpeed + 0.5 ) ) : 0x7FFF );
+    appendInt16( &msg, 0x7FFF );
+
+    return msg;
+}
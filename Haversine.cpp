@@ -0,0 +1,402 @@
+/*
+Stratofier Stratux AHRS Display
+(c) 2018 Allen K. Lair, Sky Fun
+*/
+
+// The geometry half of TrafficMath; it needs nothing from the rest of the app so the tools can link it on its own
+
+#include <math.h>
+
+#include <QPair>
+
+#if defined( __x86_64__ ) || defined( __i386__ )
+#include <immintrin.h>
+#elif defined( __aarch64__ )
+#include <arm_neon.h>
+#endif
+
+#include "StratofierDefs.h"
+#include "TrafficMath.h"
+
+
+// Find the distance and bearing from one lat/long to another
+BearingDist TrafficMath::haversine( double dLat1, double dLong1, double dLat2, double dLong2 )
+{
+    BearingDist ret;
+
+    double dRadiusEarth = 6371008.8;
+    double deltaLat = radiansRel( dLat2 - dLat1 );
+    double dAvgLat = radiansRel( (dLat2 + dLat1) / 2.0 );
+    double deltaLong = radiansRel( dLong2 - dLong1 );
+    double dDistN = deltaLat * dRadiusEarth;
+    double dDistE = deltaLong * dRadiusEarth * fabs( cos( dAvgLat ) );
+
+    ret.dDistance = sqrt( dDistN * dDistN + dDistE * dDistE ) * MetersToNM;
+    ret.dBearing  = degHeading( atan2( dDistE, dDistN ) );
+
+    while( ret.dBearing > 180 )
+        ret.dBearing -= 360;
+    while( ret.dBearing < -180 )
+        ret.dBearing += 360;
+
+    return ret;
+}
+
+
+// Batch version of haversine for many points from the same origin; the vector kernels below do the trig with polynomials
+// good to about 1e-15 instead of calling the math library per point. Anything the vector kernel can't cover, whether the
+// CPU has no usable vector unit or it's the last few points, goes through haversine() one at a time.
+#if defined( __x86_64__ ) || defined( __i386__ )
+#define HAVERSINE_AVX2
+#if defined( __clang__ )
+#pragma clang attribute push( __attribute__(( target( "avx2" ) )), apply_to = function )
+#else
+#pragma GCC push_options
+#pragma GCC target( "avx2" )
+#endif
+#elif defined( __aarch64__ )
+#define HAVERSINE_NEON
+#endif
+
+#if defined( HAVERSINE_AVX2 )
+struct HaversineAVX2
+{
+    typedef __m256d Vec;
+    enum { Width = 4 };
+
+    static inline Vec  load( const double *p ) { return _mm256_loadu_pd( p ); }
+    static inline Vec  splat( double d ) { return _mm256_set1_pd( d ); }
+    static inline Vec  add( Vec a, Vec b ) { return _mm256_add_pd( a, b ); }
+    static inline Vec  sub( Vec a, Vec b ) { return _mm256_sub_pd( a, b ); }
+    static inline Vec  mul( Vec a, Vec b ) { return _mm256_mul_pd( a, b ); }
+    static inline Vec  div( Vec a, Vec b ) { return _mm256_div_pd( a, b ); }
+    static inline Vec  sqrt( Vec a ) { return _mm256_sqrt_pd( a ); }
+    static inline Vec  min( Vec a, Vec b ) { return _mm256_min_pd( a, b ); }
+    static inline Vec  max( Vec a, Vec b ) { return _mm256_max_pd( a, b ); }
+    static inline Vec  abs( Vec a ) { return _mm256_andnot_pd( _mm256_set1_pd( -0.0 ), a ); }
+    static inline Vec  lt( Vec a, Vec b ) { return _mm256_cmp_pd( a, b, _CMP_LT_OQ ); }
+    static inline Vec  gt( Vec a, Vec b ) { return _mm256_cmp_pd( a, b, _CMP_GT_OQ ); }
+    static inline Vec  select( Vec m, Vec a, Vec b ) { return _mm256_blendv_pd( b, a, m ); }
+
+    // Bearings and distances back into BearingDist pairs
+    static inline void store( BearingDist *p, Vec vBearing, Vec vDist )
+    {
+        Vec lo = _mm256_unpacklo_pd( vBearing, vDist );
+        Vec hi = _mm256_unpackhi_pd( vBearing, vDist );
+
+        _mm256_storeu_pd( &p[0].dBearing, _mm256_permute2f128_pd( lo, hi, 0x20 ) );
+        _mm256_storeu_pd( &p[2].dBearing, _mm256_permute2f128_pd( lo, hi, 0x31 ) );
+    }
+};
+#endif
+
+#if defined( HAVERSINE_NEON )
+struct HaversineNEON
+{
+    typedef float64x2_t Vec;
+    enum { Width = 2 };
+
+    static inline Vec  load( const double *p ) { return vld1q_f64( p ); }
+    static inline Vec  splat( double d ) { return vdupq_n_f64( d ); }
+    static inline Vec  add( Vec a, Vec b ) { return vaddq_f64( a, b ); }
+    static inline Vec  sub( Vec a, Vec b ) { return vsubq_f64( a, b ); }
+    static inline Vec  mul( Vec a, Vec b ) { return vmulq_f64( a, b ); }
+    static inline Vec  div( Vec a, Vec b ) { return vdivq_f64( a, b ); }
+    static inline Vec  sqrt( Vec a ) { return vsqrtq_f64( a ); }
+    static inline Vec  min( Vec a, Vec b ) { return vminq_f64( a, b ); }
+    static inline Vec  max( Vec a, Vec b ) { return vmaxq_f64( a, b ); }
+    static inline Vec  abs( Vec a ) { return vabsq_f64( a ); }
+    static inline Vec  lt( Vec a, Vec b ) { return vreinterpretq_f64_u64( vcltq_f64( a, b ) ); }
+    static inline Vec  gt( Vec a, Vec b ) { return vreinterpretq_f64_u64( vcgtq_f64( a, b ) ); }
+    static inline Vec  select( Vec m, Vec a, Vec b ) { return vbslq_f64( vreinterpretq_u64_f64( m ), a, b ); }
+
+    static inline void store( BearingDist *p, Vec vBearing, Vec vDist )
+    {
+        float64x2x2_t pair = { { vBearing, vDist } };
+
+        vst2q_f64( &p[0].dBearing, pair );
+    }
+};
+#endif
+
+#if defined( HAVERSINE_AVX2 ) || defined( HAVERSINE_NEON )
+// Points iFrom up to the last whole vector; returns where it stopped
+template <class Ops>
+static int haversineVec( double dLat1, double dLong1, const double *pLat2, const double *pLong2, BearingDist *pOut, int iFrom, int iCount )
+{
+    typedef typename Ops::Vec Vec;
+
+    const double dRadiusEarth = 6371008.8;
+    const Vec    vZero = Ops::splat( 0.0 );
+    const Vec    vOne = Ops::splat( 1.0 );
+    const Vec    vHalf = Ops::splat( 0.5 );
+    const Vec    v180 = Ops::splat( 180.0 );
+    const Vec    vNeg180 = Ops::splat( -180.0 );
+    const Vec    v360 = Ops::splat( 360.0 );
+    const Vec    vTiny = Ops::splat( 1.0e-300 );
+    const Vec    vQuarterPi = Ops::splat( TwoPi / 8.0 );
+    const Vec    vHalfPi = Ops::splat( TwoPi / 4.0 );
+    const Vec    vPi = Ops::splat( TwoPi / 2.0 );
+    const Vec    vToRad = Ops::splat( ToRad );
+    const Vec    vToDeg = Ops::splat( ToDeg );
+    const Vec    vRadius = Ops::splat( dRadiusEarth );
+    const Vec    vMetersToNM = Ops::splat( MetersToNM );
+    const Vec    vLat1 = Ops::splat( dLat1 );
+    const Vec    vLong1 = Ops::splat( dLong1 );
+    int          i;
+
+    for( i = iFrom; (i + Ops::Width) <= iCount; i += Ops::Width )
+    {
+        Vec lat2 = Ops::load( pLat2 + i );
+        Vec deltaLat, avgLat, deltaLong, distN, distE, dist;
+        Vec z, c, aN, aE, a, big, x, p, q, r;
+
+        deltaLat = Ops::mul( Ops::sub( lat2, vLat1 ), vToRad );
+        avgLat = Ops::abs( Ops::mul( Ops::mul( Ops::add( lat2, vLat1 ), vHalf ), vToRad ) );
+        deltaLong = Ops::sub( Ops::load( pLong2 + i ), vLong1 );
+        deltaLong = Ops::sub( deltaLong, Ops::select( Ops::gt( deltaLong, v180 ), v360, vZero ) );
+        deltaLong = Ops::add( deltaLong, Ops::select( Ops::lt( deltaLong, vNeg180 ), v360, vZero ) );
+        deltaLong = Ops::mul( deltaLong, vToRad );
+
+        // cos() of a latitude, so 0 to pi/2: Taylor series through x^18
+        z = Ops::mul( avgLat, avgLat );
+        c = Ops::splat( 1.0 / 6402373705728000.0 );
+        c = Ops::add( Ops::mul( c, z ), Ops::splat( -1.0 / 20922789888000.0 ) );
+        c = Ops::add( Ops::mul( c, z ), Ops::splat( 1.0 / 87178291200.0 ) );
+        c = Ops::add( Ops::mul( c, z ), Ops::splat( -1.0 / 479001600.0 ) );
+        c = Ops::add( Ops::mul( c, z ), Ops::splat( 1.0 / 3628800.0 ) );
+        c = Ops::add( Ops::mul( c, z ), Ops::splat( -1.0 / 40320.0 ) );
+        c = Ops::add( Ops::mul( c, z ), Ops::splat( 1.0 / 720.0 ) );
+        c = Ops::add( Ops::mul( c, z ), Ops::splat( -1.0 / 24.0 ) );
+        c = Ops::add( Ops::mul( c, z ), Ops::splat( 0.5 ) );
+        c = Ops::sub( vOne, Ops::mul( c, z ) );
+
+        distN = Ops::mul( deltaLat, vRadius );
+        distE = Ops::mul( Ops::mul( deltaLong, vRadius ), Ops::abs( c ) );
+        dist = Ops::mul( Ops::sqrt( Ops::add( Ops::mul( distN, distN ), Ops::mul( distE, distE ) ) ), vMetersToNM );
+
+        // atan2( east, north ) from atan() of the smaller over the larger, which is 0 to 1.
+        // Above 0.66 it's reduced around pi/4 so the rational approximation (Cephes atan) only sees 0 to 0.66.
+        aN = Ops::abs( distN );
+        aE = Ops::abs( distE );
+        a = Ops::div( Ops::min( aN, aE ), Ops::max( Ops::max( aN, aE ), vTiny ) );
+        big = Ops::gt( a, Ops::splat( 0.66 ) );
+        x = Ops::select( big, Ops::div( Ops::sub( a, vOne ), Ops::add( a, vOne ) ), a );
+        z = Ops::mul( x, x );
+        p = Ops::splat( -8.750608600031904122785e-1 );
+        p = Ops::add( Ops::mul( p, z ), Ops::splat( -1.615753718733365076637e1 ) );
+        p = Ops::add( Ops::mul( p, z ), Ops::splat( -7.500855792314704667340e1 ) );
+        p = Ops::add( Ops::mul( p, z ), Ops::splat( -1.228866684490136173410e2 ) );
+        p = Ops::add( Ops::mul( p, z ), Ops::splat( -6.485021904942025371773e1 ) );
+        q = Ops::add( z, Ops::splat( 2.485846490142306297962e1 ) );
+        q = Ops::add( Ops::mul( q, z ), Ops::splat( 1.650270098316988542046e2 ) );
+        q = Ops::add( Ops::mul( q, z ), Ops::splat( 4.328810604912902668951e2 ) );
+        q = Ops::add( Ops::mul( q, z ), Ops::splat( 4.853903996359136964868e2 ) );
+        q = Ops::add( Ops::mul( q, z ), Ops::splat( 1.945506571482613964425e2 ) );
+        r = Ops::add( x, Ops::mul( Ops::mul( x, z ), Ops::div( p, q ) ) );
+        r = Ops::add( r, Ops::select( big, vQuarterPi, vZero ) );
+        r = Ops::select( Ops::gt( aE, aN ), Ops::sub( vHalfPi, r ), r );
+        r = Ops::select( Ops::lt( distN, vZero ), Ops::sub( vPi, r ), r );
+        r = Ops::select( Ops::lt( distE, vZero ), Ops::sub( vZero, r ), r );
+
+        Ops::store( pOut + i, Ops::mul( r, vToDeg ), dist );
+    }
+
+    return i;
+}
+#endif
+
+#if defined( HAVERSINE_AVX2 )
+#if defined( __clang__ )
+#pragma clang attribute pop
+#else
+#pragma GCC pop_options
+#endif
+#endif
+
+
+// Distance and bearing from one lat/long to each of iCount others; same results as haversine() to within rounding
+void TrafficMath::haversine( double dLat1, double dLong1, const double *pLat2, const double *pLong2, BearingDist *pOut, int iCount )
+{
+    int i = 0;
+
+#if defined( HAVERSINE_AVX2 )
+    static const bool s_bAVX2 = __builtin_cpu_supports( "avx2" );
+
+    if( s_bAVX2 )
+        i = haversineVec<HaversineAVX2>( dLat1, dLong1, pLat2, pLong2, pOut, 0, iCount );
+#elif defined( HAVERSINE_NEON )
+    i = haversineVec<HaversineNEON>( dLat1, dLong1, pLat2, pLong2, pOut, 0, iCount );
+#endif
+    for( ; i < iCount; i++ )
+        pOut[i] = haversine( dLat1, dLong1, pLat2[i], pLong2[i] );
+}
+
+
+// Which kernel the batch haversine runs on this machine
+const char *TrafficMath::haversineKernel()
+{
+#if defined( HAVERSINE_AVX2 )
+    return __builtin_cpu_supports( "avx2" ) ? "AVX2" : "scalar";
+#elif defined( HAVERSINE_NEON )
+    return "NEON";
+#else
+    return "scalar";
+#endif
+}
+
+
+// Lat/long boxes (x is longitude, y latitude) that hold everything haversine() puts within dRangeNM of the point.
+// A range that crosses the antimeridian comes back as two boxes, one each side, so pBoxes needs room for two; returns how many.
+int TrafficMath::rangeBoxes( double dLat, double dLong, double dRangeNM, QRectF *pBoxes )
+{
+    double dLatSpan = dRangeNM / (6371008.8 * MetersToNM * ToRad);
+    double dMaxAbsLat = fabs( dLat ) + dLatSpan;
+    double dLatFrom = qMax( dLat - dLatSpan, -90.0 );
+    double dLatTo = qMin( dLat + dLatSpan, 90.0 );
+    double dLongSpan = 360.0;
+    int    iBoxes = 0;
+
+    // East-west scales by the cosine of the average latitude, which is never smaller than at the box's far edge
+    if( dMaxAbsLat < 89.0 )
+        dLongSpan = dRangeNM / (6371008.8 * MetersToNM * ToRad * cos( dMaxAbsLat * ToRad ));
+
+    if( dLongSpan >= 180.0 )
+    {
+        pBoxes[0].setCoords( -180.0, dLatFrom, 180.0, dLatTo );
+        return 1;
+    }
+
+    pBoxes[iBoxes++].setCoords( qMax( dLong - dLongSpan, -180.0 ), dLatFrom, qMin( dLong + dLongSpan, 180.0 ), dLatTo );
+    if( (dLong - dLongSpan) < -180.0 )
+        pBoxes[iBoxes++].setCoords( dLong - dLongSpan + 360.0, dLatFrom, 180.0, dLatTo );
+    if( (dLong + dLongSpan) > 180.0 )
+        pBoxes[iBoxes++].setCoords( -180.0, dLatFrom, dLong + dLongSpan - 360.0, dLatTo );
+
+    return iBoxes;
+}
+
+
+// Douglas-Peucker tolerances of the airspace shape levels in NM; level 0 is every vertex
+static const double s_dShapeLevelNM[] = { 0.0, 0.025, 0.05, 0.1, 0.2, 0.4 };
+static const int    s_iShapeLevels = sizeof( s_dShapeLevelNM ) / sizeof( double );
+
+
+// Distance from a point to the segment between two others, or to the one point if the segment has no length
+static double segmentDistance( const QPointF &pt, const QPointF &from, const QPointF &to )
+{
+    QPointF seg = to - from;
+    QPointF rel = pt - from;
+    double  dLenSq = (seg.x() * seg.x()) + (seg.y() * seg.y());
+    double  dT = 0.0;
+
+    if( dLenSq > 0.0 )
+        dT = qBound( 0.0, ((rel.x() * seg.x()) + (rel.y() * seg.y())) / dLenSq, 1.0 );
+    rel -= seg * dT;
+
+    return sqrt( (rel.x() * rel.x()) + (rel.y() * rel.y()) );
+}
+
+
+// Douglas-Peucker at each tolerance in turn, each pass over what survived the one before, so every level is a subset of
+// the one below it and a single number per vertex describes the whole pyramid: the coarsest level the vertex is still in.
+// The ends are always kept, which for a closed ring is the same point twice.
+void TrafficMath::simplifyShape( const QPolygonF &shape, QVector<quint8> *pLevels )
+{
+    QVector<QPointF>          flat( shape.count() );
+    QVector<int>              kept, next;
+    QVector<bool>             keep;
+    QVector<QPair<int, int> > spans;
+    QPair<int, int>           span;
+    double                    dScale, dFar, dDist;
+    int                       iLevel, iFar, i;
+
+    pLevels->fill( 0, shape.count() );
+    if( shape.count() < 3 )
+    {
+        pLevels->fill( s_iShapeLevels - 1 );
+        return;
+    }
+
+    // Flattened to NM about the middle of the shape, which is near enough at the size of an airspace
+    dScale = cos( shape.boundingRect().center().y() * ToRad );
+    for( i = 0; i < shape.count(); i++ )
+    {
+        flat[i] = QPointF( shape.at( i ).x() * dScale * 60.0, shape.at( i ).y() * 60.0 );
+        kept.append( i );
+    }
+
+    for( iLevel = 1; iLevel < s_iShapeLevels; iLevel++ )
+    {
+        keep.fill( false, kept.count() );
+        keep.first() = true;
+        keep.last() = true;
+        spans.append( qMakePair( 0, kept.count() - 1 ) );
+        while( !spans.isEmpty() )
+        {
+            span = spans.takeLast();
+            dFar = 0.0;
+            iFar = -1;
+            for( i = span.first + 1; i < span.second; i++ )
+            {
+                dDist = segmentDistance( flat.at( kept.at( i ) ), flat.at( kept.at( span.first ) ), flat.at( kept.at( span.second ) ) );
+                if( dDist > dFar )
+                {
+                    dFar = dDist;
+                    iFar = i;
+                }
+            }
+            if( (iFar >= 0) && (dFar > s_dShapeLevelNM[iLevel]) )
+            {
+                keep[iFar] = true;
+                spans.append( qMakePair( span.first, iFar ) );
+                spans.append( qMakePair( iFar, span.second ) );
+            }
+        }
+
+        next.clear();
+        for( i = 0; i < kept.count(); i++ )
+        {
+            if( keep.at( i ) )
+            {
+                next.append( kept.at( i ) );
+                (*pLevels)[kept.at( i )] = static_cast<quint8>( iLevel );
+            }
+        }
+        kept = next;
+    }
+}
+
+
+// The coarsest shape level that's still within a pixel at this scale
+int TrafficMath::shapeLevel( double dNMPerPx )
+{
+    int iLevel = 0;
+
+    while( ((iLevel + 1) < s_iShapeLevels) && (s_dShapeLevelNM[iLevel + 1] <= dNMPerPx) )
+        iLevel++;
+
+    return iLevel;
+}
+
+
+// Normalize angle and convert to radians
+double TrafficMath::radiansRel( double dAng )
+{
+    while( dAng > 180 )
+        dAng -= 360;
+    while( dAng < -180 )
+        dAng += 360;
+
+    return dAng * ToRad;
+}
+
+
+// Normalize heading angle and convert to degrees
+double TrafficMath::degHeading( double dAng )
+{
+    while( dAng < 0 )
+        dAng += TwoPi;
+
+    return dAng * ToDeg;
+}
@@ -0,0 +1,93 @@
+/*
+Stratofier Stratux AHRS Display
+(c) 2018 Allen K. Lair, Sky Fun
+*/
+
+#include <QPainter>
+
+#include "NumberAtlas.h"
+
+
+static const int s_iColon = 10;    // Column of the colon in the plain row
+
+
+NumberAtlas::NumberAtlas()
+    : m_iW( 0 ),
+      m_iH( 0 ),
+      m_iSmallW( 0 ),
+      m_iSmallH( 0 ),
+      m_iMantissaY( 0 )
+{
+}
+
+
+// Glyphs are scaled by drawing them into their cells the same way buildNumber() used to draw them into the number,
+// so they come out exactly as they did
+void NumberAtlas::build( const CanvasConstants *c )
+{
+    int iDigit;
+
+    m_iW = static_cast<int>( c->dWNum );
+    m_iH = static_cast<int>( c->dHNum );
+    m_iSmallW = static_cast<int>( c->dWNum / 1.5 );
+    m_iSmallH = static_cast<int>( c->dHNum / 1.5 );
+    m_iMantissaY = static_cast<int>( (c->dHNum * 0.25) - 1.0 );
+    m_atlas = QPixmap( qMax( m_iW * (s_iColon + 1), 1 ), qMax( (m_iH * 2) + m_iSmallH, 1 ) );
+    m_atlas.fill( Qt::transparent );
+
+    QPainter atlas( &m_atlas );
+
+    for( iDigit = 0; iDigit < 10; iDigit++ )
+    {
+        QPixmap plain( QString( ":/num/resources/%1.png" ).arg( iDigit ) );
+        QPixmap bold( QString( ":/num/resources/%1b.png" ).arg( iDigit ) );
+
+        atlas.drawPixmap( iDigit * m_iW, 0, m_iW, m_iH, plain );
+        atlas.drawPixmap( iDigit * m_iW, m_iH, m_iW, m_iH, bold );
+        atlas.drawPixmap( iDigit * m_iSmallW, m_iH * 2, m_iSmallW, m_iSmallH, bold );
+    }
+    atlas.drawPixmap( s_iColon * m_iW, 0, m_iW, m_iH, QPixmap( ":/num/resources/colon.png" ) );
+}
+
+
+bool NumberAtlas::fits( const CanvasConstants *c ) const
+{
+    return (!m_atlas.isNull()) && (m_iW == static_cast<int>( c->dWNum )) && (m_iH == static_cast<int>( c->dHNum ));
+}
+
+
+int NumberAtlas::width( Style eStyle ) const
+{
+    return (eStyle == BoldSmall) ? m_iSmallW : m_iW;
+}
+
+
+// Anything without an image (a minus sign, say) leaves its cell empty the way the missing resource used to
+void NumberAtlas::draw( QPainter *pPainter, int iX, int iY, QChar cGlyph, Style eStyle ) const
+{
+    QRect source = glyph( cGlyph, eStyle );
+
+    if( !source.isEmpty() )
+        pPainter->drawPixmap( QPoint( iX, iY ), m_atlas, source );
+}
+
+
+QRect NumberAtlas::glyph( QChar cGlyph, Style eStyle ) const
+{
+    int iDigit = cGlyph.digitValue();
+
+    if( (cGlyph == ':') && (eStyle == Plain) )
+        return QRect( s_iColon * m_iW, 0, m_iW, m_iH );
+    if( (iDigit < 0) || (iDigit > 9) )
+        return QRect();
+
+    switch( eStyle )
+    {
+        case Bold:
+            return QRect( iDigit * m_iW, m_iH, m_iW, m_iH );
+        case BoldSmall:
+            return QRect( iDigit * m_iSmallW, m_iH * 2, m_iSmallW, m_iSmallH );
+        default:
+            return QRect( iDigit * m_iW, 0, m_iW, m_iH );
+    }
+}
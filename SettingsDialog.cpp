@@ -11,6 +11,7 @@ Stratofier Stratux AHRS Display
 #include <QDir>
 #include <QString>
 #include <QTimer>
+#include <QtConcurrent>
 
 #include "SettingsDialog.h"
 #include "Builder.h"
@@ -18,6 +19,7 @@ Stratofier Stratux AHRS Display
 #include "CountryDialog.h"
 #include "ClickLabel.h"
 #include "Canvas.h"
+#include "AviationDB.h"
 
 
 extern QSettings *g_pSet;
@@ -300,6 +302,9 @@ void SettingsDialog::httpDownloadFinishedAirports()
     m_pFile->flush();
     m_pFile->close();
 
+    // Compile it in the background so the next startup maps it instead of parsing the XML
+    QtConcurrent::run( AviationDB::convert, m_pFile->fileName() );
+
     m_pReply->deleteLater();
     m_pReply = nullptr;
     delete m_pFile;
@@ -361,6 +366,9 @@ void SettingsDialog::httpDownloadFinishedAirspace()
     m_pFile->flush();
     m_pFile->close();
 
+    // Compile it in the background so the next startup maps it instead of parsing the XML
+    QtConcurrent::run( AviationDB::convert, m_pFile->fileName() );
+
     m_pReply->deleteLater();
     m_pReply = nullptr;
     delete m_pFile;
@@ -490,6 +498,7 @@ void SettingsDialog::selCountries()
         {
             qsFile = settingsRoot() + "/space.skyfun.stratofier/" + m_mapUrlsAirports[countryAirport] + ".aip";
             QFile::remove( qsFile );
+            QFile::remove( AviationDB::dbFile( qsFile ) );
         }
         g_pSet->setValue( "CountryAirports", countries );
         countries.clear();
@@ -499,6 +508,7 @@ void SettingsDialog::selCountries()
         {
             qsFile = settingsRoot() + "/space.skyfun.stratofier/" + m_mapUrlsAirspaces[countryAirspace] + ".aip";
             QFile::remove( qsFile );
+            QFile::remove( AviationDB::dbFile( qsFile ) );
         }
         g_pSet->setValue( "CountryAirspaces", countries );
         g_pSet->sync();
@@ -62,9 +62,17 @@ SOURCES += main.cpp \
            BugSelector.cpp \
            Keypad.cpp \
            TrafficMath.cpp \
+           Haversine.cpp \
+           TrafficTable.cpp \
+           TrafficGeometry.cpp \
+           AirportCache.cpp \
+           AirportIndex.cpp \
+           AirspaceIndex.cpp \
            Canvas.cpp \
            MenuDialog.cpp \
            Builder.cpp \
+           NumberAtlas.cpp \
+           Compositor.cpp \
            TimerDialog.cpp \
            FuelTanksDialog.cpp \
            ClickLabel.cpp \
@@ -73,7 +81,11 @@ SOURCES += main.cpp \
            CountryDialog.cpp \
            DetailsDialog.cpp \
            Overlays.cpp \
-           Keyboard.cpp
+           Keyboard.cpp \
+           StratuxParser.cpp \
+           GDL90.cpp \
+           StreamCapture.cpp \
+           AviationDB.cpp
 
 HEADERS += StratuxStreams.h \
            StreamReader.h \
@@ -83,9 +95,16 @@ HEADERS += StratuxStreams.h \
            BugSelector.h \
            Keypad.h \
            TrafficMath.h \
+           TrafficTable.h \
+           TrafficGeometry.h \
+           AirportCache.h \
+           AirportIndex.h \
+           AirspaceIndex.h \
            Canvas.h \
            MenuDialog.h \
            Builder.h \
+           NumberAtlas.h \
+           Compositor.h \
            StratofierDefs.h \
            TimerDialog.h \
            ScreenLocker.h \
@@ -96,7 +115,15 @@ HEADERS += StratuxStreams.h \
            CountryDialog.h \
            DetailsDialog.h \
            Overlays.h \
-           Keyboard.h
+           Keyboard.h \
+           StratuxParser.h \
+           StratuxFields.h \
+           GDL90.h \
+           StreamQueue.h \
+           StreamCapture.h \
+           AviationDB.h \
+           StringTable.h \
+           Snapshot.h
 
 FORMS += AHRSMainWin.ui \
          BugSelector.ui \
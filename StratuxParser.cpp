@@ -0,0 +1,520 @@
+/*
+Stratofier Stratux AHRS Display
+(c) 2018 Allen K. Lair, Sky Fun
+*/
+
+#include <QString>
+
+#include <math.h>
+#include <string.h>
+
+#include "StratuxParser.h"
+#include "StratuxFields.h"
+#include "StratofierDefs.h"
+
+
+// Exact powers of ten representable as doubles
+static const double s_dPow10[] = { 1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                                   1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+
+
+static inline bool isTag( const StratuxParser::Field &f, const char *szTag )
+{
+    int iLen = static_cast<int>( strlen( szTag ) );
+
+    return (f.iTagLen == iLen) && (memcmp( f.pTag, szTag, static_cast<size_t>( iLen ) ) == 0);
+}
+
+
+static inline bool isDigit( char c )
+{
+    return (c >= '0') && (c <= '9');
+}
+
+
+// Step to the next top level tag/value pair of the object starting at pCursor.
+// Quoted values may contain commas and colons; nested objects and arrays are returned whole (including the brackets) so they can be skipped.
+bool StratuxParser::nextField( const char *&pCursor, const char *pEnd, Field *pField )
+{
+    const char *p = pCursor;
+
+    // Skip the opening brace, separators and whitespace up to the next tag
+    while( (p < pEnd) && (*p != '"') )
+    {
+        // End of the top level object
+        if( *p == '}' )
+        {
+            pCursor = pEnd;
+            return false;
+        }
+        p++;
+    }
+    if( p >= pEnd )
+    {
+        pCursor = pEnd;
+        return false;
+    }
+
+    // Tag
+    pField->pTag = ++p;
+    while( (p < pEnd) && (*p != '"') )
+    {
+        if( *p == '\\' )
+            p++;
+        p++;
+    }
+    if( p >= pEnd )
+    {
+        pCursor = pEnd;
+        return false;
+    }
+    pField->iTagLen = static_cast<int>( p - pField->pTag );
+    p++;
+
+    // Separator and any whitespace ahead of the value
+    while( (p < pEnd) && (*p != ':') )
+        p++;
+    p++;
+    while( (p < pEnd) && ((*p == ' ') || (*p == '\t') || (*p == '\r') || (*p == '\n')) )
+        p++;
+    if( p >= pEnd )
+    {
+        pCursor = pEnd;
+        return false;
+    }
+
+    // Quoted string value
+    if( *p == '"' )
+    {
+        pField->pVal = ++p;
+        while( (p < pEnd) && (*p != '"') )
+        {
+            if( *p == '\\' )
+                p++;
+            p++;
+        }
+        pField->iValLen = static_cast<int>( (p < pEnd ? p : pEnd) - pField->pVal );
+        pField->bString = true;
+        p++;
+    }
+    // Nested object or array; keep track of depth and step over any strings inside it
+    else if( (*p == '{') || (*p == '[') )
+    {
+        int iDepth = 0;
+
+        pField->pVal = p;
+        while( p < pEnd )
+        {
+            if( *p == '"' )
+            {
+                p++;
+                while( (p < pEnd) && (*p != '"') )
+                {
+                    if( *p == '\\' )
+                        p++;
+                    p++;
+                }
+            }
+            else if( (*p == '{') || (*p == '[') )
+                iDepth++;
+            else if( (*p == '}') || (*p == ']') )
+            {
+                iDepth--;
+                if( iDepth == 0 )
+                {
+                    p++;
+                    break;
+                }
+            }
+            p++;
+        }
+        pField->iValLen = static_cast<int>( (p < pEnd ? p : pEnd) - pField->pVal );
+        pField->bString = false;
+    }
+    // Number, true, false or null
+    else
+    {
+        pField->pVal = p;
+        while( (p < pEnd) && (*p != ',') && (*p != '}') && (*p != ']') && (*p != ' ') && (*p != '\r') && (*p != '\n') )
+            p++;
+        pField->iValLen = static_cast<int>( p - pField->pVal );
+        pField->bString = false;
+    }
+
+    pCursor = (p < pEnd) ? p : pEnd;
+
+    return true;
+}
+
+
+// Locale independent decimal conversion; QString::toDouble and strtod are both far heavier than the handful of digits Stratux sends
+double StratuxParser::toDouble( const char *pVal, int iLen )
+{
+    const char *p = pVal;
+    const char *pEnd = pVal + iLen;
+    bool        bNeg = false;
+    quint64     iMant = 0;
+    int         iDigits = 0;
+    int         iExp = 0;
+    double      dVal;
+
+    if( (p < pEnd) && ((*p == '-') || (*p == '+')) )
+    {
+        bNeg = (*p == '-');
+        p++;
+    }
+
+    // Integer part; anything past 18 significant digits only affects the magnitude
+    while( (p < pEnd) && isDigit( *p ) )
+    {
+        if( iDigits < 18 )
+        {
+            iMant = (iMant * 10) + static_cast<quint64>( *p - '0' );
+            if( iMant > 0 )
+                iDigits++;
+        }
+        else
+            iExp++;
+        p++;
+    }
+
+    // Fraction
+    if( (p < pEnd) && (*p == '.') )
+    {
+        p++;
+        while( (p < pEnd) && isDigit( *p ) )
+        {
+            if( iDigits < 18 )
+            {
+                iMant = (iMant * 10) + static_cast<quint64>( *p - '0' );
+                iExp--;
+                if( iMant > 0 )
+                    iDigits++;
+            }
+            p++;
+        }
+    }
+
+    // Exponent
+    if( (p < pEnd) && ((*p == 'e') || (*p == 'E')) )
+    {
+        bool bExpNeg = false;
+        int  iE = 0;
+
+        p++;
+        if( (p < pEnd) && ((*p == '-') || (*p == '+')) )
+        {
+            bExpNeg = (*p == '-');
+            p++;
+        }
+        while( (p < pEnd) && isDigit( *p ) )
+        {
+            if( iE < 10000 )
+                iE = (iE * 10) + (*p - '0');
+            p++;
+        }
+        iExp += (bExpNeg ? -iE : iE);
+    }
+
+    dVal = static_cast<double>( iMant );
+    if( iMant != 0 )
+    {
+        if( (iExp < 0) && (iExp >= -22) )
+            dVal /= s_dPow10[-iExp];
+        else if( (iExp > 0) && (iExp <= 22) )
+            dVal *= s_dPow10[iExp];
+        else if( iExp != 0 )
+            dVal *= pow( 10.0, iExp );
+    }
+
+    return bNeg ? -dVal : dVal;
+}
+
+
+// Integer prefix of the value; like QString::toInt anything that isn't a plain integer comes back as zero
+int StratuxParser::toInt( const char *pVal, int iLen )
+{
+    const char *p = pVal;
+    const char *pEnd = pVal + iLen;
+    bool        bNeg = false;
+    qint64      iVal = 0;
+
+    if( (p < pEnd) && ((*p == '-') || (*p == '+')) )
+    {
+        bNeg = (*p == '-');
+        p++;
+    }
+    while( (p < pEnd) && isDigit( *p ) )
+    {
+        iVal = (iVal * 10) + (*p - '0');
+        if( iVal > 0x7FFFFFFF )
+            return 0;
+        p++;
+    }
+    if( p != pEnd )
+        return 0;
+
+    return static_cast<int>( bNeg ? -iVal : iVal );
+}
+
+
+bool StratuxParser::toBool( const char *pVal, int iLen )
+{
+    return (iLen == 4) && (memcmp( pVal, "true", 4 ) == 0);
+}
+
+
+static inline int digits( const char *p, int iCount )
+{
+    int iVal = 0;
+
+    for( int i = 0; i < iCount; i++ )
+        iVal = (iVal * 10) + (p[i] - '0');
+
+    return iVal;
+}
+
+
+static inline bool allDigits( const char *p, int iCount )
+{
+    for( int i = 0; i < iCount; i++ )
+    {
+        if( !isDigit( p[i] ) )
+            return false;
+    }
+
+    return true;
+}
+
+
+// Days from 1970-01-01 to the given proleptic Gregorian date; valid for any year including the year 1 Stratux uses for "never"
+static inline qint64 daysFromCivil( int iYear, int iMonth, int iDay )
+{
+    int iYoE, iDoY, iDoE, iEra;
+
+    iYear -= (iMonth <= 2) ? 1 : 0;
+    iEra = ((iYear >= 0) ? iYear : iYear - 399) / 400;
+    iYoE = iYear - (iEra * 400);
+    iDoY = ((153 * (iMonth + ((iMonth > 2) ? -3 : 9))) + 2) / 5 + iDay - 1;
+    iDoE = (iYoE * 365) + (iYoE / 4) - (iYoE / 100) + iDoY;
+
+    return (static_cast<qint64>( iEra ) * 146097) + iDoE - 719468;
+}
+
+
+// Fixed format RFC 3339 as Go writes it: YYYY-MM-DDTHH:MM:SS, an optional fraction of any length and Z or +HH:MM/-HH:MM.
+// Anything that doesn't fit the layout is rejected rather than guessed at; the caller keeps whatever it had.
+bool StratuxParser::toEpochMs( const char *pVal, int iLen, qint64 *pEpochMs )
+{
+    const char *p = pVal;
+    const char *pEnd = pVal + iLen;
+    int         iMonth, iDay, iHour, iMin, iSec;
+    int         iMs = 0;
+    int         iScale = 100;
+    int         iOffsetMin = 0;
+
+    if( (iLen < 19) || !allDigits( p, 4 ) || (p[4] != '-') || !allDigits( p + 5, 2 ) || (p[7] != '-') || !allDigits( p + 8, 2 ) ||
+        ((p[10] != 'T') && (p[10] != ' ')) || !allDigits( p + 11, 2 ) || (p[13] != ':') || !allDigits( p + 14, 2 ) || (p[16] != ':') || !allDigits( p + 17, 2 ) )
+        return false;
+
+    iMonth = digits( p + 5, 2 );
+    iDay = digits( p + 8, 2 );
+    iHour = digits( p + 11, 2 );
+    iMin = digits( p + 14, 2 );
+    iSec = digits( p + 17, 2 );
+    if( (iMonth < 1) || (iMonth > 12) || (iDay < 1) || (iDay > 31) || (iHour > 23) || (iMin > 59) || (iSec > 60) )
+        return false;
+    p += 19;
+
+    // Fraction; only milliseconds are kept
+    if( (p < pEnd) && (*p == '.') )
+    {
+        p++;
+        while( (p < pEnd) && isDigit( *p ) )
+        {
+            iMs += (*p - '0') * iScale;
+            iScale /= 10;
+            p++;
+        }
+    }
+
+    // Zone
+    if( (p < pEnd) && ((*p == '+') || (*p == '-')) )
+    {
+        if( ((pEnd - p) < 6) || !allDigits( p + 1, 2 ) || (p[3] != ':') || !allDigits( p + 4, 2 ) )
+            return false;
+        iOffsetMin = (digits( p + 1, 2 ) * 60) + digits( p + 4, 2 );
+        if( *p == '-' )
+            iOffsetMin = -iOffsetMin;
+        p += 6;
+    }
+    else if( (p < pEnd) && (*p == 'Z') )
+        p++;
+    if( p != pEnd )
+        return false;
+
+    *pEpochMs = (((daysFromCivil( digits( pVal, 4 ), iMonth, iDay ) * 86400) + (iHour * 3600) + ((iMin - iOffsetMin) * 60) + iSec) * 1000) + iMs;
+
+    return true;
+}
+
+
+// Unit conversions named in the field tables (the table name prefixed with Conv)
+enum FieldConv
+{
+    ConvNone,
+    ConvAbs,
+    ConvUnits,
+    ConvNM
+};
+
+
+static inline double convert( double dVal, FieldConv eConv, double dUnitsMult )
+{
+    switch( eConv )
+    {
+        case ConvAbs:
+            return fabs( dVal );
+        case ConvUnits:
+            return dVal * dUnitsMult;
+        case ConvNM:
+            return dVal * MetersToNM;
+        case ConvNone:
+            break;
+    }
+
+    return dVal;
+}
+
+
+// Value stores, picked by the type of the struct member
+static inline void store( double *pMember, const StratuxParser::Field &f, FieldConv eConv, double dUnitsMult )
+{
+    *pMember = f.bString ? 0.0 : convert( StratuxParser::toDouble( f.pVal, f.iValLen ), eConv, dUnitsMult );
+}
+
+
+static inline void store( int *pMember, const StratuxParser::Field &f, FieldConv, double )
+{
+    *pMember = StratuxParser::toInt( f.pVal, f.iValLen );
+}
+
+
+static inline void store( bool *pMember, const StratuxParser::Field &f, FieldConv, double )
+{
+    *pMember = StratuxParser::toBool( f.pVal, f.iValLen );
+}
+
+
+static inline void store( QString *pMember, const StratuxParser::Field &f, FieldConv, double )
+{
+    *pMember = QString::fromUtf8( f.pVal, f.iValLen );
+}
+
+
+// Timestamps stay as epoch milliseconds; StratuxTime::toDateTime() builds the QDateTime if anything wants one
+static inline void store( StratuxTime *pMember, const StratuxParser::Field &f, FieldConv, double )
+{
+    StratuxParser::toEpochMs( f.pVal, f.iValLen, &pMember->iEpochMs );
+}
+
+
+// One case per table entry; the hash picks the entry and the compare confirms it
+#define SITUATION_CASE( tag, member, conv ) \
+    case fieldHash( #tag ): \
+        if( !isTag( f, #tag ) ) \
+            return false; \
+        store( &pSituation->member, f, Conv##conv, dUnitsMult ); \
+        return true;
+
+#define TRAFFIC_CASE( tag, member, conv ) \
+    case fieldHash( #tag ): \
+        if( !isTag( f, #tag ) ) \
+            return false; \
+        store( &pTraffic->member, f, Conv##conv, dUnitsMult ); \
+        return true;
+
+#define STATUS_CASE( tag, member, conv ) \
+    case fieldHash( #tag ): \
+        if( !isTag( f, #tag ) ) \
+            return false; \
+        store( &pStatus->member, f, Conv##conv, 1.0 ); \
+        return true;
+
+
+bool StratuxParser::situationField( const Field &f, StratuxSituation *pSituation, double dUnitsMult )
+{
+    switch( fieldHash( f.pTag, f.iTagLen ) )
+    {
+        STRATUX_SITUATION_FIELDS( SITUATION_CASE )
+    }
+
+    return false;
+}
+
+
+bool StratuxParser::trafficField( const Field &f, StratuxTraffic *pTraffic, double dUnitsMult, int *pICAO )
+{
+    switch( fieldHash( f.pTag, f.iTagLen ) )
+    {
+        case fieldHash( "Icao_addr" ):
+            if( !isTag( f, "Icao_addr" ) )
+                return false;
+            *pICAO = toInt( f.pVal, f.iValLen );
+            return true;
+
+        STRATUX_TRAFFIC_FIELDS( TRAFFIC_CASE )
+    }
+
+    return false;
+}
+
+
+bool StratuxParser::statusField( const Field &f, StratuxStatus *pStatus )
+{
+    switch( fieldHash( f.pTag, f.iTagLen ) )
+    {
+        STRATUX_STATUS_FIELDS( STATUS_CASE )
+    }
+
+    return false;
+}
+
+
+// Fill the situation struct from one /situation message
+void StratuxParser::parseSituation( const QByteArray &message, StratuxSituation *pSituation, double dUnitsMult )
+{
+    const char *pCursor = message.constData();
+    const char *pEnd = pCursor + message.size();
+    Field       f;
+
+    while( nextField( pCursor, pEnd, &f ) )
+        situationField( f, pSituation, dUnitsMult );
+}
+
+
+// Fill the traffic struct from one /traffic message and return the ICAO address (zero if it wasn't present)
+int StratuxParser::parseTraffic( const QByteArray &message, StratuxTraffic *pTraffic, double dUnitsMult )
+{
+    const char *pCursor = message.constData();
+    const char *pEnd = pCursor + message.size();
+    Field       f;
+    int         iICAO = 0;
+
+    while( nextField( pCursor, pEnd, &f ) )
+        trafficField( f, pTraffic, dUnitsMult, &iICAO );
+
+    return iICAO;
+}
+
+
+// Fill the status struct from one /status message
+void StratuxParser::parseStatus( const QByteArray &message, StratuxStatus *pStatus )
+{
+    const char *pCursor = message.constData();
+    const char *pEnd = pCursor + message.size();
+    Field       f;
+
+    while( nextField( pCursor, pEnd, &f ) )
+        statusField( f, pStatus );
+}
@@ -0,0 +1,160 @@
+/*
+Stratofier Stratux AHRS Display
+(c) 2018 Allen K. Lair, Sky Fun
+*/
+
+#include <QtDebug>
+#include <QDateTime>
+
+#include <string.h>
+
+#include "StreamCapture.h"
+
+
+static const char    s_szMagic[8] = { 'S', 'T', 'R', 'F', 'C', 'A', 'P', 0 };
+static const quint32 s_uiVersion = 1;
+static const quint32 s_uiByteOrder = 0x01020304;
+
+
+static inline qint64 padded( qint64 iLen )
+{
+    return (iLen + 7) & ~static_cast<qint64>( 7 );
+}
+
+
+CaptureWriter::CaptureWriter()
+    : m_iEpochNs( 0 )
+{
+}
+
+
+CaptureWriter::~CaptureWriter()
+{
+    m_file.close();
+}
+
+
+// Start or continue a recording; new records always go on the end
+bool CaptureWriter::open( const QString &qsFile )
+{
+    m_file.setFileName( qsFile );
+    if( !m_file.open( QIODevice::WriteOnly | QIODevice::Append ) )
+    {
+        qWarning() << "Unable to open capture file" << qsFile;
+        return false;
+    }
+
+    if( m_file.size() == 0 )
+    {
+        CaptureHeader header;
+
+        memcpy( header.szMagic, s_szMagic, sizeof( header.szMagic ) );
+        header.uiVersion = s_uiVersion;
+        header.uiByteOrder = s_uiByteOrder;
+        m_file.write( reinterpret_cast<const char *>( &header ), sizeof( header ) );
+    }
+
+    // Wall clock once for the base and the monotonic clock from then on so the timestamps never step backwards
+    m_iEpochNs = QDateTime::currentMSecsSinceEpoch() * 1000000;
+    m_clock.start();
+
+    return true;
+}
+
+
+void CaptureWriter::write( StreamCapture::Channel eChannel, const QByteArray &data )
+{
+    static const char s_zeros[8] = { 0, 0, 0, 0, 0, 0, 0, 0 };
+    CaptureRecord     rec;
+
+    if( !m_file.isOpen() )
+        return;
+
+    rec.iTimeNs = m_iEpochNs + m_clock.nsecsElapsed();
+    rec.uiLen = static_cast<quint32>( data.size() );
+    rec.uiChannel = static_cast<quint8>( eChannel );
+    memset( rec.uiPad, 0, sizeof( rec.uiPad ) );
+
+    m_file.write( reinterpret_cast<const char *>( &rec ), sizeof( rec ) );
+    m_file.write( data );
+    m_file.write( s_zeros, padded( data.size() ) - data.size() );
+}
+
+
+void CaptureWriter::flush()
+{
+    if( m_file.isOpen() )
+        m_file.flush();
+}
+
+
+CaptureReader::CaptureReader()
+    : m_pMap( nullptr ),
+      m_iSize( 0 )
+{
+}
+
+
+CaptureReader::~CaptureReader()
+{
+    if( m_pMap != nullptr )
+        m_file.unmap( const_cast<uchar *>( m_pMap ) );
+    m_file.close();
+}
+
+
+// Map the capture and index every whole record
+bool CaptureReader::open( const QString &qsFile )
+{
+    const CaptureHeader *pHeader;
+    const CaptureRecord *pRec;
+    qint64               iPos;
+
+    m_file.setFileName( qsFile );
+    if( !m_file.open( QIODevice::ReadOnly ) )
+    {
+        qWarning() << "Unable to open capture file" << qsFile;
+        return false;
+    }
+    m_iSize = m_file.size();
+    if( m_iSize < static_cast<qint64>( sizeof( CaptureHeader ) ) )
+    {
+        qWarning() << "Capture file too short" << qsFile;
+        return false;
+    }
+    m_pMap = m_file.map( 0, m_iSize );
+    if( m_pMap == nullptr )
+    {
+        qWarning() << "Unable to map capture file" << qsFile;
+        return false;
+    }
+
+    pHeader = reinterpret_cast<const CaptureHeader *>( m_pMap );
+    if( (memcmp( pHeader->szMagic, s_szMagic, sizeof( s_szMagic ) ) != 0) || (pHeader->uiVersion != s_uiVersion) || (pHeader->uiByteOrder != s_uiByteOrder) )
+    {
+        qWarning() << "Not a capture file (or written on a machine of the other byte order)" << qsFile;
+        return false;
+    }
+
+    m_offsets.clear();
+    m_offsets.reserve( static_cast<int>( m_iSize / 256 ) );
+    iPos = sizeof( CaptureHeader );
+    while( (iPos + static_cast<qint64>( sizeof( CaptureRecord ) )) <= m_iSize )
+    {
+        pRec = reinterpret_cast<const CaptureRecord *>( m_pMap + iPos );
+        if( (iPos + static_cast<qint64>( sizeof( CaptureRecord ) ) + pRec->uiLen) > m_iSize )
+            break;
+        m_offsets.append( iPos );
+        iPos += sizeof( CaptureRecord ) + padded( pRec->uiLen );
+    }
+
+    return true;
+}
+
+
+QByteArray CaptureReader::payload( int i ) const
+{
+    const CaptureRecord *pRec = record( i );
+
+    return QByteArray::fromRawData( reinterpret_cast<const char *>( pRec + 1 ), static_cast<int>( pRec->uiLen ) );
+}
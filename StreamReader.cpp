@@ -13,10 +13,15 @@ Stratofier Stratux AHRS Display
 #include <QTimer>
 #include <QSettings>
 #include <QNetworkDatagram>
+#include <QFile>
+#include <QThread>
 
 #include <math.h>
 
 #include "StreamReader.h"
+#include "StratuxParser.h"
+#include "GDL90.h"
+#include "StreamCapture.h"
 #include "TrafficMath.h"
 #include "StratofierDefs.h"
 
@@ -24,15 +29,23 @@ Stratofier Stratux AHRS Display
 extern QSettings *g_pSet;
 
 
+static const int s_iReplayBatch = 256;      // Most records replayed in one go; well inside the traffic ring
+
+
 StreamReader::StreamReader( const QString &qsIP )
     : QObject( nullptr ),
       m_bHaveMyPos( false ),
       m_bAHRSStatus( false ),
       m_bStratuxStatus( false ),
       m_bGPSStatus( false ),
+      m_stratuxSituation( QString(), QWebSocketProtocol::VersionLatest, this ),   // Parented so they follow the reader onto the stream thread
+      m_stratuxTraffic( QString(), QWebSocketProtocol::VersionLatest, this ),
+      m_stratuxStatus( QString(), QWebSocketProtocol::VersionLatest, this ),
+      m_stratuxWeather( QString(), QWebSocketProtocol::VersionLatest, this ),
       m_bConnected( false ),
       m_qsIP( qsIP ),
       m_eUnits( Canvas::Knots ),
+      m_wtSocket( this ),
       m_bHaveWTtelem( false ),
       m_dBaroPress( 29.92 ),
       m_wtHost(),
@@ -43,11 +56,34 @@ StreamReader::StreamReader( const QString &qsIP )
       m_dRawRoll( 0.0 ),
       m_dRawPitch( 0.0 ),
       m_bReported( false ),
-      m_dAirspeedCal( 1.0 )
+      m_dAirspeedCal( 1.0 ),
+      m_bLegacyParser( false ),
+      m_eInput( JSONInput ),
+      m_gdl90Socket( this ),
+      m_iGDL90Traffic( 0 ),
+      m_iCapturePos( 0 ),
+      m_captureTimer( this ),
+      m_iWakePending( 0 ),
+      m_pRecorder( nullptr ),
+      m_pReplay( nullptr ),
+      m_dReplaySpeed( 1.0 ),
+      m_iReplayPos( 0 ),
+      m_iReplayDueNs( 0 ),
+      m_replayTimer( this )
 {
     m_dPitchRef = g_pSet->value( "PitchRef", 0.0 ).toDouble();
     m_dRollRef = g_pSet->value( "RollRef", 0.0 ).toDouble();
     m_dAirspeedCal = g_pSet->value( "AirspeedCal", 1.0 ).toDouble();
+    m_bLegacyParser = g_pSet->value( "LegacyParser", false ).toBool();
+    if( g_pSet->value( "InputMode", "JSON" ).toString() == "GDL90" )
+        m_eInput = GDL90Input;
+
+    m_captureTimer.setSingleShot( true );
+    connect( &m_captureTimer, SIGNAL( timeout() ), this, SLOT( gdl90CaptureStep() ) );
+
+    m_replayTimer.setSingleShot( true );
+    m_replayTimer.setTimerType( Qt::PreciseTimer );
+    connect( &m_replayTimer, SIGNAL( timeout() ), this, SLOT( replayStep() ) );
 
     // If one connects there's a 99.99% chance they all will so just use the status
     connect( &m_stratuxStatus, SIGNAL( connected() ), this, SLOT( stratuxConnected() ) );
@@ -55,7 +91,8 @@ StreamReader::StreamReader( const QString &qsIP )
 
     connect( &m_wtSocket, SIGNAL( readyRead() ), this, SLOT( wtDataAvail() ) );
     connect( &m_wtSocket, SIGNAL( disconnected() ), this, SLOT( wtDisconnected() ) );
-    m_wtSocket.bind( QHostAddress( "192.168.10.255" ), 45678 );
+    // WingThingAddress lets a bench setup point the WingThing input at the simulator (e.g. 127.0.0.1)
+    m_wtSocket.bind( QHostAddress( g_pSet->value( "WingThingAddress", "192.168.10.255" ).toString() ), 45678 );
 
     // Re-transmit the currently set barometric pressure every ten seconds in case the WingThing restarted
     startTimer( 10000 );
@@ -74,9 +111,17 @@ void StreamReader::wtDataAvail()
 {
     QNetworkDatagram sensorData = m_wtSocket.receiveDatagram();
 
+    record( StreamCapture::WingThing, sensorData.data() );
+    wtDatagram( sensorData.data(), sensorData.senderAddress() );
+}
+
+
+// The sender is null when the datagram is being replayed; there's nobody to send the barometric pressure back to in that case
+void StreamReader::wtDatagram( const QByteArray &data, const QHostAddress &sender )
+{
     // Format coming from the WingThing is:
     // <Firmware Version>,<Airspeed>,<Altitude>,<Temp>,<Mag X>,<Mag Y>,<Mag Z>,<Orient X>,<Orient Y>,<Orient Z>,<Accel X>,<Accel Y>,<Accel Z>
-    QString               qsBuffer( sensorData.data() );
+    QString               qsBuffer( data );
     QStringList           qslFields = qsBuffer.split( ',' );
     double                dAS;
 
@@ -105,7 +150,8 @@ void StreamReader::wtDataAvail()
         m_wtTelem.dAccelY = qslFields.at( 11 ).toDouble();
         m_wtTelem.dAccelZ = qslFields.last().toDouble();
         m_bHaveWTtelem = true;
-        m_wtHost = sensorData.senderAddress();  // So we know where to send data TO
+        if( !sender.isNull() )
+            m_wtHost = sender;  // So we know where to send data TO
         m_lastPacketDateTime = QDateTime::currentDateTime();
 
         m_wtLast = m_wtTelem;
@@ -135,6 +181,10 @@ void StreamReader::wtDataAvail()
 
 StreamReader::~StreamReader()
 {
+    delete m_pRecorder;
+    m_pRecorder = nullptr;
+    delete m_pReplay;
+    m_pReplay = nullptr;
 }
 
 
@@ -170,11 +220,20 @@ void StreamReader::timerEvent( QTimerEvent* )
         emit newWTStatus( false );
     }
 
-    setBaroPress( m_dBaroPress );
+    sendBaroPress( m_dBaroPress );
+
+    if( m_pRecorder != nullptr )
+        m_pRecorder->flush();
 }
 
 
 void StreamReader::setBaroPress( double dBaro )
+{
+    QMetaObject::invokeMethod( this, "sendBaroPress", Qt::AutoConnection, Q_ARG( double, dBaro ) );
+}
+
+
+void StreamReader::sendBaroPress( double dBaro )
 {
     if( !m_wtHost.isNull() )
     {
@@ -187,25 +246,135 @@ void StreamReader::setBaroPress( double dBaro )
 }
 
 
-// Open the websocket URLs from the Stratux
+void StreamReader::setUnits( Canvas::Units eUnits )
+{
+    QMetaObject::invokeMethod( this, "applyUnits", Qt::AutoConnection, Q_ARG( int, static_cast<int>( eUnits ) ) );
+}
+
+
+void StreamReader::applyUnits( int iUnits )
+{
+    m_eUnits = static_cast<Canvas::Units>( iUnits );
+}
+
+
+void StreamReader::setAirspeedCal( double dCal )
+{
+    QMetaObject::invokeMethod( this, "applyAirspeedCal", Qt::AutoConnection, Q_ARG( double, dCal ) );
+}
+
+
+void StreamReader::applyAirspeedCal( double dCal )
+{
+    m_dAirspeedCal = dCal;
+}
+
+
 void StreamReader::connectStreams()
 {
+    QMetaObject::invokeMethod( this, "openStreams", Qt::AutoConnection );
+}
+
+
+void StreamReader::disconnectStreams()
+{
+    QMetaObject::invokeMethod( this, "closeStreams", Qt::AutoConnection );
+}
+
+
+// Open the websocket URLs from the Stratux
+void StreamReader::openStreams()
+{
+    // A replay stands in for every live source
+    if( m_pReplay != nullptr )
+    {
+        initSituation( m_gdl90Situation );
+        m_gdl90Pending.clear();
+        m_iReplayPos = 0;
+        m_iReplayDueNs = 0;
+        m_replayClock.start();
+        m_replayTimer.start( 0 );
+        return;
+    }
+
+    // GDL90 replaces all three websockets
+    if( m_eInput == GDL90Input )
+    {
+        initSituation( m_gdl90Situation );
+        m_iGDL90Traffic = 0;
+        m_gdl90Pending.clear();
+        if( !m_gdl90Capture.isEmpty() )
+        {
+            m_iCapturePos = 0;
+            m_captureTimer.start( 0 );
+        }
+        else
+        {
+            m_gdl90Socket.bind( QHostAddress::AnyIPv4, 4000, QUdpSocket::ShareAddress | QUdpSocket::ReuseAddressHint );
+            connect( &m_gdl90Socket, SIGNAL( readyRead() ), this, SLOT( gdl90DataAvail() ) );
+        }
+        return;
+    }
+
     // Open the streams
     m_stratuxSituation.open( QUrl( QString( "ws://%1/situation" ).arg( m_qsIP ) ) );
     m_stratuxTraffic.open( QUrl( QString( "ws://%1/traffic" ).arg( m_qsIP ) ) );
     m_stratuxStatus.open( QUrl( QString( "ws://%1/status" ).arg( m_qsIP ) ) );
-    connect( &m_stratuxTraffic, SIGNAL( textMessageReceived( const QString& ) ), this, SLOT( trafficUpdate( const QString& ) ) );
-    connect( &m_stratuxSituation, SIGNAL( textMessageReceived( const QString& ) ), this, SLOT( situationUpdate( const QString& ) ) );
-    connect( &m_stratuxStatus, SIGNAL( textMessageReceived( const QString& ) ), this, SLOT( statusUpdate( const QString& ) ) );
+
+    // Binary frames always go straight to the byte parser
+    connect( &m_stratuxTraffic, SIGNAL( binaryMessageReceived( const QByteArray& ) ), this, SLOT( trafficBytes( const QByteArray& ) ) );
+    connect( &m_stratuxSituation, SIGNAL( binaryMessageReceived( const QByteArray& ) ), this, SLOT( situationBytes( const QByteArray& ) ) );
+    connect( &m_stratuxStatus, SIGNAL( binaryMessageReceived( const QByteArray& ) ), this, SLOT( statusBytes( const QByteArray& ) ) );
+
+    if( m_bLegacyParser )
+    {
+        connect( &m_stratuxTraffic, SIGNAL( textMessageReceived( const QString& ) ), this, SLOT( trafficUpdate( const QString& ) ) );
+        connect( &m_stratuxSituation, SIGNAL( textMessageReceived( const QString& ) ), this, SLOT( situationUpdate( const QString& ) ) );
+        connect( &m_stratuxStatus, SIGNAL( textMessageReceived( const QString& ) ), this, SLOT( statusUpdate( const QString& ) ) );
+    }
+    else
+    {
+        connect( &m_stratuxTraffic, SIGNAL( textMessageReceived( const QString& ) ), this, SLOT( trafficText( const QString& ) ) );
+        connect( &m_stratuxSituation, SIGNAL( textMessageReceived( const QString& ) ), this, SLOT( situationText( const QString& ) ) );
+        connect( &m_stratuxStatus, SIGNAL( textMessageReceived( const QString& ) ), this, SLOT( statusText( const QString& ) ) );
+    }
 }
 
 
 // Close all the streams
-void StreamReader::disconnectStreams()
+void StreamReader::closeStreams()
 {
-    disconnect( &m_stratuxTraffic, SIGNAL( textMessageReceived( const QString& ) ), this, SLOT( trafficUpdate( const QString& ) ) );
-    disconnect( &m_stratuxSituation, SIGNAL( textMessageReceived( const QString& ) ), this, SLOT( situationUpdate( const QString& ) ) );
-    disconnect( &m_stratuxStatus, SIGNAL( textMessageReceived( const QString& ) ), this, SLOT( statusUpdate( const QString& ) ) );
+    if( m_pReplay != nullptr )
+    {
+        m_replayTimer.stop();
+        emit newStatus( false, false, false, false );
+        return;
+    }
+
+    if( m_eInput == GDL90Input )
+    {
+        m_captureTimer.stop();
+        disconnect( &m_gdl90Socket, SIGNAL( readyRead() ), this, SLOT( gdl90DataAvail() ) );
+        m_gdl90Socket.close();
+        emit newStatus( false, false, false, false );
+        return;
+    }
+
+    disconnect( &m_stratuxTraffic, SIGNAL( binaryMessageReceived( const QByteArray& ) ), this, SLOT( trafficBytes( const QByteArray& ) ) );
+    disconnect( &m_stratuxSituation, SIGNAL( binaryMessageReceived( const QByteArray& ) ), this, SLOT( situationBytes( const QByteArray& ) ) );
+    disconnect( &m_stratuxStatus, SIGNAL( binaryMessageReceived( const QByteArray& ) ), this, SLOT( statusBytes( const QByteArray& ) ) );
+    if( m_bLegacyParser )
+    {
+        disconnect( &m_stratuxTraffic, SIGNAL( textMessageReceived( const QString& ) ), this, SLOT( trafficUpdate( const QString& ) ) );
+        disconnect( &m_stratuxSituation, SIGNAL( textMessageReceived( const QString& ) ), this, SLOT( situationUpdate( const QString& ) ) );
+        disconnect( &m_stratuxStatus, SIGNAL( textMessageReceived( const QString& ) ), this, SLOT( statusUpdate( const QString& ) ) );
+    }
+    else
+    {
+        disconnect( &m_stratuxTraffic, SIGNAL( textMessageReceived( const QString& ) ), this, SLOT( trafficText( const QString& ) ) );
+        disconnect( &m_stratuxSituation, SIGNAL( textMessageReceived( const QString& ) ), this, SLOT( situationText( const QString& ) ) );
+        disconnect( &m_stratuxStatus, SIGNAL( textMessageReceived( const QString& ) ), this, SLOT( statusText( const QString& ) ) );
+    }
     m_stratuxSituation.close();
     m_stratuxTraffic.close();
     m_stratuxStatus.close();
@@ -213,113 +382,56 @@ void StreamReader::disconnectStreams()
 }
 
 
+// Tag and value of one comma separated field for the legacy parser - see https://github.com/cyoung/stratux/blob/master/notes/app-vendor-integration.md
+// The split tag and value are handed to the same field tables the byte parser uses.
+bool StreamReader::splitField( const QString &qsField, QByteArray *pTag, QByteArray *pVal, StratuxParser::Field *pField )
+{
+    QStringList qslThisField = qsField.split( "\":" );
+
+    if( qslThisField.count() != 2 )
+        return false;
+
+    *pTag = qslThisField.first().remove( 0, 1 ).trimmed().remove( '\"' ).toLatin1();
+    *pVal = qslThisField.last().trimmed().remove( '\"' ).remove( '}' ).toUtf8();
+
+    pField->pTag = pTag->constData();
+    pField->iTagLen = pTag->size();
+    pField->pVal = pVal->constData();
+    pField->iValLen = pVal->size();
+    pField->bString = false;
+
+    return true;
+}
+
+
 // Updates from the situation stream
 // String is received from stratux and the situation struct filled in
 void StreamReader::situationUpdate( const QString &qsMessage )
 {
-    QStringList      qslFields( qsMessage.split( ',' ) );
-    QString          qsField;
-    StratuxSituation situation;
-    QStringList      qslThisField;
-    QString          qsTag;
-    QString          qsVal;
-    double           dVal;
-    int              iVal;
+    QStringList           qslFields( qsMessage.split( ',' ) );
+    QString               qsField;
+    StratuxSituation      situation;
+    QByteArray            tag, val;
+    StratuxParser::Field  f;
+
+    if( m_pRecorder != nullptr )
+        record( StreamCapture::Situation, qsMessage.toUtf8() );
 
     initSituation( situation );
 
     foreach( qsField, qslFields )
     {
-        qslThisField = qsField.split( "\":" );
-        if( qslThisField.count() != 2 )
-            continue;
-
-        // Tag and value - see https://github.com/cyoung/stratux/blob/master/notes/app-vendor-integration.md
-        qsTag = qslThisField.first().remove( 0, 1 ).trimmed().remove( '\"' );
-        qsVal = qslThisField.last().trimmed().remove( '\"' ).remove( '}' );
-        dVal = qsVal.toDouble();
-        iVal = qsVal.toInt();
-
-        if( qsTag == "GPSLastFixSinceMidnightUTC" )
-            situation.dLastGPSFixSinceMidnight = dVal;
-        else if( qsTag == "GPSLatitude" )
-            situation.dGPSlat = dVal;
-        else if( qsTag == "GPSLongitude" )
-            situation.dGPSlong = dVal;
-        else if( qsTag == "GPSFixQuality" )
-            situation.iGPSFixQuality = iVal;
-        else if( qsTag == "GPSHeightAboveEllipsoid" )
-            situation.dGPSHeightAboveEllipsoid = dVal;
-        else if( qsTag == "GPSGeoidSep" )
-            situation.dGPSGeoidSep = dVal;
-        else if( qsTag == "GPSSatellites" )
-            situation.iGPSSats = iVal;
-        else if( qsTag == "GPSSatellitesTracked" )
-            situation.iGPSSatsTracked = iVal;
-        else if( qsTag == "GPSSatellitesSeen" )
-            situation.iGPSSatsSeen = iVal;
-        else if( qsTag == "GPSHorizontalAccuracy" )
-            situation.dGPSHorizAccuracy = dVal;
-        else if( qsTag == "GPSNACp" )
-            situation.iGPSNACp = iVal;
-        else if( qsTag == "GPSAltitudeMSL" )
-            situation.dGPSAltMSL = fabs( iVal );
-        else if( qsTag == "GPSVerticalAccuracy" )
-            situation.dGPSVertAccuracy = dVal;
-        else if( qsTag == "GPSVerticalSpeed" )
-            situation.dGPSVertSpeed = dVal;
-        else if( qsTag == "GPSLastFixLocalTime" )
-            situation.lastGPSFixTime.fromString( qsVal, Qt::ISODate );
-        else if( qsTag == "GPSTrueCourse" )
-            situation.dGPSTrueCourse = dVal;
-        else if( qsTag == "GPSTurnRate" )
-            situation.dGPSTurnRate = dVal;
-        else if( qsTag == "GPSGroundSpeed" )
-            situation.dGPSGroundSpeed = dVal * unitsMult();
-        else if( qsTag == "GPSLastGroundTrackTime" )
-            situation.lastGPSGroundTrackTime.fromString( qsVal, Qt::ISODate );
-        else if( qsTag == "GPSTime" )
-            situation.gpsDateTime.fromString( qsVal, Qt::ISODate );
-        else if( qsTag == "GPSLastGPSTimeStratuxTime" )
-            situation.lastGPSTimeStratuxTime.fromString( qsVal, Qt::ISODate );
-        else if( qsTag == "GPSLastValidNMEAMessageTime" )
-            situation.lastValidNMEAMessageTime.fromString( qsVal, Qt::ISODate );
-        else if( qsTag == "GPSLastValidNMEAMessage" )
-            situation.qsLastNMEAMsg = qsVal;
-        else if( qsTag == "GPSPositionSampleRate" )
-            situation.iGPSPosSampleRate = iVal;
-        else if( qsTag == "BaroTemperature" )
-            situation.dBaroTemp = dVal;
-        else if( qsTag == "BaroPressureAltitude" )
-            situation.dBaroPressAlt = fabs( dVal );
-        else if( qsTag == "BaroVerticalSpeed" )
-            situation.dBaroVertSpeed = dVal;
-        else if( qsTag == "BaroLastMeasurementTime" )
-            situation.lastBaroMeasTime.fromString( qsVal, Qt::ISODate );
-        else if( qsTag == "AHRSPitch" )
-            situation.dAHRSpitch = dVal;
-        else if( qsTag == "AHRSRoll" )
-            situation.dAHRSroll = dVal;
-        else if( qsTag == "AHRSGyroHeading" )
-            situation.dAHRSGyroHeading = dVal;
-        else if( qsTag == "AHRSMagHeading" )
-            situation.dAHRSMagHeading = dVal;
-        else if( qsTag == "AHRSSlipSkid" )
-            situation.dAHRSSlipSkid = dVal;
-        else if( qsTag == "AHRSTurnRate" )
-            situation.dAHRSTurnRate = dVal;
-        else if( qsTag == "AHRSGLoad" )
-            situation.dAHRSGLoad = dVal;
-        else if( qsTag == "AHRSGLoadMin" )
-            situation.dAHRSGLoadMin = dVal;
-        else if( qsTag == "AHRSGLoadMax" )
-            situation.dAHRSGLoadMax = dVal;
-        else if( qsTag == "AHRSLastAttitudeTime" )
-            situation.lastAHRSAttTime.fromString( qsVal, Qt::ISODate );
-        else if( qsTag == "AHRSStatus" )
-            situation.iAHRSStatus = iVal;
+        if( splitField( qsField, &tag, &val, &f ) )
+            StratuxParser::situationField( f, &situation, unitsMult() );
     }
 
+    publishSituation( situation );
+}
+
+
+// Anything that comes after the parsing is the same regardless of how the message was parsed
+void StreamReader::publishSituation( StratuxSituation &situation )
+{
     // Replace Stratux telemetry with actual air data from the sensor sending UDP data
     if( m_bHaveWTtelem )
     {
@@ -354,85 +466,38 @@ void StreamReader::situationUpdate( const QString &qsMessage )
 
     m_bAHRSStatus = (situation.iAHRSStatus > 0);
 
-    emit newSituation( situation );
+    m_situationBox.publish( situation );
+    wake();
 }
 
 
 // Updates from the traffic stream
 void StreamReader::trafficUpdate( const QString &qsMessage )
 {
-    QStringList    qslFields( qsMessage.split( ',' ) );
-    QString        qsField;
-    StratuxTraffic traffic;
-    QStringList    qslThisField;
-    QString        qsTag;
-    QString        qsVal;
-    double         dVal;
-    int            iVal;
-    bool           bVal;
-    int            iICAO = 0;
+    QStringList          qslFields( qsMessage.split( ',' ) );
+    QString              qsField;
+    StratuxTraffic       traffic;
+    QByteArray           tag, val;
+    StratuxParser::Field f;
+    int                  iICAO = 0;
 
-    traffic.dLat = 0.0;
-    traffic.dLong = 0.0;
-    traffic.lastActualReport = QDateTime::currentDateTime();
+    if( m_pRecorder != nullptr )
+        record( StreamCapture::Traffic, qsMessage.toUtf8() );
 
     initTraffic( traffic );
 
     foreach( qsField, qslFields )
     {
-        qslThisField = qsField.split( "\":" );
-        if( qslThisField.count() != 2 )
-            continue;
-
-        // Tag and value - see https://github.com/cyoung/stratux/blob/master/notes/app-vendor-integration.md
-        qsTag = qslThisField.first().remove( 0, 1 ).trimmed().remove( '\"' );
-        qsVal = qslThisField.last().trimmed().remove( '\"' ).remove( '}' );
-        dVal = qsVal.toDouble();
-        iVal = qsVal.toInt();
-        bVal = (qsVal == "true");
-
-        if( qsTag == "Icao_addr" )
-            iICAO = iVal;   // Note this is not part of the struct
-        else if( qsTag == "OnGround" )
-            traffic.bOnGround = bVal;
-        else if( qsTag == "Lat" )
-            traffic.dLat = dVal;
-        else if( qsTag == "Lng" )
-            traffic.dLong = dVal;
-        else if( qsTag == "Position_valid" )
-            traffic.bPosValid = bVal;
-        else if( qsTag == "Alt" )
-            traffic.dAlt = dVal;
-        else if( qsTag == "Track" )
-            traffic.dTrack = dVal;
-        else if( qsTag == "Speed" )
-            traffic.dSpeed = dVal * unitsMult();
-        else if( qsTag == "Vvel" )
-            traffic.dVertSpeed = dVal;
-        else if( qsTag == "Tail" )
-            traffic.qsTail = qsVal;
-        else if( qsTag == "Last_seen" )
-            traffic.lastSeen.fromString( qsVal, Qt::ISODate );
-        else if( qsTag == "Last_source" )
-            traffic.iLastSource = iVal;
-        else if( qsTag == "Reg" )
-            traffic.qsReg = qsVal;
-        else if( qsTag == "SignalLevel" )
-            traffic.dSigLevel = dVal;
-        else if( qsTag == "Squawk" )
-            traffic.iSquawk = iVal;
-        else if( qsTag == "Timestamp" )
-            traffic.timestamp.fromString( qsVal, Qt::ISODate );
-        else if( qsTag == "Last_source" )
-            traffic.iLastSource = iVal;
-        else if( qsTag == "Bearing" )
-            traffic.dBearing = dVal;
-        else if( qsTag == "Distance" )
-            traffic.dDist = dVal * 0.000539957;  // Meters to Nautical Miles
-        else if( qsTag == "Age" )
-            traffic.dAge = dVal;
+        if( splitField( qsField, &tag, &val, &f ) )
+            StratuxParser::trafficField( f, &traffic, unitsMult(), &iICAO );
     }
 
+    publishTraffic( traffic, iICAO );
+}
+
+
+void StreamReader::publishTraffic( StratuxTraffic &traffic, int iICAO )
+{
     // If we know where we are, figure out where they are
     if( traffic.bPosValid && m_bHaveMyPos )
     {
@@ -447,46 +512,49 @@ void StreamReader::trafficUpdate( const QString &qsMessage )
         traffic.bHasADSB = false;
 
     if( iICAO > 0 )
-        emit newTraffic( traffic );
+    {
+        traffic.iICAO = iICAO;
+        m_trafficRing.push( traffic );
+        wake();
+    }
+}
+
+
+// Let the GUI know there's something in the hand-off unless a notification is already pending.
+// However fast the messages come in there's at most one queued event outstanding.
+void StreamReader::wake()
+{
+    if( m_iWakePending.testAndSetOrdered( 0, 1 ) )
+        emit dataReady();
 }
 
 
 // Updates from the status stream
 void StreamReader::statusUpdate( const QString &qsMessage )
 {
-    QStringList   qslFields( qsMessage.split( ',' ) );
-    QString       qsField;
-    QStringList   qslThisField;
-    QString       qsTag;
-    QString       qsVal;
-    int           iVal;
-    bool          bVal;
-    StratuxStatus status;
+    QStringList          qslFields( qsMessage.split( ',' ) );
+    QString              qsField;
+    StratuxStatus        status;
+    QByteArray           tag, val;
+    StratuxParser::Field f;
+
+    if( m_pRecorder != nullptr )
+        record( StreamCapture::Status, qsMessage.toUtf8() );
 
     initStatus( status );
 
     foreach( qsField, qslFields )
     {
-        qslThisField = qsField.split( "\":" );
-        if( qslThisField.count() != 2 )
-            continue;
-
-        // Tag and value - see https://github.com/cyoung/stratux/blob/master/notes/app-vendor-integration.md
-        qsTag = qslThisField.first().remove( 0, 1 ).trimmed().remove( '\"' );
-        qsVal = qslThisField.last().trimmed().remove( '\"' ).remove( '}' );
-        iVal = qsVal.toInt();
-        bVal = (qsVal == "true");
-
-        if( qsTag == "UAT_traffic_targets_tracking" )
-            status.iUATTrafficTracking = iVal;
-        else if( qsTag == "ES_traffic_targets_tracking" )
-            status.iESTrafficTracking = iVal;
-        else if( qsTag == "GPS_satellites_locked" )
-            status.iGPSSatsLocked = iVal;
-        else if( qsTag == "GPS_connected" )
-            status.bGPSConnected = bVal;
+        if( splitField( qsField, &tag, &val, &f ) )
+            StratuxParser::statusField( f, &status );
     }
 
+    publishStatus( status );
+}
+
+
+void StreamReader::publishStatus( StratuxStatus &status )
+{
     m_bStratuxStatus = true;    // If this signal fired then we're at least talking to the Stratux
     m_bGPSStatus = (status.bGPSConnected && m_bHaveMyPos);
     m_bTrafficStatus = ((status.iUATTrafficTracking > 0) || (status.iESTrafficTracking > 0));
@@ -495,9 +563,353 @@ void StreamReader::statusUpdate( const QString &qsMessage )
 }
 
 
+// Byte level parsing of the same three streams; see StratuxParser
+// Text frames arrive from QWebSocket already decoded to UTF-16 so they're converted back to UTF-8 once here
+void StreamReader::situationText( const QString &qsMessage )
+{
+    situationBytes( qsMessage.toUtf8() );
+}
+
+
+void StreamReader::trafficText( const QString &qsMessage )
+{
+    trafficBytes( qsMessage.toUtf8() );
+}
+
+
+void StreamReader::statusText( const QString &qsMessage )
+{
+    statusBytes( qsMessage.toUtf8() );
+}
+
+
+void StreamReader::situationBytes( const QByteArray &message )
+{
+    StratuxSituation situation;
+
+    record( StreamCapture::Situation, message );
+
+    initSituation( situation );
+    StratuxParser::parseSituation( message, &situation, unitsMult() );
+    publishSituation( situation );
+}
+
+
+void StreamReader::trafficBytes( const QByteArray &message )
+{
+    StratuxTraffic traffic;
+    int            iICAO;
+
+    record( StreamCapture::Traffic, message );
+
+    initTraffic( traffic );
+    iICAO = StratuxParser::parseTraffic( message, &traffic, unitsMult() );
+    publishTraffic( traffic, iICAO );
+}
+
+
+void StreamReader::statusBytes( const QByteArray &message )
+{
+    StratuxStatus status;
+
+    record( StreamCapture::Status, message );
+
+    initStatus( status );
+    StratuxParser::parseStatus( message, &status );
+    publishStatus( status );
+}
+
+
+// Record everything that comes in from the network to the given capture file
+bool StreamReader::setRecordFile( const QString &qsFile )
+{
+    delete m_pRecorder;
+    m_pRecorder = new CaptureWriter;
+    if( !m_pRecorder->open( qsFile ) )
+    {
+        delete m_pRecorder;
+        m_pRecorder = nullptr;
+        return false;
+    }
+    qInfo() << "Recording to" << qsFile;
+
+    return true;
+}
+
+
+// Feed a capture back through the same slots the network uses.
+// dSpeed is the replay rate relative to the recording (2.0 is twice as fast); zero or less replays as fast as possible.
+bool StreamReader::setReplayFile( const QString &qsFile, double dSpeed )
+{
+    delete m_pReplay;
+    m_pReplay = new CaptureReader;
+    if( !m_pReplay->open( qsFile ) )
+    {
+        delete m_pReplay;
+        m_pReplay = nullptr;
+        return false;
+    }
+    m_dReplaySpeed = dSpeed;
+    qInfo() << "Replaying" << m_pReplay->count() << "records from" << qsFile;
+
+    return true;
+}
+
+
+// Nothing is recorded while replaying; the capture would just be a copy of itself
+void StreamReader::record( int iChannel, const QByteArray &data )
+{
+    if( (m_pRecorder != nullptr) && (m_pReplay == nullptr) )
+        m_pRecorder->write( static_cast<StreamCapture::Channel>( iChannel ), data );
+}
+
+
+// Replay every record that is due, then sleep until the next one.
+// Gaps of more than ten seconds in the recording (e.g. between two recording sessions appended to the same file) are cut to ten seconds.
+void StreamReader::replayStep()
+{
+    int    iCount = m_pReplay->count();
+    int    iBatch = 0;
+    qint64 iWaitNs;
+
+    while( m_iReplayPos < iCount )
+    {
+        if( m_dReplaySpeed > 0.0 )
+        {
+            iWaitNs = m_iReplayDueNs - m_replayClock.nsecsElapsed();
+            if( iWaitNs > 0 )
+            {
+                m_replayTimer.start( static_cast<int>( (iWaitNs + 999999) / 1000000 ) );
+                return;
+            }
+        }
+
+        // Flat out, or catching up after falling behind, still has to give the event loop and the consumer a look in now
+        // and then; whatever's left is still overdue next step and goes straight out
+        if( ++iBatch > s_iReplayBatch )
+        {
+            m_replayTimer.start( 0 );
+            return;
+        }
+
+        replayRecord( m_iReplayPos );
+        m_iReplayPos++;
+        if( (m_iReplayPos < iCount) && (m_dReplaySpeed > 0.0) )
+        {
+            qint64 iGapNs = qBound( static_cast<qint64>( 0 ), m_pReplay->timeNs( m_iReplayPos ) - m_pReplay->timeNs( m_iReplayPos - 1 ), static_cast<qint64>( 10000000000LL ) );
+
+            m_iReplayDueNs += static_cast<qint64>( static_cast<double>( iGapNs ) / m_dReplaySpeed );
+        }
+    }
+
+    qInfo() << QString( "Replay finished: %1 records in %2 ms (%3 records/s)" )
+                   .arg( iCount )
+                   .arg( m_replayClock.elapsed() )
+                   .arg( static_cast<double>( iCount ) * 1000.0 / qMax( static_cast<double>( m_replayClock.elapsed() ), 1.0 ), 0, 'f', 0 )
+                   .toLatin1().constData();
+    emit replayFinished();
+}
+
+
+void StreamReader::replayRecord( int i )
+{
+    QByteArray payload = m_pReplay->payload( i );
+
+    m_bConnected = true;
+
+    switch( m_pReplay->channel( i ) )
+    {
+        case StreamCapture::Situation:
+            situationBytes( payload );
+            break;
+        case StreamCapture::Traffic:
+            trafficBytes( payload );
+            break;
+        case StreamCapture::Status:
+            statusBytes( payload );
+            break;
+        case StreamCapture::WingThing:
+            wtDatagram( payload, QHostAddress() );
+            break;
+        case StreamCapture::GDL90:
+            gdl90Bytes( payload );
+            break;
+    }
+}
+
+
+// Use a raw GDL90 byte stream (e.g. a capture of what Stratux sends to UDP port 4000) instead of the network
+bool StreamReader::setGDL90Capture( const QString &qsFile )
+{
+    QFile capture( qsFile );
+
+    if( !capture.open( QIODevice::ReadOnly ) )
+    {
+        qWarning() << "Unable to open GDL90 capture" << qsFile;
+        return false;
+    }
+    m_gdl90Capture = capture.readAll();
+    m_eInput = GDL90Input;
+
+    return true;
+}
+
+
+void StreamReader::gdl90DataAvail()
+{
+    while( m_gdl90Socket.hasPendingDatagrams() )
+    {
+        QByteArray datagram = m_gdl90Socket.receiveDatagram().data();
+
+        record( StreamCapture::GDL90, datagram );
+        gdl90Bytes( datagram );
+    }
+}
+
+
+// Split incoming bytes into GDL90 messages; a datagram normally holds several complete frames
+void StreamReader::gdl90Bytes( const QByteArray &data )
+{
+    QByteArray msg;
+    int        iPos = 0;
+
+    m_gdl90Pending.append( data );
+    while( GDL90::nextMessage( m_gdl90Pending, &iPos, &msg ) )
+        gdl90Message( msg );
+    m_gdl90Pending.remove( 0, iPos );
+}
+
+
+// Play a capture back one heartbeat (one second) at a time, starting over at the end
+void StreamReader::gdl90CaptureStep()
+{
+    QByteArray msg;
+    bool       bHeartbeat = false;
+
+    while( !bHeartbeat )
+    {
+        if( !GDL90::nextMessage( m_gdl90Capture, &m_iCapturePos, &msg ) )
+        {
+            m_iCapturePos = 0;
+            break;
+        }
+        gdl90Message( msg );
+        bHeartbeat = (static_cast<quint8>( msg.at( 0 ) ) == GDL90::Heartbeat);
+    }
+
+    m_captureTimer.start( 1000 );
+}
+
+
+// Decode one GDL90 message into the same structs and signals the websocket streams produce
+void StreamReader::gdl90Message( const QByteArray &msg )
+{
+    GDL90Heartbeat heartbeat;
+    GDL90Target    target;
+    GDL90AHRS      ahrs;
+    double         dAlt;
+
+    m_bConnected = true;
+
+    switch( static_cast<quint8>( msg.at( 0 ) ) )
+    {
+        case GDL90::Heartbeat:
+            if( GDL90::heartbeat( msg, &heartbeat ) )
+            {
+                StratuxStatus status;
+
+                initStatus( status );
+                status.bGPSConnected = heartbeat.bGPSValid;
+                status.iESTrafficTracking = m_iGDL90Traffic;
+                m_iGDL90Traffic = 0;
+                publishStatus( status );
+            }
+            break;
+
+        case GDL90::Ownship:
+            if( GDL90::targetReport( msg, &target ) )
+            {
+                StratuxSituation situation;
+
+                m_gdl90Situation.dGPSlat = target.bPosValid ? target.dLat : 0.0;
+                m_gdl90Situation.dGPSlong = target.bPosValid ? target.dLong : 0.0;
+                m_gdl90Situation.iGPSFixQuality = target.bPosValid ? 1 : 0;
+                m_gdl90Situation.iGPSNACp = target.iNACp;
+                m_gdl90Situation.dGPSTrueCourse = target.dTrack;
+                m_gdl90Situation.dGPSGroundSpeed = target.dSpeed * unitsMult();
+                m_gdl90Situation.dGPSVertSpeed = target.dVertSpeed;
+                situation = m_gdl90Situation;
+                publishSituation( situation );
+            }
+            break;
+
+        // Stratux sends height above ellipsoid; there's no geoid separation in GDL90 so it stands in for MSL too
+        case GDL90::OwnshipGeoAlt:
+            if( GDL90::geoAltitude( msg, &dAlt ) )
+            {
+                m_gdl90Situation.dGPSHeightAboveEllipsoid = dAlt;
+                m_gdl90Situation.dGPSAltMSL = fabs( dAlt );
+            }
+            break;
+
+        case GDL90::Traffic:
+            if( GDL90::targetReport( msg, &target ) )
+            {
+                StratuxTraffic traffic;
+
+                initTraffic( traffic );
+                traffic.bOnGround = !target.bAirborne;
+                traffic.dLat = target.dLat;
+                traffic.dLong = target.dLong;
+                traffic.bPosValid = target.bPosValid;
+                traffic.dAlt = target.dAlt;
+                traffic.dTrack = target.dTrack;
+                traffic.dSpeed = target.dSpeed * unitsMult();
+                traffic.dVertSpeed = target.dVertSpeed;
+                if( !target.qsCallsign.isEmpty() )
+                    traffic.qsTail = target.qsCallsign;
+                traffic.dAge = 0.0;
+                m_iGDL90Traffic++;
+                publishTraffic( traffic, target.iAddress );
+            }
+            break;
+
+        case GDL90::StratuxAHRS:
+            if( GDL90::stratuxAHRS( msg, &ahrs ) )
+            {
+                StratuxSituation situation;
+
+                m_gdl90Situation.iAHRSStatus = ahrs.bAttValid ? 1 : 0;
+                m_gdl90Situation.dAHRSroll = ahrs.dRoll;
+                m_gdl90Situation.dAHRSpitch = ahrs.dPitch;
+                if( ahrs.bHeadingValid )
+                {
+                    m_gdl90Situation.dAHRSGyroHeading = ahrs.dHeading;
+                    m_gdl90Situation.dAHRSMagHeading = ahrs.dHeading;
+                }
+                m_gdl90Situation.dAHRSSlipSkid = ahrs.dSlipSkid;
+                m_gdl90Situation.dAHRSTurnRate = ahrs.dTurnRate;
+                m_gdl90Situation.dAHRSGLoad = ahrs.dGLoad;
+                if( ahrs.dGLoad < m_gdl90Situation.dAHRSGLoadMin )
+                    m_gdl90Situation.dAHRSGLoadMin = ahrs.dGLoad;
+                if( ahrs.dGLoad > m_gdl90Situation.dAHRSGLoadMax )
+                    m_gdl90Situation.dAHRSGLoadMax = ahrs.dGLoad;
+                if( ahrs.bPressAltValid )
+                    m_gdl90Situation.dBaroPressAlt = fabs( ahrs.dPressAlt );
+                if( ahrs.bVertSpeedValid )
+                    m_gdl90Situation.dBaroVertSpeed = ahrs.dVertSpeed;
+                situation = m_gdl90Situation;
+                publishSituation( situation );
+            }
+            break;
+    }
+}
+
+
 // Initialize the traffic struct
 void StreamReader::initTraffic( StratuxTraffic &traffic )
 {
+    traffic.iICAO = 0;
     traffic.bOnGround = false;
     traffic.dLat = 0.0;
     traffic.dLong = 0.0;
@@ -507,14 +919,12 @@ void StreamReader::initTraffic( StratuxTraffic &traffic )
     traffic.dSpeed = 0.0;
     traffic.dVertSpeed = false;
     traffic.qsTail = "N/A";
-    traffic.lastSeen.setDate( QDate( 2000, 1, 1 ) );
-    traffic.lastSeen.setTime( QTime( 0, 0, 0 ) );
+    traffic.lastSeen.iEpochMs = StratuxNullTime;
     traffic.iLastSource = 0;
     traffic.qsReg = "N/A";
     traffic.dSigLevel = 0.0;
     traffic.iSquawk = 1200;
-    traffic.timestamp.setDate( QDate( 2000, 1, 1 ) );
-    traffic.timestamp.setTime( QTime( 0, 0, 0 ) );
+    traffic.timestamp.iEpochMs = StratuxNullTime;
     traffic.iLastSource = 0;
     traffic.dBearing = 0.0;
     traffic.dDist = 0.0;
@@ -536,8 +946,6 @@ void StreamReader::initStatus( StratuxStatus &status )
 // Initialize the situation struct
 void StreamReader::initSituation( StratuxSituation &situation )
 {
-    QDateTime nullDateTime( QDate( 2000, 1, 1 ), QTime( 0, 0, 0 ) );
-
     situation.dLastGPSFixSinceMidnight = 0.0;
     situation.dGPSlat = 0.0;
     situation.dGPSlong = 0.0;
@@ -552,20 +960,20 @@ void StreamReader::initSituation( StratuxSituation &situation )
     situation.dGPSAltMSL = 0;
     situation.dGPSVertAccuracy = 0.0;
     situation.dGPSVertSpeed = 0.0;
-    situation.lastGPSFixTime = nullDateTime;
+    situation.lastGPSFixTime.iEpochMs = StratuxNullTime;
     situation.dGPSTrueCourse = 0.0;
     situation.dGPSTurnRate = 0.0;
     situation.dGPSGroundSpeed = 0.0;
-    situation.lastGPSGroundTrackTime = nullDateTime;
-    situation.gpsDateTime = nullDateTime;
-    situation.lastGPSTimeStratuxTime = nullDateTime;
-    situation.lastValidNMEAMessageTime = nullDateTime;
+    situation.lastGPSGroundTrackTime.iEpochMs = StratuxNullTime;
+    situation.gpsDateTime.iEpochMs = StratuxNullTime;
+    situation.lastGPSTimeStratuxTime.iEpochMs = StratuxNullTime;
+    situation.lastValidNMEAMessageTime.iEpochMs = StratuxNullTime;
     situation.qsLastNMEAMsg = "";
     situation.iGPSPosSampleRate = 0;
     situation.dBaroTemp = 0.0;
     situation.dBaroPressAlt = 0.0;
     situation.dBaroVertSpeed = 0.0;
-    situation.lastBaroMeasTime = nullDateTime;
+    situation.lastBaroMeasTime.iEpochMs = StratuxNullTime;
     situation.dAHRSpitch = 0.0;
     situation.dAHRSroll = 0.0;
     situation.dAHRSGyroHeading = 0.0;
@@ -575,7 +983,7 @@ void StreamReader::initSituation( StratuxSituation &situation )
     situation.dAHRSGLoad = 1.0;
     situation.dAHRSGLoadMin = 1.0;
     situation.dAHRSGLoadMax = 1.0;
-    situation.lastAHRSAttTime = nullDateTime;
+    situation.lastAHRSAttTime.iEpochMs = StratuxNullTime;
     situation.iAHRSStatus = 0;
     situation.bHaveWTData = false;
     situation.dTAS = 0.0;
@@ -616,11 +1024,17 @@ double StreamReader::unitsMult()
 }
 
 
+// The raw attitude belongs to the stream thread so the snapshot is taken there; the settings are written from the caller's (GUI) thread
 void StreamReader::snapshotOrientation()
 {
-    m_dRollRef = m_dRawRoll;
-    m_dPitchRef = m_dRawPitch;
+    QMetaObject::invokeMethod( this, "snapshotRefs", (QThread::currentThread() == thread()) ? Qt::DirectConnection : Qt::BlockingQueuedConnection );
     g_pSet->setValue( "PitchRef", m_dPitchRef );
     g_pSet->setValue( "RollRef", m_dRollRef );
 }
 
+
+void StreamReader::snapshotRefs()
+{
+    m_dRollRef = m_dRawRoll;
+    m_dPitchRef = m_dRawPitch;
+}
@@ -0,0 +1,340 @@
+/*
+Stratofier Stratux AHRS Display
+(c) 2018 Allen K. Lair, Sky Fun
+*/
+
+// The vector kernels only match the scalar one if no compiler fuses a multiply and add behind our back
+#if defined( __clang__ )
+#pragma clang fp contract( off )
+#elif defined( __GNUC__ )
+#pragma GCC optimize( "fp-contract=off" )
+#endif
+
+#include <math.h>
+
+#if defined( __SSE2__ ) || defined( __AVX2__ )
+#include <immintrin.h>
+#endif
+#if defined( __ARM_NEON ) || defined( __ARM_NEON__ )
+#include <arm_neon.h>
+#endif
+
+#include "TrafficGeometry.h"
+#include "StratofierDefs.h"
+
+
+// Arctangent on [0, 1]; about 1e-5 radians worst case which is far below a pixel at any zoom
+static const float s_fAtan1 = 0.9998660f;
+static const float s_fAtan3 = -0.3302995f;
+static const float s_fAtan5 = 0.1801410f;
+static const float s_fAtan7 = -0.0851330f;
+static const float s_fAtan9 = 0.0208351f;
+
+
+// Per frame constants, already in single precision
+struct TrafficFrame
+{
+    float fLat;
+    float fLong;
+    float fAlt;
+    float fNMPerDegLat;
+    float fNMPerDegLong;
+    float fCosHead;
+    float fSinHead;
+    float fPxPerNM;
+    float fCenterX;
+    float fCenterY;
+};
+
+
+// One operation set per instruction set. The kernel below is written once against these so every instruction set
+// performs the identical sequence of operations, which is what makes the results identical.
+struct ScalarOps
+{
+    typedef float Vec;
+    typedef bool  Mask;
+    enum { Width = 1 };
+
+    static inline Vec  load( const float *p ) { return *p; }
+    static inline void store( float *p, Vec v ) { *p = v; }
+    static inline Vec  splat( float f ) { return f; }
+    static inline Vec  add( Vec a, Vec b ) { return a + b; }
+    static inline Vec  sub( Vec a, Vec b ) { return a - b; }
+    static inline Vec  mul( Vec a, Vec b ) { return a * b; }
+    static inline Vec  div( Vec a, Vec b ) { return a / b; }
+    static inline Vec  sqrt( Vec a ) { return sqrtf( a ); }
+    static inline Vec  min( Vec a, Vec b ) { return (a < b) ? a : b; }
+    static inline Vec  max( Vec a, Vec b ) { return (a > b) ? a : b; }
+    static inline Vec  abs( Vec a ) { return fabsf( a ); }
+    static inline Vec  neg( Vec a ) { return -a; }
+    static inline Mask lt( Vec a, Vec b ) { return a < b; }
+    static inline Mask gt( Vec a, Vec b ) { return a > b; }
+    static inline Vec  select( Mask m, Vec a, Vec b ) { return m ? a : b; }
+};
+
+
+#if defined( __SSE2__ )
+struct SSE2Ops
+{
+    typedef __m128 Vec;
+    typedef __m128 Mask;
+    enum { Width = 4 };
+
+    static inline Vec  load( const float *p ) { return _mm_loadu_ps( p ); }
+    static inline void store( float *p, Vec v ) { _mm_storeu_ps( p, v ); }
+    static inline Vec  splat( float f ) { return _mm_set1_ps( f ); }
+    static inline Vec  add( Vec a, Vec b ) { return _mm_add_ps( a, b ); }
+    static inline Vec  sub( Vec a, Vec b ) { return _mm_sub_ps( a, b ); }
+    static inline Vec  mul( Vec a, Vec b ) { return _mm_mul_ps( a, b ); }
+    static inline Vec  div( Vec a, Vec b ) { return _mm_div_ps( a, b ); }
+    static inline Vec  sqrt( Vec a ) { return _mm_sqrt_ps( a ); }
+    static inline Vec  min( Vec a, Vec b ) { return _mm_min_ps( a, b ); }
+    static inline Vec  max( Vec a, Vec b ) { return _mm_max_ps( a, b ); }
+    static inline Vec  abs( Vec a ) { return _mm_andnot_ps( _mm_set1_ps( -0.0f ), a ); }
+    static inline Vec  neg( Vec a ) { return _mm_xor_ps( _mm_set1_ps( -0.0f ), a ); }
+    static inline Mask lt( Vec a, Vec b ) { return _mm_cmplt_ps( a, b ); }
+    static inline Mask gt( Vec a, Vec b ) { return _mm_cmpgt_ps( a, b ); }
+    static inline Vec  select( Mask m, Vec a, Vec b ) { return _mm_or_ps( _mm_and_ps( m, a ), _mm_andnot_ps( m, b ) ); }
+};
+#endif
+
+
+// AVX2 is a build time choice (e.g. QMAKE_CXXFLAGS += -mavx2); the Pi never has it and a desktop build for everyone can't assume it
+#if defined( __AVX2__ )
+struct AVX2Ops
+{
+    typedef __m256 Vec;
+    typedef __m256 Mask;
+    enum { Width = 8 };
+
+    static inline Vec  load( const float *p ) { return _mm256_loadu_ps( p ); }
+    static inline void store( float *p, Vec v ) { _mm256_storeu_ps( p, v ); }
+    static inline Vec  splat( float f ) { return _mm256_set1_ps( f ); }
+    static inline Vec  add( Vec a, Vec b ) { return _mm256_add_ps( a, b ); }
+    static inline Vec  sub( Vec a, Vec b ) { return _mm256_sub_ps( a, b ); }
+    static inline Vec  mul( Vec a, Vec b ) { return _mm256_mul_ps( a, b ); }
+    static inline Vec  div( Vec a, Vec b ) { return _mm256_div_ps( a, b ); }
+    static inline Vec  sqrt( Vec a ) { return _mm256_sqrt_ps( a ); }
+    static inline Vec  min( Vec a, Vec b ) { return _mm256_min_ps( a, b ); }
+    static inline Vec  max( Vec a, Vec b ) { return _mm256_max_ps( a, b ); }
+    static inline Vec  abs( Vec a ) { return _mm256_andnot_ps( _mm256_set1_ps( -0.0f ), a ); }
+    static inline Vec  neg( Vec a ) { return _mm256_xor_ps( _mm256_set1_ps( -0.0f ), a ); }
+    static inline Mask lt( Vec a, Vec b ) { return _mm256_cmp_ps( a, b, _CMP_LT_OQ ); }
+    static inline Mask gt( Vec a, Vec b ) { return _mm256_cmp_ps( a, b, _CMP_GT_OQ ); }
+    static inline Vec  select( Mask m, Vec a, Vec b ) { return _mm256_blendv_ps( b, a, m ); }
+};
+#endif
+
+
+#if defined( __ARM_NEON ) || defined( __ARM_NEON__ )
+struct NEONOps
+{
+    typedef float32x4_t Vec;
+    typedef uint32x4_t  Mask;
+    enum { Width = 4 };
+
+    static inline Vec  load( const float *p ) { return vld1q_f32( p ); }
+    static inline void store( float *p, Vec v ) { vst1q_f32( p, v ); }
+    static inline Vec  splat( float f ) { return vdupq_n_f32( f ); }
+    static inline Vec  add( Vec a, Vec b ) { return vaddq_f32( a, b ); }
+    static inline Vec  sub( Vec a, Vec b ) { return vsubq_f32( a, b ); }
+    static inline Vec  mul( Vec a, Vec b ) { return vmulq_f32( a, b ); }
+#if defined( __aarch64__ )
+    static inline Vec  div( Vec a, Vec b ) { return vdivq_f32( a, b ); }
+    static inline Vec  sqrt( Vec a ) { return vsqrtq_f32( a ); }
+#else
+    // ARMv7 NEON only has reciprocal estimates which wouldn't match; the VFP unit does these exactly a lane at a time
+    static inline Vec div( Vec a, Vec b )
+    {
+        float fA[4], fB[4];
+
+        vst1q_f32( fA, a );
+        vst1q_f32( fB, b );
+        for( int i = 0; i < 4; i++ )
+            fA[i] /= fB[i];
+
+        return vld1q_f32( fA );
+    }
+    static inline Vec sqrt( Vec a )
+    {
+        float fA[4];
+
+        vst1q_f32( fA, a );
+        for( int i = 0; i < 4; i++ )
+            fA[i] = sqrtf( fA[i] );
+
+        return vld1q_f32( fA );
+    }
+#endif
+    static inline Vec  min( Vec a, Vec b ) { return vbslq_f32( vcltq_f32( a, b ), a, b ); }
+    static inline Vec  max( Vec a, Vec b ) { return vbslq_f32( vcgtq_f32( a, b ), a, b ); }
+    static inline Vec  abs( Vec a ) { return vabsq_f32( a ); }
+    static inline Vec  neg( Vec a ) { return vnegq_f32( a ); }
+    static inline Mask lt( Vec a, Vec b ) { return vcltq_f32( a, b ); }
+    static inline Mask gt( Vec a, Vec b ) { return vcgtq_f32( a, b ); }
+    static inline Vec  select( Mask m, Vec a, Vec b ) { return vbslq_f32( m, a, b ); }
+};
+#endif
+
+
+// Slots iFrom up to the last whole vector; returns where it stopped so the scalar version can finish the tail
+template <class Ops>
+static int plot( const TrafficFrame &f, const TrafficArrays &in, TrafficPlot *pOut, int iFrom, int iCount )
+{
+    typedef typename Ops::Vec  Vec;
+    typedef typename Ops::Mask Mask;
+
+    const float *pLat = in.fLat.constData();
+    const float *pLong = in.fLong.constData();
+    const float *pAlt = in.fAlt.constData();
+    float       *pX = pOut->fX.data();
+    float       *pY = pOut->fY.data();
+    float       *pBearing = pOut->fBearing.data();
+    float       *pDist = pOut->fDist.data();
+    float       *pAltDelta = pOut->fAltDelta.data();
+    const Vec    vZero = Ops::splat( 0.0f );
+    const Vec    v180 = Ops::splat( 180.0f );
+    const Vec    vNeg180 = Ops::splat( -180.0f );
+    const Vec    v360 = Ops::splat( 360.0f );
+    const Vec    vTiny = Ops::splat( 1.0e-30f );
+    const Vec    vHalfPi = Ops::splat( static_cast<float>( TwoPi / 4.0 ) );
+    const Vec    vPi = Ops::splat( static_cast<float>( TwoPi / 2.0 ) );
+    const Vec    vTwoPi = Ops::splat( static_cast<float>( TwoPi ) );
+    const Vec    vToDeg = Ops::splat( static_cast<float>( ToDeg ) );
+    const Vec    vLat0 = Ops::splat( f.fLat );
+    const Vec    vLong0 = Ops::splat( f.fLong );
+    const Vec    vAlt0 = Ops::splat( f.fAlt );
+    const Vec    vNMPerDegLat = Ops::splat( f.fNMPerDegLat );
+    const Vec    vNMPerDegLong = Ops::splat( f.fNMPerDegLong );
+    const Vec    vCos = Ops::splat( f.fCosHead );
+    const Vec    vSin = Ops::splat( f.fSinHead );
+    const Vec    vPxPerNM = Ops::splat( f.fPxPerNM );
+    const Vec    vCenterX = Ops::splat( f.fCenterX );
+    const Vec    vCenterY = Ops::splat( f.fCenterY );
+    int          i;
+
+    for( i = iFrom; (i + Ops::Width) <= iCount; i += Ops::Width )
+    {
+        Vec  dLong, dX, dY, dist, sX, sY;
+        Vec  aX, aY, lo, hi, a, s, r;
+        Mask m;
+
+        // Offsets east and north in NM, the long way round never being the short way
+        dLong = Ops::sub( Ops::load( pLong + i ), vLong0 );
+        dLong = Ops::sub( dLong, Ops::select( Ops::gt( dLong, v180 ), v360, vZero ) );
+        dLong = Ops::add( dLong, Ops::select( Ops::lt( dLong, vNeg180 ), v360, vZero ) );
+        dX = Ops::mul( dLong, vNMPerDegLong );
+        dY = Ops::mul( Ops::sub( Ops::load( pLat + i ), vLat0 ), vNMPerDegLat );
+        dist = Ops::sqrt( Ops::add( Ops::mul( dX, dX ), Ops::mul( dY, dY ) ) );
+
+        // Rotate so the display heading is up; screen y grows downward
+        sX = Ops::sub( Ops::mul( dX, vCos ), Ops::mul( dY, vSin ) );
+        sY = Ops::add( Ops::mul( dY, vCos ), Ops::mul( dX, vSin ) );
+        Ops::store( pX + i, Ops::add( vCenterX, Ops::mul( sX, vPxPerNM ) ) );
+        Ops::store( pY + i, Ops::sub( vCenterY, Ops::mul( sY, vPxPerNM ) ) );
+        Ops::store( pDist + i, dist );
+        Ops::store( pAltDelta + i, Ops::sub( Ops::load( pAlt + i ), vAlt0 ) );
+
+        // Bearing is atan2( east, north ) folded onto 0 to 360
+        aX = Ops::abs( dY );
+        aY = Ops::abs( dX );
+        lo = Ops::min( aX, aY );
+        hi = Ops::max( Ops::max( aX, aY ), vTiny );
+        a = Ops::div( lo, hi );
+        s = Ops::mul( a, a );
+        r = Ops::add( Ops::mul( Ops::splat( s_fAtan9 ), s ), Ops::splat( s_fAtan7 ) );
+        r = Ops::add( Ops::mul( r, s ), Ops::splat( s_fAtan5 ) );
+        r = Ops::add( Ops::mul( r, s ), Ops::splat( s_fAtan3 ) );
+        r = Ops::add( Ops::mul( r, s ), Ops::splat( s_fAtan1 ) );
+        r = Ops::mul( r, a );
+        r = Ops::select( Ops::gt( aY, aX ), Ops::sub( vHalfPi, r ), r );
+        r = Ops::select( Ops::lt( dY, vZero ), Ops::sub( vPi, r ), r );
+        r = Ops::select( Ops::lt( dX, vZero ), Ops::neg( r ), r );
+        m = Ops::lt( r, vZero );
+        r = Ops::select( m, Ops::add( r, vTwoPi ), r );
+        Ops::store( pBearing + i, Ops::mul( r, vToDeg ) );
+    }
+
+    return i;
+}
+
+
+TrafficGeometry::Kernel TrafficGeometry::best()
+{
+#if defined( __AVX2__ )
+    return AVX2;
+#elif defined( __SSE2__ )
+    return SSE2;
+#elif defined( __ARM_NEON ) || defined( __ARM_NEON__ )
+    return NEON;
+#else
+    return Scalar;
+#endif
+}
+
+
+const char *TrafficGeometry::name( Kernel eKernel )
+{
+    switch( eKernel )
+    {
+        case SSE2:
+            return "SSE2";
+        case AVX2:
+            return "AVX2";
+        case NEON:
+            return "NEON";
+        case Scalar:
+            break;
+    }
+
+    return "scalar";
+}
+
+
+// A kernel that wasn't built in falls back to scalar
+void TrafficGeometry::compute( const TrafficArrays &in, const TrafficView &view, TrafficPlot *pOut, Kernel eKernel )
+{
+    TrafficFrame f;
+    int          iCount = in.fLat.count();
+    int          i = 0;
+    double       dNMPerDeg = 6371008.8 * MetersToNM * ToRad;     // Same earth as TrafficMath::haversine
+
+    pOut->fX.resize( iCount );
+    pOut->fY.resize( iCount );
+    pOut->fBearing.resize( iCount );
+    pOut->fDist.resize( iCount );
+    pOut->fAltDelta.resize( iCount );
+
+    f.fLat = static_cast<float>( view.dLat );
+    f.fLong = static_cast<float>( view.dLong );
+    f.fAlt = static_cast<float>( view.dAlt );
+    f.fNMPerDegLat = static_cast<float>( dNMPerDeg );
+    f.fNMPerDegLong = static_cast<float>( dNMPerDeg * fabs( cos( view.dLat * ToRad ) ) );
+    f.fCosHead = static_cast<float>( cos( view.dHeading * ToRad ) );
+    f.fSinHead = static_cast<float>( sin( view.dHeading * ToRad ) );
+    f.fPxPerNM = static_cast<float>( view.dPxPerNM );
+    f.fCenterX = static_cast<float>( view.dCenterX );
+    f.fCenterY = static_cast<float>( view.dCenterY );
+
+    switch( eKernel )
+    {
+#if defined( __AVX2__ )
+        case AVX2:
+            i = plot<AVX2Ops>( f, in, pOut, 0, iCount );
+            break;
+#endif
+#if defined( __SSE2__ )
+        case SSE2:
+            i = plot<SSE2Ops>( f, in, pOut, 0, iCount );
+            break;
+#endif
+#if defined( __ARM_NEON ) || defined( __ARM_NEON__ )
+        case NEON:
+            i = plot<NEONOps>( f, in, pOut, 0, iCount );
+            break;
+#endif
+        default:
+            break;
+    }
+    plot<ScalarOps>( f, in, pOut, i, iCount );
+}
@@ -4,11 +4,10 @@ Stratofier Stratux AHRS Display
 */
 
 #include <QtDebug>
-#include <QFile>
 #include <QSettings>
-#include <QDomDocument>
-#include <QDomElement>
-#include <QDomNode>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QtConcurrent>
 
 #include <math.h>
 
@@ -16,454 +15,293 @@ Stratofier Stratux AHRS Display
 #include "TrafficMath.h"
 #include "StratuxStreams.h"
 #include "Builder.h"
+#include "AirportCache.h"
+#include "AirportIndex.h"
+#include "AirspaceIndex.h"
+#include "AviationDB.h"
 
 
 extern StratuxSituation g_situation;
 extern QSettings       *g_pSet;
-extern bool             g_bNoAirportsUpdate;
 
 
 // This was implemented to cut down on the airport lookup by lat/long that takes long enough to be noticeable on the display (it's threaded but you can see it filling back in)
-QList<Airport>  g_airportCache;
-QList<Airspace> g_airspaceCache;
+// Reloading builds a new cache and index and swaps them in, so a reader holding the current one is never disturbed
+AirportDatabase  g_airportDB;
+AirspaceDatabase g_airspaceDB;
 
 
-// Find the distance and bearing from one lat/long to another
-BearingDist TrafficMath::haversine( double dLat1, double dLong1, double dLat2, double dLong2 )
+// Get every airport in the cache that's within twice the distance of the current heading indicator radius, plus any airport
+// being navigated to or from (direct, from and to in that order) wherever it is.
+// The list is built here and published whole; if a newer request comes in first this one gives up.
+void TrafficMath::updateNearbyAirports( NearbyAirports *pNearby, int iRequest, QList<Airport> nav, double dDist )
 {
-    BearingDist ret;
+    AirportDatabase::Ptr db = g_airportDB.current();
+    QVector<AirportHit>  hits;
+    QList<Airport>       airports;
+    int                  i, j;
 
-    double dRadiusEarth = 6371008.8;
-    double deltaLat = radiansRel( dLat2 - dLat1 );
-    double dAvgLat = radiansRel( (dLat2 + dLat1) / 2.0 );
-    double deltaLong = radiansRel( dLong2 - dLong1 );
-    double dDistN = deltaLat * dRadiusEarth;
-    double dDistE = deltaLong * dRadiusEarth * fabs( cos( dAvgLat ) );
+    dDist *= 2;
+    db->index.withinRange( g_situation.dGPSlat, g_situation.dGPSlong, dDist, &hits );
+    if( pNearby->isStale( iRequest ) )
+        return;
+    airports.reserve( hits.count() + nav.count() );
+    for( i = 0; i < hits.count(); i++ )
+    {
+        airports.append( db->airports.airport( hits.at( i ).iAirport ) );
+        airports.last().bd = hits.at( i ).bd;
+    }
 
-    ret.dDistance = pow( dDistN * dDistN + dDistE * dDistE, 0.5 ) * MetersToNM;
-    ret.dBearing  = degHeading( atan2( dDistE, dDistN ) );
+    for( i = 0; i < nav.count(); i++ )
+    {
+        const Airport &ap = nav.at( i );
 
-    while( ret.dBearing > 180 )
-        ret.dBearing -= 360;
-    while( ret.dBearing < -180 )
-        ret.dBearing += 360;
+        if( ap.qsID.isEmpty() || (ap.qsID == "NULL") || (findAirport( &ap, &airports ) < airports.count()) )
+            continue;
+        // Direct, from and to are often the same airport
+        for( j = 0; j < i; j++ )
+        {
+            if( nav.at( j ).qsID == ap.qsID )
+                break;
+        }
+        if( j < i )
+            continue;
+        airports.append( ap );
+        airports.last().bd = haversine( g_situation.dGPSlat, g_situation.dGPSlong, ap.dLat, ap.dLong );
+    }
 
-    return ret;
+    pNearby->publish( iRequest, airports );
 }
 
 
-// Normalize angle and convert to radians
-double TrafficMath::radiansRel( double dAng )
+// The closest airport if it's within 2 NM of ownship
+Airport TrafficMath::getCurrentAirport()
 {
-    while( dAng > 180 )
-        dAng -= 360;
-    while( dAng < -180 )
-        dAng += 360;
+    AirportDatabase::Ptr db = g_airportDB.current();
+    QVector<AirportHit>  hits;
+    Airport              ap;
+    int                  iClosest = -1;
+    int                  i;
+
+    // Only the cells within 2 NM are looked at; nearest() would keep widening until it found something
+    db->index.withinRange( g_situation.dGPSlat, g_situation.dGPSlong, 2.0, &hits );
+    for( i = 0; i < hits.count(); i++ )
+    {
+        if( (iClosest < 0) || (hits.at( i ).bd.dDistance < hits.at( iClosest ).bd.dDistance) )
+            iClosest = i;
+    }
+    if( iClosest >= 0 )
+    {
+        ap = db->airports.airport( hits.at( iClosest ).iAirport );
+        ap.bd = hits.at( iClosest ).bd;
+    }
 
-    return dAng * ToRad;
+    return ap;
 }
 
 
-// Normalize heading angle and convert to degrees
-double TrafficMath::degHeading( double dAng )
+// Only the vertices of the level of detail that fits dNMPerPx get transformed, so zoomed out it's the same sort of vertex
+// count across many more airspaces as zoomed in across a few
+void TrafficMath::updateNearbyAirspaces( NearbyAirspaces *pNearby, int iRequest, double dDist, double dNMPerPx )
 {
-    while( dAng < 0 )
-        dAng += TwoPi;
-
-    return dAng * ToDeg;
-}
+    AirspaceDatabase::Ptr db = g_airspaceDB.current();
+    Airspace              as;
+    QList<Airspace>       airspaces;
+    QVector<int>          candidates;
+    QVector<double>       lat;
+    QVector<double>       lon;
+    QVector<BearingDist>  center;
+    int                   iLevel = shapeLevel( dNMPerPx );
+    int                   i, j;
 
+    dDist *= 4.0;
 
-// Get every airport in the cache that's within twice the distance of the current heading indicator radius
-void TrafficMath::updateNearbyAirports( QList<Airport> *pAirports, Airport *pDirect, Airport *pFrom, Airport *pTo, double dDist )
-{
-    Airport ap;
+    // Only airspaces whose middle is near enough get every vertex transformed; the index narrows it down to the ones whose
+    // bounds reach the range, which is every one whose middle could be in it
+    db->index.overlapping( g_situation.dGPSlat, g_situation.dGPSlong, dDist, &candidates );
+    lat.resize( candidates.count() );
+    lon.resize( candidates.count() );
+    center.resize( candidates.count() );
+    for( i = 0; i < candidates.count(); i++ )
+    {
+        lat[i] = db->airspaces.at( candidates.at( i ) ).center.y();
+        lon[i] = db->airspaces.at( candidates.at( i ) ).center.x();
+    }
+    haversine( g_situation.dGPSlat, g_situation.dGPSlong, lat.constData(), lon.constData(), center.data(), center.count() );
 
-    pAirports->clear();
-    dDist *= 2;
-    foreach( ap, g_airportCache )
+    // Build a list of points that are vectors; the polygons are the expensive part so check between them for a newer request
+    for( i = 0; i < candidates.count(); i++ )
     {
-        ap.bd = TrafficMath::haversine( g_situation.dGPSlat, g_situation.dGPSlong, ap.dLat, ap.dLong );
+        if( center.at( i ).dDistance > dDist )
+            continue;
+        if( pNearby->isStale( iRequest ) )
+            return;
 
-        if( (ap.bd.dDistance <= dDist) || (ap.qsID == pDirect->qsID) || (ap.qsID == pFrom->qsID) || (ap.qsID == pTo->qsID) )
-            pAirports->append( ap );
+        as = db->airspaces.at( candidates.at( i ) );
+        lat.clear();
+        lon.clear();
+        for( j = 0; j < as.shape.count(); j++ )
+        {
+            if( as.shapeLevels.at( j ) < iLevel )
+                continue;
+            lat.append( as.shape.at( j ).y() );
+            lon.append( as.shape.at( j ).x() );
+            as.shapeHavLevels.append( as.shapeLevels.at( j ) );
+        }
+        as.shapeHav.resize( lat.count() );
+        haversine( g_situation.dGPSlat, g_situation.dGPSlong, lat.constData(), lon.constData(), as.shapeHav.data(), lat.count() );
+        airspaces.append( as );
     }
+
+    pNearby->publish( iRequest, airspaces );
 }
 
 
-Airport TrafficMath::getCurrentAirport()
+int TrafficMath::findAirport( const Airport *pAirport, const QList<Airport> *apList )
 {
-    Airport ap;
+    int iIndex;
 
-    foreach( ap, g_airportCache )
+    for( iIndex = 0; iIndex < apList->count(); iIndex++ )
     {
-        ap.bd = TrafficMath::haversine( g_situation.dGPSlat, g_situation.dGPSlong, ap.dLat, ap.dLong );
-
-        // The first airport within 2 NM of ownship
-        if( ap.bd.dDistance <= 2 )
+        if( apList->at( iIndex ).qsID == pAirport->qsID )
             break;
     }
 
-    return ap;
+    return iIndex;
 }
 
 
-void TrafficMath::updateNearbyAirspaces( QList<Airspace> *pAirspaces, double dDist )
+// One country's airports or airspace, loaded on a thread of its own
+struct CountryAirports
 {
-    Airspace    as;
-    BearingDist bd;
-    QPointF     pt;
+    bool         bLoaded;
+    AirportCache airports;
+    AirportIndex index;
+};
 
-    pAirspaces->clear();
-    dDist *= 4.0;
 
-    // Build a list of points that are vectors
-    foreach( as, g_airspaceCache )
-    {
-        pt = as.shape.boundingRect().center();
-        bd = TrafficMath::haversine( g_situation.dGPSlat, g_situation.dGPSlong, pt.y(), pt.x() );
+struct CountryAirspaces
+{
+    bool            bLoaded;
+    QList<Airspace> airspaces;
+    AirspaceIndex   index;
+};
 
-        as.shapeHav.clear();
-        if( bd.dDistance <= dDist )
-        {
-            foreach( pt, as.shape )
-            {
-                bd = TrafficMath::haversine( g_situation.dGPSlat, g_situation.dGPSlong, pt.y(), pt.x() );
-                as.shapeHav.append( bd );
-            }
-            pAirspaces->append( as );
-        }
-    }
+
+static CountryAirports loadCountryAirports( const QString &qsFile )
+{
+    CountryAirports country;
+    QElapsedTimer   timer;
+
+    timer.start();
+    country.bLoaded = AviationDB::loadAirports( qsFile, &country.airports, &country.index );
+    if( country.bLoaded )
+        qInfo() << "Loaded" << country.airports.count() << "airports from" << QFileInfo( qsFile ).fileName() << "in" << timer.elapsed() << "ms";
+    else
+        qWarning() << "Unable to load airports from" << qsFile;
+
+    return country;
 }
 
 
-int TrafficMath::findAirport( Airport *pAirport, QList<Airport> *apList )
+static CountryAirspaces loadCountryAirspaces( const QString &qsFile )
 {
-    Airport ap;
-    int     iIndex = 0;
+    CountryAirspaces country;
+    QElapsedTimer    timer;
 
-    foreach( ap, *apList )
-    {
-        if( ap.qsID == pAirport->qsID )
-            break;
-        iIndex++;
-    }
+    timer.start();
+    country.bLoaded = AviationDB::loadAirspaces( qsFile, &country.airspaces, &country.index );
+    if( country.bLoaded )
+        qInfo() << "Loaded" << country.airspaces.count() << "airspaces from" << QFileInfo( qsFile ).fileName() << "in" << timer.elapsed() << "ms";
+    else
+        qWarning() << "Unable to load airspaces from" << qsFile;
 
-    return iIndex;
+    return country;
 }
 
 
+// Every selected country's file is loaded in parallel across the thread pool. blockingMapped has this thread take a share
+// of the work too, so it can't starve waiting on a pool it's already holding a thread of.
 void TrafficMath::cacheAirports()
 {
     QString                                    qsInternal;
-    QFile                                      aipDatabase;
     QMap<Canvas::CountryCodeAirports, QString> urlMap;
+    QStringList                                qslFiles;
+    QList<CountryAirports>                     loaded;
+    AirportData                                merged;
+    int                                        iRequest = g_airportDB.request();
+    int                                        iLoaded;
 
     Builder::populateUrlMapAirports( &urlMap );
 
     QVariantList countries = g_pSet->value( "CountryAirports", QVariantList() ).toList();
     QVariant     country;
 
-    g_airportCache.clear();
     foreach( country, countries )
     {
         Builder::getStorage( &qsInternal );
         qsInternal.append( QString( "/data/space.skyfun.stratofier/%1.aip" )
                                 .arg( urlMap[static_cast<Canvas::CountryCodeAirports>( country.toInt() )] ) );
+        qslFiles.append( qsInternal );
+    }
+    loaded = QtConcurrent::blockingMapped<QList<CountryAirports> >( qslFiles, loadCountryAirports );
 
-        aipDatabase.setFileName( qsInternal );
-
-        if( !aipDatabase.open( QIODevice::ReadOnly ) )
-            return;
-
-        QDomDocument aipDoc( "XML_OpenAIP" );
-        QDomElement  xRoot, xAirportElem, xChildElem, xSubChildElem, xWayPtElem;
-        QDomNode     xAirportNode, xChildNode, xSubChildNode, xWayPtNode;
-        QString      qsTemp, qsErrMsg;
-        Airport      ap;
-        int          iErrLine, iErrCol;
-
-        if( !aipDoc.setContent( &aipDatabase, &qsErrMsg, &iErrLine, &iErrCol ) )
-        {
-            qDebug() << qsErrMsg << iErrLine << iErrCol;
-            aipDatabase.close();
-            return;
-        }
-        aipDatabase.close();
-
-        xRoot = aipDoc.documentElement();
-
-        // Don't proceed if this isn't an OpenAIP file
-        if( xRoot.tagName() != "OPENAIP" )
-            return;
-
-        // Total test points in test results file
-        xWayPtNode = xRoot.firstChild();
-
-        while( !xWayPtNode.isNull() )
-        {
-            xWayPtElem = xWayPtNode.toElement();
-            if( xWayPtElem.tagName() == "WAYPOINTS" )
-            {
-                xAirportNode = xWayPtNode.firstChild();
-                while( !xAirportNode.isNull() )
-                {
-                    xAirportElem = xAirportNode.toElement();
-                    if( (xAirportElem.tagName() == "AIRPORT") && (xAirportElem.attribute( "TYPE" ) != "HELI_CIVIL") )
-                    {
-                        ap.bd.dBearing = 0.0;
-                        ap.bd.dDistance = 0.0;
-                        ap.dLat = 0.0;
-                        ap.dLong = 0.0;
-                        ap.dElev = 0.0;
-                        ap.bGrass = false;
-                        ap.qsID.clear();
-                        ap.runways.clear();
-                        ap.frequencies.clear();
-
-                        xChildNode = xAirportNode.firstChild();
-                        while( !xChildNode.isNull() )
-                        {
-                            Frequency f;
-
-                            xChildElem = xChildNode.toElement();
-                            if( xChildElem.tagName() == "ICAO" )
-                                ap.qsID = xChildElem.text();
-                            else if( xChildElem.tagName() == "NAME" )
-                            {
-                                ap.qsName = xChildElem.text();
-                                // Clean up really long names
-                                ap.qsName.replace( "REGIONAL", "RGNL" );
-                                ap.qsName.replace( "EXECUTIVE", "EXEC" );
-                                ap.qsName.replace( "INTERNATIONAL", "INTL" );
-                                ap.qsName.replace( "AERODROME", "AERO" );
-                                ap.qsName.replace( "BALLOONPORT", "BALLOON" );
-                                ap.qsName.remove( "AIRPORT" );
-                                ap.qsName.remove( "FIELD" );
-                            }
-                            else if( xChildElem.tagName() == "GEOLOCATION" )
-                            {
-                                xSubChildNode = xChildNode.firstChild();
-                                while( !xSubChildNode.isNull() )
-                                {
-                                    xSubChildElem = xSubChildNode.toElement();
-                                    if( xSubChildElem.tagName() == "LAT" )
-                                        ap.dLat = xSubChildElem.text().toDouble();
-                                    else if( xSubChildElem.tagName() == "LON" )
-                                        ap.dLong = xSubChildElem.text().toDouble();
-                                    else if( xSubChildElem.tagName() == "ELEV" )
-                                    {
-                                        if( xSubChildElem.attribute( "UNIT" ).contains( "M", Qt::CaseInsensitive ) )
-                                            ap.dElev = xSubChildElem.text().toDouble() * MetersToFeet;
-                                        else
-                                            ap.dElev = xSubChildElem.text().toDouble();
-                                    }
-                                    xSubChildNode = xSubChildNode.nextSibling();
-                                }
-                            }
-                            else if( xChildElem.tagName() == "RWY" )
-                            {
-                                xSubChildNode = xChildNode.firstChild();
-                                while( !xSubChildNode.isNull() )
-                                {
-                                    xSubChildElem = xSubChildNode.toElement();
-                                    if( xSubChildElem.tagName() == "SFC" )
-                                    {
-                                        if( xSubChildElem.text() == "GRAS" )
-                                            ap.bGrass = true;
-                                    }
-                                    else if( xSubChildElem.tagName() == "DIRECTION" )
-                                        ap.runways.append( xSubChildElem.attribute( "TC" ).toInt() );
-                                    xSubChildNode = xSubChildNode.nextSibling();
-                                }
-                            }
-                            else if( xChildElem.tagName() == "RADIO" )
-                            {
-                                xSubChildNode = xChildNode.firstChild();
-                                while( !xSubChildNode.isNull() )
-                                {
-                                    xSubChildElem = xSubChildNode.toElement();
-                                    if( xSubChildElem.tagName() == "FREQUENCY" )
-                                    {
-                                        f.dFreq = xSubChildElem.text().toDouble();
-                                    }
-                                    else if( xSubChildElem.tagName() == "DESCRIPTION" )
-                                    {
-                                        f.qsDescription = xSubChildElem.text();
-                                    }
-                                    xSubChildNode = xSubChildNode.nextSibling();
-                                }
-                                ap.frequencies.append( f );
-                            }
-                            xChildNode = xChildNode.nextSibling();
-                        }
-                        if( ap.qsID.isEmpty() )
-                            ap.qsID = "R";
-                        g_airportCache.append( ap );    // Note the cache has no haversine transforms to get the bearing and distance since that's handled by updateNearbyAirports
-                    }
-                    xAirportNode = xAirportNode.nextSibling();
-                }
-            }
-            xWayPtNode = xWayPtNode.nextSibling();
-        }
+    // Merged in the order the countries were selected, stopping at the first that failed as the one at a time load did
+    for( iLoaded = 0; iLoaded < loaded.count(); iLoaded++ )
+    {
+        if( !loaded.at( iLoaded ).bLoaded )
+            break;
+        merged.airports.append( loaded.at( iLoaded ).airports );    // Note the cache has no haversine transforms to get the bearing and distance since that's handled by updateNearbyAirports
     }
+    merged.airports.squeeze();
+    qInfo() << "Airport cache:" << merged.airports.count() << "airports in" << (merged.airports.bytes() / 1024) << "kB";
+
+    // A single country's index comes ready built from its database; otherwise whatever made it in gets indexed together,
+    // even if a country further down the list failed to load
+    if( iLoaded == 1 )
+        merged.index = loaded.first().index;
+    else
+        merged.index.build( merged.airports );
+
+    // A reload started since this one wins
+    g_airportDB.publish( iRequest, merged );
 }
 
 
 void TrafficMath::cacheAirspaces()
 {
     QString                                    qsInternal;
-    QFile                                      aipDatabase;
     QMap<Canvas::CountryCodeAirspace, QString> urlMap;
+    QStringList                                qslFiles;
+    QList<CountryAirspaces>                    loaded;
+    AirspaceData                               merged;
+    int                                        iRequest = g_airspaceDB.request();
+    int                                        iLoaded;
 
     Builder::populateUrlMapAirspaces( &urlMap );
 
     QVariantList countries = g_pSet->value( "CountryAirspaces", QVariantList() ).toList();
     QVariant     country;
 
-    g_airspaceCache.clear();
-    Builder::getStorage( &qsInternal );
-
     foreach( country, countries )
     {
         Builder::getStorage( &qsInternal );
         qsInternal.append( QString( "/data/space.skyfun.stratofier/%1.aip" ).arg( urlMap[static_cast<Canvas::CountryCodeAirspace>( country.toInt() )] ) );
+        qslFiles.append( qsInternal );
+    }
+    loaded = QtConcurrent::blockingMapped<QList<CountryAirspaces> >( qslFiles, loadCountryAirspaces );
 
-        aipDatabase.setFileName( qsInternal );
-
-        if( !aipDatabase.open( QIODevice::ReadOnly ) )
-            return;
-
-        QDomDocument aipDoc( "XML_OpenAIP" );
-        QDomElement  xRoot, xWayPtElem, xAirspaceElem, xChildElem, xSubChildElem;
-        QDomNode     xWayPtNode, xAirspaceNode, xChildNode, xSubChildNode;
-        QString      qsTemp, qsErrMsg;
-        Airspace     as;
-        int          iErrLine, iErrCol;
-
-        if( !aipDoc.setContent( &aipDatabase, &qsErrMsg, &iErrLine, &iErrCol ) )
-        {
-            qDebug() << qsErrMsg << iErrLine << iErrCol;
-            aipDatabase.close();
-            return;
-        }
-        aipDatabase.close();
-
-        xRoot = aipDoc.documentElement();
-
-        // Don't proceed if this isn't an OpenAIP file
-        if( xRoot.tagName() != "OPENAIP" )
-            return;
+    for( iLoaded = 0; iLoaded < loaded.count(); iLoaded++ )
+    {
+        if( !loaded.at( iLoaded ).bLoaded )
+            break;
+        merged.airspaces.append( loaded.at( iLoaded ).airspaces );
+    }
 
-        // Total test points in test results file
-        xWayPtNode = xRoot.firstChild();
+    if( iLoaded == 1 )
+        merged.index = loaded.first().index;
+    else
+        merged.index.build( merged.airspaces );
 
-        while( !xWayPtNode.isNull() )
-        {
-            xWayPtElem = xWayPtNode.toElement();
-            if( xWayPtElem.tagName() == "AIRSPACES" )
-            {
-                xAirspaceNode = xWayPtNode.firstChild();
-                while( !xAirspaceNode.isNull() )
-                {
-                    xAirspaceElem = xAirspaceNode.toElement();
-                    if( xAirspaceElem.tagName() == "ASP" )
-                    {
-                        as.qsName.clear();
-                        as.eType = Canvas::Airspace_Class_G;
-                        as.iAltTop = 0;
-                        as.iAltBottom = 0;
-                        as.shape.clear();
-
-                        QString qsTemp = xAirspaceElem.attribute( "CATEGORY" );
-
-                        if( qsTemp == "G" )
-                            as.eType = Canvas::Airspace_Class_G;
-                        else if( qsTemp == "E" )
-                            as.eType = Canvas::Airspace_Class_E;
-                        else if( qsTemp == "D" )
-                            as.eType = Canvas::Airspace_Class_D;
-                        else if( qsTemp == "C" )
-                            as.eType = Canvas::Airspace_Class_C;
-                        // The AIP database doesn't distinguish between MOA, TFR and SFRA types; most can be resolved by the name but those that can't will
-                        // remain assigned to this unofficial type and should probably be colored the same as Restricted or Prohibited
-                        else if( qsTemp == "DANGER" )
-                            as.eType = Canvas::Airspace_Danger;
-                        else if( qsTemp == "PROHIBITED" )
-                            as.eType = Canvas::Airspace_Prohibited;
-                        else if( qsTemp == "RESTRICTED" )
-                            as.eType = Canvas::Airspace_Restricted;
-
-                        xChildNode = xAirspaceNode.firstChild();
-                        while( !xChildNode.isNull() )
-                        {
-                            xChildElem = xChildNode.toElement();
-                            if( xChildElem.tagName() == "NAME" )
-                            {
-                                as.qsName = xChildElem.text();
-                                // Try to resolve the ambiguous "DANGER" category to what it really is
-                                if( as.qsName.contains( "MOA" ) || as.qsName.contains( "BY NOTAM" ) )
-                                    as.eType = Canvas::Airspace_MOA;
-                                else if( as.qsName.contains( "TFR" ) )
-                                    as.eType = Canvas::Airspace_TFR;
-                                else if( as.qsName.contains( "SFRA" ) )
-                                    as.eType = Canvas::Airspace_SFRA;
-                            }
-                            else if( xChildElem.tagName() == "ALTLIMIT_TOP" )
-                            {
-                                xSubChildNode = xChildNode.firstChild();
-                                while( !xSubChildNode.isNull() )
-                                {
-                                    xSubChildElem = xSubChildNode.toElement();
-                                    if( xSubChildElem.tagName() == "ALT" )
-                                        as.iAltTop = xSubChildElem.text().toInt();  // Assume feet
-                                    xSubChildNode = xSubChildNode.nextSibling();
-                                }
-                            }
-                            else if( xChildElem.tagName() == "ALTLIMIT_BOTTOM" )
-                            {
-                                xSubChildNode = xChildNode.firstChild();
-                                while( !xSubChildNode.isNull() )
-                                {
-                                    xSubChildElem = xSubChildNode.toElement();
-                                    if( xSubChildElem.tagName() == "ALT" )
-                                        as.iAltBottom = xSubChildElem.text().toInt();  // Assume feet
-                                    xSubChildNode = xSubChildNode.nextSibling();
-                                }
-                            }
-                            else if( xChildElem.tagName() == "GEOMETRY" )
-                            {
-                                xSubChildNode = xChildNode.firstChild();
-                                while( !xSubChildNode.isNull() )
-                                {
-                                    xSubChildElem = xSubChildNode.toElement();
-                                    if( xSubChildElem.tagName() == "POLYGON" )
-                                    {
-                                        qsTemp = xSubChildElem.text();
-
-                                        QStringList qslPolyCoords = qsTemp.split( ',' );
-                                        QString     qsCoordPair;
-
-                                        foreach( qsCoordPair, qslPolyCoords )
-                                        {
-                                            qsCoordPair = qsCoordPair.trimmed();
-
-                                            QStringList qslCoords = qsCoordPair.split( ' ' );
-                                            if( qslCoords.count() == 2 )
-                                                as.shape.append( QPointF( qslCoords.first().toDouble(), qslCoords.last().toDouble() ) );
-                                        }
-                                    }
-                                    xSubChildNode = xSubChildNode.nextSibling();
-                                }
-                            }
-                            xChildNode = xChildNode.nextSibling();
-                        }
-                        g_airspaceCache.append( as );    // Note the cache has no haversine transforms to get the bearing and distance since that's handled by updateNearbyAirports
-                    }
-                    xAirspaceNode = xAirspaceNode.nextSibling();
-                }
-            }
-            xWayPtNode = xWayPtNode.nextSibling();
-        }
-    }
+    g_airspaceDB.publish( iRequest, merged );
 }
@@ -0,0 +1,319 @@
+/*
+Stratofier Stratux AHRS Display
+(c) 2018 Allen K. Lair, Sky Fun
+*/
+
+#include "TrafficTable.h"
+
+
+static const int s_iInitialBuckets = 64;   // Power of two
+
+
+// Fibonacci hashing; addresses from one block are often sequential so the low bits alone would cluster
+static inline int bucket( int iICAO, int iMask )
+{
+    return static_cast<int>( (static_cast<quint32>( iICAO ) * 2654435761u) >> 8 ) & iMask;
+}
+
+
+TrafficTable::TrafficTable()
+    : m_iCount( 0 ),
+      m_iTimeoutSecs( 0 ),
+      m_iWheelSec( -1 ),
+      m_uiAdded( 0 ),
+      m_uiRefreshed( 0 ),
+      m_uiExpired( 0 )
+{
+    m_index.fill( -1, s_iInitialBuckets );
+    setTimeout( 30 );
+}
+
+
+// Seconds without a report before an aircraft is dropped. Aircraft already in the table keep their current expiry until they next report.
+void TrafficTable::setTimeout( int iSecs )
+{
+    int iBuckets = 4;
+
+    m_iTimeoutSecs = qMax( iSecs, 1 );
+
+    // The wheel has to span the whole timeout so a live aircraft is never in a bucket being expired
+    while( iBuckets < (m_iTimeoutSecs + 2) )
+        iBuckets *= 2;
+    if( iBuckets == m_wheel.count() )
+        return;
+
+    m_wheel.fill( -1, iBuckets );
+    for( int i = 0; i < m_slots.count(); i++ )
+    {
+        if( m_bUsed.at( i ) )
+            schedule( i, m_links.at( i ).iExpireSec );
+    }
+}
+
+
+// Bucket holding the address or the empty bucket where it would go
+int TrafficTable::indexOf( int iICAO ) const
+{
+    int iMask = m_index.count() - 1;
+    int iBucket = bucket( iICAO, iMask );
+    int iSlot;
+
+    while( (iSlot = m_index.at( iBucket )) >= 0 )
+    {
+        if( m_slots.at( iSlot ).iICAO == iICAO )
+            break;
+        iBucket = (iBucket + 1) & iMask;
+    }
+
+    return iBucket;
+}
+
+
+// Store the latest report for the aircraft, taking a slot if it's new, and push its expiry out
+void TrafficTable::update( const StratuxTraffic &traffic, qint64 iNowMs )
+{
+    int iBucket = indexOf( traffic.iICAO );
+    int iSlot = m_index.at( iBucket );
+
+    if( m_iWheelSec < 0 )
+        m_iWheelSec = (iNowMs / 1000) - 1;
+
+    if( iSlot >= 0 )
+    {
+        m_slots[iSlot] = traffic;
+        storeArrays( iSlot, traffic );
+        unschedule( iSlot );
+        schedule( iSlot, (iNowMs / 1000) + m_iTimeoutSecs );
+        m_uiRefreshed++;
+        return;
+    }
+
+    if( m_freeSlots.isEmpty() )
+    {
+        WheelLink link = { 0, -1, -1 };
+
+        iSlot = m_slots.count();
+        m_slots.append( traffic );
+        m_bUsed.append( true );
+        m_links.append( link );
+        m_arrays.fLat.append( 0.0f );
+        m_arrays.fLong.append( 0.0f );
+        m_arrays.fAlt.append( 0.0f );
+        m_arrays.fTrack.append( 0.0f );
+        m_arrays.fSpeed.append( 0.0f );
+        m_arrays.uiFlags.append( 0 );
+    }
+    else
+    {
+        iSlot = m_freeSlots.takeLast();
+        m_slots[iSlot] = traffic;
+        m_bUsed[iSlot] = true;
+    }
+    storeArrays( iSlot, traffic );
+    m_index[iBucket] = iSlot;
+    schedule( iSlot, (iNowMs / 1000) + m_iTimeoutSecs );
+    m_iCount++;
+    m_uiAdded++;
+
+    // Keep the load at or under one half so probe runs stay short
+    if( (m_iCount * 2) > m_index.count() )
+        grow();
+}
+
+
+// Drop everything that has gone stale; returns how many went
+int TrafficTable::expire( qint64 iNowMs )
+{
+    qint64 iNowSec = iNowMs / 1000;
+    qint64 iSec;
+    int    iMask = m_wheel.count() - 1;
+    int    iExpired = 0;
+    int    iSlot, iNext;
+
+    if( m_iWheelSec < 0 )
+    {
+        m_iWheelSec = iNowSec - 1;
+        return 0;
+    }
+
+    // After a long stall one turn of the wheel covers everything
+    iSec = qMax( m_iWheelSec + 1, iNowSec - m_wheel.count() );
+    for( ; iSec < iNowSec; iSec++ )
+    {
+        iSlot = m_wheel.at( static_cast<int>( iSec & iMask ) );
+        while( iSlot >= 0 )
+        {
+            iNext = m_links.at( iSlot ).iNext;
+            // Only a stall can leave an aircraft from a later turn of the wheel in here
+            if( m_links.at( iSlot ).iExpireSec <= iSec )
+            {
+                removeSlot( indexOf( m_slots.at( iSlot ).iICAO ) );
+                iExpired++;
+            }
+            iSlot = iNext;
+        }
+    }
+    m_iWheelSec = iNowSec - 1;
+    m_uiExpired += static_cast<quint32>( iExpired );
+
+    return iExpired;
+}
+
+
+StratuxTraffic *TrafficTable::find( int iICAO )
+{
+    int iSlot = m_index.at( indexOf( iICAO ) );
+
+    return (iSlot >= 0) ? &m_slots[iSlot] : nullptr;
+}
+
+
+bool TrafficTable::remove( int iICAO )
+{
+    int iBucket = indexOf( iICAO );
+
+    if( m_index.at( iBucket ) < 0 )
+        return false;
+    removeSlot( iBucket );
+
+    return true;
+}
+
+
+// Free the slot in the given hash bucket.
+// Backward shift delete: entries after the hole that would have probed past it move back so no tombstones are needed.
+void TrafficTable::removeSlot( int iHole )
+{
+    int iMask = m_index.count() - 1;
+    int iSlot = m_index.at( iHole );
+    int iNext, iHome;
+
+    unschedule( iSlot );
+    m_bUsed[iSlot] = false;
+    m_slots[iSlot] = StratuxTraffic();      // Drop the strings now rather than when the slot is reused
+    m_arrays.uiFlags[iSlot] = 0;
+    m_freeSlots.append( iSlot );
+    m_iCount--;
+
+    iNext = (iHole + 1) & iMask;
+    while( m_index.at( iNext ) >= 0 )
+    {
+        iHome = bucket( m_slots.at( m_index.at( iNext ) ).iICAO, iMask );
+        // Move it back unless its home bucket lies cyclically in (hole, next]
+        if( ((iNext > iHole) && ((iHome <= iHole) || (iHome > iNext))) ||
+            ((iNext < iHole) && ((iHome <= iHole) && (iHome > iNext))) )
+        {
+            m_index[iHole] = m_index.at( iNext );
+            iHole = iNext;
+        }
+        iNext = (iNext + 1) & iMask;
+    }
+    m_index[iHole] = -1;
+}
+
+
+void TrafficTable::clear()
+{
+    m_slots.clear();
+    m_bUsed.clear();
+    m_links.clear();
+    m_arrays = TrafficArrays();
+    m_freeSlots.clear();
+    m_index.fill( -1, s_iInitialBuckets );
+    m_wheel.fill( -1, m_wheel.count() );
+    m_iCount = 0;
+}
+
+
+// Screen position, bearing, distance and altitude difference for every slot; check arrays().uiFlags before using an entry.
+// The result stays valid until the next call.
+const TrafficPlot &TrafficTable::project( const TrafficView &view )
+{
+    TrafficGeometry::compute( m_arrays, view, &m_plot );
+
+    return m_plot;
+}
+
+
+TrafficTableStats TrafficTable::stats()
+{
+    TrafficTableStats stats;
+
+    stats.iCount = m_iCount;
+    stats.uiAdded = m_uiAdded;
+    stats.uiRefreshed = m_uiRefreshed;
+    stats.uiExpired = m_uiExpired;
+    m_uiAdded = 0;
+    m_uiRefreshed = 0;
+    m_uiExpired = 0;
+
+    return stats;
+}
+
+
+void TrafficTable::grow()
+{
+    int iMask = (m_index.count() * 2) - 1;
+    int iBucket;
+
+    m_index.fill( -1, iMask + 1 );
+    for( int i = 0; i < m_slots.count(); i++ )
+    {
+        if( !m_bUsed.at( i ) )
+            continue;
+        iBucket = bucket( m_slots.at( i ).iICAO, iMask );
+        while( m_index.at( iBucket ) >= 0 )
+            iBucket = (iBucket + 1) & iMask;
+        m_index[iBucket] = i;
+    }
+}
+
+
+void TrafficTable::storeArrays( int iSlot, const StratuxTraffic &traffic )
+{
+    quint8 uiFlags = TrafficUsed;
+
+    if( traffic.bHasADSB )
+        uiFlags |= TrafficHasPos;
+    if( traffic.bOnGround )
+        uiFlags |= TrafficOnGround;
+
+    m_arrays.fLat[iSlot] = static_cast<float>( traffic.dLat );
+    m_arrays.fLong[iSlot] = static_cast<float>( traffic.dLong );
+    m_arrays.fAlt[iSlot] = static_cast<float>( traffic.dAlt );
+    m_arrays.fTrack[iSlot] = static_cast<float>( traffic.dTrack );
+    m_arrays.fSpeed[iSlot] = static_cast<float>( traffic.dSpeed );
+    m_arrays.uiFlags[iSlot] = uiFlags;
+}
+
+
+// Link the slot onto the front of the bucket for the second it goes stale in.
+// Anything due in a second that's already been expired goes in the next one instead of waiting a whole turn.
+void TrafficTable::schedule( int iSlot, qint64 iExpireSec )
+{
+    WheelLink &link = m_links[iSlot];
+    int       *pHead;
+
+    link.iExpireSec = qMax( iExpireSec, m_iWheelSec + 1 );
+    pHead = &m_wheel[static_cast<int>( link.iExpireSec & (m_wheel.count() - 1) )];
+    link.iPrev = -1;
+    link.iNext = *pHead;
+    if( *pHead >= 0 )
+        m_links[*pHead].iPrev = iSlot;
+    *pHead = iSlot;
+}
+
+
+void TrafficTable::unschedule( int iSlot )
+{
+    WheelLink &link = m_links[iSlot];
+
+    if( link.iPrev >= 0 )
+        m_links[link.iPrev].iNext = link.iNext;
+    else
+        m_wheel[static_cast<int>( link.iExpireSec & (m_wheel.count() - 1) )] = link.iNext;
+    if( link.iNext >= 0 )
+        m_links[link.iNext].iPrev = link.iPrev;
+    link.iPrev = -1;
+    link.iNext = -1;
+}
@@ -0,0 +1,985 @@
+/*
+Stratofier Stratux AHRS Display
+(c) 2018 Allen K. Lair, Sky Fun
+*/
+
+#include <QtDebug>
+#include <QElapsedTimer>
+#include <QByteArray>
+#include <QDateTime>
+#include <QLineF>
+#include <QFile>
+#include <QMap>
+#include <QDomDocument>
+#include <QPixmap>
+#include <QPainter>
+#include <QImage>
+#include <QThreadPool>
+
+#include <string.h>
+#include <math.h>
+
+#include <algorithm>
+
+#include "Benchmark.h"
+#include "StreamReader.h"
+#include "GDL90.h"
+#include "StratuxParser.h"
+#include "TrafficMath.h"
+#include "TrafficTable.h"
+#include "AviationDB.h"
+#include "AirportCache.h"
+#include "Builder.h"
+#include "AHRSCanvas.h"
+#include "AHRSDraw.h"
+#include "StratofierDefs.h"
+
+
+// Representative messages as sent by Stratux v1.4+; see https://github.com/cyoung/stratux/blob/master/notes/app-vendor-integration.md
+static const char *s_szSituation =
+    "{\"GPSLastFixSinceMidnightUTC\":32304.2,\"GPSLatitude\":43.607,\"GPSLongitude\":-116.19,\"GPSFixQuality\":1,"
+    "\"GPSHeightAboveEllipsoid\":2578.41,\"GPSGeoidSep\":-54.46,\"GPSSatellites\":9,\"GPSSatellitesTracked\":11,"
+    "\"GPSSatellitesSeen\":10,\"GPSHorizontalAccuracy\":6.1,\"GPSNACp\":10,\"GPSAltitudeMSL\":2632.87,"
+    "\"GPSVerticalAccuracy\":12.2,\"GPSVerticalSpeed\":-0.3,\"GPSLastFixLocalTime\":\"0001-01-01T00:06:44.24Z\","
+    "\"GPSTrueCourse\":0,\"GPSTurnRate\":0,\"GPSGroundSpeed\":0,\"GPSLastGroundTrackTime\":\"0001-01-01T00:00:00Z\","
+    "\"GPSTime\":\"2017-09-26T08:58:24Z\",\"GPSLastGPSTimeStratuxTime\":\"0001-01-01T00:06:43.65Z\","
+    "\"GPSLastValidNMEAMessageTime\":\"0001-01-01T00:06:44.24Z\","
+    "\"GPSLastValidNMEAMessage\":\"$PUBX,04,085824.00,260917,291504.00,1967,18,-1061671,-181.285,21*13\","
+    "\"GPSPositionSampleRate\":0,\"BaroTemperature\":37.02,\"BaroPressureAltitude\":153.32,\"BaroVerticalSpeed\":1.3,"
+    "\"BaroLastMeasurementTime\":\"0001-01-01T00:06:44.23Z\",\"AHRSPitch\":-0.97,\"AHRSRoll\":-2.36,"
+    "\"AHRSGyroHeading\":187.7,\"AHRSMagHeading\":3276.7,\"AHRSSlipSkid\":0.52,\"AHRSTurnRate\":3276.7,"
+    "\"AHRSGLoad\":0.99,\"AHRSGLoadMin\":0.99,\"AHRSGLoadMax\":1.78,\"AHRSLastAttitudeTime\":\"0001-01-01T00:06:44.28Z\","
+    "\"AHRSStatus\":7}";
+
+static const char *s_szTraffic =
+    "{\"Icao_addr\":11160045,\"Reg\":\"N761UP\",\"Tail\":\"N761UP\",\"Emitter_category\":1,\"OnGround\":false,"
+    "\"Addr_type\":0,\"TargetType\":1,\"SignalLevel\":-28.21023052706831,\"Squawk\":1200,\"Position_valid\":true,"
+    "\"Lat\":43.55,\"Lng\":-116.2,\"Alt\":4400,\"GnssDiffFromBaroAlt\":25,\"AltIsGNSS\":false,\"NIC\":8,\"NACp\":10,"
+    "\"Track\":220,\"Speed\":97,\"Speed_valid\":true,\"Vvel\":-64,\"Timestamp\":\"2017-09-26T09:03:47.614Z\","
+    "\"PriorityStatus\":0,\"Age\":1.71,\"AgeLastAlt\":1.71,\"Last_seen\":\"0001-01-01T00:11:09.66Z\","
+    "\"Last_alt\":\"0001-01-01T00:11:09.66Z\",\"Last_GnssDiff\":\"0001-01-01T00:11:09.66Z\",\"Last_GnssDiffAlt\":4400,"
+    "\"Last_speed\":\"0001-01-01T00:11:09.66Z\",\"Last_source\":1,\"ExtrapolatedPosition\":false,"
+    "\"BearingDist_valid\":true,\"Bearing\":148.4,\"Distance\":12151.5}";
+
+static const char *s_szStatus =
+    "{\"Version\":\"v1.4r5\",\"Build\":\"0f4ab3a\",\"HardwareBuild\":\"\",\"Devices\":2,\"Connected_Users\":1,"
+    "\"DiskBytesFree\":1520656384,\"UAT_messages_last_minute\":0,\"UAT_messages_max\":0,\"ES_messages_last_minute\":107,"
+    "\"ES_messages_max\":1130,\"UAT_traffic_targets_tracking\":0,\"ES_traffic_targets_tracking\":3,"
+    "\"Ping_connected\":false,\"UATRadio_connected\":false,\"GPS_satellites_locked\":8,\"GPS_satellites_seen\":10,"
+    "\"GPS_satellites_tracked\":12,\"GPS_position_accuracy\":4.4,\"GPS_connected\":true,\"GPS_solution\":\"3D GPS + SBAS\","
+    "\"GPS_detected_type\":55,\"Uptime\":494270,\"UptimeClock\":\"0001-01-01T00:08:14.27Z\",\"CPUTemp\":50.464,"
+    "\"NetworkDataMessagesSent\":250,\"Errors\":[],\"Logfile_Size\":0,\"BMPConnected\":true,\"IMUConnected\":true}";
+
+
+extern StratuxSituation g_situation;
+extern TrafficTable     g_trafficTable;
+
+
+int Benchmark::run( const QString &qsWhat, double dBudgetMs )
+{
+    if( qsWhat == "streams" )
+        streams();
+    else if( qsWhat == "gdl90" )
+        gdl90();
+    else if( qsWhat == "timestamps" )
+        timestamps();
+    else if( qsWhat == "traffic" )
+        traffic();
+    else if( qsWhat == "haversine" )
+        return haversine() ? 0 : 2;
+    else if( qsWhat == "openaip" )
+        openaip();
+    else if( qsWhat == "numbers" )
+        numbers();
+    else if( qsWhat == "render" )
+        return render( dBudgetMs ) ? 0 : 2;
+    else
+    {
+        qWarning() << "Unknown benchmark" << qsWhat;
+        return 1;
+    }
+
+    return 0;
+}
+
+
+static void report( const char *szName, int iCount, qint64 iNanoSecs )
+{
+    qInfo() << QString( "%1 x%2  %3 ms  %4 us each" )
+                   .arg( QString( szName ), -24 )
+                   .arg( iCount )
+                   .arg( static_cast<double>( iNanoSecs ) / 1000000.0, 0, 'f', 1 )
+                   .arg( static_cast<double>( iNanoSecs ) / 1000.0 / static_cast<double>( iCount ), 0, 'f', 2 )
+                   .toLatin1().constData();
+}
+
+
+// Split based text parsing against the byte level parser for each of the three websocket streams.
+// The split runs go through StreamReader's split parser, which now hands each field to the same tables the byte parser
+// uses, so they measure the split plus table dispatch rather than the original if/else chains.
+void Benchmark::streams()
+{
+    StreamReader  reader( "127.0.0.1" );   // Streams are never connected; only the parsing slots are driven
+    QString       qsSituation( s_szSituation ), qsTraffic( s_szTraffic ), qsStatus( s_szStatus );
+    QByteArray    situation( s_szSituation ), traffic( s_szTraffic ), status( s_szStatus );
+    QElapsedTimer timer;
+    int           iCount = 20000;
+    int           i;
+
+    timer.start();
+    for( i = 0; i < iCount; i++ )
+        reader.situationUpdate( qsSituation );
+    report( "situation split+table", iCount, timer.nsecsElapsed() );
+
+    timer.restart();
+    for( i = 0; i < iCount; i++ )
+        reader.situationBytes( situation );
+    report( "situation bytes", iCount, timer.nsecsElapsed() );
+
+    timer.restart();
+    for( i = 0; i < iCount; i++ )
+        reader.situationText( qsSituation );
+    report( "situation text->bytes", iCount, timer.nsecsElapsed() );
+
+    timer.restart();
+    for( i = 0; i < iCount; i++ )
+        reader.trafficUpdate( qsTraffic );
+    report( "traffic split+table", iCount, timer.nsecsElapsed() );
+
+    timer.restart();
+    for( i = 0; i < iCount; i++ )
+        reader.trafficBytes( traffic );
+    report( "traffic bytes", iCount, timer.nsecsElapsed() );
+
+    timer.restart();
+    for( i = 0; i < iCount; i++ )
+        reader.trafficText( qsTraffic );
+    report( "traffic text->bytes", iCount, timer.nsecsElapsed() );
+
+    timer.restart();
+    for( i = 0; i < iCount; i++ )
+        reader.statusUpdate( qsStatus );
+    report( "status split+table", iCount, timer.nsecsElapsed() );
+
+    timer.restart();
+    for( i = 0; i < iCount; i++ )
+        reader.statusBytes( status );
+    report( "status bytes", iCount, timer.nsecsElapsed() );
+}
+
+
+// The GDL90 backend on one second's worth of Stratux output: heartbeat, ownship, geometric altitude, five AHRS reports and ten traffic reports
+void Benchmark::gdl90()
+{
+    StreamReader   reader( "127.0.0.1" );
+    GDL90Heartbeat heartbeat;
+    GDL90Target    target;
+    GDL90AHRS      ahrs;
+    QByteArray     second, geoAlt;
+    QElapsedTimer  timer;
+    int            iCount = 20000;
+    int            i;
+
+    heartbeat.bGPSValid = true;
+    heartbeat.bUATInit = true;
+    heartbeat.bUTCValid = true;
+    heartbeat.iTimestamp = 32304;
+    heartbeat.iUplinkCount = 0;
+    heartbeat.iBasicLongCount = 10;
+
+    target.iAlertStatus = 0;
+    target.iAddrType = 0;
+    target.iAddress = 0xAA4E2D;
+    target.dLat = 43.607;
+    target.dLong = -116.19;
+    target.bPosValid = true;
+    target.dAlt = 2650.0;
+    target.bAltValid = true;
+    target.bAirborne = true;
+    target.iTrackType = 1;
+    target.iNIC = 8;
+    target.iNACp = 10;
+    target.dSpeed = 105.0;
+    target.bSpeedValid = true;
+    target.dVertSpeed = 0.0;
+    target.bVertSpeedValid = true;
+    target.dTrack = 187.0;
+    target.iEmitter = 1;
+    target.qsCallsign = "N12345";
+    target.iPriority = 0;
+
+    ahrs.dRoll = -2.4;
+    ahrs.dPitch = -1.0;
+    ahrs.bAttValid = true;
+    ahrs.dHeading = 187.7;
+    ahrs.bHeadingValid = true;
+    ahrs.dSlipSkid = 0.5;
+    ahrs.dTurnRate = 0.0;
+    ahrs.dGLoad = 1.0;
+    ahrs.bGLoadValid = true;
+    ahrs.dIAS = 0.0;
+    ahrs.bIASValid = false;
+    ahrs.dPressAlt = 2480.0;
+    ahrs.bPressAltValid = true;
+    ahrs.dVertSpeed = 0.0;
+    ahrs.bVertSpeedValid = true;
+
+    geoAlt.append( static_cast<char>( GDL90::OwnshipGeoAlt ) );
+    geoAlt.append( static_cast<char>( 0x02 ) );     // 2650 ft in 5 ft units
+    geoAlt.append( static_cast<char>( 0x12 ) );
+    geoAlt.append( static_cast<char>( 0x00 ) );
+    geoAlt.append( static_cast<char>( 0x0A ) );
+
+    second.append( GDL90::frame( GDL90::encodeHeartbeat( heartbeat ) ) );
+    second.append( GDL90::frame( GDL90::encodeTargetReport( GDL90::Ownship, target ) ) );
+    second.append( GDL90::frame( geoAlt ) );
+    for( i = 0; i < 5; i++ )
+        second.append( GDL90::frame( GDL90::encodeStratuxAHRS( ahrs ) ) );
+    target.qsCallsign = "N761UP";
+    target.dLat = 43.55;
+    target.dLong = -116.2;
+    target.dAlt = 4400.0;
+    for( i = 0; i < 10; i++ )
+    {
+        target.iAddress = 0xAA4E2E + i;
+        second.append( GDL90::frame( GDL90::encodeTargetReport( GDL90::Traffic, target ) ) );
+    }
+
+    timer.start();
+    for( i = 0; i < iCount; i++ )
+        reader.gdl90Bytes( second );
+    report( "gdl90 (18 msgs)", iCount, timer.nsecsElapsed() );
+
+    // The same second over the websockets is five situation and ten traffic messages plus one status
+    timer.restart();
+    for( i = 0; i < iCount; i++ )
+    {
+        QByteArray situation( s_szSituation ), traffic( s_szTraffic ), status( s_szStatus );
+        int        j;
+
+        for( j = 0; j < 5; j++ )
+            reader.situationBytes( situation );
+        for( j = 0; j < 10; j++ )
+            reader.trafficBytes( traffic );
+        reader.statusBytes( status );
+    }
+    report( "json bytes (16 msgs)", iCount, timer.nsecsElapsed() );
+}
+
+
+// QDateTime::fromString against the fixed format decoder on the timestamps from one situation and one traffic message
+void Benchmark::timestamps()
+{
+    static const char *s_szStamps[] = { "0001-01-01T00:06:44.24Z", "0001-01-01T00:00:00Z", "2017-09-26T08:58:24Z", "0001-01-01T00:06:43.65Z",
+                                        "0001-01-01T00:06:44.24Z", "0001-01-01T00:06:44.23Z", "0001-01-01T00:06:44.28Z",
+                                        "2017-09-26T09:03:47.614Z", "0001-01-01T00:11:09.66Z" };
+    const int     iStamps = static_cast<int>( sizeof( s_szStamps ) / sizeof( s_szStamps[0] ) );
+    QString       qsStamps[iStamps];
+    QElapsedTimer timer;
+    int           iCount = 20000;
+    int           iMismatch = 0;
+    qint64        iSum = 0;
+    qint64        iEpochMs;
+    int           i, j;
+
+    for( j = 0; j < iStamps; j++ )
+    {
+        qsStamps[j] = s_szStamps[j];
+        if( !StratuxParser::toEpochMs( s_szStamps[j], static_cast<int>( strlen( s_szStamps[j] ) ), &iEpochMs ) ||
+            (iEpochMs != QDateTime::fromString( qsStamps[j], Qt::ISODateWithMs ).toMSecsSinceEpoch()) )
+            iMismatch++;
+    }
+    if( iMismatch > 0 )
+        qWarning() << iMismatch << "timestamps decoded differently from QDateTime";
+
+    timer.start();
+    for( i = 0; i < iCount; i++ )
+    {
+        for( j = 0; j < iStamps; j++ )
+            iSum += QDateTime::fromString( qsStamps[j], Qt::ISODateWithMs ).toMSecsSinceEpoch();
+    }
+    report( "QDateTime::fromString", iCount * iStamps, timer.nsecsElapsed() );
+
+    timer.restart();
+    for( i = 0; i < iCount; i++ )
+    {
+        for( j = 0; j < iStamps; j++ )
+        {
+            StratuxParser::toEpochMs( s_szStamps[j], static_cast<int>( strlen( s_szStamps[j] ) ), &iEpochMs );
+            iSum += iEpochMs;
+        }
+    }
+    report( "toEpochMs", iCount * iStamps, timer.nsecsElapsed() );
+
+    // Keeps the loops from being optimized away
+    if( iSum == 0 )
+        qInfo() << "";
+}
+
+
+// Positioning every target on the heading indicator for one frame: the old per target haversine and QLineF rotation
+// against the parallel arrays through the scalar and the best vector kernel
+void Benchmark::traffic()
+{
+    static const int s_iTargets[] = { 50, 500, 5000 };
+    TrafficGeometry::Kernel eBest = TrafficGeometry::best();
+    TrafficView             view = { 43.607, -116.19, 4500.0, 187.7, 10.0, 240.0, 400.0 };
+    QElapsedTimer           timer;
+    double                  dSum = 0.0;
+    quint32                 uiRand = 12345;
+    int                     iFrames, iTargets;
+    int                     i, j, t;
+
+    qInfo() << "Best traffic kernel:" << TrafficGeometry::name( eBest );
+
+    for( t = 0; t < static_cast<int>( sizeof( s_iTargets ) / sizeof( s_iTargets[0] ) ); t++ )
+    {
+        TrafficTable table;
+        TrafficPlot  scalarPlot, bestPlot;
+
+        iTargets = s_iTargets[t];
+        iFrames = 2000000 / iTargets;
+
+        // Scattered across the 20 NM the display covers at the widest zoom
+        for( i = 0; i < iTargets; i++ )
+        {
+            StratuxTraffic traffic;
+
+            StreamReader::initTraffic( traffic );
+            uiRand = (uiRand * 1103515245u) + 12345u;
+            traffic.dLat = view.dLat + ((static_cast<double>( uiRand >> 8 ) / 16777216.0) - 0.5) * 0.66;
+            uiRand = (uiRand * 1103515245u) + 12345u;
+            traffic.dLong = view.dLong + ((static_cast<double>( uiRand >> 8 ) / 16777216.0) - 0.5) * 0.9;
+            uiRand = (uiRand * 1103515245u) + 12345u;
+            traffic.dAlt = static_cast<double>( uiRand >> 18 );
+            traffic.iICAO = 0xA00000 + i;
+            traffic.bPosValid = true;
+            traffic.bHasADSB = true;
+            table.update( traffic, 0 );
+        }
+
+        timer.start();
+        for( j = 0; j < iFrames; j++ )
+        {
+            for( i = 0; i < table.slots(); i++ )
+            {
+                const StratuxTraffic *pTraffic = table.slot( i );
+                BearingDist           bd = TrafficMath::haversine( view.dLat, view.dLong, pTraffic->dLat, pTraffic->dLong );
+                QLineF                ball( view.dCenterX, view.dCenterY, view.dCenterX, view.dCenterY - (bd.dDistance * view.dPxPerNM) );
+
+                ball.setAngle( -(bd.dBearing - view.dHeading - 90.0) );
+                dSum += ball.p2().x() + (pTraffic->dAlt - view.dAlt);
+            }
+        }
+        report( QString( "haversine + QLineF %1" ).arg( iTargets ).toLatin1().constData(), iFrames * iTargets, timer.nsecsElapsed() );
+
+        timer.restart();
+        for( j = 0; j < iFrames; j++ )
+        {
+            TrafficGeometry::compute( table.arrays(), view, &scalarPlot, TrafficGeometry::Scalar );
+            dSum += scalarPlot.fX.at( j % iTargets );
+        }
+        report( QString( "scalar kernel %1" ).arg( iTargets ).toLatin1().constData(), iFrames * iTargets, timer.nsecsElapsed() );
+
+        timer.restart();
+        for( j = 0; j < iFrames; j++ )
+        {
+            TrafficGeometry::compute( table.arrays(), view, &bestPlot, eBest );
+            dSum += bestPlot.fX.at( j % iTargets );
+        }
+        report( QString( "%1 kernel %2" ).arg( TrafficGeometry::name( eBest ) ).arg( iTargets ).toLatin1().constData(), iFrames * iTargets, timer.nsecsElapsed() );
+
+        if( (memcmp( scalarPlot.fX.constData(), bestPlot.fX.constData(), iTargets * sizeof( float ) ) != 0) ||
+            (memcmp( scalarPlot.fY.constData(), bestPlot.fY.constData(), iTargets * sizeof( float ) ) != 0) ||
+            (memcmp( scalarPlot.fBearing.constData(), bestPlot.fBearing.constData(), iTargets * sizeof( float ) ) != 0) ||
+            (memcmp( scalarPlot.fDist.constData(), bestPlot.fDist.constData(), iTargets * sizeof( float ) ) != 0) ||
+            (memcmp( scalarPlot.fAltDelta.constData(), bestPlot.fAltDelta.constData(), iTargets * sizeof( float ) ) != 0) )
+            qWarning() << TrafficGeometry::name( eBest ) << "kernel results differ from scalar at" << iTargets << "targets";
+    }
+
+    // Keeps the loops from being optimized away
+    if( dSum == 0.0 )
+        qInfo() << "";
+}
+
+
+// One haversine call per point against the batch version over points spread across the whole globe, which also checks
+// the batch results agree with the per point ones; a run where they don't fails
+bool Benchmark::haversine()
+{
+    const int            iPoints = 100000;
+    const double         dLat1 = 43.607;
+    const double         dLong1 = -116.19;
+    QVector<double>      lat( iPoints );
+    QVector<double>      lon( iPoints );
+    QVector<BearingDist> single( iPoints );
+    QVector<BearingDist> batch( iPoints );
+    QElapsedTimer        timer;
+    quint32              uiRand = 12345;
+    double               dBearingErr = 0.0;
+    double               dDistErr = 0.0;
+    double               dErr;
+    int                  iRuns = 20;
+    int                  i, j;
+
+    qInfo() << "Batch haversine kernel:" << TrafficMath::haversineKernel();
+
+    for( i = 0; i < iPoints; i++ )
+    {
+        uiRand = (uiRand * 1103515245u) + 12345u;
+        lat[i] = ((static_cast<double>( uiRand >> 8 ) / 16777216.0) * 178.0) - 89.0;
+        uiRand = (uiRand * 1103515245u) + 12345u;
+        lon[i] = ((static_cast<double>( uiRand >> 8 ) / 16777216.0) * 360.0) - 180.0;
+    }
+
+    timer.start();
+    for( j = 0; j < iRuns; j++ )
+    {
+        for( i = 0; i < iPoints; i++ )
+            single[i] = TrafficMath::haversine( dLat1, dLong1, lat.at( i ), lon.at( i ) );
+    }
+    report( "haversine", iRuns * iPoints, timer.nsecsElapsed() );
+
+    timer.restart();
+    for( j = 0; j < iRuns; j++ )
+        TrafficMath::haversine( dLat1, dLong1, lat.constData(), lon.constData(), batch.data(), iPoints );
+    report( "haversine batch", iRuns * iPoints, timer.nsecsElapsed() );
+
+    // Bearing error wraps at +/-180; distance error is relative
+    for( i = 0; i < iPoints; i++ )
+    {
+        dErr = fabs( batch.at( i ).dBearing - single.at( i ).dBearing );
+        if( dErr > 180.0 )
+            dErr = 360.0 - dErr;
+        dBearingErr = qMax( dBearingErr, dErr );
+        dErr = fabs( batch.at( i ).dDistance - single.at( i ).dDistance ) / qMax( single.at( i ).dDistance, 1.0e-9 );
+        dDistErr = qMax( dDistErr, dErr );
+    }
+    qInfo() << "Largest batch difference:" << dBearingErr << "degrees bearing," << dDistErr << "relative distance";
+    if( (dBearingErr > 1.0e-9) || (dDistErr > 1.0e-12) )
+    {
+        qWarning() << TrafficMath::haversineKernel() << "batch haversine is less accurate than it should be";
+        return false;
+    }
+
+    return true;
+}
+
+
+// A field from /proc/self/status in kB, or -1 where there isn't one
+static qint64 procStatus( const char *szField )
+{
+    QFile      status( "/proc/self/status" );
+    QByteArray line;
+
+    if( !status.open( QIODevice::ReadOnly ) )
+        return -1;
+    while( !status.atEnd() )
+    {
+        line = status.readLine();
+        if( line.startsWith( szField ) )
+            return line.mid( static_cast<int>( strlen( szField ) ) ).simplified().split( ' ' ).first().toLongLong();
+    }
+
+    return -1;
+}
+
+
+// Brings VmHWM back down to the current resident set (Linux 4.0 and later) so each parse's peak can be seen on its own
+static qint64 resetPeakRSS()
+{
+    QFile clearRefs( "/proc/self/clear_refs" );
+
+    if( clearRefs.open( QIODevice::WriteOnly ) )
+        clearRefs.write( "5" );
+
+    return procStatus( "VmRSS:" );
+}
+
+
+static void reportPeakRSS( qint64 iBaseKB )
+{
+    qint64 iPeakKB = procStatus( "VmHWM:" );
+
+    if( (iBaseKB < 0) || (iPeakKB < 0) )
+        qInfo() << "    peak RSS not available";
+    else
+        qInfo() << "    peak RSS +" << (iPeakKB - iBaseKB) << "kB";
+}
+
+
+// Resident set each form of the same airports holds once built: a copy of the cache, then every airport expanded into
+// the QList<Airport> the cache replaced. Each is measured as the rise in VmRSS while it's held.
+static void airportMemory( const AirportCache &airports )
+{
+    AirportCache   copy;
+    QList<Airport> list;
+    qint64         iBaseKB, iCacheKB, iListKB;
+    int            i;
+
+    iBaseKB = procStatus( "VmRSS:" );
+    copy.load( airports.airports().constData(), airports.count(), airports.runways().constData(), airports.runways().count(),
+               airports.frequencies().constData(), airports.frequencies().count(),
+               QByteArray( airports.strings().data().constData(), airports.strings().data().size() ) );
+    iCacheKB = procStatus( "VmRSS:" ) - iBaseKB;
+
+    iBaseKB = procStatus( "VmRSS:" );
+    list.reserve( airports.count() );
+    for( i = 0; i < airports.count(); i++ )
+        list.append( airports.airport( i ) );
+    iListKB = procStatus( "VmRSS:" ) - iBaseKB;
+
+    if( iBaseKB < 0 )
+        qInfo() << "    held RSS not available; cache heap" << (copy.bytes() / 1024) << "kB";
+    else
+        qInfo() << "    held RSS: AirportCache" << iCacheKB << "kB (heap" << (copy.bytes() / 1024) << "kB), QList<Airport>" << iListKB << "kB,"
+                << qPrintable( QString( "%1x" ).arg( static_cast<double>( iListKB ) / static_cast<double>( qMax( iCacheKB, Q_INT64_C( 1 ) ) ), 0, 'f', 1 ) );
+}
+
+
+// What the document based parser had to do before it could read a single record: build the whole tree
+static int domRecords( const QString &qsFile, const QString &qsTag )
+{
+    QFile        aip( qsFile );
+    QDomDocument aipDoc( "XML_OpenAIP" );
+
+    if( !aip.open( QIODevice::ReadOnly ) || !aipDoc.setContent( &aip ) )
+        return 0;
+
+    return aipDoc.elementsByTagName( qsTag ).count();
+}
+
+
+// Streaming OpenAIP parser against the document tree the old one built, on the US airport and airspace downloads.
+// Memory is the rise in peak resident set over each parse, so run it on Linux; the streaming runs go first so the
+// document's freed memory doesn't hide theirs. The parsed airports are then held both ways to show what the cache saves.
+void Benchmark::openaip()
+{
+    QMap<Canvas::CountryCodeAirports, QString> airportMap;
+    QMap<Canvas::CountryCodeAirspace, QString> airspaceMap;
+    QString                                    qsRoot, qsAirports, qsAirspaces;
+    AirportCache                               airports;
+    QList<Airspace>                            airspaces;
+    QElapsedTimer                              timer;
+    qint64                                     iBaseKB;
+    int                                        iCount;
+
+    Builder::getStorage( &qsRoot );
+    qsRoot.append( "/data/space.skyfun.stratofier/" );
+    Builder::populateUrlMapAirports( &airportMap );
+    Builder::populateUrlMapAirspaces( &airspaceMap );
+    qsAirports = qsRoot + airportMap.value( Canvas::USap ) + ".aip";
+    qsAirspaces = qsRoot + airspaceMap.value( Canvas::USas ) + ".aip";
+    if( !QFile::exists( qsAirports ) || !QFile::exists( qsAirspaces ) )
+    {
+        qWarning() << "Download the US airports and airspace in Settings first;" << qsAirports << qsAirspaces;
+        return;
+    }
+
+    iBaseKB = resetPeakRSS();
+    timer.start();
+    if( !AviationDB::parseAirports( qsAirports, &airports ) )
+        qWarning() << "Unable to parse" << qsAirports;
+    report( "airports stream", qMax( airports.count(), 1 ), timer.nsecsElapsed() );
+    reportPeakRSS( iBaseKB );
+    airportMemory( airports );
+    airports.clear();
+
+    iBaseKB = resetPeakRSS();
+    timer.restart();
+    if( !AviationDB::parseAirspaces( qsAirspaces, &airspaces ) )
+        qWarning() << "Unable to parse" << qsAirspaces;
+    report( "airspace stream", qMax( airspaces.count(), 1 ), timer.nsecsElapsed() );
+    reportPeakRSS( iBaseKB );
+    airspaces.clear();
+
+    iBaseKB = resetPeakRSS();
+    timer.restart();
+    iCount = domRecords( qsAirports, "AIRPORT" );
+    report( "airports document", qMax( iCount, 1 ), timer.nsecsElapsed() );
+    reportPeakRSS( iBaseKB );
+
+    iBaseKB = resetPeakRSS();
+    timer.restart();
+    iCount = domRecords( qsAirspaces, "ASP" );
+    report( "airspace document", qMax( iCount, 1 ), timer.nsecsElapsed() );
+    reportPeakRSS( iBaseKB );
+}
+
+
+// Numbers the way buildNumber() made them before the glyph atlas: a resource decode and a scaled draw per digit
+static void resourceNumber( QPixmap *pNumber, const CanvasConstants *c, const QString &qsNum, bool bBold )
+{
+    pNumber->fill( Qt::transparent );
+
+    QPainter numPainter( pNumber );
+    QChar    cNum;
+    int      iX = 0;
+    bool     bMantissa = false;
+
+    foreach( cNum, qsNum )
+    {
+        if( cNum == '.' )
+        {
+            bMantissa = true;
+            continue;
+        }
+
+        QPixmap num( QString( ":/num/resources/%1%2.png" ).arg( (cNum == ':') ? QString( "colon" ) : QString( cNum ) ).arg( bBold ? "b" : "" ) );
+
+        if( bMantissa )
+        {
+            numPainter.drawPixmap( iX, (c->dHNum * 0.25) - 1.0, c->dWNum / 1.5, c->dHNum / 1.5, num );
+            iX += static_cast<int>( c->dWNum / 1.5 );
+        }
+        else
+        {
+            numPainter.drawPixmap( iX, 0, c->dWNum, c->dHNum, num );
+            iX += static_cast<int>( c->dWNum );
+        }
+    }
+}
+
+
+// The numbers one portrait frame draws with direct-to and from-to both set and four runways in view: two speeds, the
+// altitude, the heading, two bearing and distance pairs, the timer and the runway numbers
+void Benchmark::numbers()
+{
+    Canvas          canvas( 480.0, 800.0, true );
+    CanvasConstants c = canvas.constants();
+    NumberAtlas     atlas;
+    QPixmap         num( 320, 84 );
+    QPixmap         runway( 128, 84 );
+    QPixmap         timer( c.dW5, c.dH20 );
+    QElapsedTimer   elapsed;
+    int             iFrames = 500;
+    int             i, j;
+
+    elapsed.start();
+    for( i = 0; i < iFrames; i++ )
+    {
+        resourceNumber( &num, &c, QString::number( 120 + (i % 10) ), false );
+        resourceNumber( &num, &c, QString::number( 115 + (i % 10) ), false );
+        resourceNumber( &num, &c, QString::number( 8500 + i ), false );
+        resourceNumber( &num, &c, QString( "%1" ).arg( i % 360, 3, 10, QChar( '0' ) ), false );
+        for( j = 0; j < 2; j++ )
+        {
+            resourceNumber( &num, &c, QString::number( 270.0 + j, 'f', 0 ), true );
+            resourceNumber( &num, &c, QString::number( 12.3 + j, 'f', 1 ), true );
+        }
+        resourceNumber( &timer, &c, "12:34", false );
+        for( j = 0; j < 4; j++ )
+            resourceNumber( &runway, &c, QString( "%1" ).arg( (j * 9) + 1, 2, 10, QChar( '0' ) ), false );
+    }
+    report( "numbers from resources", iFrames, elapsed.nsecsElapsed() );
+
+    elapsed.restart();
+    atlas.build( &c );
+    report( "number atlas build", 1, elapsed.nsecsElapsed() );
+
+    elapsed.restart();
+    for( i = 0; i < iFrames; i++ )
+    {
+        Builder::buildNumber( &num, &atlas, 120 + (i % 10), 0 );
+        Builder::buildNumber( &num, &atlas, 115 + (i % 10), 0 );
+        Builder::buildNumber( &num, &atlas, 8500 + i, 0 );
+        Builder::buildNumber( &num, &atlas, i % 360, 3 );
+        for( j = 0; j < 2; j++ )
+        {
+            Builder::buildNumber( &num, &atlas, 270.0 + j, 0 );
+            Builder::buildNumber( &num, &atlas, 12.3 + j, 1 );
+        }
+        Builder::buildNumber( &timer, &atlas, QString( "12:34" ) );
+        for( j = 0; j < 4; j++ )
+            Builder::buildNumber( &runway, &atlas, (j * 9) + 1, 2 );
+    }
+    report( "numbers from atlas", iFrames, elapsed.nsecsElapsed() );
+}
+
+
+// A display load: how much traffic, how many airports and airspaces and how many vertices around each airspace
+struct RenderLoad
+{
+    const char *szName;
+    int         iTraffic;
+    int         iAirports;
+    int         iAirspaces;
+    int         iVertices;
+};
+
+
+static double nextRand( quint32 *pRand )
+{
+    *pRand = (*pRand * 1103515245u) + 12345u;
+
+    return static_cast<double>( *pRand >> 8 ) / 16777216.0;
+}
+
+
+// Airports scattered inside the zoom range, each with a couple of runways so the runway labels get drawn
+static void renderAirports( int iCount, double dZoomNM, QList<Airport> *pAirports )
+{
+    quint32 uiRand = 4242;
+    Airport ap;
+
+    pAirports->clear();
+    for( int i = 0; i < iCount; i++ )
+    {
+        ap.qsID = QString( "K%1" ).arg( i, 3, 10, QChar( '0' ) );
+        ap.qsName = ap.qsID;
+        ap.dLat = g_situation.dGPSlat + ((nextRand( &uiRand ) - 0.5) * dZoomNM * 2.0 / 60.0);
+        ap.dLong = g_situation.dGPSlong + ((nextRand( &uiRand ) - 0.5) * dZoomNM * 2.0 / 60.0 / cos( g_situation.dGPSlat * ToRad ));
+        ap.dElev = 2800.0;
+        ap.bGrass = (i % 4) == 0;
+        ap.bd = TrafficMath::haversine( g_situation.dGPSlat, g_situation.dGPSlong, ap.dLat, ap.dLong );
+        ap.runways.clear();
+        ap.runways << ((i * 70) % 180) + 10 << ((i * 70) % 180) + 190;
+        pAirports->append( ap );
+    }
+}
+
+
+// Lumpy rings around points inside the zoom range, all vertices in the way TrafficMath::updateNearbyAirspaces() would
+// transform them at the finest level of detail
+static void renderAirspaces( int iCount, int iVertices, double dZoomNM, QList<Airspace> *pAirspaces )
+{
+    quint32         uiRand = 2424;
+    Airspace        as;
+    QVector<double> lat, lon;
+    double          dLat, dLong, dRadius, dAng;
+
+    pAirspaces->clear();
+    for( int i = 0; i < iCount; i++ )
+    {
+        dLat = g_situation.dGPSlat + ((nextRand( &uiRand ) - 0.5) * dZoomNM / 60.0);
+        dLong = g_situation.dGPSlong + ((nextRand( &uiRand ) - 0.5) * dZoomNM / 60.0 / cos( g_situation.dGPSlat * ToRad ));
+        dRadius = (2.0 + (nextRand( &uiRand ) * dZoomNM * 0.5)) / 60.0;
+        as.eType = static_cast<Canvas::AirspaceType>( i % Canvas::Airspace_Unknown );
+        as.qsName = QString( "Airspace %1" ).arg( i );
+        as.iAltTop = 4000 + (i * 500);
+        as.iAltBottom = (i % 3) * 1000;
+        as.shape.clear();
+        for( int j = 0; j < iVertices; j++ )
+        {
+            dAng = TwoPi * j / iVertices;
+            as.shape.append( QPointF( dLong + (cos( dAng ) * dRadius * (1.0 + (nextRand( &uiRand ) * 0.05)) / cos( dLat * ToRad )),
+                                      dLat + (sin( dAng ) * dRadius * (1.0 + (nextRand( &uiRand ) * 0.05))) ) );
+        }
+        as.shape.append( as.shape.first() );
+        TrafficMath::simplifyShape( as.shape, &as.shapeLevels );
+        as.bounds = as.shape.boundingRect();
+        as.center = as.bounds.center();
+
+        lat.resize( as.shape.count() );
+        lon.resize( as.shape.count() );
+        for( int j = 0; j < as.shape.count(); j++ )
+        {
+            lat[j] = as.shape.at( j ).y();
+            lon[j] = as.shape.at( j ).x();
+        }
+        as.shapeHav.resize( as.shape.count() );
+        as.shapeHavLevels = as.shapeLevels;
+        TrafficMath::haversine( g_situation.dGPSlat, g_situation.dGPSlong, lat.constData(), lon.constData(), as.shapeHav.data(), lat.count() );
+        pAirspaces->append( as );
+    }
+}
+
+
+// Traffic the way it arrives from the stream, inside the zoom range
+static void renderTraffic( AHRSCanvas *pCanvas, int iCount, double dZoomNM )
+{
+    quint32        uiRand = 777;
+    StratuxTraffic traffic;
+
+    for( int i = 0; i < iCount; i++ )
+    {
+        StreamReader::initTraffic( traffic );
+        traffic.iICAO = 0xA00000 + i;
+        traffic.qsTail = QString( "N%1" ).arg( 100 + i );
+        traffic.dLat = g_situation.dGPSlat + ((nextRand( &uiRand ) - 0.5) * dZoomNM * 1.5 / 60.0);
+        traffic.dLong = g_situation.dGPSlong + ((nextRand( &uiRand ) - 0.5) * dZoomNM * 1.5 / 60.0 / cos( g_situation.dGPSlat * ToRad ));
+        traffic.dAlt = g_situation.dBaroPressAlt + ((nextRand( &uiRand ) - 0.5) * 6000.0);
+        traffic.dTrack = nextRand( &uiRand ) * 360.0;
+        traffic.dSpeed = 80.0 + (nextRand( &uiRand ) * 150.0);
+        traffic.bPosValid = true;
+        traffic.bHasADSB = true;
+        pCanvas->traffic( traffic );
+    }
+}
+
+
+// The situation for frame i: a gentle climbing turn with some pitch and roll oscillation so the attitude and heading
+// dial never hold still
+static void renderSituation( AHRSCanvas *pCanvas, int i )
+{
+    StratuxSituation s = g_situation;
+
+    s.dAHRSpitch = 5.0 + (8.0 * sin( i * 0.07 ));
+    s.dAHRSroll = 25.0 * sin( i * 0.03 );
+    s.dAHRSGyroHeading = fmod( 187.7 + (i * 0.6), 360.0 );
+    s.dAHRSMagHeading = s.dAHRSGyroHeading;
+    s.dAHRSSlipSkid = 3.0 * sin( i * 0.11 );
+    s.dAHRSGLoad = 1.0 + (0.3 * sin( i * 0.05 ));
+    s.dBaroPressAlt = 4500.0 + (i * 2.0);
+    s.dGPSVertSpeed = 500.0 + (200.0 * sin( i * 0.02 ));
+    s.dGPSGroundSpeed = 110.0 + (10.0 * sin( i * 0.01 ));
+    s.dTAS = s.dGPSGroundSpeed;
+    pCanvas->situation( s );
+}
+
+
+// Whole frames painted offscreen at the common screen sizes under a light and a heavy load, then the heavy hitters in
+// AHRSDraw on their own for where the time goes. Each frame has a new attitude, and the heading turns more than the nav
+// layer's half degree step so it's redrawn every frame, as in a steady turn.
+// With a budget, a p99 frame time over it fails the run so a regression breaks a CI build.
+bool Benchmark::render( double dBudgetMs )
+{
+    static const QSize      s_sizes[] = { QSize( 480, 800 ), QSize( 800, 480 ), QSize( 1152, 648 ), QSize( 648, 1152 ),
+                                          QSize( 1024, 600 ), QSize( 1280, 800 ), QSize( 1920, 1080 ) };
+    static const RenderLoad s_loads[] = { { "light", 5, 10, 4, 100 }, { "heavy", 60, 80, 30, 600 } };
+    static const int        s_iFrames = 200;
+    AHRSCanvas             *pCanvas = new AHRSCanvas( Q_NULLPTR );
+    QVector<qint64>         frameNs( s_iFrames );
+    QElapsedTimer           timer, total;
+    QList<Airport>          airports;
+    QList<Airspace>         airspaces;
+    QPixmap                 num( 320, 84 );
+    qint64                  iTotalNs;
+    double                  dP50, dP99;
+    bool                    bPassed = true;
+    int                     iSize, iLoad, i;
+
+    StreamReader::initSituation( g_situation );
+    g_situation.dGPSlat = 43.607;
+    g_situation.dGPSlong = -116.19;
+
+    pCanvas->m_dZoomNM = 10.0;
+    pCanvas->m_settings.eShowAirports = Canvas::ShowAllAirports;
+    pCanvas->m_settings.bShowPrivate = true;
+    pCanvas->m_settings.bShowRunways = true;
+    pCanvas->m_settings.bShowAirspaces = true;
+    pCanvas->m_settings.bShowAltitudes = true;
+    pCanvas->m_settings.bShowAllTraffic = true;
+
+    for( iSize = 0; iSize < static_cast<int>( sizeof( s_sizes ) / sizeof( s_sizes[0] ) ); iSize++ )
+    {
+        QImage image( s_sizes[iSize], QImage::Format_RGB32 );
+
+        pCanvas->resize( s_sizes[iSize] );
+        pCanvas->setPortrait( s_sizes[iSize].height() > s_sizes[iSize].width() );
+        if( iSize == 0 )
+        {
+            pCanvas->init();
+            // Let the start up cache loads finish rather than compete for the CPU
+            QThreadPool::globalInstance()->waitForDone();
+        }
+        else
+            pCanvas->orient2();
+
+        for( iLoad = 0; iLoad < static_cast<int>( sizeof( s_loads ) / sizeof( s_loads[0] ) ); iLoad++ )
+        {
+            const RenderLoad &load = s_loads[iLoad];
+            QString           qsRun = QString( "%1x%2 %3" ).arg( s_sizes[iSize].width() ).arg( s_sizes[iSize].height() ).arg( load.szName );
+
+            renderAirports( load.iAirports, pCanvas->m_dZoomNM, &airports );
+            renderAirspaces( load.iAirspaces, load.iVertices, pCanvas->m_dZoomNM, &airspaces );
+            pCanvas->m_airports.publish( pCanvas->m_airports.request(), airports );
+            pCanvas->m_airspaces.publish( pCanvas->m_airspaces.request(), airspaces );
+            g_trafficTable.expire( 0x7FFFFFFF );
+            renderTraffic( pCanvas, load.iTraffic, pCanvas->m_dZoomNM );
+            for( i = 0; i < Compositor::LayerCount; i++ )
+                pCanvas->compositor()->stats( static_cast<Compositor::Layer>( i ) );
+
+            // One untimed frame for the layers and caches to settle
+            image.fill( Qt::black );
+            renderSituation( pCanvas, 0 );
+            pCanvas->snapshotFrame();
+            pCanvas->renderFrame( &image );
+            pCanvas->compositor()->invalidateAll();
+
+            total.start();
+            for( i = 0; i < s_iFrames; i++ )
+            {
+                renderSituation( pCanvas, i + 1 );
+                image.fill( Qt::black );
+                timer.start();
+                pCanvas->snapshotFrame();
+                pCanvas->renderFrame( &image );
+                frameNs[i] = timer.nsecsElapsed();
+            }
+            iTotalNs = total.nsecsElapsed();
+
+            std::sort( frameNs.begin(), frameNs.end() );
+            dP50 = frameNs.at( s_iFrames / 2 ) / 1000000.0;
+            dP99 = frameNs.at( qMin( s_iFrames - 1, (s_iFrames * 99) / 100 ) ) / 1000000.0;
+
+            qInfo() << QString( "%1  %2 fps  p50 %3 ms  p99 %4 ms" )
+                           .arg( qsRun, -20 )
+                           .arg( s_iFrames * 1000000000.0 / iTotalNs, 0, 'f', 1 )
+                           .arg( dP50, 0, 'f', 2 ).arg( dP99, 0, 'f', 2 ).toLatin1().constData();
+            for( i = 0; i < Compositor::LayerCount; i++ )
+            {
+                LayerStats stats = pCanvas->compositor()->stats( static_cast<Compositor::Layer>( i ) );
+
+                if( stats.iRedraws > 0 )
+                    report( QString( "  %1 layer" ).arg( Compositor::name( static_cast<Compositor::Layer>( i ) ) ).toLatin1().constData(),
+                            stats.iRedraws, stats.iRedrawNs );
+            }
+
+            // The draw calls on their own, into the same frame
+            NearbyAirports::Ptr  nearbyAirports = pCanvas->m_airports.current();
+            NearbyAirspaces::Ptr nearbyAirspaces = pCanvas->m_airspaces.current();
+            CanvasConstants      c = pCanvas->m_pCanvas->constants();
+            QPainter             painter( &image );
+            AHRSDraw             draw( &painter, &c, pCanvas->m_pCanvas, &pCanvas->m_numbers, &pCanvas->m_runwayLabels, &g_situation, &g_trafficTable,
+                                       &pCanvas->m_directAP, &pCanvas->m_fromAP, &pCanvas->m_toAP, nearbyAirports.get(), nearbyAirspaces.get(),
+                                       pCanvas->m_dZoomNM, &pCanvas->m_settings, pCanvas->m_iMagDev,
+                                       &pCanvas->m_trafficRed,
+                                       &pCanvas->m_trafficYellow,
+                                       &pCanvas->m_trafficGreen,
+                                       &pCanvas->m_trafficCyan,
+                                       &pCanvas->m_trafficOrange );
+
+            painter.setRenderHints( QPainter::Antialiasing | QPainter::TextAntialiasing, true );
+            Builder::buildNumber( &num, &pCanvas->m_numbers, static_cast<int>( g_situation.dBaroPressAlt ), 0 );
+
+            timer.start();
+            for( i = 0; i < s_iFrames; i++ )
+                draw.updateAirspaces();
+            report( "  updateAirspaces", s_iFrames, timer.nsecsElapsed() );
+
+            timer.start();
+            for( i = 0; i < s_iFrames; i++ )
+                draw.updateAirports();
+            report( "  updateAirports", s_iFrames, timer.nsecsElapsed() );
+
+            timer.start();
+            for( i = 0; i < s_iFrames; i++ )
+                draw.updateTraffic();
+            report( "  updateTraffic", s_iFrames, timer.nsecsElapsed() );
+
+            timer.start();
+            for( i = 0; i < s_iFrames; i++ )
+            {
+                draw.drawCurrAlt( &num );
+                draw.drawCurrSpeed( &num );
+            }
+            report( "  drawCurrAlt/Speed", s_iFrames, timer.nsecsElapsed() );
+
+            timer.start();
+            for( i = 0; i < s_iFrames; i++ )
+                draw.drawSlipSkid( c.dW2 );
+            report( "  drawSlipSkid", s_iFrames, timer.nsecsElapsed() );
+
+            if( (dBudgetMs > 0.0) && (dP99 > dBudgetMs) )
+            {
+                qWarning() << qsRun.toLatin1().constData() << "p99 frame time" << dP99 << "ms is over the" << dBudgetMs << "ms budget";
+                bPassed = false;
+            }
+        }
+    }
+
+    delete pCanvas;
+
+    return bPassed;
+}
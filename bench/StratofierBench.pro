@@ -0,0 +1,119 @@
+#-------------------------------------------------
+#
+# StratofierBench - timing runs for Stratofier's hot paths, kept out of the app itself
+# Copyright 2019 Sky Fun
+#
+#-------------------------------------------------
+
+QT += core gui websockets widgets network concurrent xml
+
+CONFIG += console
+CONFIG -= app_bundle
+
+TARGET = StratofierBench
+TEMPLATE = app
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+VPATH += ./include
+
+INCLUDEPATH += ./include \
+               ../include \
+               ./gen/uic \
+               ./gen/rcc
+
+DESTDIR = ./bin
+OBJECTS_DIR = ./obj
+
+UI_DIR = ./gen/uic
+MOC_DIR = ./gen/moc
+RCC_DIR = ./gen/rcc
+
+# Everything the app builds but its main.cpp, since the render run paints through the real AHRSCanvas
+SOURCES += main.cpp \
+           Benchmark.cpp \
+           ../StreamReader.cpp \
+           ../AHRSCanvas.cpp \
+           ../AHRSDraw.cpp \
+           ../AHRSMainWin.cpp \
+           ../BugSelector.cpp \
+           ../Keypad.cpp \
+           ../TrafficMath.cpp \
+           ../Haversine.cpp \
+           ../TrafficTable.cpp \
+           ../TrafficGeometry.cpp \
+           ../AirportCache.cpp \
+           ../AirportIndex.cpp \
+           ../AirspaceIndex.cpp \
+           ../Canvas.cpp \
+           ../MenuDialog.cpp \
+           ../Builder.cpp \
+           ../NumberAtlas.cpp \
+           ../Compositor.cpp \
+           ../TimerDialog.cpp \
+           ../FuelTanksDialog.cpp \
+           ../ClickLabel.cpp \
+           ../SettingsDialog.cpp \
+           ../AirportDialog.cpp \
+           ../CountryDialog.cpp \
+           ../DetailsDialog.cpp \
+           ../Overlays.cpp \
+           ../Keyboard.cpp \
+           ../StratuxParser.cpp \
+           ../GDL90.cpp \
+           ../StreamCapture.cpp \
+           ../AviationDB.cpp
+
+HEADERS += Benchmark.h \
+           ../include/StratuxStreams.h \
+           ../include/StreamReader.h \
+           ../include/AHRSCanvas.h \
+           ../include/AHRSDraw.h \
+           ../include/AHRSMainWin.h \
+           ../include/BugSelector.h \
+           ../include/Keypad.h \
+           ../include/TrafficMath.h \
+           ../include/TrafficTable.h \
+           ../include/TrafficGeometry.h \
+           ../include/AirportCache.h \
+           ../include/AirportIndex.h \
+           ../include/AirspaceIndex.h \
+           ../include/Canvas.h \
+           ../include/MenuDialog.h \
+           ../include/Builder.h \
+           ../include/NumberAtlas.h \
+           ../include/Compositor.h \
+           ../include/StratofierDefs.h \
+           ../include/TimerDialog.h \
+           ../include/FuelTanksDialog.h \
+           ../include/ClickLabel.h \
+           ../include/SettingsDialog.h \
+           ../include/AirportDialog.h \
+           ../include/CountryDialog.h \
+           ../include/DetailsDialog.h \
+           ../include/Overlays.h \
+           ../include/Keyboard.h \
+           ../include/StratuxParser.h \
+           ../include/StratuxFields.h \
+           ../include/GDL90.h \
+           ../include/StreamQueue.h \
+           ../include/StreamCapture.h \
+           ../include/AviationDB.h \
+           ../include/StringTable.h \
+           ../include/Snapshot.h
+
+FORMS += ../ui/AHRSMainWin.ui \
+         ../ui/BugSelector.ui \
+         ../ui/Keypad.ui \
+         ../ui/MenuDialog.ui \
+         ../ui/TimerDialog.ui \
+         ../ui/FuelTanksDialog.ui \
+         ../ui/FuelTanksDialogLandscape.ui \
+         ../ui/SettingsDialog.ui \
+         ../ui/AirportDialog.ui \
+         ../ui/CountryDialog.ui \
+         ../ui/DetailsDialog.ui \
+         ../ui/Overlays.ui \
+         ../ui/Keyboard.ui
+
+RESOURCES += ../AHRSResources.qrc
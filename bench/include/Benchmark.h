@@ -0,0 +1,29 @@
+/*
+Stratofier Stratux AHRS Display
+(c) 2018 Allen K. Lair, Sky Fun
+*/
+
+#ifndef __BENCHMARK_H__
+#define __BENCHMARK_H__
+
+#include <QString>
+
+
+// Timing runs for the hot paths, built into StratofierBench rather than the app; see main.cpp
+class Benchmark
+{
+public:
+    static int run( const QString &qsWhat, double dBudgetMs = 0.0 );
+
+private:
+    static void streams();
+    static void gdl90();
+    static void timestamps();
+    static void traffic();
+    static bool haversine();
+    static void openaip();
+    static void numbers();
+    static bool render( double dBudgetMs );
+};
+
+#endif // __BENCHMARK_H__
@@ -0,0 +1,66 @@
+/*
+Stratofier Stratux AHRS Display
+(c) 2018 Allen K. Lair, Sky Fun
+*/
+
+#include <QApplication>
+#include <QtDebug>
+#include <QDir>
+#include <QSettings>
+
+#include "Keyboard.h"
+#include "StreamReader.h"
+#include "Benchmark.h"
+
+
+// The app's globals; nothing here connects to a Stratux, so there's never a stream reader
+QSettings    *g_pSet = nullptr;
+Keyboard     *g_pKeyboard = nullptr;
+StreamReader *g_pStratuxStream = nullptr;
+
+
+// The first argument names the run: streams, gdl90, timestamps, traffic, haversine, openaip, numbers or render.
+// budget=<ms> fails the render run on a p99 frame time over it (for CI) and home=<dir> is where config.ini and the
+// OpenAIP files are, the current directory by default.
+// e.g. StratofierBench render budget=33
+int main( int argc, char *argv[] )
+{
+    // No screen needed, so it runs anywhere including CI; an explicit platform still wins
+    if( qEnvironmentVariableIsEmpty( "QT_QPA_PLATFORM" ) )
+        qputenv( "QT_QPA_PLATFORM", "offscreen" );
+
+    QApplication app( argc, argv );
+    QStringList  qslArgs = app.arguments();
+    QString      qsArg;
+    QString      qsBench;
+    QString      qsHome;
+    double       dBudgetMs = 0.0;
+
+    qslArgs.removeFirst();
+    foreach( qsArg, qslArgs )
+    {
+        if( qsArg.startsWith( "budget=" ) )
+            dBudgetMs = qsArg.mid( 7 ).toDouble();
+        else if( qsArg.startsWith( "home=" ) )
+            qsHome = qsArg.mid( 5 );
+        else
+            qsBench = qsArg;
+    }
+
+    if( qsBench.isEmpty() )
+    {
+        qWarning() << "Usage: StratofierBench <run> [budget=<ms>] [home=<dir>]";
+        return 1;
+    }
+
+    if( !qsHome.isEmpty() )
+        QDir::setCurrent( qsHome );
+
+    QCoreApplication::setOrganizationName( "Sky Fun" );
+    QCoreApplication::setOrganizationDomain( "skyfun.space" );
+    QCoreApplication::setApplicationName( "Stratofier" );
+
+    g_pSet = new QSettings( "./config.ini", QSettings::IniFormat );
+
+    return Benchmark::run( qsBench, dBudgetMs );
+}
@@ -0,0 +1,35 @@
+#-------------------------------------------------
+#
+# AipConvert - compiles OpenAIP downloads into Stratofier's binary database files
+# Copyright 2019 Sky Fun
+#
+#-------------------------------------------------
+
+QT += core gui xml
+
+CONFIG += console
+CONFIG -= app_bundle
+
+TARGET = AipConvert
+TEMPLATE = app
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+INCLUDEPATH += ../include
+
+DESTDIR = ./bin
+OBJECTS_DIR = ./obj
+
+SOURCES += main.cpp \
+           ../AviationDB.cpp \
+           ../AirportCache.cpp \
+           ../AirportIndex.cpp \
+           ../AirspaceIndex.cpp \
+           ../Haversine.cpp
+
+HEADERS += ../include/AviationDB.h \
+           ../include/AirportCache.h \
+           ../include/StringTable.h \
+           ../include/AirportIndex.h \
+           ../include/AirspaceIndex.h \
+           ../include/TrafficMath.h
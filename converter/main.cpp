@@ -0,0 +1,44 @@
+/*
+Stratofier Stratux AHRS Display
+(c) 2018 Allen K. Lair, Sky Fun
+*/
+
+#include <QCoreApplication>
+#include <QtDebug>
+#include <QElapsedTimer>
+
+#include "AviationDB.h"
+
+
+// Each argument is an OpenAIP airport or airspace .aip; its .adb is written alongside it, ready to copy onto the
+// device with the .aip so the first startup doesn't have to compile it.
+// e.g. AipConvert us_wpt.aip us_asp.aip
+int main( int argc, char *argv[] )
+{
+    QCoreApplication app( argc, argv );
+    QStringList      qslArgs = app.arguments();
+    QString          qsArg;
+    QElapsedTimer    timer;
+    int              iFailed = 0;
+
+    qslArgs.removeFirst();
+    if( qslArgs.isEmpty() )
+    {
+        qWarning() << "Usage: AipConvert <file.aip> [<file.aip> ...]";
+        return 1;
+    }
+
+    foreach( qsArg, qslArgs )
+    {
+        timer.start();
+        if( AviationDB::convert( qsArg ) )
+            qInfo() << qsArg << "->" << AviationDB::dbFile( qsArg ) << timer.elapsed() << "ms";
+        else
+        {
+            qWarning() << "Unable to convert" << qsArg;
+            iFailed++;
+        }
+    }
+
+    return (iFailed > 0) ? 1 : 0;
+}
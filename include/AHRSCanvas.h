@@ -11,22 +11,65 @@ Stratofier Stratux AHRS Display
 #include <QMap>
 #include <QList>
 #include <QDateTime>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QImage>
+#include <QColor>
+#include <QFuture>
 
 #include "StratuxStreams.h"
 #include "Canvas.h"
 #include "TrafficMath.h"
+#include "Compositor.h"
+#include "TrafficTable.h"
+#include "NumberAtlas.h"
+#include "AHRSDraw.h"
+
+
+// Everything one frame paints that can change while it's being painted, copied on the GUI thread by snapshotFrame()
+struct FrameState
+{
+    StratuxSituation     situation;
+    TrafficTable         traffic;
+    NearbyAirports::Ptr  airports;      // Held for the whole frame; the workers publish new lists alongside
+    NearbyAirspaces::Ptr airspaces;
+    int                  iAirportsRequest;  // What the lists above were published under, for the nav layer's key
+    int                  iAirspacesRequest;
+    StratofierSettings   settings;
+    FuelTanks            tanks;
+    Airport              directAP;
+    Airport              fromAP;
+    Airport              toAP;
+    double               dZoomNM;
+    int                  iMagDev;
+    int                  iHeadBugAngle;
+    int                  iWindBugAngle;
+    int                  iWindBugSpeed;
+    int                  iAltBug;
+    int                  iTimerMin;
+    int                  iTimerSec;
+    bool                 bPortrait;
+    bool                 bDark;
+    bool                 bShowGPSDetails;
+    bool                 bShowCrosswind;
+    bool                 bDisplayTanksSwitchNotice;
+    bool                 bFuelFlowStarted;
+};
 
 
 class AHRSCanvas : public QWidget
 {
     Q_OBJECT
 
+    friend class Benchmark;
+
 public:
     explicit AHRSCanvas( QWidget *parent = 0 );
     ~AHRSCanvas();
 
     void    setPortrait( bool bPortrait ) { m_bPortrait = bPortrait; }
     void    setFuelTanks( FuelTanks tanks ) { m_tanks = tanks; }
+    void    setFuelFlowStarted( bool bStarted ) { m_bFuelFlowStarted = bStarted; }
     void    timerReminder( int iMinutes, int iSeconds );
     Canvas *canvas() { return m_pCanvas; }
     void    orient( bool bPortrait );
@@ -35,12 +78,15 @@ public:
     void    setSwitchableTanks( bool bSwitchable );
     void    dark( bool bDark );
 
+    Compositor *compositor() { return &m_layers; }
+
     bool m_bFuelFlowStarted;
 
 public slots:
     void init();
     void situation( StratuxSituation s );
-    void traffic( StratuxTraffic t );
+    void traffic( const StratuxTraffic &t );
+    void drainTraffic();
 
     void showAllTraffic( bool bAll );
     void showAirports( Canvas::ShowAirports eShow );
@@ -57,12 +103,28 @@ protected:
     void timerEvent( QTimerEvent *pEvent );
 
 private:
+    void streamData();
     void cullTrafficMap();
+    void updateNearbyAirports();
+    void updateNearbyAirspaces();
     void zoomIn();
     void zoomOut();
     void handleScreenPress( const QPoint &pressPt );
-    void paintPortrait();
-    void paintLandscape();
+    void paintPortrait( QPaintDevice *pDevice );
+    void paintLandscape( QPaintDevice *pDevice );
+    void snapshotFrame();
+    void renderFrame( QPaintDevice *pDevice );
+    void startRender();
+    void renderJob();
+    void waitForRender();
+    void redraw();
+    void logLayers();
+    void paintPortraitAttitude( QPainter *pAHRS, CanvasConstants *c );
+    void paintLandscapeAttitude( QPainter *pAHRS, CanvasConstants *c );
+    void paintFuelLayer( QPainter *pAHRS, CanvasConstants *c );
+    void paintPortraitFuel( QPainter *pAHRS, CanvasConstants *c );
+    void paintLandscapeFuel( QPainter *pAHRS, CanvasConstants *c );
+    void paintNavLayer( QPainter *pAHRS, CanvasConstants *c, const QList<Airport> *pAirports, const QList<Airspace> *pAirspaces );
     void loadSettings();
     void swipeLeft();
     void swipeRight();
@@ -115,16 +177,47 @@ private:
     QPixmap m_FromTo;
 
     StratofierSettings m_settings;
-    QList<Airport>     m_airports;
-    QList<Airspace>    m_airspaces;
+    NearbyAirports     m_airports;
+    NearbyAirspaces    m_airspaces;
     FuelTanks          m_tanks;
+    Compositor         m_layers;
+    NumberAtlas        m_numbers;   // Digit images for buildNumber(), rebuilt in init() and orient2() with the render finished
+    RunwayLabels       m_runwayLabels;
 
     double m_dBaroPress;
 
     QDateTime m_lastTrafficUpdate;
 
+    // Frame scheduler
+    QTimer        m_frameTimer;
+    bool          m_bFrameDirty;        // Stream data applied or something else changed since the last frame
+    bool          m_bPaintPending;      // update() issued but paintEvent() not yet run
+    bool          m_bLogFrames;
+    QElapsedTimer m_frameStatsTimer;
+    quint32       m_uiFrameUpdatesBase; // Hand-off total at the start of the current one second window
+    int           m_iFramesPainted;
+    int           m_iFramesWithData;
+    int           m_iFramesDropped;
+
+    // Render thread; frames are painted into m_backImage on a worker and paintEvent() only copies out m_frontImage
+    bool          m_bRenderThread;
+    bool          m_bRendering;         // A render is in flight; it only reads m_frame and the pixmaps
+    bool          m_bRenderShown;       // A finished render is waiting for paintEvent() to copy it out
+    bool          m_bLogLayersPending;  // Layer stats are due but a render was in flight
+    QFuture<void> m_render;
+    QImage        m_frontImage;
+    QImage        m_backImage;
+    QColor        m_background;
+    FrameState    m_frame;              // What the frame being rendered paints; only written while no render is in flight
+
+    // Many of the Stratux timestamps are bogus, at least the non-ADS-B ones, so traffic expiry runs off the time each report arrived here
+    QElapsedTimer m_trafficClock;
+    bool          m_bLogTraffic;
+
 private slots:
     void orient2();
+    void frame();
+    void rendered();
 };
 
 #endif // __AHRSCANVAS_H__
@@ -6,7 +6,7 @@ Stratofier Stratux AHRS Display
 #ifndef __AHRSDRAW_H__
 #define __AHRSDRAW_H__
 
-#include <QWidget>
+#include <QPainter>
 #include <QPixmap>
 #include <QMap>
 #include <QList>
@@ -15,21 +15,44 @@ Stratofier Stratux AHRS Display
 #include "StratuxStreams.h"
 #include "Canvas.h"
 #include "TrafficMath.h"
+#include "TrafficTable.h"
+#include "NumberAtlas.h"
 
 
-class AHRSDraw : public QWidget
+// Ready scaled runway numbers, 00 through 36, for the canvas size they were made for; the canvas owns them and clears
+// them along with its layers
+struct RunwayLabels
 {
-    Q_OBJECT
+    enum { Count = 37 };
 
+    void clear()
+    {
+        for( int i = 0; i < Count; i++ )
+            labels[i] = QPixmap();
+    }
+
+    QPixmap labels[Count];
+};
+
+
+// Draws one frame's worth of the display's parts through a painter. Everything it shows comes in through the
+// constructor rather than from the globals, so it can paint a frame's copy on the render thread. Not a widget, since
+// it's made on whichever thread is painting.
+class AHRSDraw
+{
 public:
     explicit AHRSDraw( QPainter *pAHRS,
                        CanvasConstants *c,
                        Canvas *pCanvas,
+                       const NumberAtlas *pNumbers,
+                       RunwayLabels *pRunwayLabels,
+                       const StratuxSituation *pSituation,
+                       TrafficTable *pTraffic,
                        Airport *pDirectAP,
                        Airport *pFromAP,
                        Airport *pToAP,
-                       QList<Airport> *pAirports,
-                       QList<Airspace> *pAirspaces,
+                       const QList<Airport> *pAirports,
+                       const QList<Airspace> *pAirspaces,
                        double dZoomNM,
                        StratofierSettings *pSettings,
                        int iMagDev,
@@ -53,24 +76,31 @@ public:
     void paintTimer( int iTimerMin, int iTimerSec );
 
 private:
-    void maskHeading();
+    void    maskHeading();
+    double  heading();
+    QPointF airportPoint( const BearingDist &bd );
+    QPixmap runwayLabel( int iDesignator );
 
-    QPainter           *m_pAHRS;
-    CanvasConstants    *m_pC;
-    Canvas             *m_pCanvas;
-    Airport            *m_pDirectAP;
-    Airport            *m_pFromAP;
-    Airport            *m_pToAP;
-    QList<Airport>     *m_pAirports;
-    QList<Airspace>    *m_pAirspaces;
-    double              m_dZoomNM;
-    StratofierSettings *m_pSettings;
-    int                 m_iMagDev;
-    QPixmap            *m_trafficRed;
-    QPixmap            *m_trafficYellow;
-    QPixmap            *m_trafficGreen;
-    QPixmap            *m_trafficCyan;
-    QPixmap            *m_trafficOrange;
+    QPainter               *m_pAHRS;
+    CanvasConstants        *m_pC;
+    Canvas                 *m_pCanvas;
+    const NumberAtlas      *m_pNumbers;
+    RunwayLabels           *m_pRunwayLabels;
+    const StratuxSituation *m_pSituation;
+    TrafficTable           *m_pTraffic;
+    Airport                *m_pDirectAP;
+    Airport                *m_pFromAP;
+    Airport                *m_pToAP;
+    const QList<Airport>   *m_pAirports;
+    const QList<Airspace>  *m_pAirspaces;
+    double                  m_dZoomNM;
+    StratofierSettings     *m_pSettings;
+    int                     m_iMagDev;
+    QPixmap                *m_trafficRed;
+    QPixmap                *m_trafficYellow;
+    QPixmap                *m_trafficGreen;
+    QPixmap                *m_trafficCyan;
+    QPixmap                *m_trafficOrange;
 };
 
 #endif // __AHRSDRAW_H__
@@ -46,6 +46,7 @@ protected:
 
 private:
     void emptyHttpPost( const QString &qsToken );
+    void logHandoff();
 
     StreamReader *m_pStratuxStream;
     bool          m_bStartup;
@@ -59,6 +60,7 @@ private:
     int           m_iReconnectTimer;
     int           m_iTimerTimer;
     bool          m_bRecording;
+    bool          m_bLogHandoff;
 
     QList<TrackPoint> m_Track;
 
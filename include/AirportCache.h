@@ -0,0 +1,78 @@
+/*
+Stratofier Stratux AHRS Display
+(c) 2018 Allen K. Lair, Sky Fun
+*/
+
+#ifndef __AIRPORTCACHE_H__
+#define __AIRPORTCACHE_H__
+
+#include <QVector>
+#include <QString>
+
+#include "Canvas.h"
+#include "StringTable.h"
+
+
+// One airport in the cache; fixed size, no pointers, so the whole array is one allocation and can go to and from
+// the compiled database as it is
+struct CachedAirport
+{
+    double  dLat;
+    double  dLong;
+    double  dElev;
+    char    szID[8];            // ICAO, or "R" for none; NUL terminated
+    quint32 uiName;             // Into the string table
+    quint32 uiFirstRunway;      // Into the shared runway and frequency arrays
+    quint32 uiFirstFrequency;
+    quint8  uiRunways;
+    quint8  uiFrequencies;
+    bool    bGrass;
+    quint8  uiReserved;
+};
+
+
+struct CachedFrequency
+{
+    double  dFreq;
+    quint32 uiDescription;      // Interned; the same few descriptions repeat across thousands of airports
+    quint32 uiReserved;
+};
+
+
+// The airport database in memory: compact records with their runways and frequencies in shared arrays and every
+// string interned once, several times smaller than a list of Airports. Airports are handed out by position;
+// airport() expands one into the full struct the display and dialogs work with.
+class AirportCache
+{
+public:
+    AirportCache();
+
+    void clear();
+    void squeeze();
+    int  count() const { return m_airports.count(); }
+    bool isEmpty() const { return m_airports.isEmpty(); }
+
+    void append( const Airport &ap );
+    void append( const AirportCache &other );
+    bool load( const CachedAirport *pAirports, int iAirports, const qint32 *pRunways, int iRunways, const CachedFrequency *pFrequencies, int iFrequencies, const QByteArray &strings );
+
+    const CachedAirport &at( int i ) const { return m_airports.at( i ); }
+    QString              id( int i ) const { return QString::fromLatin1( m_airports.at( i ).szID ); }
+    QString              name( int i ) const { return m_strings.string( m_airports.at( i ).uiName ); }
+    Airport              airport( int i ) const;
+    int                  findName( const QString &qsName ) const;
+    qint64               bytes() const;
+
+    const QVector<CachedAirport>   &airports() const { return m_airports; }
+    const QVector<qint32>          &runways() const { return m_runways; }
+    const QVector<CachedFrequency> &frequencies() const { return m_frequencies; }
+    const StringTable              &strings() const { return m_strings; }
+
+private:
+    QVector<CachedAirport>   m_airports;
+    QVector<qint32>          m_runways;
+    QVector<CachedFrequency> m_frequencies;
+    StringTable              m_strings;
+};
+
+#endif // __AIRPORTCACHE_H__
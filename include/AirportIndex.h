@@ -0,0 +1,62 @@
+/*
+Stratofier Stratux AHRS Display
+(c) 2018 Allen K. Lair, Sky Fun
+*/
+
+#ifndef __AIRPORTINDEX_H__
+#define __AIRPORTINDEX_H__
+
+#include <QVector>
+#include <QByteArray>
+
+#include "Canvas.h"
+#include "AirportCache.h"
+
+
+// One airport found by a query; iAirport is its position in the list the index was built from
+struct AirportHit
+{
+    int         iAirport;
+    BearingDist bd;
+};
+
+
+// Fixed lat/long grid over the airport cache for range and nearest queries.
+// Airports are bucket sorted by cell, row by row, with their coordinates copied alongside, so the cells a query touches
+// in one row of the grid are a single contiguous run that goes straight through the batch haversine. A query only
+// looks at the cells its circle overlaps, so the cost follows the number of airports nearby rather than the database size.
+// Distances are TrafficMath::haversine's.
+// Built once after the cache loads; queries are const and safe from any number of threads while nothing rebuilds it.
+class AirportIndex
+{
+public:
+    AirportIndex();
+
+    void build( const AirportCache &airports );
+    void clear();
+    int  count() const { return m_items.count(); }
+
+    void save( QByteArray *pData ) const;
+    bool load( const uchar *pData, int iSize );
+
+    void withinRange( double dLat, double dLong, double dRangeNM, QVector<AirportHit> *pHits ) const;
+    void nearest( double dLat, double dLong, int iK, QVector<AirportHit> *pHits ) const;
+
+private:
+    int  row( double dLat ) const;
+    int  col( double dLong ) const;
+    void scanRow( int iRow, double dLongFrom, double dLongTo, double dLat, double dLong, double dRangeNM, QVector<BearingDist> *pScratch, QVector<AirportHit> *pHits ) const;
+
+    double m_dCellDeg;
+    double m_dMinLat;
+    double m_dMinLong;
+    int    m_iRows;
+    int    m_iCols;
+
+    QVector<int>    m_cellStart;    // First entry of each cell in the arrays below, plus one past the end
+    QVector<int>    m_items;        // Airport list positions sorted by cell
+    QVector<double> m_lat;
+    QVector<double> m_long;
+};
+
+#endif // __AIRPORTINDEX_H__
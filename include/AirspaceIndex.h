@@ -0,0 +1,51 @@
+/*
+Stratofier Stratux AHRS Display
+(c) 2018 Allen K. Lair, Sky Fun
+*/
+
+#ifndef __AIRSPACEINDEX_H__
+#define __AIRSPACEINDEX_H__
+
+#include <QList>
+#include <QVector>
+#include <QRectF>
+#include <QByteArray>
+
+#include "Canvas.h"
+
+
+// R-tree over the airspace cache's precomputed bounding boxes (x is longitude, y latitude).
+// The whole database is known up front so it's bulk loaded with sort-tile-recursive packing: the boxes are sorted into
+// vertical slices by longitude, each slice by latitude, and packed in runs of a fixed fan out, then the same again on the
+// nodes until there's one root. Every node's children are contiguous so a node is just a box and a range.
+// Built once after the cache loads; queries are const and safe from any number of threads while nothing rebuilds it.
+class AirspaceIndex
+{
+public:
+    AirspaceIndex();
+
+    void build( const QList<Airspace> &airspaces );
+    void clear();
+    int  count() const { return m_items.count(); }
+
+    void save( QByteArray *pData ) const;
+    bool load( const uchar *pData, int iSize );
+
+    void overlapping( double dLat, double dLong, double dRangeNM, QVector<int> *pHits ) const;
+    void overlapping( const QRectF &box, QVector<int> *pHits ) const;
+
+private:
+    struct Node
+    {
+        QRectF box;
+        int    iFirst;      // First child in m_nodes, or in m_items for a leaf
+        int    iCount;
+        bool   bLeaf;
+    };
+
+    QVector<Node>   m_nodes;        // Root last
+    QVector<int>    m_items;        // Airspace list positions in leaf order
+    QVector<QRectF> m_itemBoxes;
+};
+
+#endif // __AIRSPACEINDEX_H__
@@ -0,0 +1,52 @@
+/*
+Stratofier Stratux AHRS Display
+(c) 2018 Allen K. Lair, Sky Fun
+*/
+
+#ifndef __AVIATIONDB_H__
+#define __AVIATIONDB_H__
+
+#include <QString>
+#include <QList>
+
+#include "Canvas.h"
+
+
+class AirportCache;
+class AirportIndex;
+class AirspaceIndex;
+
+
+// Compiled form of the OpenAIP downloads so startup doesn't have to parse XML.
+// Each country's .aip gets a .adb alongside it: a versioned header, a checksummed table of sections, then the
+// sections themselves - fixed size airport or airspace records, their runways, frequencies or polygon vertices as flat
+// arrays, one table of interned strings the records point into, and the spatial index already built. The file is mapped
+// rather than read and the records copied straight out of it. The whole file is checksummed at open, each section
+// against its own CRC so a bad one is named in the log. Anything that doesn't check out (wrong version, checksum,
+// other endianness, older than the .aip) is ignored and rebuilt from the XML.
+class AviationDB
+{
+public:
+    enum Kind
+    {
+        Airports = 1,
+        Airspaces = 2
+    };
+
+    static QString dbFile( const QString &qsAipFile );
+    static bool    convert( const QString &qsAipFile );
+
+    static bool loadAirports( const QString &qsAipFile, AirportCache *pAirports, AirportIndex *pIndex );
+    static bool loadAirspaces( const QString &qsAipFile, QList<Airspace> *pAirspaces, AirspaceIndex *pIndex );
+
+    static bool parseAirports( const QString &qsAipFile, AirportCache *pAirports );
+    static bool parseAirspaces( const QString &qsAipFile, QList<Airspace> *pAirspaces );
+
+private:
+    static bool writeAirports( const QString &qsAipFile, const AirportCache &airports, const AirportIndex &index );
+    static bool writeAirspaces( const QString &qsAipFile, const QList<Airspace> &airspaces, const AirspaceIndex &index );
+    static bool readAirports( const QString &qsAipFile, AirportCache *pAirports, AirportIndex *pIndex );
+    static bool readAirspaces( const QString &qsAipFile, QList<Airspace> *pAirspaces, AirspaceIndex *pIndex );
+};
+
+#endif // __AVIATIONDB_H__
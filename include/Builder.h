@@ -12,6 +12,7 @@ Stratofier Stratux AHRS Display
 
 
 class QPixmap;
+class NumberAtlas;
 
 
 class Builder
@@ -19,9 +20,9 @@ class Builder
 public:
     explicit Builder();
 
-    static void buildNumber( QPixmap *pNumber, CanvasConstants *c, int iNum, int iFieldWidth );
-    static void buildNumber( QPixmap *pNumber, CanvasConstants *c, const QString &qsNum );
-    static void buildNumber( QPixmap *pNumber, CanvasConstants *c, double dNum, int iPrec );
+    static void buildNumber( QPixmap *pNumber, const NumberAtlas *pAtlas, int iNum, int iFieldWidth );
+    static void buildNumber( QPixmap *pNumber, const NumberAtlas *pAtlas, const QString &qsNum );
+    static void buildNumber( QPixmap *pNumber, const NumberAtlas *pAtlas, double dNum, int iPrec );
 
     static void getStorage( QString *pInternal );
 
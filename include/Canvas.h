@@ -7,6 +7,7 @@ Stratofier Stratux AHRS Display
 #define __CANVAS_H__
 
 #include <QList>
+#include <QVector>
 #include <QDataStream>
 #include <QDateTime>
 #include <QPolygonF>
@@ -102,7 +103,6 @@ struct Airport
     BearingDist      bd;
     QList<int>       runways;
     QList<Frequency> frequencies;
-    QPointF          logicalPt;
 };
 
 
@@ -244,7 +244,11 @@ struct Airspace
     int                  iAltTop;
     int                  iAltBottom;
     QPolygonF            shape;
-    QList<BearingDist>   shapeHav;
+    QVector<quint8>      shapeLevels;   // Coarsest level of detail each vertex of shape is in; see TrafficMath::simplifyShape()
+    QRectF               bounds;        // Of shape, worked out once when the cache loads
+    QPointF              center;        // Of bounds
+    QVector<BearingDist> shapeHav;      // The vertices of one level of detail from ownship
+    QVector<quint8>      shapeHavLevels;
 };
 
 #endif // __CANVAS_H__
@@ -0,0 +1,87 @@
+/*
+Stratofier Stratux AHRS Display
+(c) 2018 Allen K. Lair, Sky Fun
+*/
+
+#ifndef __COMPOSITOR_H__
+#define __COMPOSITOR_H__
+
+#include <QImage>
+#include <QVector>
+#include <QRect>
+#include <QElapsedTimer>
+
+
+class QPainter;
+
+
+// Everything a layer's drawing depends on, streamed in; the layer is redrawn when it's different from last time
+class LayerKey
+{
+public:
+    LayerKey &operator<<( double d );
+    LayerKey &operator<<( int i );
+    LayerKey &operator<<( bool b );
+
+    bool operator==( const LayerKey &other ) const { return m_parts == other.m_parts; }
+    bool operator!=( const LayerKey &other ) const { return m_parts != other.m_parts; }
+
+private:
+    QVector<quint64> m_parts;
+};
+
+
+// Counters since the last call to stats()
+struct LayerStats
+{
+    int    iRedraws;
+    int    iReused;
+    qint64 iRedrawNs;
+};
+
+
+// Parts of the display that change much less often than the attitude are each kept in an image of their own and only
+// redrawn when what they depend on changes; a frame just copies them into place in paint order.
+// A layer covers a list of rectangles of the canvas. The image is their bounding box but only the rectangles themselves
+// are composed, so a layer made of things at opposite edges of the screen doesn't cost a blend of everything between.
+// Used by whichever thread is painting the frame, the GUI thread or the render thread; AHRSCanvas::waitForRender()
+// keeps two frames from using it at once.
+class Compositor
+{
+public:
+    enum Layer
+    {
+        FuelLayer,          // Tank gauges
+        NavLayer,           // Airspace and airports on the heading indicator
+        LayerCount
+    };
+
+    Compositor();
+
+    static const char *name( Layer eLayer );
+
+    void       invalidate( Layer eLayer );
+    void       invalidateAll();
+    bool       begin( Layer eLayer, const QVector<QRect> &parts, const LayerKey &key, qreal dPixelRatio );
+    QImage    *image( Layer eLayer ) { return &m_layers[eLayer].image; }
+    QPoint     origin( Layer eLayer ) const { return m_layers[eLayer].bounds.topLeft(); }
+    void       end( Layer eLayer );
+    void       draw( QPainter *pPainter, Layer eLayer ) const;
+    LayerStats stats( Layer eLayer );
+
+private:
+    struct Entry
+    {
+        QImage         image;
+        QVector<QRect> parts;
+        QRect          bounds;
+        LayerKey       key;
+        bool           bDirty;
+        QElapsedTimer  drawTime;
+        LayerStats     stats;
+    };
+
+    Entry m_layers[LayerCount];
+};
+
+#endif // __COMPOSITOR_H__
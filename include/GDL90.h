@@ -0,0 +1,100 @@
+/*
+Stratofier Stratux AHRS Display
+(c) 2018 Allen K. Lair, Sky Fun
+*/
+
+#ifndef __GDL90_H__
+#define __GDL90_H__
+
+#include <QByteArray>
+#include <QString>
+
+
+// Heartbeat (0x00)
+struct GDL90Heartbeat
+{
+    bool bGPSValid;
+    bool bUATInit;
+    bool bUTCValid;
+    int  iTimestamp;     // Seconds since midnight UTC
+    int  iUplinkCount;
+    int  iBasicLongCount;
+};
+
+
+// Ownship (0x0A) and traffic (0x14) reports share the same layout
+struct GDL90Target
+{
+    int     iAlertStatus;
+    int     iAddrType;
+    int     iAddress;
+    double  dLat;
+    double  dLong;
+    bool    bPosValid;
+    double  dAlt;           // Pressure altitude in feet
+    bool    bAltValid;
+    bool    bAirborne;
+    int     iTrackType;     // 0 = invalid, 1 = true track, 2 = magnetic heading, 3 = true heading
+    int     iNIC;
+    int     iNACp;
+    double  dSpeed;         // Knots
+    bool    bSpeedValid;
+    double  dVertSpeed;     // Feet per minute
+    bool    bVertSpeedValid;
+    double  dTrack;
+    int     iEmitter;
+    QString qsCallsign;
+    int     iPriority;
+};
+
+
+// Stratux AHRS extension (0x4C 0x45 0x01 0x01)
+struct GDL90AHRS
+{
+    double dRoll;
+    double dPitch;
+    bool   bAttValid;
+    double dHeading;
+    bool   bHeadingValid;
+    double dSlipSkid;
+    double dTurnRate;
+    double dGLoad;
+    bool   bGLoadValid;
+    double dIAS;
+    bool   bIASValid;
+    double dPressAlt;
+    bool   bPressAltValid;
+    double dVertSpeed;
+    bool   bVertSpeedValid;
+};
+
+
+// Framing and decoding for the GDL90 data interface (FAA GDL 90 Data Interface Specification 560-1058-00 Rev A) as broadcast by Stratux on UDP port 4000
+class GDL90
+{
+public:
+    enum MessageID
+    {
+        Heartbeat = 0x00,
+        Ownship = 0x0A,
+        OwnshipGeoAlt = 0x0B,
+        Traffic = 0x14,
+        StratuxAHRS = 0x4C
+    };
+
+    static bool       nextMessage( const QByteArray &buffer, int *pPos, QByteArray *pMsg );
+    static QByteArray frame( const QByteArray &msg );
+    static quint16    crc( const char *pData, int iLen );
+
+    static bool heartbeat( const QByteArray &msg, GDL90Heartbeat *pHeartbeat );
+    static bool targetReport( const QByteArray &msg, GDL90Target *pTarget );
+    static bool geoAltitude( const QByteArray &msg, double *pAlt );
+    static bool stratuxAHRS( const QByteArray &msg, GDL90AHRS *pAHRS );
+
+    // Encoders for captures, benchmarks and the simulator; the inverse of the decoders above
+    static QByteArray encodeHeartbeat( const GDL90Heartbeat &heartbeat );
+    static QByteArray encodeTargetReport( MessageID eID, const GDL90Target &target );
+    static QByteArray encodeStratuxAHRS( const GDL90AHRS &ahrs );
+};
+
+#endif // __GDL90_H__
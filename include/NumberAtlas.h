@@ -0,0 +1,53 @@
+/*
+Stratofier Stratux AHRS Display
+(c) 2018 Allen K. Lair, Sky Fun
+*/
+
+#ifndef __NUMBERATLAS_H__
+#define __NUMBERATLAS_H__
+
+#include <QPixmap>
+#include <QRect>
+
+#include "Canvas.h"
+
+
+class QPainter;
+
+
+// Every digit image buildNumber() uses, decoded and scaled to the canvas's number size once and packed into one pixmap:
+// a row of the plain digits and the colon, a row of the bold digits and a row of the bold digits at the two thirds size
+// used after a decimal point. Numbers are then straight copies of rectangles out of it rather than a resource decode
+// and a scaled draw per digit.
+// Built for one set of canvas constants; the canvas owns it and rebuilds it when the number size changes with the
+// orientation.
+class NumberAtlas
+{
+public:
+    enum Style
+    {
+        Plain,
+        Bold,
+        BoldSmall
+    };
+
+    NumberAtlas();
+
+    void build( const CanvasConstants *c );
+    bool fits( const CanvasConstants *c ) const;
+    int  width( Style eStyle ) const;
+    int  mantissaY() const { return m_iMantissaY; }
+    void draw( QPainter *pPainter, int iX, int iY, QChar cGlyph, Style eStyle ) const;
+
+private:
+    QRect glyph( QChar cGlyph, Style eStyle ) const;
+
+    QPixmap m_atlas;
+    int     m_iW;
+    int     m_iH;
+    int     m_iSmallW;
+    int     m_iSmallH;
+    int     m_iMantissaY;  // Drop of the small digits after a decimal point
+};
+
+#endif // __NUMBERATLAS_H__
@@ -0,0 +1,80 @@
+/*
+Stratofier Stratux AHRS Display
+(c) 2018 Allen K. Lair, Sky Fun
+*/
+
+#ifndef __SNAPSHOT_H__
+#define __SNAPSHOT_H__
+
+#include <QAtomicInt>
+
+#include <memory>
+
+
+// A value built on a worker thread and read on any other without the caller taking a lock (the standard library may
+// still use one inside the atomic shared_ptr operations). Used for the loaded airport and airspace databases as well as
+// the nearby lists worked out from them.
+// The worker builds a complete new value and publishes it by atomically swapping the shared pointer to the current one;
+// readers take a reference to whatever is current and keep it for as long as they like, and the old value goes away
+// when the last reader lets go. Nothing published is ever modified.
+// Each piece of work is numbered by request() when it's started; starting a newer one makes the older stale, so the
+// worker can give up early (isStale) and a late finisher can never replace a newer result (publish).
+template <typename T>
+class Snapshot
+{
+public:
+    typedef std::shared_ptr<const T> Ptr;
+
+    Snapshot() : m_pEntry( std::make_shared<Entry>() ) {}
+
+    int  request() { return m_iRequested.fetchAndAddOrdered( 1 ) + 1; }
+    bool isStale( int iRequest ) const { return m_iRequested.loadAcquire() != iRequest; }
+
+    bool publish( int iRequest, const T &value )
+    {
+        std::shared_ptr<Entry>       pNew = std::make_shared<Entry>();
+        std::shared_ptr<const Entry> pCurrent = std::atomic_load( &m_pEntry );
+
+        pNew->iRequest = iRequest;
+        pNew->value = value;
+        while( pCurrent->iRequest < iRequest )
+        {
+            if( std::atomic_compare_exchange_weak( &m_pEntry, &pCurrent, std::shared_ptr<const Entry>( pNew ) ) )
+                return true;
+        }
+
+        return false;
+    }
+
+    // Shares ownership with the entry it came from so it stays valid after the next publish
+    Ptr current() const
+    {
+        std::shared_ptr<const Entry> pEntry = std::atomic_load( &m_pEntry );
+
+        return Ptr( pEntry, &pEntry->value );
+    }
+
+    // The same, along with the request number it was published under; two reads with the same number saw the same value
+    Ptr current( int *pRequest ) const
+    {
+        std::shared_ptr<const Entry> pEntry = std::atomic_load( &m_pEntry );
+
+        *pRequest = pEntry->iRequest;
+
+        return Ptr( pEntry, &pEntry->value );
+    }
+
+private:
+    struct Entry
+    {
+        Entry() : iRequest( 0 ) {}
+
+        int iRequest;
+        T   value;
+    };
+
+    std::shared_ptr<const Entry> m_pEntry;
+    QAtomicInt                   m_iRequested;
+};
+
+#endif // __SNAPSHOT_H__
@@ -0,0 +1,108 @@
+/*
+Stratofier Stratux AHRS Display
+(c) 2018 Allen K. Lair, Sky Fun
+*/
+
+#ifndef __STRATUXFIELDS_H__
+#define __STRATUXFIELDS_H__
+
+#include <QtGlobal>
+
+
+// Field tables for the Stratux websocket messages - see https://github.com/cyoung/stratux/blob/master/notes/app-vendor-integration.md
+// FIELD( <JSON tag>, <struct member>, <conversion> )
+// The value type comes from the struct member. Adding a Stratux field is one line here plus the member in StratuxStreams.h.
+// Conversions:
+//   None  - stored as received
+//   Abs   - absolute value
+//   Units - knots times the current speed units multiplier
+//   NM    - meters to nautical miles
+
+#define STRATUX_SITUATION_FIELDS( FIELD ) \
+    FIELD( GPSLastFixSinceMidnightUTC,  dLastGPSFixSinceMidnight, None ) \
+    FIELD( GPSLatitude,                 dGPSlat,                  None ) \
+    FIELD( GPSLongitude,                dGPSlong,                 None ) \
+    FIELD( GPSFixQuality,               iGPSFixQuality,           None ) \
+    FIELD( GPSHeightAboveEllipsoid,     dGPSHeightAboveEllipsoid, None ) \
+    FIELD( GPSGeoidSep,                 dGPSGeoidSep,             None ) \
+    FIELD( GPSSatellites,               iGPSSats,                 None ) \
+    FIELD( GPSSatellitesTracked,        iGPSSatsTracked,          None ) \
+    FIELD( GPSSatellitesSeen,           iGPSSatsSeen,             None ) \
+    FIELD( GPSHorizontalAccuracy,       dGPSHorizAccuracy,        None ) \
+    FIELD( GPSNACp,                     iGPSNACp,                 None ) \
+    FIELD( GPSAltitudeMSL,              dGPSAltMSL,               Abs ) \
+    FIELD( GPSVerticalAccuracy,         dGPSVertAccuracy,         None ) \
+    FIELD( GPSVerticalSpeed,            dGPSVertSpeed,            None ) \
+    FIELD( GPSLastFixLocalTime,         lastGPSFixTime,           None ) \
+    FIELD( GPSTrueCourse,               dGPSTrueCourse,           None ) \
+    FIELD( GPSTurnRate,                 dGPSTurnRate,             None ) \
+    FIELD( GPSGroundSpeed,              dGPSGroundSpeed,          Units ) \
+    FIELD( GPSLastGroundTrackTime,      lastGPSGroundTrackTime,   None ) \
+    FIELD( GPSTime,                     gpsDateTime,              None ) \
+    FIELD( GPSLastGPSTimeStratuxTime,   lastGPSTimeStratuxTime,   None ) \
+    FIELD( GPSLastValidNMEAMessageTime, lastValidNMEAMessageTime, None ) \
+    FIELD( GPSLastValidNMEAMessage,     qsLastNMEAMsg,            None ) \
+    FIELD( GPSPositionSampleRate,       iGPSPosSampleRate,        None ) \
+    FIELD( BaroTemperature,             dBaroTemp,                None ) \
+    FIELD( BaroPressureAltitude,        dBaroPressAlt,            Abs ) \
+    FIELD( BaroVerticalSpeed,           dBaroVertSpeed,           None ) \
+    FIELD( BaroLastMeasurementTime,     lastBaroMeasTime,         None ) \
+    FIELD( AHRSPitch,                   dAHRSpitch,               None ) \
+    FIELD( AHRSRoll,                    dAHRSroll,                None ) \
+    FIELD( AHRSGyroHeading,             dAHRSGyroHeading,         None ) \
+    FIELD( AHRSMagHeading,              dAHRSMagHeading,          None ) \
+    FIELD( AHRSSlipSkid,                dAHRSSlipSkid,            None ) \
+    FIELD( AHRSTurnRate,                dAHRSTurnRate,            None ) \
+    FIELD( AHRSGLoad,                   dAHRSGLoad,               None ) \
+    FIELD( AHRSGLoadMin,                dAHRSGLoadMin,            None ) \
+    FIELD( AHRSGLoadMax,                dAHRSGLoadMax,            None ) \
+    FIELD( AHRSLastAttitudeTime,        lastAHRSAttTime,          None ) \
+    FIELD( AHRSStatus,                  iAHRSStatus,              None )
+
+// Icao_addr is handled by the parser since it isn't part of the struct
+#define STRATUX_TRAFFIC_FIELDS( FIELD ) \
+    FIELD( OnGround,       bOnGround,   None ) \
+    FIELD( Lat,            dLat,        None ) \
+    FIELD( Lng,            dLong,       None ) \
+    FIELD( Position_valid, bPosValid,   None ) \
+    FIELD( Alt,            dAlt,        None ) \
+    FIELD( Track,          dTrack,      None ) \
+    FIELD( Speed,          dSpeed,      Units ) \
+    FIELD( Vvel,           dVertSpeed,  None ) \
+    FIELD( Tail,           qsTail,      None ) \
+    FIELD( Last_seen,      lastSeen,    None ) \
+    FIELD( Last_source,    iLastSource, None ) \
+    FIELD( Reg,            qsReg,       None ) \
+    FIELD( SignalLevel,    dSigLevel,   None ) \
+    FIELD( Squawk,         iSquawk,     None ) \
+    FIELD( Timestamp,      timestamp,   None ) \
+    FIELD( Bearing,        dBearing,    None ) \
+    FIELD( Distance,       dDist,       NM ) \
+    FIELD( Age,            dAge,        None )
+
+#define STRATUX_STATUS_FIELDS( FIELD ) \
+    FIELD( UAT_traffic_targets_tracking, iUATTrafficTracking, None ) \
+    FIELD( ES_traffic_targets_tracking,  iESTrafficTracking,  None ) \
+    FIELD( GPS_satellites_locked,        iGPSSatsLocked,      None ) \
+    FIELD( GPS_connected,                bGPSConnected,       None )
+
+
+// 32 bit FNV-1a of a tag; the constexpr form produces the case labels and the span form hashes tags as they're parsed.
+// Two tags hashing the same would be duplicate case labels so a collision is a compile error rather than a silent mismatch.
+constexpr quint32 fieldHash( const char *szTag, quint32 uiHash = 2166136261u )
+{
+    return (*szTag == 0) ? uiHash : fieldHash( szTag + 1, (uiHash ^ static_cast<quint8>( *szTag )) * 16777619u );
+}
+
+
+inline quint32 fieldHash( const char *pTag, int iLen )
+{
+    quint32 uiHash = 2166136261u;
+
+    for( int i = 0; i < iLen; i++ )
+        uiHash = (uiHash ^ static_cast<quint8>( pTag[i] )) * 16777619u;
+
+    return uiHash;
+}
+
+#endif // __STRATUXFIELDS_H__
@@ -0,0 +1,45 @@
+/*
+Stratofier Stratux AHRS Display
+(c) 2018 Allen K. Lair, Sky Fun
+*/
+
+#ifndef __STRATUXPARSER_H__
+#define __STRATUXPARSER_H__
+
+#include <QByteArray>
+
+#include "StratuxStreams.h"
+
+
+// Single pass parser for the flat JSON objects sent on the Stratux websockets.
+// The message bytes are walked in place; tags and values are reported as spans into the original buffer so
+// nothing is allocated per field except for the few string values that are actually stored in the structs.
+class StratuxParser
+{
+public:
+    struct Field
+    {
+        const char *pTag;
+        int         iTagLen;
+        const char *pVal;
+        int         iValLen;
+        bool        bString;    // Value was quoted; the span excludes the quotes
+    };
+
+    static bool   nextField( const char *&pCursor, const char *pEnd, Field *pField );
+    static double toDouble( const char *pVal, int iLen );
+    static int    toInt( const char *pVal, int iLen );
+    static bool   toBool( const char *pVal, int iLen );
+    static bool   toEpochMs( const char *pVal, int iLen, qint64 *pEpochMs );
+
+    // Store one field through the tables in StratuxFields.h; false if the tag isn't one we use
+    static bool situationField( const Field &f, StratuxSituation *pSituation, double dUnitsMult );
+    static bool trafficField( const Field &f, StratuxTraffic *pTraffic, double dUnitsMult, int *pICAO );
+    static bool statusField( const Field &f, StratuxStatus *pStatus );
+
+    static void parseSituation( const QByteArray &message, StratuxSituation *pSituation, double dUnitsMult );
+    static int  parseTraffic( const QByteArray &message, StratuxTraffic *pTraffic, double dUnitsMult );
+    static void parseStatus( const QByteArray &message, StratuxStatus *pStatus );
+};
+
+#endif // __STRATUXPARSER_H__
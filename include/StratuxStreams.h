@@ -10,77 +10,90 @@ Stratofier Stratux AHRS Display
 #include <QString>
 
 
+// Stratux timestamp kept as UTC milliseconds since 1970 (Stratux's "never", 0001-01-01, comes through as a large negative value).
+// Decoding the ISO-8601 text to this is a few integer operations; a QDateTime is only built when something reads one.
+struct StratuxTime
+{
+    qint64 iEpochMs;
+
+    QDateTime toDateTime() const { return QDateTime::fromMSecsSinceEpoch( iEpochMs, Qt::UTC ); }
+};
+
+
+// What the time stamps are set to before a message fills them in (2000-01-01 00:00 UTC)
+static const qint64 StratuxNullTime = Q_INT64_C( 946684800000 );
+
+
 struct StratuxSituation
 {
-    double    dLastGPSFixSinceMidnight;
-    double    dGPSlat;
-    double    dGPSlong;
-    int       iGPSFixQuality;
-    double    dGPSHeightAboveEllipsoid;
-    double    dGPSGeoidSep;
-    int       iGPSSats;
-    int       iGPSSatsTracked;
-    int       iGPSSatsSeen;
-    double    dGPSHorizAccuracy;
-    int       iGPSNACp;
-    double    dGPSAltMSL;
-    double    dGPSVertAccuracy;
-    double    dGPSVertSpeed;
-    QDateTime lastGPSFixTime;
-    double    dGPSTrueCourse;
-    double    dGPSTurnRate;
-    double    dGPSGroundSpeed;
-    QDateTime lastGPSGroundTrackTime;
-    QDateTime gpsDateTime;
-    QDateTime lastGPSTimeStratuxTime;
-    QDateTime lastValidNMEAMessageTime;
-    QString   qsLastNMEAMsg;
-    int       iGPSPosSampleRate;
-    double    dBaroTemp;
-    double    dBaroPressAlt;
-    double    dBaroVertSpeed;
-    QDateTime lastBaroMeasTime;
-    double    dAHRSpitch;
-    double    dAHRSroll;
-    double    dAHRSGyroHeading;
-    double    dAHRSMagHeading;
-    double    dAHRSSlipSkid;
-    double    dAHRSTurnRate;
-    double    dAHRSGLoad;
-    double    dAHRSGLoadMin;
-    double    dAHRSGLoadMax;
-    QDateTime lastAHRSAttTime;
-    int       iAHRSStatus;
-    bool      bHaveWTData;
-    double    dTAS;
-    QString   qsBADASPversion;
+    double      dLastGPSFixSinceMidnight;
+    double      dGPSlat;
+    double      dGPSlong;
+    int         iGPSFixQuality;
+    double      dGPSHeightAboveEllipsoid;
+    double      dGPSGeoidSep;
+    int         iGPSSats;
+    int         iGPSSatsTracked;
+    int         iGPSSatsSeen;
+    double      dGPSHorizAccuracy;
+    int         iGPSNACp;
+    double      dGPSAltMSL;
+    double      dGPSVertAccuracy;
+    double      dGPSVertSpeed;
+    StratuxTime lastGPSFixTime;
+    double      dGPSTrueCourse;
+    double      dGPSTurnRate;
+    double      dGPSGroundSpeed;
+    StratuxTime lastGPSGroundTrackTime;
+    StratuxTime gpsDateTime;
+    StratuxTime lastGPSTimeStratuxTime;
+    StratuxTime lastValidNMEAMessageTime;
+    QString     qsLastNMEAMsg;
+    int         iGPSPosSampleRate;
+    double      dBaroTemp;
+    double      dBaroPressAlt;
+    double      dBaroVertSpeed;
+    StratuxTime lastBaroMeasTime;
+    double      dAHRSpitch;
+    double      dAHRSroll;
+    double      dAHRSGyroHeading;
+    double      dAHRSMagHeading;
+    double      dAHRSSlipSkid;
+    double      dAHRSTurnRate;
+    double      dAHRSGLoad;
+    double      dAHRSGLoadMin;
+    double      dAHRSGLoadMax;
+    StratuxTime lastAHRSAttTime;
+    int         iAHRSStatus;
+    bool        bHaveWTData;
+    double      dTAS;
+    QString     qsBADASPversion;
 };
 
 
 // Traffic struct
-// NOTE ICAO is deliberately missing since it's used in a map in a higher level class to differentiate aircraft
 struct StratuxTraffic
 {
-    QString   qsReg;
-    double    dSigLevel;
-    int       iSquawk;
-    bool      bOnGround;
-    double    dLat;
-    double    dLong;
-    bool      bPosValid;
-    double    dAlt;
-    double    dTrack;
-    double    dSpeed;
-    double    dVertSpeed;
-    QString   qsTail;
-    QDateTime lastSeen;
-    QDateTime timestamp;
-    int       iLastSource;
-    double    dBearing;
-    double    dDist;
-    double    dAge;
-    bool      bHasADSB;
-    QDateTime lastActualReport; // Many of the timestamps appear to be bogus, at least the non-ADSB ones. This is the actual time this ICAO registration was reported and what we key off of to cull old entries
+    int         iICAO;      // 24 bit ICAO address; the key into the traffic table
+    QString     qsReg;
+    double      dSigLevel;
+    int         iSquawk;
+    bool        bOnGround;
+    double      dLat;
+    double      dLong;
+    bool        bPosValid;
+    double      dAlt;
+    double      dTrack;
+    double      dSpeed;
+    double      dVertSpeed;
+    QString     qsTail;
+    StratuxTime lastSeen;
+    StratuxTime timestamp;
+    int         iLastSource;
+    double      dBearing;
+    double      dDist;
+    double      dAge;
+    bool        bHasADSB;
 };
 
 
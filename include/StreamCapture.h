@@ -0,0 +1,94 @@
+/*
+Stratofier Stratux AHRS Display
+(c) 2018 Allen K. Lair, Sky Fun
+*/
+
+#ifndef __STREAMCAPTURE_H__
+#define __STREAMCAPTURE_H__
+
+#include <QFile>
+#include <QVector>
+#include <QByteArray>
+#include <QElapsedTimer>
+
+
+// Capture file layout (host byte order, checked on open):
+//   CaptureHeader
+//   CaptureRecord, payload, zero padding to the next 8 byte boundary
+//   CaptureRecord, payload, ...
+// Records are only ever appended so a capture cut short by a crash or power loss is still readable up to the last whole record.
+// The fixed size, aligned record headers let a mapped file be indexed by just hopping from header to header.
+
+struct CaptureHeader
+{
+    char    szMagic[8];     // "STRFCAP"
+    quint32 uiVersion;
+    quint32 uiByteOrder;    // 0x01020304 as written
+};
+
+
+struct CaptureRecord
+{
+    qint64  iTimeNs;        // Nanoseconds since the epoch
+    quint32 uiLen;          // Payload bytes
+    quint8  uiChannel;
+    quint8  uiPad[3];
+};
+
+
+class StreamCapture
+{
+public:
+    enum Channel
+    {
+        Situation = 0,
+        Traffic,
+        Status,
+        WingThing,
+        GDL90
+    };
+};
+
+
+// Append-only writer; one per recording
+class CaptureWriter
+{
+public:
+    CaptureWriter();
+    ~CaptureWriter();
+
+    bool open( const QString &qsFile );
+    void write( StreamCapture::Channel eChannel, const QByteArray &data );
+    void flush();
+
+private:
+    QFile         m_file;
+    qint64        m_iEpochNs;
+    QElapsedTimer m_clock;
+};
+
+
+// Memory mapped reader; the payloads handed out point straight into the mapping
+class CaptureReader
+{
+public:
+    CaptureReader();
+    ~CaptureReader();
+
+    bool open( const QString &qsFile );
+
+    int                    count() const { return m_offsets.count(); }
+    qint64                 timeNs( int i ) const { return record( i )->iTimeNs; }
+    StreamCapture::Channel channel( int i ) const { return static_cast<StreamCapture::Channel>( record( i )->uiChannel ); }
+    QByteArray             payload( int i ) const;
+
+private:
+    const CaptureRecord *record( int i ) const { return reinterpret_cast<const CaptureRecord *>( m_pMap + m_offsets.at( i ) ); }
+
+    QFile           m_file;
+    const uchar    *m_pMap;
+    qint64          m_iSize;
+    QVector<qint64> m_offsets;
+};
+
+#endif // __STREAMCAPTURE_H__
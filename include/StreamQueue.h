@@ -0,0 +1,241 @@
+/*
+Stratofier Stratux AHRS Display
+(c) 2018 Allen K. Lair, Sky Fun
+*/
+
+#ifndef __STREAMQUEUE_H__
+#define __STREAMQUEUE_H__
+
+#include <QAtomicInteger>
+#include <QElapsedTimer>
+
+
+// Lock-free hand-off between the stream thread (the only producer) and the GUI thread (the only consumer).
+// Every entry is stamped on the way in so the consumer can tell how stale it is when it comes out.
+
+
+// Monotonic nanosecond clock shared by both sides of the hand-off
+struct HandoffClock
+{
+    QElapsedTimer timer;
+
+    HandoffClock() { timer.start(); }
+};
+
+
+inline qint64 handoffNow()
+{
+    static const HandoffClock s_clock;
+
+    return s_clock.timer.nsecsElapsed();
+}
+
+
+// Counters since the last call to stats(); depth is the current fill
+struct HandoffStats
+{
+    int     iDepth;
+    int     iMaxDepth;
+    quint32 uiPushed;
+    quint32 uiDropped;      // Ring was full
+    quint32 uiMerged;       // Mailbox value replaced before it was read
+    quint32 uiTaken;
+    double  dMeanAgeMs;
+    double  dMaxAgeMs;
+};
+
+
+// Age bookkeeping; consumer side only
+class HandoffAge
+{
+public:
+    HandoffAge() : m_uiTaken( 0 ), m_iSumNs( 0 ), m_iMaxNs( 0 ) {}
+
+    void taken( qint64 iStamp )
+    {
+        qint64 iAge = handoffNow() - iStamp;
+
+        m_uiTaken++;
+        m_iSumNs += iAge;
+        if( iAge > m_iMaxNs )
+            m_iMaxNs = iAge;
+    }
+
+    void fill( HandoffStats *pStats )
+    {
+        pStats->uiTaken = m_uiTaken;
+        pStats->dMeanAgeMs = (m_uiTaken > 0) ? static_cast<double>( m_iSumNs ) / static_cast<double>( m_uiTaken ) / 1000000.0 : 0.0;
+        pStats->dMaxAgeMs = static_cast<double>( m_iMaxNs ) / 1000000.0;
+        m_uiTaken = 0;
+        m_iSumNs = 0;
+        m_iMaxNs = 0;
+    }
+
+private:
+    quint32 m_uiTaken;
+    qint64  m_iSumNs;
+    qint64  m_iMaxNs;
+};
+
+
+// Single producer, single consumer ring of N entries (N a power of two).
+// push() never blocks; when the consumer falls behind the new entry is dropped and counted.
+template <class T, int N>
+class SpscRing
+{
+    Q_STATIC_ASSERT( (N > 0) && ((N & (N - 1)) == 0) );
+
+public:
+    SpscRing() : m_uiHead( 0 ), m_uiTail( 0 ), m_uiPushed( 0 ), m_uiDropped( 0 ), m_iMaxDepth( 0 ) {}
+
+    // Entries ever accepted; unlike stats() this isn't reset so any number of observers can take differences
+    quint32 total() const { return m_uiHead.loadAcquire(); }
+
+    // Producer
+    bool push( const T &item )
+    {
+        quint32 uiHead = m_uiHead.loadAcquire();
+        quint32 uiTail = m_uiTail.loadAcquire();
+        int     iDepth;
+
+        if( (uiHead - uiTail) >= static_cast<quint32>( N ) )
+        {
+            m_uiDropped.fetchAndAddRelaxed( 1 );
+            return false;
+        }
+        m_slots[uiHead & (N - 1)].item = item;
+        m_slots[uiHead & (N - 1)].iStamp = handoffNow();
+        m_uiHead.storeRelease( uiHead + 1 );
+        m_uiPushed.fetchAndAddRelaxed( 1 );
+
+        // Racing the consumer's reset only ever loses one high water mark
+        iDepth = static_cast<int>( uiHead + 1 - uiTail );
+        if( iDepth > m_iMaxDepth.loadAcquire() )
+            m_iMaxDepth.storeRelease( iDepth );
+
+        return true;
+    }
+
+    // Consumer
+    bool pop( T *pItem )
+    {
+        quint32 uiTail = m_uiTail.loadAcquire();
+
+        if( uiTail == m_uiHead.loadAcquire() )
+            return false;
+        *pItem = m_slots[uiTail & (N - 1)].item;
+        m_age.taken( m_slots[uiTail & (N - 1)].iStamp );
+        m_uiTail.storeRelease( uiTail + 1 );
+
+        return true;
+    }
+
+    int depth() const
+    {
+        return static_cast<int>( m_uiHead.loadAcquire() - m_uiTail.loadAcquire() );
+    }
+
+    // Consumer
+    HandoffStats stats()
+    {
+        HandoffStats stats;
+
+        stats.iDepth = depth();
+        stats.iMaxDepth = m_iMaxDepth.fetchAndStoreOrdered( 0 );
+        stats.uiPushed = m_uiPushed.fetchAndStoreOrdered( 0 );
+        stats.uiDropped = m_uiDropped.fetchAndStoreOrdered( 0 );
+        stats.uiMerged = 0;
+        m_age.fill( &stats );
+
+        return stats;
+    }
+
+private:
+    struct Slot
+    {
+        T      item;
+        qint64 iStamp;
+    };
+
+    Slot                    m_slots[N];
+    QAtomicInteger<quint32> m_uiHead;
+    QAtomicInteger<quint32> m_uiTail;
+    QAtomicInteger<quint32> m_uiPushed;
+    QAtomicInteger<quint32> m_uiDropped;
+    QAtomicInt              m_iMaxDepth;
+    HandoffAge              m_age;
+};
+
+
+// Latest value mailbox (triple buffer). The producer always has a slot to write and never waits;
+// the consumer only ever sees the newest complete value and intermediate ones are merged away.
+template <class T>
+class Mailbox
+{
+public:
+    Mailbox() : m_iShared( 1 ), m_iWrite( 0 ), m_iRead( 2 ), m_uiPushed( 0 ), m_uiMerged( 0 ), m_uiTotal( 0 ) {}
+
+    // Values ever published; never reset
+    quint32 total() const { return m_uiTotal.loadAcquire(); }
+
+    // Producer
+    void publish( const T &value )
+    {
+        int iPrev;
+
+        m_slots[m_iWrite] = value;
+        m_iStamps[m_iWrite] = handoffNow();
+        iPrev = m_iShared.fetchAndStoreOrdered( m_iWrite | Fresh );
+        m_iWrite = iPrev & SlotMask;
+        m_uiPushed.fetchAndAddRelaxed( 1 );
+        m_uiTotal.fetchAndAddRelaxed( 1 );
+        if( iPrev & Fresh )
+            m_uiMerged.fetchAndAddRelaxed( 1 );
+    }
+
+    // Consumer; the newest value if one arrived since the last take, otherwise nullptr.
+    // The pointer stays valid until the next take().
+    const T *take()
+    {
+        if( (m_iShared.loadAcquire() & Fresh) == 0 )
+            return nullptr;
+        m_iRead = m_iShared.fetchAndStoreOrdered( m_iRead ) & SlotMask;
+        m_age.taken( m_iStamps[m_iRead] );
+
+        return &m_slots[m_iRead];
+    }
+
+    // Consumer
+    HandoffStats stats()
+    {
+        HandoffStats stats;
+
+        stats.iDepth = (m_iShared.loadAcquire() & Fresh) ? 1 : 0;
+        stats.iMaxDepth = 1;
+        stats.uiPushed = m_uiPushed.fetchAndStoreOrdered( 0 );
+        stats.uiDropped = 0;
+        stats.uiMerged = m_uiMerged.fetchAndStoreOrdered( 0 );
+        m_age.fill( &stats );
+
+        return stats;
+    }
+
+private:
+    enum
+    {
+        SlotMask = 0x03,
+        Fresh = 0x04
+    };
+
+    T                       m_slots[3];
+    qint64                  m_iStamps[3];
+    QAtomicInt              m_iShared;      // Slot index handed between the two sides plus the fresh flag
+    int                     m_iWrite;       // Producer only
+    int                     m_iRead;        // Consumer only
+    QAtomicInteger<quint32> m_uiPushed;
+    QAtomicInteger<quint32> m_uiMerged;
+    QAtomicInteger<quint32> m_uiTotal;
+    HandoffAge              m_age;
+};
+
+#endif // __STREAMQUEUE_H__
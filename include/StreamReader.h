@@ -10,19 +10,34 @@ Stratofier Stratux AHRS Display
 #include <QWebSocket>
 #include <QUdpSocket>
 #include <QPair>
+#include <QTimer>
+#include <QAtomicInt>
 
 #include "StratuxStreams.h"
+#include "StratuxParser.h"
+#include "StreamQueue.h"
 #include "Canvas.h"
 
 
 class QCoreApplication;
+class Benchmark;
+class CaptureWriter;
+class CaptureReader;
 
 
 class StreamReader : public QObject
 {
     Q_OBJECT
 
+    friend class Benchmark;
+
 public:
+    enum InputMode
+    {
+        JSONInput,      // Stratux websockets
+        GDL90Input      // GDL90 broadcast on UDP port 4000
+    };
+
     explicit StreamReader( const QString &qsIP );
     ~StreamReader();
 
@@ -32,11 +47,24 @@ public:
     static void initSituation( StratuxSituation &situation );
     static void initStatus( StratuxStatus &status );
 
-    void setUnits( Canvas::Units eUnits ) { m_eUnits = eUnits; }
+    // These may be called from the GUI thread; the work is handed to the stream thread
+    void setUnits( Canvas::Units eUnits );
     void setBaroPress( double dBaro );
     void snapshotOrientation();
+    void setAirspeedCal( double dCal );
+
+    // Consumer side of the hand-off (GUI thread only)
+    const StratuxSituation *takeSituation() { return m_situationBox.take(); }
+    bool                    takeTraffic( StratuxTraffic *pTraffic ) { return m_trafficRing.pop( pTraffic ); }
+    void                    drained() { m_iWakePending.storeRelease( 0 ); }
+    HandoffStats            situationStats() { return m_situationBox.stats(); }
+    HandoffStats            trafficStats() { return m_trafficRing.stats(); }
+    quint32                 updatesTotal() const { return m_situationBox.total() + m_trafficRing.total(); }
 
-    void setAirspeedCal( double dCal ) { m_dAirspeedCal = dCal; }
+    void setInputMode( InputMode eMode ) { m_eInput = eMode; }
+    bool setGDL90Capture( const QString &qsFile );
+    bool setRecordFile( const QString &qsFile );
+    bool setReplayFile( const QString &qsFile, double dSpeed );
 
 public slots:
     void connectStreams();
@@ -48,6 +76,17 @@ protected:
 private:
     double unitsMult();
     void   calcHeading( double dX, double dY, double dZ );
+    void   publishSituation( StratuxSituation &situation );
+    void   publishTraffic( StratuxTraffic &traffic, int iICAO );
+    void   publishStatus( StratuxStatus &status );
+
+    void   gdl90Message( const QByteArray &msg );
+    void   wake();
+    void   wtDatagram( const QByteArray &data, const QHostAddress &sender );
+    void   record( int iChannel, const QByteArray &data );
+    void   replayRecord( int i );
+
+    static bool splitField( const QString &qsField, QByteArray *pTag, QByteArray *pVal, StratuxParser::Field *pField );
 
     bool          m_bHaveMyPos;
     bool          m_bAHRSStatus;
@@ -80,22 +119,63 @@ private:
 
     double             m_dRollRef, m_dPitchRef, m_dRawRoll, m_dRawPitch;
     double             m_dAirspeedCal;
+    bool               m_bLegacyParser;
+
+    InputMode          m_eInput;
+    QUdpSocket         m_gdl90Socket;
+    QByteArray         m_gdl90Pending;      // Partial frame carried over to the next read
+    StratuxSituation   m_gdl90Situation;    // GDL90 delivers the situation in pieces so it's accumulated here
+    int                m_iGDL90Traffic;     // Traffic reports since the last heartbeat
+    QByteArray         m_gdl90Capture;
+    int                m_iCapturePos;
+    QTimer             m_captureTimer;
+
+    // The canvas drains the traffic on every dataReady() as well as every frame, so the ring only has to cover the GUI
+    // being busy; a few thousand targets reporting once a second each is a couple of seconds of that
+    Mailbox<StratuxSituation>      m_situationBox;
+    SpscRing<StratuxTraffic, 4096> m_trafficRing;
+    QAtomicInt                     m_iWakePending;  // A dataReady() is already on its way to the GUI
+
+    CaptureWriter *m_pRecorder;
+    CaptureReader *m_pReplay;
+    double         m_dReplaySpeed;
+    int            m_iReplayPos;
+    qint64         m_iReplayDueNs;      // When the record at m_iReplayPos is due, relative to the start of the replay
+    QElapsedTimer  m_replayClock;
+    QTimer         m_replayTimer;
 
 private slots:
     void situationUpdate( const QString &qsMessage );
     void trafficUpdate( const QString &qsMessage );
     void statusUpdate( const QString &qsMessage );
+    void situationText( const QString &qsMessage );
+    void trafficText( const QString &qsMessage );
+    void statusText( const QString &qsMessage );
+    void situationBytes( const QByteArray &message );
+    void trafficBytes( const QByteArray &message );
+    void statusBytes( const QByteArray &message );
+    void openStreams();
+    void closeStreams();
+    void applyUnits( int iUnits );
+    void applyAirspeedCal( double dCal );
+    void sendBaroPress( double dBaro );
+    void snapshotRefs();
     void stratuxConnected();
     void stratuxDisconnected();
 
     void wtDataAvail();
     void wtDisconnected();
 
+    void gdl90DataAvail();
+    void gdl90Bytes( const QByteArray &data );
+    void gdl90CaptureStep();
+    void replayStep();
+
 signals:
-    void newSituation( StratuxSituation );
-    void newTraffic( StratuxTraffic );          // ICAO, Rest of traffic struct
+    void dataReady();                           // Situation or traffic waiting in the hand-off; not repeated until drained() is called
     void newStatus( bool, bool, bool, bool );   // Stratux available, AHRS available, GPS available, Traffic available
     void newWTStatus( bool );                   // Valid WingThing sensor data has been received
+    void replayFinished();
 };
 
 #endif // __STREAMREADER_H__
@@ -0,0 +1,79 @@
+/*
+Stratofier Stratux AHRS Display
+(c) 2018 Allen K. Lair, Sky Fun
+*/
+
+#ifndef __STRINGTABLE_H__
+#define __STRINGTABLE_H__
+
+#include <QByteArray>
+#include <QString>
+#include <QHash>
+
+
+// Block of NUL terminated UTF-8 strings addressed by offset, each distinct string stored once.
+// Offset 0 is always the empty string. The lookup that makes adding strings dedupe is only wanted while a table is
+// being filled; squeeze() drops it, after which adds still work but no longer find earlier copies.
+class StringTable
+{
+public:
+    StringTable() { clear(); }
+
+    void clear()
+    {
+        m_data = QByteArray( 1, '\0' );
+        m_offsets.clear();
+    }
+
+    quint32 add( const QString &qs )
+    {
+        QByteArray utf8;
+        quint32    uiOffset;
+
+        if( qs.isEmpty() )
+            return 0;
+        utf8 = qs.toUtf8();
+        if( m_offsets.contains( utf8 ) )
+            return m_offsets.value( utf8 );
+        uiOffset = static_cast<quint32>( m_data.size() );
+        m_data.append( utf8 );
+        m_data.append( '\0' );
+        m_offsets.insert( utf8, uiOffset );
+
+        return uiOffset;
+    }
+
+    // Tacks another table on the end; its offsets move up by the return value
+    quint32 append( const StringTable &other )
+    {
+        quint32 uiBase = static_cast<quint32>( m_data.size() );
+
+        m_data.append( other.m_data );
+
+        return uiBase;
+    }
+
+    // Takes a whole table as written out by data(); the caller has checked it ends in a terminator
+    void setData( const QByteArray &data )
+    {
+        m_data = data;
+        m_offsets.clear();
+    }
+
+    void squeeze()
+    {
+        m_offsets = QHash<QByteArray, quint32>();
+        m_data.squeeze();
+    }
+
+    bool              contains( quint32 uiOffset ) const { return uiOffset < static_cast<quint32>( m_data.size() ); }
+    const char       *at( quint32 uiOffset ) const { return m_data.constData() + uiOffset; }
+    QString           string( quint32 uiOffset ) const { return QString::fromUtf8( at( uiOffset ) ); }
+    const QByteArray &data() const { return m_data; }
+
+private:
+    QByteArray                 m_data;
+    QHash<QByteArray, quint32> m_offsets;
+};
+
+#endif // __STRINGTABLE_H__
@@ -0,0 +1,78 @@
+/*
+Stratofier Stratux AHRS Display
+(c) 2018 Allen K. Lair, Sky Fun
+*/
+
+#ifndef __TRAFFICGEOMETRY_H__
+#define __TRAFFICGEOMETRY_H__
+
+#include <QVector>
+
+
+// Per slot flags in TrafficArrays
+enum TrafficFlag
+{
+    TrafficUsed = 0x01,
+    TrafficHasPos = 0x02,       // Position valid and ownship position known when it was reported (StratuxTraffic::bHasADSB)
+    TrafficOnGround = 0x04
+};
+
+
+// The traffic table's hot fields as parallel arrays, one entry per slot
+struct TrafficArrays
+{
+    QVector<float>  fLat;
+    QVector<float>  fLong;
+    QVector<float>  fAlt;           // Feet
+    QVector<float>  fTrack;         // Degrees true
+    QVector<float>  fSpeed;
+    QVector<quint8> uiFlags;
+};
+
+
+// Everything about ownship and the display that's the same for every target in a frame
+struct TrafficView
+{
+    double dLat;
+    double dLong;
+    double dAlt;            // Feet
+    double dHeading;        // Straight up on the heading indicator, degrees
+    double dPxPerNM;
+    double dCenterX;        // Ownship on screen
+    double dCenterY;
+};
+
+
+// Per slot results; entries for unused slots are computed but meaningless
+struct TrafficPlot
+{
+    QVector<float> fX;          // Screen position
+    QVector<float> fY;
+    QVector<float> fBearing;    // Degrees true from ownship, 0 to 360
+    QVector<float> fDist;       // Nautical miles
+    QVector<float> fAltDelta;   // Feet above ownship
+};
+
+
+// Relative geometry for the whole traffic table in one pass.
+// Positions use the same flat earth approximation as TrafficMath::haversine with the scale taken at ownship's latitude.
+// Every kernel runs exactly the same sequence of IEEE single precision operations (no fused multiply-add, bearing from the
+// same polynomial arctangent) so the vector kernels match the scalar one bit for bit.
+class TrafficGeometry
+{
+public:
+    enum Kernel
+    {
+        Scalar,
+        SSE2,
+        AVX2,
+        NEON
+    };
+
+    static Kernel      best();
+    static const char *name( Kernel eKernel );
+    static void        compute( const TrafficArrays &in, const TrafficView &view, TrafficPlot *pOut, Kernel eKernel );
+    static void        compute( const TrafficArrays &in, const TrafficView &view, TrafficPlot *pOut ) { compute( in, view, pOut, best() ); }
+};
+
+#endif // __TRAFFICGEOMETRY_H__
@@ -7,23 +7,56 @@ Stratofier Stratux AHRS Display
 #define TRAFFICMATH_H
 
 #include <QList>
+#include <QRectF>
 
 #include "Canvas.h"
+#include "Snapshot.h"
+#include "AirportCache.h"
+#include "AirportIndex.h"
+#include "AirspaceIndex.h"
+
+
+// Every selected country's airports or airspace merged, with the index over them; published whole by the cache loaders
+struct AirportData
+{
+    AirportCache airports;
+    AirportIndex index;
+};
+
+
+struct AirspaceData
+{
+    QList<Airspace> airspaces;
+    AirspaceIndex   index;
+};
+
+
+typedef Snapshot<AirportData>  AirportDatabase;
+typedef Snapshot<AirspaceData> AirspaceDatabase;
+
+// What the nearby airport and airspace workers publish for the display
+typedef Snapshot<QList<Airport> >  NearbyAirports;
+typedef Snapshot<QList<Airspace> > NearbyAirspaces;
 
 
 class TrafficMath
 {
 public:
     static BearingDist haversine( double dLat1, double dLong1, double dLat2, double dLong2 );
+    static void        haversine( double dLat1, double dLong1, const double *pLat2, const double *pLong2, BearingDist *pOut, int iCount );
+    static const char *haversineKernel();
+    static int         rangeBoxes( double dLat, double dLong, double dRangeNM, QRectF *pBoxes );
+    static void        simplifyShape( const QPolygonF &shape, QVector<quint8> *pLevels );
+    static int         shapeLevel( double dNMPerPx );
     static double      radiansRel( double dAng );
     static double      degHeading( double dAng );
 
     static void    cacheAirports();
     static void    cacheAirspaces();
-    static void    updateNearbyAirports( QList<Airport> *pAirports, Airport *pDirect, Airport *pFrom, Airport *pTo, double dDist );
+    static void    updateNearbyAirports( NearbyAirports *pNearby, int iRequest, QList<Airport> nav, double dDist );
     static Airport getCurrentAirport();
-    static void    updateNearbyAirspaces( QList<Airspace> *pAirspaces, double dDist );
-    static int     findAirport( Airport *pAirport, QList<Airport> *apList );
+    static void    updateNearbyAirspaces( NearbyAirspaces *pNearby, int iRequest, double dDist, double dNMPerPx );
+    static int     findAirport( const Airport *pAirport, const QList<Airport> *apList );
 };
 
 #endif // TRAFFICMATH_H
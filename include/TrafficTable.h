@@ -0,0 +1,102 @@
+/*
+Stratofier Stratux AHRS Display
+(c) 2018 Allen K. Lair, Sky Fun
+*/
+
+#ifndef __TRAFFICTABLE_H__
+#define __TRAFFICTABLE_H__
+
+#include <QVector>
+
+#include "StratuxStreams.h"
+#include "TrafficGeometry.h"
+
+
+// Counters since the last call to stats(); count is the current number of aircraft
+struct TrafficTableStats
+{
+    int     iCount;
+    quint32 uiAdded;
+    quint32 uiRefreshed;
+    quint32 uiExpired;
+};
+
+
+// Traffic keyed by the 24 bit ICAO address.
+// Each aircraft keeps the same slot for as long as it's tracked; a removed aircraft's slot goes on a free list for the next one.
+// The address to slot index is open addressed (linear probing, backward shift delete) so update, find and remove
+// are O(1) amortized and never scan the whole table.
+//
+// Expiry runs off a timing wheel of one second buckets. Every report moves its aircraft to the bucket for the second it
+// will go stale in, so expire() only ever visits the buckets that have come due and the aircraft in them; when nothing
+// is stale it's a couple of compares.
+// Times are milliseconds on any monotonic clock the caller likes, as long as it's the same one throughout.
+// Not thread safe. g_trafficTable is only touched on the GUI thread; the render thread paints a copy, which is cheap
+// since the arrays are implicitly shared until one side changes them.
+//
+// The fields the display positions every frame are mirrored into parallel arrays indexed by slot so project() can run
+// the whole table through the vector geometry kernel in one pass.
+//
+// Walking the table:
+//     for( i = 0; i < g_trafficTable.slots(); i++ )
+//     {
+//         const StratuxTraffic *pTraffic = g_trafficTable.slot( i );
+//
+//         if( pTraffic == nullptr )
+//             continue;
+//         ...
+//     }
+class TrafficTable
+{
+public:
+    TrafficTable();
+
+    void                  setTimeout( int iSecs );
+    void                  update( const StratuxTraffic &traffic, qint64 iNowMs );
+    int                   expire( qint64 iNowMs );
+    StratuxTraffic       *find( int iICAO );
+    bool                  remove( int iICAO );
+    void                  clear();
+    TrafficTableStats     stats();
+
+    int                   count() const { return m_iCount; }
+    int                   slots() const { return m_slots.count(); }
+    const StratuxTraffic *slot( int i ) const { return m_bUsed.at( i ) ? &m_slots.at( i ) : nullptr; }
+    const TrafficArrays  &arrays() const { return m_arrays; }
+    const TrafficPlot    &project( const TrafficView &view );
+
+private:
+    // Where the slot sits on the wheel; the bucket lists are doubly linked through the slot numbers
+    struct WheelLink
+    {
+        qint64 iExpireSec;
+        int    iPrev;
+        int    iNext;
+    };
+
+    int  indexOf( int iICAO ) const;
+    void grow();
+    void schedule( int iSlot, qint64 iExpireSec );
+    void unschedule( int iSlot );
+    void removeSlot( int iBucket );
+    void storeArrays( int iSlot, const StratuxTraffic &traffic );
+
+    QVector<StratuxTraffic> m_slots;
+    QVector<bool>           m_bUsed;
+    QVector<WheelLink>      m_links;
+    QVector<int>            m_freeSlots;
+    QVector<int>            m_index;        // Slot number per hash bucket, -1 for empty; size is a power of two
+    int                     m_iCount;
+    TrafficArrays           m_arrays;
+    TrafficPlot             m_plot;
+
+    QVector<int> m_wheel;           // First slot in each one second bucket, -1 for empty; size is a power of two larger than the timeout
+    int          m_iTimeoutSecs;
+    qint64       m_iWheelSec;       // Every bucket up to and including this second has been expired
+
+    quint32 m_uiAdded;
+    quint32 m_uiRefreshed;
+    quint32 m_uiExpired;
+};
+
+#endif // __TRAFFICTABLE_H__
@@ -10,6 +10,7 @@ Stratofier Stratux AHRS Display
 #include <QDir>
 #include <QSettings>
 #include <QFontDatabase>
+#include <QThread>
 
 #include "AHRSMainWin.h"
 #include "Keyboard.h"
@@ -41,6 +42,12 @@ int main( int argc, char *argv[] )
     QString      qsIP;
     bool         bPortrait = true;
     AHRSMainWin *pMainWin = 0;
+    QThread      streamThread;
+    QString      qsInput;
+    QString      qsGDL90File;
+    QString      qsRecord;
+    QString      qsReplay;
+    double       dReplaySpeed = 1.0;
     QString      qsCurrWorkPath( "/home/pi/Stratofier" );  // If you put Stratofier anywhere else, specify home=<whatever> as an argument when running
 
 #if defined( Q_OS_ANDROID )
@@ -64,6 +71,16 @@ int main( int argc, char *argv[] )
                 bPortrait = (qsVal == "portrait");
             else if( qsToken == "home" )
                 qsCurrWorkPath = qsVal;
+            else if( qsToken == "input" )
+                qsInput = qsVal;
+            else if( qsToken == "gdl90file" )
+                qsGDL90File = qsVal;
+            else if( qsToken == "record" )
+                qsRecord = qsVal;
+            else if( qsToken == "replay" )
+                qsReplay = qsVal;
+            else if( qsToken == "replayspeed" )
+                dReplaySpeed = (qsVal == "max") ? 0.0 : qsVal.toDouble();
         }
     }
 
@@ -88,10 +105,29 @@ int main( int argc, char *argv[] )
     g_pSet = new QSettings;
 #endif
 
-    qsIP = g_pSet->value( "StratuxIP", "192.168.10.1" ).toString();
+    // ip= on the command line (a simulator, say) wins over the setting for this run
+    if( qsIP.isEmpty() )
+        qsIP = g_pSet->value( "StratuxIP", "192.168.10.1" ).toString();
 
     qInfo() << "Starting Stratofier";
     g_pStratuxStream = new StreamReader( qsIP );
+    // Command line overrides the InputMode setting for this run
+    if( qsInput == "gdl90" )
+        g_pStratuxStream->setInputMode( StreamReader::GDL90Input );
+    else if( qsInput == "json" )
+        g_pStratuxStream->setInputMode( StreamReader::JSONInput );
+    if( !qsGDL90File.isEmpty() )
+        g_pStratuxStream->setGDL90Capture( qsGDL90File );
+    if( !qsRecord.isEmpty() )
+        g_pStratuxStream->setRecordFile( qsRecord );
+    if( !qsReplay.isEmpty() )
+        g_pStratuxStream->setReplayFile( qsReplay, dReplaySpeed );
+
+    // Sockets and parsing get their own thread so a long paint never holds up a read (and vice versa)
+    streamThread.setObjectName( "StratuxStream" );
+    g_pStratuxStream->moveToThread( &streamThread );
+    QObject::connect( &streamThread, SIGNAL( finished() ), g_pStratuxStream, SLOT( deleteLater() ) );
+    streamThread.start();
     pMainWin = new AHRSMainWin( qsIP, bPortrait, g_pStratuxStream );
     // This is the normal mode for a dedicated Raspberry Pi touchscreen or on Android
     if( bMax )
@@ -108,7 +144,9 @@ int main( int argc, char *argv[] )
 
     guiApp.exec();
 
-    delete g_pStratuxStream;
+    // The reader is deleted on the stream thread as it finishes
+    streamThread.quit();
+    streamThread.wait();
     g_pStratuxStream = nullptr;
 
     return 0;
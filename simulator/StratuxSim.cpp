@@ -0,0 +1,716 @@
+/*
+Stratofier Stratux AHRS Display
+(c) 2018 Allen K. Lair, Sky Fun
+*/
+
+#include <QtDebug>
+#include <QFile>
+#include <QTextStream>
+#include <QDateTime>
+#include <QUrl>
+
+#include <math.h>
+
+#include "StratuxSim.h"
+
+
+static const double s_dDegToRad = 0.01745329252;
+static const double s_dNMToMeters = 1852.0;
+static const double s_dTrafficTickHz = 50.0;    // Traffic reports are spread across ticks at this rate
+static const int    s_iMaxTargets = 9999;       // Tail numbers are SIM0000 to SIM9998
+
+
+static inline double wrap360( double dAngle )
+{
+    while( dAngle < 0.0 )
+        dAngle += 360.0;
+    while( dAngle >= 360.0 )
+        dAngle -= 360.0;
+
+    return dAngle;
+}
+
+
+static inline void addField( QByteArray *pMsg, const char *szTag, double dVal, int iPrec )
+{
+    pMsg->append( '"' ).append( szTag ).append( "\":" ).append( QByteArray::number( dVal, 'f', iPrec ) ).append( ',' );
+}
+
+
+static inline void addField( QByteArray *pMsg, const char *szTag, int iVal )
+{
+    pMsg->append( '"' ).append( szTag ).append( "\":" ).append( QByteArray::number( iVal ) ).append( ',' );
+}
+
+
+static inline void addField( QByteArray *pMsg, const char *szTag, bool bVal )
+{
+    pMsg->append( '"' ).append( szTag ).append( "\":" ).append( bVal ? "true" : "false" ).append( ',' );
+}
+
+
+static inline void addField( QByteArray *pMsg, const char *szTag, const char *szVal )
+{
+    pMsg->append( '"' ).append( szTag ).append( "\":\"" ).append( szVal ).append( "\"," );
+}
+
+
+// Replace the trailing comma with the closing brace
+static inline void closeMessage( QByteArray *pMsg )
+{
+    if( pMsg->endsWith( ',' ) )
+        pMsg->chop( 1 );
+    pMsg->append( '}' );
+}
+
+
+StratuxSim::StratuxSim( QObject *pParent )
+    : QObject( pParent ),
+      m_server( "StratuxSim", QWebSocketServer::NonSecureMode, this ),
+      m_wtSocket( this ),
+      m_wtHost( "192.168.10.255" ),
+      m_situationTimer( this ),
+      m_trafficTimer( this ),
+      m_statusTimer( this ),
+      m_wtTimer( this ),
+      m_statsTimer( this ),
+      m_scriptTimer( this ),
+      m_random( 1 ),
+      m_dSituationHz( 10.0 ),
+      m_dTrafficHz( 1.0 ),
+      m_dStatusHz( 1.0 ),
+      m_dWingThingHz( 0.0 ),
+      m_iJitterMs( 0 ),
+      m_ePattern( Straight ),
+      m_dRadiusNM( 20.0 ),
+      m_bOwnshipOrbit( false ),
+      m_dLat( 45.0 ),
+      m_dLong( -93.0 ),
+      m_dAlt( 3500.0 ),
+      m_dTrack( 0.0 ),
+      m_dSpeed( 110.0 ),
+      m_dPitch( 0.0 ),
+      m_dRoll( 0.0 ),
+      m_iLastOwnshipMs( 0 ),
+      m_iNextTarget( 0 ),
+      m_dTrafficDue( 0.0 ),
+      m_iLastTrafficMs( 0 ),
+      m_uiSituationSent( 0 ),
+      m_uiTrafficSent( 0 ),
+      m_uiStatusSent( 0 ),
+      m_uiWingThingSent( 0 ),
+      m_iBytesSent( 0 )
+{
+    // Every timer is single shot and restarted with its own jitter
+    m_situationTimer.setSingleShot( true );
+    m_trafficTimer.setSingleShot( true );
+    m_statusTimer.setSingleShot( true );
+    m_wtTimer.setSingleShot( true );
+    m_scriptTimer.setSingleShot( true );
+    m_situationTimer.setTimerType( Qt::PreciseTimer );
+    m_trafficTimer.setTimerType( Qt::PreciseTimer );
+    m_wtTimer.setTimerType( Qt::PreciseTimer );
+
+    connect( &m_server, SIGNAL( newConnection() ), this, SLOT( newClient() ) );
+    connect( &m_situationTimer, SIGNAL( timeout() ), this, SLOT( situationTick() ) );
+    connect( &m_trafficTimer, SIGNAL( timeout() ), this, SLOT( trafficTick() ) );
+    connect( &m_statusTimer, SIGNAL( timeout() ), this, SLOT( statusTick() ) );
+    connect( &m_wtTimer, SIGNAL( timeout() ), this, SLOT( wingThingTick() ) );
+    connect( &m_statsTimer, SIGNAL( timeout() ), this, SLOT( statsTick() ) );
+    connect( &m_scriptTimer, SIGNAL( timeout() ), this, SLOT( scriptTick() ) );
+}
+
+
+StratuxSim::~StratuxSim()
+{
+    m_server.close();
+}
+
+
+bool StratuxSim::listen( quint16 uiPort )
+{
+    if( !m_server.listen( QHostAddress::Any, uiPort ) )
+    {
+        qWarning() << "Unable to listen on port" << uiPort << m_server.errorString();
+        return false;
+    }
+    qInfo() << "Serving /situation, /traffic and /status on port" << uiPort;
+
+    return true;
+}
+
+
+// Script lines are "<seconds from start> <setting> [<setting> ...]"; # starts a comment.
+// e.g.
+//     0    targets=50 pattern=orbit trafficrate=1
+//     30   targets=2000 jitter=15
+//     120  quit
+bool StratuxSim::loadScript( const QString &qsFile )
+{
+    QFile       script( qsFile );
+    QString     qsLine;
+    QStringList qslTokens;
+    ScriptStep  step;
+    bool        bOk;
+    int         iLine = 0;
+
+    if( !script.open( QIODevice::ReadOnly | QIODevice::Text ) )
+    {
+        qWarning() << "Unable to open script" << qsFile;
+        return false;
+    }
+
+    QTextStream in( &script );
+
+    m_script.clear();
+    while( !in.atEnd() )
+    {
+        qsLine = in.readLine();
+        iLine++;
+        qsLine = qsLine.left( qsLine.indexOf( '#' ) ).simplified();
+        if( qsLine.isEmpty() )
+            continue;
+        qslTokens = qsLine.split( ' ' );
+        step.iAtMs = static_cast<qint64>( qslTokens.takeFirst().toDouble( &bOk ) * 1000.0 );
+        if( !bOk )
+        {
+            qWarning() << "Script line" << iLine << "doesn't start with a time";
+            return false;
+        }
+        step.qslSettings = qslTokens;
+        m_script.append( step );
+    }
+
+    return true;
+}
+
+
+// Apply one token=value setting; rate changes take effect from the next send
+bool StratuxSim::apply( const QString &qsSetting )
+{
+    QStringList qsl = qsSetting.split( '=' );
+    QString     qsToken = qsl.first();
+    QString     qsVal = qsl.last();
+    bool        bRunning = m_clock.isValid();
+
+    if( qsSetting == "quit" )
+    {
+        emit finished();
+        return true;
+    }
+    if( qsl.count() != 2 )
+        return false;
+
+    if( qsToken == "situationrate" )
+    {
+        m_dSituationHz = qsVal.toDouble();
+        if( bRunning )
+            restart( &m_situationTimer, m_dSituationHz );
+    }
+    else if( qsToken == "trafficrate" )
+        m_dTrafficHz = qsVal.toDouble();
+    else if( qsToken == "statusrate" )
+    {
+        m_dStatusHz = qsVal.toDouble();
+        if( bRunning )
+            restart( &m_statusTimer, m_dStatusHz );
+    }
+    else if( qsToken == "wtrate" )
+    {
+        m_dWingThingHz = qsVal.toDouble();
+        if( bRunning )
+            restart( &m_wtTimer, m_dWingThingHz );
+    }
+    else if( qsToken == "wthost" )
+        m_wtHost = QHostAddress( qsVal );
+    else if( qsToken == "jitter" )
+        m_iJitterMs = qMax( qsVal.toInt(), 0 );
+    else if( qsToken == "targets" )
+        setTargetCount( qsVal.toInt() );
+    else if( qsToken == "radius" )
+        m_dRadiusNM = qMax( qsVal.toDouble(), 0.5 );
+    else if( qsToken == "pattern" )
+    {
+        if( qsVal == "straight" )
+            m_ePattern = Straight;
+        else if( qsVal == "orbit" )
+            m_ePattern = Orbit;
+        else if( qsVal == "wander" )
+            m_ePattern = Wander;
+        else if( qsVal == "converge" )
+            m_ePattern = Converge;
+        else
+            return false;
+    }
+    else if( qsToken == "seed" )
+        m_random.seed( qsVal.toUInt() );
+    else if( qsToken == "lat" )
+        m_dLat = qsVal.toDouble();
+    else if( qsToken == "lon" )
+        m_dLong = qsVal.toDouble();
+    else if( qsToken == "alt" )
+        m_dAlt = qsVal.toDouble();
+    else if( qsToken == "speed" )
+        m_dSpeed = qsVal.toDouble();
+    else if( qsToken == "track" )
+        m_dTrack = wrap360( qsVal.toDouble() );
+    else if( qsToken == "ownship" )
+        m_bOwnshipOrbit = (qsVal == "orbit");
+    else
+        return false;
+
+    return true;
+}
+
+
+void StratuxSim::start()
+{
+    m_clock.start();
+    m_iLastOwnshipMs = 0;
+    m_iLastTrafficMs = 0;
+    for( int i = 0; i < m_targets.count(); i++ )
+        m_targets[i].iLastMoveMs = 0;
+
+    restart( &m_situationTimer, m_dSituationHz );
+    restart( &m_trafficTimer, s_dTrafficTickHz );
+    restart( &m_statusTimer, m_dStatusHz );
+    restart( &m_wtTimer, m_dWingThingHz );
+    m_statsTimer.start( 1000 );
+
+    if( !m_script.isEmpty() )
+        m_scriptTimer.start( static_cast<int>( m_script.first().iAtMs ) );
+}
+
+
+// Next single shot at the given rate, moved by up to the jitter either way; a zero rate stops the stream
+void StratuxSim::restart( QTimer *pTimer, double dRateHz )
+{
+    int iInterval;
+
+    if( dRateHz <= 0.0 )
+    {
+        pTimer->stop();
+        return;
+    }
+
+    iInterval = static_cast<int>( 1000.0 / dRateHz );
+    if( m_iJitterMs > 0 )
+        iInterval += m_random.bounded( -m_iJitterMs, m_iJitterMs + 1 );
+    pTimer->start( qMax( iInterval, 1 ) );
+}
+
+
+// Targets that already exist keep flying; new ones are spawned around ownship
+void StratuxSim::setTargetCount( int iCount )
+{
+    int iOld = m_targets.count();
+
+    iCount = qBound( 0, iCount, s_iMaxTargets );
+    m_targets.resize( iCount );
+    for( int i = iOld; i < iCount; i++ )
+    {
+        m_targets[i].iICAO = 0xA00001 + i;
+        qsnprintf( m_targets[i].szTail, sizeof( m_targets[i].szTail ), "SIM%04d", i );
+        spawn( &m_targets[i] );
+    }
+    if( m_iNextTarget >= iCount )
+        m_iNextTarget = 0;
+}
+
+
+void StratuxSim::spawn( SimTarget *pTarget )
+{
+    // Square root keeps the spread even over the area rather than bunched in the middle
+    double dDist = sqrt( m_random.generateDouble() ) * m_dRadiusNM;
+
+    pTarget->dLat = m_dLat;
+    pTarget->dLong = m_dLong;
+    offset( m_random.generateDouble() * 360.0, dDist, &pTarget->dLat, &pTarget->dLong );
+    pTarget->dAlt = qMax( m_dAlt + ((m_random.generateDouble() * 10000.0) - 5000.0), 0.0 );
+    pTarget->dTrack = m_random.generateDouble() * 360.0;
+    pTarget->dSpeed = 80.0 + (m_random.generateDouble() * 370.0);
+    pTarget->dVertSpeed = (m_random.bounded( 3 ) == 0) ? ((m_random.generateDouble() * 3000.0) - 1500.0) : 0.0;
+    pTarget->dTurnRate = (1.0 + (m_random.generateDouble() * 2.0)) * ((m_random.bounded( 2 ) == 0) ? -1.0 : 1.0);
+    pTarget->iSquawk = 1200;
+    pTarget->iLastMoveMs = m_clock.isValid() ? m_clock.elapsed() : 0;
+}
+
+
+void StratuxSim::move( SimTarget *pTarget, qint64 iNowMs )
+{
+    double dSecs = static_cast<double>( iNowMs - pTarget->iLastMoveMs ) / 1000.0;
+    double dDist = distanceNM( pTarget->dLat, pTarget->dLong );
+
+    pTarget->iLastMoveMs = iNowMs;
+
+    switch( m_ePattern )
+    {
+        case Orbit:
+            pTarget->dTrack += pTarget->dTurnRate * dSecs;
+            break;
+        case Wander:
+            pTarget->dTrack += ((m_random.generateDouble() * 2.0) - 1.0) * 10.0 * dSecs;
+            break;
+        case Converge:
+            if( dDist < 0.3 )
+            {
+                spawn( pTarget );
+                return;
+            }
+            pTarget->dTrack = bearingTo( pTarget->dLat, pTarget->dLong ) + 180.0;
+            break;
+        case Straight:
+            break;
+    }
+
+    // Anything that strays too far turns back toward ownship
+    if( (m_ePattern != Converge) && (dDist > m_dRadiusNM * 1.5) )
+        pTarget->dTrack = bearingTo( pTarget->dLat, pTarget->dLong ) + 180.0;
+
+    pTarget->dTrack = wrap360( pTarget->dTrack );
+    offset( pTarget->dTrack, pTarget->dSpeed * dSecs / 3600.0, &pTarget->dLat, &pTarget->dLong );
+    pTarget->dAlt = qMax( pTarget->dAlt + (pTarget->dVertSpeed * dSecs / 60.0), 0.0 );
+}
+
+
+// Ownship either flies straight with a little wing rocking or holds a standard rate turn
+void StratuxSim::moveOwnship( double dSecs )
+{
+    double dT = static_cast<double>( m_clock.elapsed() ) / 1000.0;
+
+    if( m_bOwnshipOrbit )
+    {
+        m_dTrack = wrap360( m_dTrack + (3.0 * dSecs) );
+        m_dRoll = 20.0 + (2.0 * sin( dT ));
+    }
+    else
+        m_dRoll = 5.0 * sin( dT / 3.0 );
+    m_dPitch = 2.0 * sin( dT / 4.0 );
+    offset( m_dTrack, m_dSpeed * dSecs / 3600.0, &m_dLat, &m_dLong );
+}
+
+
+// Flat earth is plenty over the few tens of miles the simulator works in
+void StratuxSim::offset( double dBearing, double dDistNM, double *pLat, double *pLong )
+{
+    double dRad = dBearing * s_dDegToRad;
+
+    *pLat += dDistNM * cos( dRad ) / 60.0;
+    *pLong += dDistNM * sin( dRad ) / (60.0 * cos( *pLat * s_dDegToRad ));
+}
+
+
+double StratuxSim::distanceNM( double dLat, double dLong )
+{
+    double dX = (dLong - m_dLong) * 60.0 * cos( m_dLat * s_dDegToRad );
+    double dY = (dLat - m_dLat) * 60.0;
+
+    return sqrt( (dX * dX) + (dY * dY) );
+}
+
+
+// Bearing from ownship to the position
+double StratuxSim::bearingTo( double dLat, double dLong )
+{
+    double dX = (dLong - m_dLong) * cos( m_dLat * s_dDegToRad );
+    double dY = dLat - m_dLat;
+
+    return wrap360( atan2( dX, dY ) / s_dDegToRad );
+}
+
+
+void StratuxSim::broadcast( QList<QWebSocket *> &clients, const QByteArray &message )
+{
+    QString qsMessage = QString::fromLatin1( message );
+
+    foreach( QWebSocket *pClient, clients )
+        pClient->sendTextMessage( qsMessage );
+    m_iBytesSent += message.size() * clients.count();
+}
+
+
+QByteArray StratuxSim::situationMessage()
+{
+    QByteArray qsNow = QDateTime::currentDateTimeUtc().toString( Qt::ISODateWithMs ).toLatin1();
+    QByteArray msg;
+    QTime      utc = QTime::currentTime();
+
+    msg.reserve( 1536 );
+    msg.append( '{' );
+    addField( &msg, "GPSLastFixSinceMidnightUTC", static_cast<double>( utc.msecsSinceStartOfDay() ) / 1000.0, 2 );
+    addField( &msg, "GPSLatitude", m_dLat, 6 );
+    addField( &msg, "GPSLongitude", m_dLong, 6 );
+    addField( &msg, "GPSFixQuality", 2 );
+    addField( &msg, "GPSHeightAboveEllipsoid", m_dAlt - 100.0, 1 );
+    addField( &msg, "GPSGeoidSep", -100.0, 1 );
+    addField( &msg, "GPSSatellites", 9 );
+    addField( &msg, "GPSSatellitesTracked", 12 );
+    addField( &msg, "GPSSatellitesSeen", 14 );
+    addField( &msg, "GPSHorizontalAccuracy", 3.5, 1 );
+    addField( &msg, "GPSNACp", 10 );
+    addField( &msg, "GPSAltitudeMSL", m_dAlt, 1 );
+    addField( &msg, "GPSVerticalAccuracy", 7.0, 1 );
+    addField( &msg, "GPSVerticalSpeed", 0.0, 1 );
+    addField( &msg, "GPSLastFixLocalTime", qsNow.constData() );
+    addField( &msg, "GPSTrueCourse", m_dTrack, 1 );
+    addField( &msg, "GPSTurnRate", m_bOwnshipOrbit ? 3.0 : 0.0, 1 );
+    addField( &msg, "GPSGroundSpeed", m_dSpeed, 1 );
+    addField( &msg, "GPSLastGroundTrackTime", qsNow.constData() );
+    addField( &msg, "GPSTime", qsNow.constData() );
+    addField( &msg, "GPSLastGPSTimeStratuxTime", qsNow.constData() );
+    addField( &msg, "GPSLastValidNMEAMessageTime", qsNow.constData() );
+    addField( &msg, "GPSLastValidNMEAMessage", "$GPGGA,SIM" );
+    addField( &msg, "GPSPositionSampleRate", 10 );
+    addField( &msg, "BaroTemperature", 15.0, 1 );
+    addField( &msg, "BaroPressureAltitude", m_dAlt, 1 );
+    addField( &msg, "BaroVerticalSpeed", 0.0, 1 );
+    addField( &msg, "BaroLastMeasurementTime", qsNow.constData() );
+    addField( &msg, "AHRSPitch", m_dPitch, 2 );
+    addField( &msg, "AHRSRoll", m_dRoll, 2 );
+    addField( &msg, "AHRSGyroHeading", m_dTrack, 2 );
+    addField( &msg, "AHRSMagHeading", m_dTrack, 2 );
+    addField( &msg, "AHRSSlipSkid", 0.0, 2 );
+    addField( &msg, "AHRSTurnRate", m_bOwnshipOrbit ? 3.0 : 0.0, 2 );
+    addField( &msg, "AHRSGLoad", 1.0 / cos( m_dRoll * s_dDegToRad ), 3 );
+    addField( &msg, "AHRSGLoadMin", 0.9, 3 );
+    addField( &msg, "AHRSGLoadMax", 1.2, 3 );
+    addField( &msg, "AHRSLastAttitudeTime", qsNow.constData() );
+    addField( &msg, "AHRSStatus", 7 );
+    closeMessage( &msg );
+
+    return msg;
+}
+
+
+// Same layout as the Stratux sends; the Timestamp is the send time so a receiver can measure end to end latency
+QByteArray StratuxSim::trafficMessage( const SimTarget &target )
+{
+    QByteArray qsNow = QDateTime::currentDateTimeUtc().toString( Qt::ISODateWithMs ).toLatin1();
+    QByteArray msg;
+
+    msg.reserve( 640 );
+    msg.append( '{' );
+    addField( &msg, "Icao_addr", target.iICAO );
+    addField( &msg, "Reg", target.szTail );
+    addField( &msg, "Tail", target.szTail );
+    addField( &msg, "Emitter_category", 1 );
+    addField( &msg, "OnGround", target.dAlt < 1.0 );
+    addField( &msg, "Addr_type", 0 );
+    addField( &msg, "TargetType", 1 );
+    addField( &msg, "SignalLevel", -28.5, 1 );
+    addField( &msg, "Squawk", target.iSquawk );
+    addField( &msg, "Position_valid", true );
+    addField( &msg, "Lat", target.dLat, 6 );
+    addField( &msg, "Lng", target.dLong, 6 );
+    addField( &msg, "Alt", static_cast<int>( target.dAlt ) );
+    addField( &msg, "AltIsGNSS", false );
+    addField( &msg, "NIC", 8 );
+    addField( &msg, "NACp", 10 );
+    addField( &msg, "Track", static_cast<int>( target.dTrack ) );
+    addField( &msg, "Speed", static_cast<int>( target.dSpeed ) );
+    addField( &msg, "Speed_valid", true );
+    addField( &msg, "Vvel", static_cast<int>( target.dVertSpeed ) );
+    addField( &msg, "Timestamp", qsNow.constData() );
+    addField( &msg, "PriorityStatus", 0 );
+    addField( &msg, "Age", 0.1, 1 );
+    addField( &msg, "AgeLastAlt", 0.1, 1 );
+    addField( &msg, "Last_seen", qsNow.constData() );
+    addField( &msg, "Last_source", 1 );
+    addField( &msg, "ExtrapolatedPosition", false );
+    addField( &msg, "BearingDist_valid", true );
+    addField( &msg, "Bearing", bearingTo( target.dLat, target.dLong ), 1 );
+    addField( &msg, "Distance", distanceNM( target.dLat, target.dLong ) * s_dNMToMeters, 0 );
+    closeMessage( &msg );
+
+    return msg;
+}
+
+
+QByteArray StratuxSim::statusMessage()
+{
+    QByteArray msg;
+    int        iES = m_targets.count() * 3 / 4;
+
+    msg.append( '{' );
+    addField( &msg, "Version", "sim" );
+    addField( &msg, "UAT_traffic_targets_tracking", m_targets.count() - iES );
+    addField( &msg, "ES_traffic_targets_tracking", iES );
+    addField( &msg, "GPS_satellites_locked", 9 );
+    addField( &msg, "GPS_connected", true );
+    closeMessage( &msg );
+
+    return msg;
+}
+
+
+// Inverse of what StreamReader::wtDatagram and calcHeading do with the raw sensor values
+QByteArray StratuxSim::wingThingMessage()
+{
+    double     dMagAngle = (90.0 - m_dTrack) * s_dDegToRad;
+    QByteArray msg;
+
+    msg.append( "213," );
+    msg.append( QByteArray::number( static_cast<int>( m_dSpeed / 173.7952 * 8192.0 ) ) ).append( ',' );
+    msg.append( QByteArray::number( m_dAlt, 'f', 1 ) ).append( ',' );
+    msg.append( "15.0," );
+    msg.append( QByteArray::number( cos( dMagAngle ) * 400.0, 'f', 1 ) ).append( ',' );
+    msg.append( QByteArray::number( sin( dMagAngle ) * 400.0, 'f', 1 ) ).append( ',' );
+    msg.append( "-300.0," );
+    msg.append( QByteArray::number( m_dTrack, 'f', 1 ) ).append( ',' );
+    msg.append( QByteArray::number( m_dPitch * 4.0, 'f', 2 ) ).append( ',' );
+    msg.append( QByteArray::number( m_dRoll, 'f', 2 ) ).append( ',' );
+    msg.append( "0.0,0.0,9.8" );
+
+    return msg;
+}
+
+
+// The Stratux serves each stream on its own path; anything else is turned away
+void StratuxSim::newClient()
+{
+    QWebSocket *pClient;
+    QString     qsPath;
+
+    while( m_server.hasPendingConnections() )
+    {
+        pClient = m_server.nextPendingConnection();
+        qsPath = pClient->requestUrl().path();
+        connect( pClient, SIGNAL( disconnected() ), this, SLOT( clientGone() ) );
+        if( qsPath == "/situation" )
+            m_situationClients.append( pClient );
+        else if( qsPath == "/traffic" )
+            m_trafficClients.append( pClient );
+        else if( qsPath == "/status" )
+            m_statusClients.append( pClient );
+        else
+        {
+            qWarning() << "Unknown stream requested" << qsPath;
+            pClient->close( QWebSocketProtocol::CloseCodeBadOperation );
+            continue;
+        }
+        qInfo() << "Client connected to" << qsPath << "from" << pClient->peerAddress().toString();
+    }
+}
+
+
+void StratuxSim::clientGone()
+{
+    QWebSocket *pClient = qobject_cast<QWebSocket *>( sender() );
+
+    if( pClient == nullptr )
+        return;
+    m_situationClients.removeAll( pClient );
+    m_trafficClients.removeAll( pClient );
+    m_statusClients.removeAll( pClient );
+    pClient->deleteLater();
+}
+
+
+void StratuxSim::situationTick()
+{
+    qint64 iNowMs = m_clock.elapsed();
+
+    moveOwnship( static_cast<double>( iNowMs - m_iLastOwnshipMs ) / 1000.0 );
+    m_iLastOwnshipMs = iNowMs;
+    if( !m_situationClients.isEmpty() )
+    {
+        broadcast( m_situationClients, situationMessage() );
+        m_uiSituationSent++;
+    }
+    restart( &m_situationTimer, m_dSituationHz );
+}
+
+
+// Each target reports at the traffic rate; the reports due since the last tick go out round robin so a large
+// fleet is spread evenly over the second instead of arriving in one burst
+void StratuxSim::trafficTick()
+{
+    qint64 iNowMs = m_clock.elapsed();
+    int    iCount = m_targets.count();
+    int    iSend;
+
+    m_dTrafficDue += static_cast<double>( iCount ) * m_dTrafficHz * static_cast<double>( iNowMs - m_iLastTrafficMs ) / 1000.0;
+    m_iLastTrafficMs = iNowMs;
+    iSend = static_cast<int>( m_dTrafficDue );
+    m_dTrafficDue -= iSend;
+
+    // Never more than one report per target per tick; whatever's left over is dropped rather than carried
+    if( iSend > iCount )
+    {
+        iSend = iCount;
+        m_dTrafficDue = 0.0;
+    }
+
+    for( int i = 0; i < iSend; i++ )
+    {
+        SimTarget &target = m_targets[m_iNextTarget];
+
+        move( &target, iNowMs );
+        if( !m_trafficClients.isEmpty() )
+        {
+            broadcast( m_trafficClients, trafficMessage( target ) );
+            m_uiTrafficSent++;
+        }
+        m_iNextTarget = (m_iNextTarget + 1) % iCount;
+    }
+    restart( &m_trafficTimer, s_dTrafficTickHz );
+}
+
+
+void StratuxSim::statusTick()
+{
+    if( !m_statusClients.isEmpty() )
+    {
+        broadcast( m_statusClients, statusMessage() );
+        m_uiStatusSent++;
+    }
+    restart( &m_statusTimer, m_dStatusHz );
+}
+
+
+void StratuxSim::wingThingTick()
+{
+    QByteArray msg = wingThingMessage();
+
+    m_wtSocket.writeDatagram( msg, m_wtHost, 45678 );
+    m_uiWingThingSent++;
+    m_iBytesSent += msg.size();
+    restart( &m_wtTimer, m_dWingThingHz );
+}
+
+
+void StratuxSim::statsTick()
+{
+    qInfo() << QString( "clients %1/%2/%3  situation %4/s  traffic %5/s (%6 targets)  status %7/s  WingThing %8/s  %9 KB/s" )
+                   .arg( m_situationClients.count() )
+                   .arg( m_trafficClients.count() )
+                   .arg( m_statusClients.count() )
+                   .arg( m_uiSituationSent )
+                   .arg( m_uiTrafficSent )
+                   .arg( m_targets.count() )
+                   .arg( m_uiStatusSent )
+                   .arg( m_uiWingThingSent )
+                   .arg( m_iBytesSent / 1024 )
+                   .toLatin1().constData();
+    m_uiSituationSent = 0;
+    m_uiTrafficSent = 0;
+    m_uiStatusSent = 0;
+    m_uiWingThingSent = 0;
+    m_iBytesSent = 0;
+}
+
+
+void StratuxSim::scriptTick()
+{
+    ScriptStep step = m_script.takeFirst();
+
+    qInfo() << "Script:" << step.qslSettings.join( ' ' ).toLatin1().constData();
+    foreach( QString qsSetting, step.qslSettings )
+    {
+        if( !apply( qsSetting ) )
+            qWarning() << "Unknown script setting" << qsSetting;
+    }
+
+    if( !m_script.isEmpty() )
+        m_scriptTimer.start( static_cast<int>( qMax( m_script.first().iAtMs - m_clock.elapsed(), static_cast<qint64>( 0 ) ) ) );
+}
@@ -0,0 +1,31 @@
+#-------------------------------------------------
+#
+# StratuxSim - Stratux and WingThing stand-in for bench testing Stratofier
+# Copyright 2019 Sky Fun
+#
+#-------------------------------------------------
+
+QT += core websockets network
+QT -= gui
+
+CONFIG += console
+CONFIG -= app_bundle
+
+TARGET = StratuxSim
+TEMPLATE = app
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+VPATH += ./include
+
+INCLUDEPATH += ./include
+
+DESTDIR = ./bin
+OBJECTS_DIR = ./obj
+
+MOC_DIR = ./gen/moc
+
+SOURCES += main.cpp \
+           StratuxSim.cpp
+
+HEADERS += StratuxSim.h
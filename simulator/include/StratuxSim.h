@@ -0,0 +1,151 @@
+/*
+Stratofier Stratux AHRS Display
+(c) 2018 Allen K. Lair, Sky Fun
+*/
+
+#ifndef __STRATUXSIM_H__
+#define __STRATUXSIM_H__
+
+#include <QObject>
+#include <QWebSocketServer>
+#include <QWebSocket>
+#include <QUdpSocket>
+#include <QHostAddress>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QRandomGenerator>
+#include <QList>
+#include <QVector>
+#include <QStringList>
+
+
+// Simulated traffic target
+struct SimTarget
+{
+    int    iICAO;
+    char   szTail[8];
+    int    iSquawk;
+    double dLat;
+    double dLong;
+    double dAlt;            // Feet
+    double dTrack;          // Degrees true
+    double dSpeed;          // Knots
+    double dVertSpeed;      // Feet per minute
+    double dTurnRate;       // Degrees per second, orbit pattern only
+    qint64 iLastMoveMs;
+};
+
+
+// Stand-in for a Stratux (and optionally a WingThing) on the bench.
+// Serves /situation, /traffic and /status on a websocket server the same way the Stratux does and broadcasts WingThing
+// sensor datagrams to port 45678. Everything is driven by token=value settings, either from the command line or from
+// a script that changes them over time so throughput and latency runs are repeatable.
+class StratuxSim : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Pattern
+    {
+        Straight,
+        Orbit,
+        Wander,
+        Converge
+    };
+
+    explicit StratuxSim( QObject *pParent = nullptr );
+    ~StratuxSim();
+
+    bool listen( quint16 uiPort );
+    bool loadScript( const QString &qsFile );
+    bool apply( const QString &qsSetting );
+    void start();
+
+signals:
+    void finished();
+
+private:
+    void   setTargetCount( int iCount );
+    void   spawn( SimTarget *pTarget );
+    void   move( SimTarget *pTarget, qint64 iNowMs );
+    void   moveOwnship( double dSecs );
+    void   restart( QTimer *pTimer, double dRateHz );
+    void   broadcast( QList<QWebSocket *> &clients, const QByteArray &message );
+    void   offset( double dBearing, double dDistNM, double *pLat, double *pLong );
+    double distanceNM( double dLat, double dLong );
+    double bearingTo( double dLat, double dLong );
+
+    QByteArray situationMessage();
+    QByteArray trafficMessage( const SimTarget &target );
+    QByteArray statusMessage();
+    QByteArray wingThingMessage();
+
+    QWebSocketServer    m_server;
+    QList<QWebSocket *> m_situationClients;
+    QList<QWebSocket *> m_trafficClients;
+    QList<QWebSocket *> m_statusClients;
+    QUdpSocket          m_wtSocket;
+    QHostAddress        m_wtHost;
+
+    QTimer m_situationTimer;
+    QTimer m_trafficTimer;
+    QTimer m_statusTimer;
+    QTimer m_wtTimer;
+    QTimer m_statsTimer;
+    QTimer m_scriptTimer;
+
+    QElapsedTimer    m_clock;
+    QRandomGenerator m_random;
+
+    // Settings
+    double  m_dSituationHz;
+    double  m_dTrafficHz;       // Reports per second per target
+    double  m_dStatusHz;
+    double  m_dWingThingHz;
+    int     m_iJitterMs;        // Each send interval is moved by up to this much either way
+    Pattern m_ePattern;
+    double  m_dRadiusNM;        // Targets are spawned within this distance of ownship
+    bool    m_bOwnshipOrbit;
+
+    // Ownship
+    double m_dLat;
+    double m_dLong;
+    double m_dAlt;
+    double m_dTrack;
+    double m_dSpeed;
+    double m_dPitch;
+    double m_dRoll;
+    qint64 m_iLastOwnshipMs;
+
+    QVector<SimTarget> m_targets;
+    int                m_iNextTarget;       // Round robin position for traffic reports
+    double             m_dTrafficDue;       // Fractional reports carried between ticks
+    qint64             m_iLastTrafficMs;
+
+    // Script
+    struct ScriptStep
+    {
+        qint64      iAtMs;
+        QStringList qslSettings;
+    };
+    QList<ScriptStep> m_script;
+
+    // Counters for the once a second log
+    quint32 m_uiSituationSent;
+    quint32 m_uiTrafficSent;
+    quint32 m_uiStatusSent;
+    quint32 m_uiWingThingSent;
+    qint64  m_iBytesSent;
+
+private slots:
+    void newClient();
+    void clientGone();
+    void situationTick();
+    void trafficTick();
+    void statusTick();
+    void wingThingTick();
+    void statsTick();
+    void scriptTick();
+};
+
+#endif // __STRATUXSIM_H__
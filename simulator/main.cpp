@@ -0,0 +1,47 @@
+/*
+Stratofier Stratux AHRS Display
+(c) 2018 Allen K. Lair, Sky Fun
+*/
+
+#include <QCoreApplication>
+#include <QtDebug>
+
+#include "StratuxSim.h"
+
+
+// Arguments are the same token=value settings a script uses plus:
+//   port=<websocket port>  (default 8080; run Stratofier with ip=<this host>:<port>)
+//   script=<file>          (timed settings, see StratuxSim::loadScript)
+// e.g. StratuxSim targets=500 trafficrate=2 pattern=orbit jitter=10 wtrate=10 wthost=127.0.0.1
+int main( int argc, char *argv[] )
+{
+    QCoreApplication app( argc, argv );
+    QStringList      qslArgs = app.arguments();
+    QString          qsArg;
+    QString          qsScript;
+    quint16          uiPort = 8080;
+    StratuxSim       sim;
+
+    // Before anything's applied; a quit among the arguments or at the top of a script has to get through
+    QObject::connect( &sim, SIGNAL( finished() ), &app, SLOT( quit() ), Qt::QueuedConnection );
+
+    qslArgs.removeFirst();
+    foreach( qsArg, qslArgs )
+    {
+        if( qsArg.startsWith( "port=" ) )
+            uiPort = static_cast<quint16>( qsArg.mid( 5 ).toUInt() );
+        else if( qsArg.startsWith( "script=" ) )
+            qsScript = qsArg.mid( 7 );
+        else if( !sim.apply( qsArg ) )
+            qWarning() << "Ignoring unknown setting" << qsArg;
+    }
+
+    if( !qsScript.isEmpty() && !sim.loadScript( qsScript ) )
+        return 1;
+    if( !sim.listen( uiPort ) )
+        return 1;
+
+    sim.start();
+
+    return app.exec();
+}